@@ -2,131 +2,33 @@
 #define _BLASR_AFFINE_GUIDE_ALIGNMENT_HPP_
 
 #include "GuidedAlign.hpp"
-template<typename QSequence, typename TSequence, typename T_ScoreFn>
-int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guideAlignment,
+
+//
+// Fill matrices along guide with affine gaps, and store the alignment
+// that ends at the end of the guide.  qSeq and tSeq are the 3-bit
+// copies made by AffineGuidedAlign.
+//
+template<typename QSequence, typename TSequence, typename T_ScoreFn, typename T_Matrices>
+int AffineAlignAlongGuide(QSequence &qSeq, TSequence &tSeq, Guide &guide,
         T_ScoreFn &scoreFn,
-        int bandSize,
+        T_Matrices &matrices,
         Alignment &alignment,
-        std::vector<int>    &scoreMat,
-        std::vector<Arrow>  &pathMat,
-        std::vector<double> &probMat,
-        std::vector<double> &optPathProbMat,
-        std::vector<float>  &lnSubPValueVect,
-        std::vector<float>  &lnInsPValueVect,
-        std::vector<float>  &lnDelPValueVect,
-        std::vector<float>  &lnMatchPValueVect,
-        AlignmentType alignType=Global, 
-        bool computeProb=false) {
-
-    Guide guide;
-    AlignmentToGuide(guideAlignment, guide, bandSize);
-    StoreMatrixOffsets(guide);
-    int guideSize = ComputeMatrixNElem(guide);
-
-    //
-    // Make a copy of the sequences that is guaranteed to be in 3-bit format for faster alignment.
-    // (mabybe eventually reuse the qseq and tseq memory)
-    //
-    QSequence qSeq;
-    TSequence tSeq;
-    qSeq.Assign(origQSeq);
-    tSeq.Assign(origTSeq);
-
-    int matrixNElem = ComputeMatrixNElem(guide);
-    StoreMatrixOffsets(guide);
-
-    /*
-     * The following code is useful to produce images of the dp-matrix.
-     * Make sure the sequenences are less than 5kb each though.
-
-     Matrix<float> probMatrix;
-     probMatrix.Resize(qSeq.length, tSeq.length);
-     probMatrix.Initialize(0);
-     ofstream matrixOut;
-     stringstream matrixOutNameStrm;
-     matrixOutNameStrm << "probMatrix_"<< runIndex << ".dat";
-     matrixOut.open(matrixOutNameStrm.str().c_str());
-     */
-
-    if (computeProb) { 
-        //
-        // Convert phred scale to proper ln for faster manipulation later on.
-        //
-        QVToLogPScale(qSeq.substitutionQV, qSeq.length, lnSubPValueVect);
-        QVToLogPScale(qSeq.insertionQV,    qSeq.length, lnInsPValueVect);
-        QVToLogPScale(qSeq.deletionQV,     qSeq.length, lnDelPValueVect);
-        if (lnMatchPValueVect.size() < qSeq.length) {
-            lnMatchPValueVect.resize(qSeq.length);
-        }
-        //
-        // Normalize probability std::vectors so that the probability of transition from each cell is 1.
-        //
-        int i;
-        for (i = 0; i < qSeq.length; i++) {
-            float subSum  = LogSumOfTwo(lnSubPValueVect[i], QVToLogPScale(scoreFn.substitutionPrior)); // prior on substitution rate
-            float denominator = LogSumOfThree(lnDelPValueVect[i], lnInsPValueVect[i], subSum);
-            lnDelPValueVect[i] = lnDelPValueVect[i] - denominator;
-            lnSubPValueVect[i]   = lnSubPValueVect[i] - denominator;
-            lnInsPValueVect[i]   = lnInsPValueVect[i] - denominator;
-            lnMatchPValueVect[i] = subSum - denominator;
-        }
-
-    }
+        AlignmentType alignType,
+        bool computeProb) {
 
-
-
-    // 
-    // Make sure the alignments can fit in the reused buffers.
-    //
-    std::vector<int>    affineInsScoreMat, affineDelScoreMat;
-    std::vector<Arrow>  affineInsPathMat, affineDelPathMat;
-    affineInsScoreMat.resize(matrixNElem);
-    fill(affineInsScoreMat.begin(), affineInsScoreMat.end(), 0);
-    affineDelScoreMat.resize(matrixNElem);
-    fill(affineDelScoreMat.begin(), affineDelScoreMat.end(), 0);
-    affineInsPathMat.resize(matrixNElem);
-    fill(affineInsPathMat.begin(), affineInsPathMat.end(), NoArrow);
-    affineDelPathMat.resize(matrixNElem);
-    fill(affineDelPathMat.begin(), affineDelPathMat.end(), NoArrow);
-
-
-    if (scoreMat.size() < matrixNElem) {
-        scoreMat.resize(matrixNElem);
-        pathMat.resize(matrixNElem);
-        fill(scoreMat.begin(), scoreMat.end(), 0);
-        fill(pathMat.begin(), pathMat.end(), NoArrow);
-    }
-    if (computeProb) {
-        if (probMat.size() < matrixNElem) {
-            probMat.resize(matrixNElem);
-            optPathProbMat.resize(matrixNElem);
-        }
+    // start alignemnt at the beginning of the guide, and align to the
+    // end of the guide.
+    if (guide.size() == 0) {
+        return 0;
     }
+    int matrixNElem = ComputeMatrixNElem(guide);
+    matrices.Initialize(guide, matrixNElem, computeProb, true);
 
-    // 
-    // Initialze matrices.  Only initialize up to matrixNElem rather
-    // than matrix.size() because the matrix.size() unnecessary space
-    // may be allocated.
-    //
-
-    std::fill(scoreMat.begin(), scoreMat.begin() + matrixNElem, 0);
-    std::fill(pathMat.begin(), pathMat.begin() + matrixNElem, NoArrow);
-    if (computeProb) {
-        std::fill(probMat.begin(), probMat.begin() + matrixNElem, 0);	
-        std::fill(optPathProbMat.begin(), optPathProbMat.begin() + matrixNElem, 0);
-    }
     //
     // Initialize boundary conditions.
     //
     int q, t;
     int bufferIndex;
-    // start alignemnt at the beginning of the guide, and align to the
-    // end of the guide.
-    if (guide.size() == 0) {
-        qSeq.Free();
-        tSeq.Free();
-        return 0;
-    }
     int qStart = guide[1].q;
     int tStart = guide[1].t;
     int qEnd   = guide[guide.size()-1].q+1;
@@ -135,79 +37,57 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
     GetBufferIndexFunctor GetBufferIndex;
     GetBufferIndex.seqRowOffset = qStart;
     GetBufferIndex.guideSize    = guide.size();
-    int indicesAreValid, delIndexIsValid, insIndexIsValid, matchIndexIsValid;
+    int indicesAreValid, delIndexIsValid;
+    matrices.StartRow(guide[0].matrixOffset - guide[0].tPre);
     bufferIndex = -1;
     indicesAreValid = GetBufferIndex(guide, qStart-1, tStart-1, bufferIndex);
     assert(indicesAreValid);
-    scoreMat[bufferIndex] = 0;
-    pathMat[bufferIndex]  = NoArrow;
+    matrices.Score(bufferIndex) = 0;
+    matrices.SetArrow(bufferIndex, NoArrow);
     int matchIndex, insIndex, delIndex, curIndex;
 
     //
     // Initialize deletion row.
     //
-    if (computeProb) {
-        probMat[0] = optPathProbMat[0] = 0;
-    }
     for (t = tStart; t < tStart + guide[0].tPost; t++) {
         curIndex=-1;
         indicesAreValid = GetBufferIndex(guide, qStart-1, t, curIndex);
         if (indicesAreValid == 0 ) {
+            qSeq.ToAscii();
+            tSeq.ToAscii();
             cout << "QSeq" << endl;
-            (static_cast<DNASequence*>(&origQSeq))->PrintSeq(cout);
+            (static_cast<DNASequence*>(&qSeq))->PrintSeq(cout);
             cout << "TSeq" << endl;
-            (static_cast<DNASequence*>(&origTSeq))->PrintSeq(cout);
+            (static_cast<DNASequence*>(&tSeq))->PrintSeq(cout);
             assert(0);
         }
         delIndex = -1;
         delIndexIsValid = GetBufferIndex(guide, qStart-1, t-1, delIndex);
         if (delIndexIsValid) {
             if (alignType == Global) {
-                scoreMat[curIndex] = scoreMat[delIndex] + scoreFn.del;
+                matrices.Score(curIndex) = matrices.Score(delIndex) + scoreFn.del;
             }
             else if (alignType == Local) {
-                scoreMat[curIndex] = 0;
+                matrices.Score(curIndex) = 0;
             }
-            affineDelScoreMat[curIndex] = scoreFn.del;
-            affineDelPathMat[curIndex] = AffineDelOpen;
-            affineInsPathMat[curIndex] = AffineInsOpen;
-            affineInsScoreMat[curIndex] = scoreFn.ins;
-            pathMat[curIndex] = Left;
+            matrices.DelScore(curIndex) = scoreFn.del;
+            matrices.SetDelArrow(curIndex, AffineDelOpen);
+            matrices.SetInsArrow(curIndex, AffineInsOpen);
+            matrices.InsScore(curIndex) = scoreFn.ins;
+            matrices.SetArrow(curIndex, Left);
             if (computeProb) {
                 if (qSeq.qual.Empty() == false) {
-                    optPathProbMat[curIndex] = probMat[curIndex] = probMat[delIndex] + QVToLogPScale(scoreFn.globalDeletionPrior);
+                    matrices.Prob(curIndex) = matrices.Prob(delIndex) + QVToLogPScale(scoreFn.globalDeletionPrior);
+                    matrices.SetOptPathProb(curIndex, matrices.Prob(curIndex));
                 }
             }
         }
     }
 
-    // 
-    // Initialize stripe along the top of the grid.
     //
-    for (q = qStart ; q < qStart + bandSize and q < qEnd; q++) {
-        insIndex = -1;
-        insIndexIsValid = GetBufferIndex(guide, q-1, tStart-1, // diagonal from t-start
-                insIndex);
-        curIndex = -1;
-        indicesAreValid = GetBufferIndex(guide, q, tStart-1, curIndex);
-
-        if (insIndexIsValid and indicesAreValid) {
-            assert(insIndex >= 0);
-            assert(curIndex >= 0);
-            if (alignType == Global) {
-                scoreMat[curIndex] = scoreMat[insIndex] + scoreFn.ins;
-            }
-            else {
-                scoreMat[curIndex] = 0;
-            }
-            affineInsScoreMat[curIndex] = scoreFn.ins;
-            affineInsPathMat[curIndex]  = AffineInsOpen;
-            affineDelScoreMat[curIndex] = scoreFn.del;
-            affineDelPathMat[curIndex] = AffineDelOpen;
-            pathMat[curIndex] = Up;
-        }
-    }
-
+    // As in AlignAlongGuide, the cells along column tStart-1 are
+    // computed with the rest of their row.
+    //
     int matchScore, insScore, delScore, 
         affineInsOpenScore, affineInsExtScore, 
         affineDelOpenScore, affineDelExtScore;
@@ -216,28 +96,16 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         int qi = q - qStart + 1;
         int tp = guide[qi].t;
         curIndex = matchIndex = insIndex = delIndex = -1;
+        matrices.StartRow(guide[qi].matrixOffset - guide[qi].tPre);
 
         //
-        // Do some work that will help define when matchIndex and insIndex
-        // may be used.  Once delIndex is computed once, it is valid for
-        // all t positions.
+        // Define the boundaries of the column which may access
+        // previously computed cells with a match.  Once delIndex is
+        // computed once, it is valid for all t positions.
         //
-        int prevRowTEnd = -1;
-        if ( qi > 0) { 
-            //
-            // Define the boundaries of the column which may access previously
-            // computed cells with a match.
-            //
-            prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
-        }    
+        int prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
 
         for (t = tp - guide[qi].tPre ; t < guide[qi].t + guide[qi].tPost +1; t++) {
-
-            if (q < qStart + bandSize and t == tp - guide[qi].tPre - 1) {
-                // On the boundary condition, don't access the 1st element;
-                t++;
-                continue;
-            }
             // Make sure the index is not past the end of the sequence.
             if (t < -1) continue;
             if (t >= tEnd) continue;
@@ -261,7 +129,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
 
             if (GetBufferIndex(guide, q-1,t-1, matchIndex)) {
                 assert(matchIndex >= 0);
-                matchScore = scoreMat[matchIndex] + scoreFn.Match(tSeq, t, qSeq, q);
+                matchScore = matrices.Score(matchIndex) + scoreFn.Match(tSeq, t, qSeq, q);
             }
             else {
                 matchScore = INF_INT;
@@ -269,8 +137,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
 
             if (GetBufferIndex(guide, q-1, t, insIndex)) {
                 assert(insIndex >= 0);
-                insScore = scoreMat[insIndex] + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
-                affineInsExtScore = affineInsScoreMat[insIndex] + scoreFn.affineExtend; // 0 extension 
+                insScore = matrices.Score(insIndex) + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
+                affineInsExtScore = matrices.InsScore(insIndex) + scoreFn.affineExtend; // 0 extension 
             }
             else {
                 insScore = INF_INT;
@@ -278,8 +146,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             }
             if (GetBufferIndex(guide, q, t-1, delIndex)) {
                 assert(delIndex >= 0);
-                delScore = scoreMat[delIndex] + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
-                affineDelExtScore = affineDelScoreMat[delIndex] + scoreFn.affineExtend;
+                delScore = matrices.Score(delIndex) + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
+                affineDelExtScore = matrices.DelScore(delIndex) + scoreFn.affineExtend;
             }
             else {
                 delScore = INF_INT;
@@ -291,62 +159,56 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             // This should only loop over valid cells.
             assert(result);
             assert(curIndex >= 0);
-            scoreMat[curIndex] = minScore;
+            matrices.Score(curIndex) = minScore;
             if (minScore == INF_INT) {
-                pathMat[curIndex] = NoArrow;
+                matrices.SetArrow(curIndex, NoArrow);
+            }
+            else if (minScore == matchScore) {
+                matrices.SetArrow(curIndex, Diagonal);
+            }
+            else if (minScore == delScore) {
+                matrices.SetArrow(curIndex, Left);
+            }
+            else if (minScore == insScore) {
+                matrices.SetArrow(curIndex, Up);
+            }
+            else if (minScore == affineInsExtScore) {
+                matrices.SetArrow(curIndex, AffineInsClose);
             }
             else {
-                assert(result == 1);
-                if (minScore == matchScore) {
-                    pathMat[curIndex] = Diagonal;
-                }
-                else if (minScore == delScore) {
-                    pathMat[curIndex] = Left;
-                }
-                else if (minScore == insScore) {
-                    pathMat[curIndex] = Up;
-                }
-                else if (minScore == affineInsExtScore) {
-                    pathMat[curIndex] = AffineInsClose;
-                }
-                else {
-                    assert (minScore == affineDelExtScore) ;
-                    pathMat[curIndex] = AffineDelClose;
-                }
+                assert (minScore == affineDelExtScore) ;
+                matrices.SetArrow(curIndex, AffineDelClose);
             }
 
-         //   affineInsOpenScore = scoreMat[curIndex] + scoreFn.ins * 2;
-         //   affineDelOpenScore = scoreMat[curIndex] + scoreFn.del * 2;
-
-      //
-      // Set the penalty to initiate an affine gap here.
-      //
-      affineInsOpenScore = scoreMat[curIndex] + scoreFn.affineOpen;
-      affineDelOpenScore = scoreMat[curIndex] + scoreFn.affineOpen;
+            //
+            // Set the penalty to initiate an affine gap here.
+            //
+            affineInsOpenScore = minScore + scoreFn.affineOpen;
+            affineDelOpenScore = minScore + scoreFn.affineOpen;
 
             if (affineInsOpenScore == INF_INT and 
                     affineInsExtScore == INF_INT) {
                 cout << q << " " << t << endl;
                 cout << "All infinity, bad things will happen." << endl;
-                cout << "the score mat here is : " << scoreMat[curIndex] << " and path " << pathMat[curIndex] << endl;
+                cout << "the score mat here is : " << minScore << " and path " << matrices.GetArrow(curIndex) << endl;
                 assert(0);
             }
             if (affineInsOpenScore < affineInsExtScore) {
-                affineInsPathMat[curIndex] = AffineInsOpen;
-                affineInsScoreMat[curIndex] = affineInsOpenScore;
+                matrices.SetInsArrow(curIndex, AffineInsOpen);
+                matrices.InsScore(curIndex) = affineInsOpenScore;
             }
             else {
-                affineInsPathMat[curIndex] = AffineInsUp;
-                affineInsScoreMat[curIndex] = affineInsExtScore;
+                matrices.SetInsArrow(curIndex, AffineInsUp);
+                matrices.InsScore(curIndex) = affineInsExtScore;
             }
 
             if (affineDelOpenScore < affineDelExtScore) {
-                affineDelPathMat[curIndex] = AffineDelOpen;
-                affineDelScoreMat[curIndex] = affineDelOpenScore;
+                matrices.SetDelArrow(curIndex, AffineDelOpen);
+                matrices.DelScore(curIndex) = affineDelOpenScore;
             }
             else {
-                affineDelPathMat[curIndex] = AffineDelLeft;
-                affineDelScoreMat[curIndex] = affineDelExtScore;
+                matrices.SetDelArrow(curIndex, AffineDelLeft);
+                matrices.DelScore(curIndex) = affineDelExtScore;
             }
         }
     }		
@@ -358,14 +220,12 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
     int curMatrix = Match;
     while(q >= qStart or t >= tStart) {
         bufferIndex = -1;
-        //    cout << "backtrace: " << q << " "<< t << endl;
         bufferIndexIsValid = GetBufferIndex(guide, q, t, bufferIndex);
         assert(bufferIndexIsValid);
         assert(bufferIndex >= 0);
         Arrow arrow;
-        //    cout << q << " "<< t << " " << curMatrix << " " << arrow << endl;
         if (curMatrix == Match) {
-            arrow = pathMat[bufferIndex];
+            arrow = matrices.GetArrow(bufferIndex);
             if (arrow == NoArrow) {
                 tSeq.ToAscii();
                 qSeq.ToAscii();
@@ -407,7 +267,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             }
         }
         else if (curMatrix == AffineIns) {
-            arrow = affineInsPathMat[bufferIndex];
+            arrow = matrices.GetInsArrow(bufferIndex);
             if (arrow == AffineInsOpen) {
                 curMatrix = Match;
             }
@@ -422,7 +282,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         }
         else {
             assert(curMatrix == AffineDel);
-            arrow = affineDelPathMat[bufferIndex];
+            arrow = matrices.GetDelArrow(bufferIndex);
             if (arrow == AffineDelOpen) {
                 curMatrix = Match;
             }
@@ -437,26 +297,113 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         }
     }
 
-    alignment.nCells = ComputeMatrixNElem(guide);
+    alignment.nCells = matrixNElem;
     std::reverse(optAlignment.begin(), optAlignment.end());
     alignment.qPos = qStart;
     alignment.tPos = tStart;
     alignment.ArrowPathToAlignment(optAlignment);
-    //  StickPrintAlignment(alignment, qSeq, tSeq, cout);
     RemoveAlignmentPrefixGaps(alignment);
-    int lastIndex = 0;
-    tSeq.Free();
-    qSeq.Free();
-    lastIndex = -1;
+    int lastIndex = -1;
     if (GetBufferIndex(guide, qEnd - 1, tEnd - 1, lastIndex)) {
-        alignment.score = scoreMat[lastIndex];
-        return scoreMat[lastIndex];
+        alignment.score = matrices.Score(lastIndex);
+        return alignment.score;
     }
     else {
         return 0;
     }
 }
 
+//
+// When compactTraceback is true, the alignment is computed in
+// GuidedAlignCompactMatrices, and scoreMat, pathMat, probMat and
+// optPathProbMat are left untouched.
+//
+template<typename QSequence, typename TSequence, typename T_ScoreFn>
+int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guideAlignment,
+        T_ScoreFn &scoreFn,
+        int bandSize,
+        Alignment &alignment,
+        std::vector<int>    &scoreMat,
+        std::vector<Arrow>  &pathMat,
+        std::vector<double> &probMat,
+        std::vector<double> &optPathProbMat,
+        std::vector<float>  &lnSubPValueVect,
+        std::vector<float>  &lnInsPValueVect,
+        std::vector<float>  &lnDelPValueVect,
+        std::vector<float>  &lnMatchPValueVect,
+        AlignmentType alignType=Global,
+        bool computeProb=false,
+        bool compactTraceback=false) {
+
+    Guide guide;
+    AlignmentToGuide(guideAlignment, guide, bandSize);
+    StoreMatrixOffsets(guide);
+
+    //
+    // Make a copy of the sequences that is guaranteed to be in 3-bit format for faster alignment.
+    // (mabybe eventually reuse the qseq and tseq memory)
+    //
+    QSequence qSeq;
+    TSequence tSeq;
+    qSeq.Assign(origQSeq);
+    tSeq.Assign(origTSeq);
+
+    /*
+     * The following code is useful to produce images of the dp-matrix.
+     * Make sure the sequenences are less than 5kb each though.
+
+     Matrix<float> probMatrix;
+     probMatrix.Resize(qSeq.length, tSeq.length);
+     probMatrix.Initialize(0);
+     ofstream matrixOut;
+     stringstream matrixOutNameStrm;
+     matrixOutNameStrm << "probMatrix_"<< runIndex << ".dat";
+     matrixOut.open(matrixOutNameStrm.str().c_str());
+     */
+
+    if (computeProb) { 
+        //
+        // Convert phred scale to proper ln for faster manipulation later on.
+        //
+        QVToLogPScale(qSeq.substitutionQV, qSeq.length, lnSubPValueVect);
+        QVToLogPScale(qSeq.insertionQV,    qSeq.length, lnInsPValueVect);
+        QVToLogPScale(qSeq.deletionQV,     qSeq.length, lnDelPValueVect);
+        if (lnMatchPValueVect.size() < qSeq.length) {
+            lnMatchPValueVect.resize(qSeq.length);
+        }
+        //
+        // Normalize probability std::vectors so that the probability of transition from each cell is 1.
+        //
+        int i;
+        for (i = 0; i < qSeq.length; i++) {
+            float subSum  = LogSumOfTwo(lnSubPValueVect[i], QVToLogPScale(scoreFn.substitutionPrior)); // prior on substitution rate
+            float denominator = LogSumOfThree(lnDelPValueVect[i], lnInsPValueVect[i], subSum);
+            lnDelPValueVect[i] = lnDelPValueVect[i] - denominator;
+            lnSubPValueVect[i]   = lnSubPValueVect[i] - denominator;
+            lnInsPValueVect[i]   = lnInsPValueVect[i] - denominator;
+            lnMatchPValueVect[i] = subSum - denominator;
+        }
+
+    }
+
+
+
+    int score;
+    if (compactTraceback) {
+        GuidedAlignCompactMatrices matrices;
+        score = AffineAlignAlongGuide(qSeq, tSeq, guide, scoreFn, matrices, 
+                                      alignment, alignType, computeProb);
+    }
+    else {
+        GuidedAlignFullMatrices matrices(scoreMat, pathMat, probMat, optPathProbMat);
+        score = AffineAlignAlongGuide(qSeq, tSeq, guide, scoreFn, matrices, 
+                                      alignment, alignType, computeProb);
+    }
+    tSeq.Free();
+    qSeq.Free();
+    return score;
+}
+
 
 template<typename QSequence, typename TSequence, typename T_ScoreFn> //, typename T_BufferCache>
 int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
@@ -466,7 +413,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
         Alignment &alignment,
         AlignmentType alignType=Global,
         bool computeProb = false,
-        int sdpTupleSize= 8) {
+        int sdpTupleSize= 8,
+        bool compactTraceback = false) {
     Alignment sdpAlignment;
 
     int alignScore = SDPAlign(origQSeq, origTSeq,
@@ -484,7 +432,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
 
     return AffineGuidedAlign(origQSeq, origTSeq, sdpAlignment, scoreFn, bandSize, alignment,
             // fill in optional parameters
-            alignType, computeProb);
+            alignType, computeProb, compactTraceback);
 
 }
 
@@ -503,7 +451,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
         Alignment &alignment, 
         AlignmentType alignType=Global,
         bool computeProb = false,
-        int sdpTupleSize= 8) {
+        int sdpTupleSize= 8,
+        bool compactTraceback = false) {
 
     Alignment sdpAlignment;
 
@@ -522,7 +471,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
 
     return AffineGuidedAlign(origQSeq, origTSeq, sdpAlignment, scoreFn, bandSize, buffers, alignment,
             // fill in optional parameters
-            alignType, computeProb);
+            alignType, computeProb, compactTraceback);
 }
 
 //
@@ -535,7 +484,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         T_BufferCache &buffers,
         Alignment &alignment, 
         AlignmentType alignType=Global, 
-        bool computeProb=false) {
+        bool computeProb=false,
+        bool compactTraceback=false) {
     return AffineGuidedAlign(origQSeq, origTSeq, guideAlignment, scoreFn, bandSize, alignment, 
             buffers.scoreMat,
             buffers.pathMat,
@@ -544,7 +494,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             buffers.lnSubPValueMat,
             buffers.lnInsPValueMat,
             buffers.lnDelPValueMat,
-            buffers.lnMatchPValueMat, alignType, computeProb);
+            buffers.lnMatchPValueMat, alignType, computeProb, compactTraceback);
 }
 
 //
@@ -563,7 +513,8 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
         int bandSize,
         Alignment &alignment, 
         AlignmentType alignType=Global, 
-        bool computeProb=false) {
+        bool computeProb=false,
+        bool compactTraceback=false) {
 
     //  Make synonyms for members of the buffers class for easier typing.
     std::vector<int>    scoreMat;
@@ -583,7 +534,7 @@ int AffineGuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  Alignment &guid
             lnSubPValueVect,
             lnInsPValueVect,
             lnDelPValueVect,
-            lnMatchPValueVect, alignType, computeProb);
+            lnMatchPValueVect, alignType, computeProb, compactTraceback);
 }
 
 #endif // _BLASR_AFFINE_GUIDE_ALIGNMENT_HPP_
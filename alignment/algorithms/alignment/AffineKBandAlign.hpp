@@ -9,9 +9,13 @@
 #include "matrix/FlatMatrix.hpp"
 #include "datastructures/alignment/Alignment.hpp"
 #include "KBandAlign.hpp"
+#include "AntiDiagonalKBandAlign.hpp"
 
+//
+// Fill the whole band of the score and path matrices.
+//
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment>
-int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
+int AffineKBandAlignFullMatrix(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
         int matchMat[5][5], 
         int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
         int del, int k,
@@ -403,4 +407,40 @@ int AffineKBandAlign(T_QuerySequence &pqSeq, T_TargetSequence &ptSeq,
 }
 
 
+//
+// The band is filled by AntiDiagonalAffineKBandAlign when it applies,
+// in which case the score and path matrices are left untouched.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment>
+int AffineKBandAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
+        int matchMat[5][5], 
+        int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
+        int del, int k,
+        vector<int> &scoreMat,
+        vector<Arrow> & pathMat,
+        vector<int> &hpInsScoreMat,
+        vector<Arrow> &hpInsPathMat,
+        vector<int> &insScoreMat,
+        vector<Arrow> &insPathMat,
+        T_Alignment &alignment, 
+        AlignmentType alignType) {
+
+    DNALength tLen, qLen;
+    SetKBoundedLengths(tSeq.length, qSeq.length, k, tLen, qLen);
+
+    vector<Arrow> optAlignment;
+    int optScore;
+    if (AntiDiagonalAffineKBandAlign(qSeq.seq, qLen, tSeq.seq, tLen, matchMat,
+            hpInsOpen, hpInsExtend, insOpen, insExtend, del, k, alignType,
+            optAlignment, optScore)) {
+        std::reverse(optAlignment.begin(), optAlignment.end());
+        alignment.ArrowPathToAlignment(optAlignment);
+        return optScore;
+    }
+    return AffineKBandAlignFullMatrix(qSeq, tSeq, matchMat, 
+        hpInsOpen, hpInsExtend, insOpen, insExtend, del, k,
+        scoreMat, pathMat, hpInsScoreMat, hpInsPathMat, insScoreMat, insPathMat,
+        alignment, alignType);
+}
+
 #endif // _BLASR_AFFINE_KBAND_ALIGN_HPP_
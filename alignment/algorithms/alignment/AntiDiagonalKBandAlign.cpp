@@ -0,0 +1,838 @@
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <cassert>
+#include <stdlib.h>
+#include <limits.h>
+#include "defs.h"
+#include "algorithms/alignment/AntiDiagonalKBandAlign.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+//
+// Score kept for cells outside the band.  A gap from it never beats a
+// cell inside the band, and adding scores to it does not overflow as
+// long as every real score is below AntiDiagonalScoreLimit.
+//
+static const int AntiDiagonalOutside = 1 << 29;
+static const int AntiDiagonalScoreLimit = 1 << 27;
+static const int AntiDiagonalLanes = 4;
+
+//
+// Score arrays are indexed by query row and padded so that the last
+// group of lanes on an anti-diagonal may run past the end of the query.
+//
+static const int AntiDiagonalPad = 2 * AntiDiagonalLanes;
+
+static inline __m128i Min32(__m128i a, __m128i b) {
+    __m128i aGreater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(aGreater, b),
+                        _mm_andnot_si128(aGreater, a));
+}
+
+//
+// mask ? a : b, lane by lane.
+//
+static inline __m128i Select32(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+//
+// Pack the low bitsPerCell bits of each lane into one integer, lane 0
+// in the lowest bits.
+//
+static inline int PackLanes(__m128i v, int bitsPerCell) {
+    v = _mm_or_si128(v, _mm_srli_epi64(v, 32 - bitsPerCell));
+    int mask = (1 << (2 * bitsPerCell)) - 1;
+    return (_mm_cvtsi128_si32(v) & mask) |
+        ((_mm_cvtsi128_si32(_mm_srli_si128(v, 8)) & mask) << (2 * bitsPerCell));
+}
+
+//
+// The geometry of the band in anti-diagonal order, and the packed
+// traceback of every cell computed in it.  Cell (q, t) is row q and
+// target position t of the scalar matrix, and lies on anti-diagonal
+// d = q + t.
+//
+class AntiDiagonalBand {
+public:
+    int qLen, tLen, k;
+    int bitsPerCell;
+    int stride;
+    std::vector<unsigned char> traceback;
+
+    AntiDiagonalBand(int qLenP, int tLenP, int kP, int bitsPerCellP) {
+        qLen = qLenP;
+        tLen = tLenP;
+        k    = kP;
+        bitsPerCell = bitsPerCellP;
+        //
+        // There are at most k+1 cells of the band on an anti-diagonal.
+        //
+        int groups = (k + 1 + AntiDiagonalLanes - 1) / AntiDiagonalLanes;
+        stride = groups * AntiDiagonalLanes * bitsPerCell / 8;
+        traceback.resize(((size_t) qLen + tLen + 1) * stride);
+    }
+
+    //
+    // The rows of the cells computed on anti-diagonal d, qlo > qhi when
+    // there are none.
+    //
+    void Range(int d, int &qlo, int &qhi) {
+        qlo = std::max(std::max(1, d - tLen), (d - k + 1) / 2);
+        qhi = std::min(std::min(qLen, d - 1), (d + k) / 2);
+    }
+
+    bool Computed(int q, int t) {
+        return (q >= 1 and q <= qLen and t >= 1 and t <= tLen and
+                t - q <= k and q - t <= k);
+    }
+
+    unsigned char *TracebackOf(int d) {
+        return &traceback[(size_t) d * stride];
+    }
+
+    void Store(unsigned char *diagonal, int group, int packed) {
+        int nBytes = AntiDiagonalLanes * bitsPerCell / 8;
+        for (int b = 0; b < nBytes; b++) {
+            diagonal[group * nBytes + b] = (packed >> (8 * b)) & 0xff;
+        }
+    }
+
+    int Get(int q, int t) {
+        int qlo, qhi;
+        Range(q + t, qlo, qhi);
+        int bit = (q - qlo) * bitsPerCell;
+        return (TracebackOf(q + t)[bit / 8] >> (bit % 8)) & ((1 << bitsPerCell) - 1);
+    }
+
+    void Set(int q, int t, int value) {
+        int qlo, qhi;
+        Range(q + t, qlo, qhi);
+        int bit = (q - qlo) * bitsPerCell;
+        unsigned char *cell = &TracebackOf(q + t)[bit / 8];
+        *cell &= ~(((1 << bitsPerCell) - 1) << (bit % 8));
+        *cell |= value << (bit % 8);
+    }
+
+    //
+    // After anti-diagonal d is computed, make the entries of its score
+    // array just outside the computed rows hold what the next two
+    // anti-diagonals read there: the first row or column of the matrix
+    // when they are in the band, and AntiDiagonalOutside when not.
+    //
+    void SetEdges(int *score, int d, int qlo, int qhi,
+                  int firstRowValue, int firstColValue) {
+        if (qlo > qhi) {
+            for (int q = std::max(0, qhi + 1); q <= qlo - 1 and q <= qLen + 1; q++) {
+                score[q] = AntiDiagonalOutside;
+            }
+        }
+        else {
+            if (qlo - 1 >= 0) {
+                score[qlo - 1] = AntiDiagonalOutside;
+            }
+            if (qhi + 1 <= qLen + 1) {
+                score[qhi + 1] = AntiDiagonalOutside;
+            }
+        }
+        score[0] = (d <= k) ? firstRowValue : AntiDiagonalOutside;
+        if (d >= 1 and d <= qLen) {
+            score[d] = (d <= k) ? firstColValue : AntiDiagonalOutside;
+        }
+    }
+};
+
+//
+// prof[c][q] is the score of query position q-1 against target base c,
+// and revTarget[i] is the base of target position tLen-1-i, so that the
+// cells of one anti-diagonal read both contiguously.  scoreMatrix is
+// indexed by [target][query].
+//
+static bool BuildAntiDiagonalProfile(Nucleotide *qSeq, int qLen,
+    Nucleotide *tSeq, int tLen, int scoreMatrix[5][5],
+    std::vector<int> prof[5], std::vector<int> &revTarget) {
+
+    int q, t, c;
+    for (c = 0; c < 5; c++) {
+        prof[c].assign(qLen + AntiDiagonalPad + 1, 0);
+    }
+    for (q = 1; q <= qLen; q++) {
+        int queryCode = ThreeBit[qSeq[q-1]];
+        if (queryCode > 4) {
+            return false;
+        }
+        for (c = 0; c < 5; c++) {
+            prof[c][q] = scoreMatrix[c][queryCode];
+        }
+    }
+    revTarget.assign(tLen + AntiDiagonalPad, 0);
+    for (t = 0; t < tLen; t++) {
+        int targetCode = ThreeBit[tSeq[t]];
+        if (targetCode > 4) {
+            return false;
+        }
+        revTarget[tLen - 1 - t] = targetCode;
+    }
+    return true;
+}
+
+static inline __m128i AntiDiagonalMatchScores(std::vector<int> prof[5],
+    int *revTarget, int q) {
+    __m128i vTarget = _mm_loadu_si128((__m128i*) revTarget);
+    __m128i vScore  = _mm_setzero_si128();
+    for (int c = 0; c < 5; c++) {
+        __m128i isCode = _mm_cmpeq_epi32(vTarget, _mm_set1_epi32(c));
+        vScore = _mm_or_si128(vScore,
+            _mm_and_si128(isCode, _mm_loadu_si128((__m128i*) &prof[c][q])));
+    }
+    return vScore;
+}
+
+static bool AntiDiagonalLengthsFit(DNALength qLen, DNALength tLen, int maxAbs) {
+    if (qLen == 0 or tLen == 0 or
+        qLen > (DNALength) AntiDiagonalScoreLimit or
+        tLen > (DNALength) AntiDiagonalScoreLimit) {
+        return false;
+    }
+    return ((long) qLen + tLen + 2) * maxAbs < AntiDiagonalScoreLimit;
+}
+
+static int MaxAbsScore(int scoreMatrix[5][5]) {
+    int maxAbs = 0;
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            maxAbs = std::max(maxAbs, abs(scoreMatrix[i][j]));
+        }
+    }
+    return maxAbs;
+}
+
+//
+// Where KBandAlign stops tracing back, t being the band column.
+//
+static inline bool KBandTracebackContinues(AlignmentType alignType,
+    int q, int t, int k) {
+    if (alignType == TargetFit) {
+        return q > 0 and (q < k ? k - q != t : true);
+    }
+    if (alignType == Fit) {
+        return (q > 0 and (t < k ? (k - t != q) : true) and
+                (q <= k ? k - q != t : true));
+    }
+    return q > 0 and (t < k ? (k - t != q) : true);
+}
+
+//
+// The linear gap engine, following KBandAlign.
+//
+class LinearAntiDiagonalBand : public AntiDiagonalBand {
+public:
+    AlignmentType alignType;
+    int ins, del;
+    std::vector<int> lastRow, lastCol, mainDiag;
+
+    LinearAntiDiagonalBand(int qLenP, int tLenP, int kP, AlignmentType alignTypeP,
+                           int insP, int delP) :
+        AntiDiagonalBand(qLenP, tLenP, kP, 2) {
+        alignType = alignTypeP;
+        ins = insP;
+        del = delP;
+        lastRow.resize(tLen + 1);
+        lastCol.resize(qLen + 1);
+        mainDiag.resize(qLen + 1);
+    }
+
+    int FirstRowScore(int t) {
+        if (t > 0 and alignType == Global and t < tLen) {
+            return t * del;
+        }
+        return 0;
+    }
+
+    int FirstColScore(int q) {
+        if ((alignType == TargetFit or alignType == Fit) and q == k and k < qLen) {
+            return 0;
+        }
+        return q * ins;
+    }
+
+    bool ScoreAt(int q, int j, int &score) {
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            if (q == qLen) { score = lastRow[t]; }
+            else if (t == tLen) { score = lastCol[q]; }
+            else if (t - q == tLen - qLen) { score = mainDiag[q]; }
+            else { return false; }
+        }
+        else if (q == 0) {
+            score = (t >= 1 and t <= k) ? FirstRowScore(t) : 0;
+        }
+        else if (t == 0) {
+            score = FirstColScore(q);
+        }
+        else {
+            score = 0;
+        }
+        return true;
+    }
+
+    Arrow ArrowAt(int q, int j) {
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            return (Arrow) Get(q, t);
+        }
+        if (q == 0) {
+            if (t == 0) {
+                return Diagonal;
+            }
+            if (t >= 1 and t <= k and t < tLen and
+                (alignType == Global or alignType == QueryFit or alignType == Fit)) {
+                return Left;
+            }
+            return NoArrow;
+        }
+        if (t == 0) {
+            return Up;
+        }
+        if (t < 0 and j == 0 and q < qLen and
+            (alignType == TargetFit or alignType == Fit)) {
+            return Up;
+        }
+        return NoArrow;
+    }
+};
+
+//
+// The affine engine, following AffineKBandAlign.
+//
+class AffineAntiDiagonalBand : public AntiDiagonalBand {
+public:
+    AlignmentType alignType;
+    int insOpen, insExtend, del;
+    std::vector<int> lastRow, lastCol, fitLine;
+    //
+    // Bits of each traceback cell.
+    //
+    static const int MatchArrowMask = 3;
+    static const int InsOpenBit     = 4;
+    static const int HPInsOpenBit   = 8;
+
+    AffineAntiDiagonalBand(int qLenP, int tLenP, int kP, AlignmentType alignTypeP,
+                           int insOpenP, int insExtendP, int delP) :
+        AntiDiagonalBand(qLenP, tLenP, kP, 4) {
+        alignType = alignTypeP;
+        insOpen   = insOpenP;
+        insExtend = insExtendP;
+        del       = delP;
+        lastRow.resize(tLen + 1);
+        lastCol.resize(qLen + 1);
+        fitLine.resize(qLen + 1);
+    }
+
+    int FirstRowScore(int t) {
+        return t * del;
+    }
+
+    int FirstColScore(int q) {
+        return (alignType == TargetFit) ? 0 : q * insExtend + insOpen;
+    }
+
+    bool ScoreAt(int q, int j, int &score) {
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            if (t == 2 * q - tLen) { score = fitLine[q]; }
+            else if (q == qLen) { score = lastRow[t]; }
+            else if (t == tLen) { score = lastCol[q]; }
+            else { return false; }
+        }
+        else if (q == 0) {
+            score = (t >= 1 and t <= k) ? FirstRowScore(t) : 0;
+        }
+        else if (t == 0) {
+            score = FirstColScore(q);
+        }
+        else {
+            score = 0;
+        }
+        return true;
+    }
+
+    Arrow MatchArrowAt(int q, int j) {
+        static const Arrow arrows[4] = {Diagonal, Left, AffineInsClose, AffineHPInsClose};
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            return arrows[Get(q, t) & MatchArrowMask];
+        }
+        if (q == 0) {
+            return (t >= 1) ? Left : NoArrow;
+        }
+        return (t == 0) ? AffineInsClose : NoArrow;
+    }
+
+    Arrow InsArrowAt(int q, int j) {
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            return (Get(q, t) & InsOpenBit) ? AffineInsOpen : AffineInsUp;
+        }
+        if (t == 0) {
+            return (q == 0) ? AffineInsOpen : AffineInsUp;
+        }
+        return NoArrow;
+    }
+
+    Arrow HPInsArrowAt(int q, int j) {
+        int t = q + j - k;
+        if (Computed(q, t)) {
+            return (Get(q, t) & HPInsOpenBit) ? AffineHPInsOpen : AffineHPInsUp;
+        }
+        if (t == 0) {
+            return (q == 0) ? AffineHPInsOpen : AffineHPInsUp;
+        }
+        return NoArrow;
+    }
+};
+#endif
+
+bool AntiDiagonalKBandAlign(Nucleotide *qSeq, DNALength qLength,
+    Nucleotide *tSeq, DNALength tLength,
+    int scoreMatrix[5][5], int ins, int del, int k,
+    AlignmentType alignType,
+    std::vector<Arrow> &optAlignment, int &q, int &t, int &optScore) {
+
+#ifndef __SSE2__
+    return false;
+#else
+    int maxAbs = std::max(MaxAbsScore(scoreMatrix), std::max(abs(ins), abs(del)));
+    if (k < 0 or AntiDiagonalLengthsFit(qLength, tLength, maxAbs) == false) {
+        return false;
+    }
+    //
+    // KBandAlign picks the end of a target fit alignment from a loop
+    // that does not run when the target is shorter than the band.
+    //
+    if (alignType == TargetFit and tLength < (DNALength) k) {
+        return false;
+    }
+    int qLen = qLength, tLen = tLength;
+    std::vector<int> prof[5], revTarget;
+    if (BuildAntiDiagonalProfile(qSeq, qLen, tSeq, tLen, scoreMatrix,
+                                 prof, revTarget) == false) {
+        return false;
+    }
+
+    LinearAntiDiagonalBand band(qLen, tLen, k, alignType, ins, del);
+    std::vector<int> scoreBuf[3];
+    int i;
+    for (i = 0; i < 3; i++) {
+        scoreBuf[i].assign(qLen + AntiDiagonalPad + 1, AntiDiagonalOutside);
+    }
+    int *H2 = &scoreBuf[0][0], *H1 = &scoreBuf[1][0], *H = &scoreBuf[2][0];
+    int qlo, qhi, d;
+    for (d = 0; d < 2; d++) {
+        int *init = (d == 0) ? H2 : H1;
+        band.Range(d, qlo, qhi);
+        band.SetEdges(init, d, qlo, qhi, band.FirstRowScore(d),
+                      (d >= 1 and d <= k) ? band.FirstColScore(d) : 0);
+    }
+
+    __m128i vIns   = _mm_set1_epi32(ins);
+    __m128i vDel   = _mm_set1_epi32(del);
+    __m128i vUp    = _mm_set1_epi32(Up);
+    __m128i vLeft  = _mm_set1_epi32(Left);
+
+    for (d = 2; d <= qLen + tLen; d++) {
+        band.Range(d, qlo, qhi);
+        unsigned char *traceback = band.TracebackOf(d);
+        int g;
+        for (q = qlo, g = 0; q <= qhi; q += AntiDiagonalLanes, g++) {
+            //
+            // Cell (q, d-q) reads (q-1, d-q-1), (q-1, d-q) and (q, d-q-1).
+            //
+            __m128i vMatch = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &H2[q - 1]),
+                AntiDiagonalMatchScores(prof, &revTarget[tLen - d + q], q));
+            __m128i vInsScore = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &H1[q - 1]), vIns);
+            __m128i vDelScore = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &H1[q]), vDel);
+            __m128i vMin = Min32(vMatch, Min32(vInsScore, vDelScore));
+            _mm_storeu_si128((__m128i*) &H[q], vMin);
+
+            //
+            // Ties go to the match, then the deletion, as in KBandAlign.
+            //
+            __m128i isMatch = _mm_cmpeq_epi32(vMin, vMatch);
+            __m128i isDel   = _mm_cmpeq_epi32(vMin, vDelScore);
+            __m128i vArrow  = _mm_andnot_si128(isMatch,
+                Select32(isDel, vLeft, vUp));
+            band.Store(traceback, g, PackLanes(vArrow, 2));
+        }
+
+        //
+        // Keep the cells the end of the alignment may be chosen from.
+        //
+        if (qLen >= qlo and qLen <= qhi) {
+            band.lastRow[d - qLen] = H[qLen];
+        }
+        if (d - tLen >= qlo and d - tLen <= qhi) {
+            band.lastCol[d - tLen] = H[d - tLen];
+        }
+        int twiceDiagRow = d - (tLen - qLen);
+        if (twiceDiagRow % 2 == 0 and twiceDiagRow / 2 >= qlo and twiceDiagRow / 2 <= qhi) {
+            band.mainDiag[twiceDiagRow / 2] = H[twiceDiagRow / 2];
+        }
+        band.SetEdges(H, d, qlo, qhi, band.FirstRowScore(d),
+                      (d <= k) ? band.FirstColScore(d) : 0);
+
+        int *next = H2;
+        H2 = H1;
+        H1 = H;
+        H  = next;
+    }
+
+    //
+    // Choose where to trace back from exactly as KBandAlign does.
+    //
+    q = qLen;
+    t = k - (qLen - tLen);
+    int globalMinScore = band.lastRow[tLen];
+    int minLastColScore = globalMinScore, minLastRowScore = globalMinScore;
+    int minLastColScoreIndex = 0, minLastRowScoreIndex = 0;
+
+    if (alignType == QueryFit or alignType == Fit) {
+        int q2 = qLen, t2;
+        bool minScoreSet = false;
+        for (t2 = q - k; t2 < q2 + k + 1; t2++) {
+            if (t2 < 1 or t2 > tLen) {
+                continue;
+            }
+            if (minScoreSet == false or band.lastRow[t2] < minLastRowScore) {
+                minScoreSet = true;
+                minLastRowScore = band.lastRow[t2];
+                minLastRowScoreIndex = t2;
+            }
+        }
+        if (minScoreSet) {
+            t = k - (q - minLastRowScoreIndex);
+            q = q2;
+        }
+    }
+    if (alignType == TargetFit or alignType == Fit) {
+        int q2, t2 = k - (qLen - tLen);
+        bool minScoreSet = false;
+        for (q2 = qLen; (DNALength) q2 >= tLength - k and q2 > 0; q2--) {
+            if (minScoreSet == false or band.lastCol[q2] < minLastColScore) {
+                minLastColScore = band.lastCol[q2];
+                minScoreSet = true;
+                minLastColScoreIndex = q2;
+            }
+        }
+        if (alignType == Fit) {
+            if (minLastColScore < minLastRowScore) {
+                t = t2;
+                q = minLastColScoreIndex;
+            }
+        }
+        else {
+            t = t2;
+            q = minLastColScoreIndex;
+        }
+    }
+    if (band.ScoreAt(q, t, optScore) == false) {
+        return false;
+    }
+
+    optAlignment.clear();
+    if (alignType == Global or alignType == QueryFit or
+        alignType == TargetFit or alignType == Fit) {
+        while (KBandTracebackContinues(alignType, q, t, k)) {
+            Arrow arrow = band.ArrowAt(q, t);
+            if (arrow == NoArrow) {
+                break;
+            }
+            optAlignment.push_back(arrow);
+            if (arrow == Diagonal) {
+                q--;
+            }
+            else if (arrow == Up) {
+                q--;
+                t++;
+            }
+            else if (arrow == Left) {
+                t--;
+            }
+        }
+    }
+    return true;
+#endif
+}
+
+bool AntiDiagonalAffineKBandAlign(Nucleotide *qSeq, DNALength qLength,
+    Nucleotide *tSeq, DNALength tLength,
+    int matchMat[5][5],
+    int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
+    int del, int k,
+    AlignmentType alignType,
+    std::vector<Arrow> &optAlignment, int &optScore) {
+
+#ifndef __SSE2__
+    return false;
+#else
+    //
+    // AffineKBandAlign reads past the matrix to find the end of any
+    // other alignment type.
+    //
+    if (alignType != Global and alignType != QueryFit and alignType != TargetFit) {
+        return false;
+    }
+    //
+    // Gap extensions from an unreachable cell start at INF_SCORE, and
+    // must not overflow.
+    //
+    const int INF_SCORE = INF_INT - 1000;
+    if (insExtend >= 1000 or hpInsExtend >= 1000) {
+        return false;
+    }
+    int maxAbs = std::max(MaxAbsScore(matchMat), abs(del));
+    maxAbs = std::max(maxAbs, abs(insOpen) + abs(insExtend));
+    maxAbs = std::max(maxAbs, abs(hpInsOpen) + abs(hpInsExtend));
+    if (k < 0 or AntiDiagonalLengthsFit(qLength, tLength, maxAbs) == false) {
+        return false;
+    }
+    int qLen = qLength, tLen = tLength;
+
+    int scoreMatrix[5][5];
+    int i, j;
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 5; j++) {
+            scoreMatrix[j][i] = matchMat[i][j];
+        }
+    }
+    std::vector<int> prof[5], revTarget;
+    if (BuildAntiDiagonalProfile(qSeq, qLen, tSeq, tLen, scoreMatrix,
+                                 prof, revTarget) == false) {
+        return false;
+    }
+    //
+    // Homopolymer insertions may only be extended where the query base
+    // repeats the one before it.
+    //
+    std::vector<int> hpExtendMask(qLen + AntiDiagonalPad + 1, 0);
+    int q, t;
+    for (q = 2; q <= qLen; q++) {
+        if (qSeq[q-1] == qSeq[q-2]) {
+            hpExtendMask[q] = -1;
+        }
+    }
+
+    AffineAntiDiagonalBand band(qLen, tLen, k, alignType, insOpen, insExtend, del);
+    std::vector<int> scoreBuf[3], insBuf[3], hpInsBuf[3];
+    for (i = 0; i < 3; i++) {
+        scoreBuf[i].assign(qLen + AntiDiagonalPad + 1, AntiDiagonalOutside);
+        insBuf[i].assign(qLen + AntiDiagonalPad + 1, AntiDiagonalOutside);
+        hpInsBuf[i].assign(qLen + AntiDiagonalPad + 1, AntiDiagonalOutside);
+    }
+    int *S2 = &scoreBuf[0][0], *S1 = &scoreBuf[1][0], *S = &scoreBuf[2][0];
+    int *I1 = &insBuf[1][0], *I = &insBuf[2][0], *I2 = &insBuf[0][0];
+    int *P1 = &hpInsBuf[1][0], *P = &hpInsBuf[2][0], *P2 = &hpInsBuf[0][0];
+    int qlo, qhi, d;
+    for (d = 0; d < 2; d++) {
+        band.Range(d, qlo, qhi);
+        band.SetEdges((d == 0) ? S2 : S1, d, qlo, qhi, band.FirstRowScore(d),
+                      (d >= 1 and d <= k) ? band.FirstColScore(d) : 0);
+        band.SetEdges((d == 0) ? I2 : I1, d, qlo, qhi, (d == 0) ? 0 : INF_SCORE,
+                      AntiDiagonalOutside);
+        band.SetEdges((d == 0) ? P2 : P1, d, qlo, qhi, (d == 0) ? 0 : INF_SCORE,
+                      AntiDiagonalOutside);
+    }
+
+    __m128i vHPInsOpen   = _mm_set1_epi32(hpInsOpen);
+    __m128i vHPInsExtend = _mm_set1_epi32(hpInsExtend);
+    __m128i vInsOpen     = _mm_set1_epi32(insOpen);
+    __m128i vInsExtend   = _mm_set1_epi32(insExtend);
+    __m128i vDel         = _mm_set1_epi32(del);
+    __m128i vInf         = _mm_set1_epi32(INF_SCORE);
+    __m128i vLeft        = _mm_set1_epi32(1);
+    __m128i vInsClose    = _mm_set1_epi32(2);
+    __m128i vHPInsClose  = _mm_set1_epi32(3);
+    __m128i vInsOpenBit  = _mm_set1_epi32(AffineAntiDiagonalBand::InsOpenBit);
+    __m128i vHPInsOpenBit= _mm_set1_epi32(AffineAntiDiagonalBand::HPInsOpenBit);
+
+    for (d = 2; d <= qLen + tLen; d++) {
+        band.Range(d, qlo, qhi);
+        unsigned char *traceback = band.TracebackOf(d);
+        int g;
+        for (q = qlo, g = 0; q <= qhi; q += AntiDiagonalLanes, g++) {
+            __m128i vUpScore = _mm_loadu_si128((__m128i*) &S1[q - 1]);
+
+            __m128i vHPOpen = _mm_add_epi32(vUpScore, vHPInsOpen);
+            __m128i vHPExtend = Select32(
+                _mm_loadu_si128((__m128i*) &hpExtendMask[q]),
+                _mm_add_epi32(_mm_loadu_si128((__m128i*) &P1[q - 1]), vHPInsExtend),
+                vInf);
+            __m128i hpOpened = _mm_cmplt_epi32(vHPOpen, vHPExtend);
+            __m128i vHP = Select32(hpOpened, vHPOpen, vHPExtend);
+            _mm_storeu_si128((__m128i*) &P[q], vHP);
+
+            __m128i vOpen = _mm_add_epi32(vUpScore, vInsOpen);
+            __m128i vExtend = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &I1[q - 1]), vInsExtend);
+            __m128i insOpened = _mm_cmplt_epi32(vOpen, vExtend);
+            __m128i vIns = Select32(insOpened, vOpen, vExtend);
+            _mm_storeu_si128((__m128i*) &I[q], vIns);
+
+            __m128i vDelScore = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &S1[q]), vDel);
+            __m128i vMatch = _mm_add_epi32(
+                _mm_loadu_si128((__m128i*) &S2[q - 1]),
+                AntiDiagonalMatchScores(prof, &revTarget[tLen - d + q], q));
+            __m128i vMin = Min32(vMatch, Min32(vDelScore, Min32(vIns, vHP)));
+            _mm_storeu_si128((__m128i*) &S[q], vMin);
+
+            //
+            // Ties go to the match, deletion, insertion and homopolymer
+            // insertion in that order, as in AffineKBandAlign.
+            //
+            __m128i vArrow = Select32(_mm_cmpeq_epi32(vMin, vIns), vInsClose, vHPInsClose);
+            vArrow = Select32(_mm_cmpeq_epi32(vMin, vDelScore), vLeft, vArrow);
+            vArrow = _mm_andnot_si128(_mm_cmpeq_epi32(vMin, vMatch), vArrow);
+            vArrow = _mm_or_si128(vArrow, _mm_and_si128(insOpened, vInsOpenBit));
+            vArrow = _mm_or_si128(vArrow, _mm_and_si128(hpOpened, vHPInsOpenBit));
+            band.Store(traceback, g, PackLanes(vArrow, 4));
+        }
+
+        //
+        // On the right edge of the band, insertions are not allowed, and
+        // both insertion matrices hold INF_SCORE reached by extension.
+        //
+        if ((d - k) % 2 == 0 and (d - k) / 2 >= qlo and (d - k) / 2 <= qhi) {
+            q = (d - k) / 2;
+            I[q] = INF_SCORE;
+            P[q] = INF_SCORE;
+            band.Set(q, d - q, band.Get(q, d - q) & AffineAntiDiagonalBand::MatchArrowMask);
+        }
+
+        if (qLen >= qlo and qLen <= qhi) {
+            band.lastRow[d - qLen] = S[qLen];
+        }
+        if (d - tLen >= qlo and d - tLen <= qhi) {
+            band.lastCol[d - tLen] = S[d - tLen];
+        }
+        if ((d + tLen) % 3 == 0 and (d + tLen) / 3 >= qlo and (d + tLen) / 3 <= qhi) {
+            band.fitLine[(d + tLen) / 3] = S[(d + tLen) / 3];
+        }
+        band.SetEdges(S, d, qlo, qhi, band.FirstRowScore(d),
+                      (d <= k) ? band.FirstColScore(d) : 0);
+        band.SetEdges(I, d, qlo, qhi, INF_SCORE, AntiDiagonalOutside);
+        band.SetEdges(P, d, qlo, qhi, INF_SCORE, AntiDiagonalOutside);
+
+        int *next = S2; S2 = S1; S1 = S; S = next;
+        next = I2; I2 = I1; I1 = I; I = next;
+        next = P2; P2 = P1; P1 = P; P = next;
+    }
+
+    //
+    // Choose where to trace back from exactly as AffineKBandAlign does.
+    //
+    int score, minScore;
+    if (alignType == Global) {
+        q = qLen;
+        t = k - (qLen - tLen);
+    }
+    else if (alignType == QueryFit) {
+        q = qLen;
+        int minScoreTPos = std::max(q - k, 1);
+        minScore = band.lastRow[minScoreTPos];
+        for (t = q - k; t < q + k + 1; t++) {
+            if (t < 1) { continue; }
+            if (t > tLen) { break; }
+            if (band.lastRow[t] < minScore) {
+                minScoreTPos = t;
+                minScore = band.lastRow[t];
+            }
+        }
+        t = k - (qLen - minScoreTPos);
+    }
+    else {
+        int qStart = std::max(0, std::min(qLen, tLen) - std::max(0, k - std::max(tLen - qLen, 0)));
+        int qEnd = std::min(qLength, tLength + k) + 1;
+        int minScoreQPos = qStart;
+        if (band.ScoreAt(qStart, k + tLen - qStart, minScore) == false) {
+            return false;
+        }
+        for (q = qStart; q < qEnd; q++) {
+            if (band.ScoreAt(q, k + q - tLen, score) == false) {
+                return false;
+            }
+            if (score < minScore) {
+                minScoreQPos = q;
+                minScore = score;
+            }
+        }
+        q = minScoreQPos;
+        t = k + q - tLen;
+    }
+    if (band.ScoreAt(q, t, optScore) == false) {
+        return false;
+    }
+
+    optAlignment.clear();
+    Arrow arrow;
+    MatrixLabel curMatrix = Match;
+    while ((q > 0) or (q == 0 and t > k)) {
+        assert(t < 2*k+1);
+        if (curMatrix == Match) {
+            arrow = band.MatchArrowAt(q, t);
+            if (arrow == Diagonal) {
+                optAlignment.push_back(arrow);
+                q--;
+            }
+            else if (arrow == Left) {
+                optAlignment.push_back(arrow);
+                t--;
+            }
+            else if (arrow == AffineInsClose) {
+                curMatrix = AffineIns;
+            }
+            else if (arrow == AffineHPInsClose) {
+                curMatrix = AffineHPIns;
+            }
+            else {
+                //
+                // AffineKBandAlign never leaves this cell.
+                //
+                return false;
+            }
+        }
+        else if (curMatrix == AffineHPIns) {
+            arrow = band.HPInsArrowAt(q, t);
+            if (arrow == AffineHPInsOpen) {
+                curMatrix = Match;
+            }
+            else if (arrow != AffineHPInsUp) {
+                std::cout << "ERROR! Affine homopolymer insertion path matrix MUST only have UP or OPEN arrows." << std::endl;
+                assert(0);
+            }
+            optAlignment.push_back(Up);
+            q--;
+            t++;
+        }
+        else {
+            arrow = band.InsArrowAt(q, t);
+            if (arrow == AffineInsOpen) {
+                curMatrix = Match;
+            }
+            else if (arrow != AffineInsUp) {
+                std::cout << "ERROR! Affine insertion path matrix MUST only have UP or OPEN arrows."<<std::endl;
+                assert(0);
+            }
+            optAlignment.push_back(Up);
+            q--;
+            t++;
+        }
+    }
+    return true;
+#endif
+}
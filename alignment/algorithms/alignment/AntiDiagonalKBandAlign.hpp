@@ -0,0 +1,54 @@
+#ifndef _BLASR_ANTI_DIAGONAL_K_BAND_ALIGN_HPP_
+#define _BLASR_ANTI_DIAGONAL_K_BAND_ALIGN_HPP_
+
+#include <vector>
+#include "Types.h"
+#include "NucConversion.hpp"
+#include "AlignmentUtils.hpp"
+#include "datastructures/alignment/Path.h"
+
+//
+// Banded alignment engines that fill the band of KBandAlign and
+// AffineKBandAlign one anti-diagonal at a time with four 32-bit SSE2
+// lanes.  Only three anti-diagonals of scores are kept, and the
+// traceback is packed into 2 bits per cell (4 for the affine version),
+// so neither needs a (qLen+1) x (2k+1) score or path matrix.
+//
+// Both reproduce the score, traceback start and arrow path of the
+// scalar code exactly, including its boundary conditions.  The arrow
+// path is returned in traceback order, that is from the end of the
+// alignment to the start, and q and t are where the traceback stopped,
+// as a row and band column.
+//
+// qLen and tLen are the lengths already bounded by SetKBoundedLengths.
+// They return false when the engine does not apply and the scalar code
+// should be run instead: no SSE2, an empty sequence, a character that
+// is not ACGTN, scores that may not fit in 32 bits, or an alignment
+// type or end condition for which the scalar code reads outside of what
+// it computed.
+//
+
+//
+// Linear gap costs, scoreMatrix indexed by [target][query] as in
+// DistanceMatrixScoreFunction.
+//
+bool AntiDiagonalKBandAlign(Nucleotide *qSeq, DNALength qLen,
+    Nucleotide *tSeq, DNALength tLen,
+    int scoreMatrix[5][5], int ins, int del, int k,
+    AlignmentType alignType,
+    std::vector<Arrow> &optAlignment, int &q, int &t, int &optScore);
+
+//
+// Affine insertions with separate homopolymer insertion costs, and
+// linear deletions, matchMat indexed by [query][target] as in
+// AffineKBandAlign.
+//
+bool AntiDiagonalAffineKBandAlign(Nucleotide *qSeq, DNALength qLen,
+    Nucleotide *tSeq, DNALength tLen,
+    int matchMat[5][5],
+    int hpInsOpen, int hpInsExtend, int insOpen, int insExtend,
+    int del, int k,
+    AlignmentType alignType,
+    std::vector<Arrow> &optAlignment, int &optScore);
+
+#endif // _BLASR_ANTI_DIAGONAL_K_BAND_ALIGN_HPP_
@@ -224,3 +224,107 @@ int AlignmentToGuide(Alignment &alignment, Guide &guide, int bandSize)  {
   return 1; // signal ok.
 
 }
+
+PackedArrowMatrix::PackedArrowMatrix() {
+    bitsPerCell = 8;
+    cellMask    = 0xff;
+}
+
+void PackedArrowMatrix::Resize(unsigned int nElem, int bitsPerCellP, int value) {
+    assert(bitsPerCellP == 1 or bitsPerCellP == 2 or 
+           bitsPerCellP == 4 or bitsPerCellP == 8);
+    bitsPerCell = bitsPerCellP;
+    cellMask    = (1 << bitsPerCell) - 1;
+    //
+    // Repeat value through a byte to initialize every cell in it.
+    //
+    unsigned char fill = 0;
+    int b;
+    for (b = 0; b < 8; b += bitsPerCell) {
+        fill |= (value & cellMask) << b;
+    }
+    cells.assign(((unsigned long) nElem * bitsPerCell + 7) / 8, fill);
+}
+
+unsigned long PackedArrowMatrix::ByteSize() {
+    return cells.size();
+}
+
+GuidedAlignFullMatrices::GuidedAlignFullMatrices(std::vector<int> &scoreMatP,
+    std::vector<Arrow> &pathMatP, std::vector<double> &probMatP,
+    std::vector<double> &optPathProbMatP) :
+    scoreMat(scoreMatP), pathMat(pathMatP), probMat(probMatP),
+    optPathProbMat(optPathProbMatP) {
+}
+
+void GuidedAlignFullMatrices::Initialize(Guide &guide, unsigned int matrixNElem,
+    bool computeProb, bool affine) {
+    // 
+    // Make sure the alignments can fit in the reused buffers.
+    //
+    if (scoreMat.size() < matrixNElem) {
+        scoreMat.resize(matrixNElem);
+        pathMat.resize(matrixNElem);
+    }
+    if (computeProb) {
+        if (probMat.size() < matrixNElem) {
+            probMat.resize(matrixNElem);
+            optPathProbMat.resize(matrixNElem);
+        }
+    }
+    // 
+    // Initialze matrices.  Only initialize up to matrixNElem rather
+    // than matrix.size() because the matrix.size() unnecessary space
+    // may be allocated.
+    //
+    std::fill(scoreMat.begin(), scoreMat.begin() + matrixNElem, 0);
+    std::fill(pathMat.begin(), pathMat.begin() + matrixNElem, NoArrow);
+    if (computeProb) {
+        std::fill(probMat.begin(), probMat.begin() + matrixNElem, 0);
+        std::fill(optPathProbMat.begin(), optPathProbMat.begin() + matrixNElem, 0);
+    }
+    if (affine) {
+        insScoreMat.assign(matrixNElem, 0);
+        delScoreMat.assign(matrixNElem, 0);
+        insPathMat.assign(matrixNElem, NoArrow);
+        delPathMat.assign(matrixNElem, NoArrow);
+    }
+}
+
+const Arrow GuidedAlignCompactMatrices::MatchArrows[6] = {Diagonal, Up, Left,
+    NoArrow, AffineInsClose, AffineDelClose};
+
+GuidedAlignCompactMatrices::GuidedAlignCompactMatrices() {
+    rowIndex[0] = rowIndex[1] = 0;
+    curRow = 0;
+}
+
+void GuidedAlignCompactMatrices::Initialize(Guide &guide, unsigned int matrixNElem,
+    bool computeProb, bool affine) {
+    arrows.Resize(matrixNElem, affine ? 8 : 2, MatchArrowCode(NoArrow));
+    int maxRowLength = 0;
+    unsigned int r;
+    for (r = 0; r < guide.size(); r++) {
+        maxRowLength = std::max(maxRowLength, guide[r].GetRowLength());
+    }
+    int i;
+    for (i = 0; i < 2; i++) {
+        score[i].assign(maxRowLength, 0);
+        if (affine) {
+            insScore[i].assign(maxRowLength, 0);
+            delScore[i].assign(maxRowLength, 0);
+        }
+        if (computeProb) {
+            prob[i].assign(maxRowLength, 0);
+        }
+    }
+}
+
+void GuidedAlignCompactMatrices::StartRow(int rowIndexP) {
+    curRow = 1 - curRow;
+    rowIndex[curRow] = rowIndexP;
+    std::fill(score[curRow].begin(), score[curRow].end(), 0);
+    std::fill(insScore[curRow].begin(), insScore[curRow].end(), 0);
+    std::fill(delScore[curRow].begin(), delScore[curRow].end(), 0);
+    std::fill(prob[curRow].begin(), prob[curRow].end(), 0);
+}
@@ -57,123 +57,200 @@ float QVToLogPScale(char qv);
 
 void QVToLogPScale(QualityValueVector<QualityValue> &qualVect, int phredVectLength, std::vector<float> &lnVect); 
 
-int AlignmentToGuide(blasr::Alignment &alignment, Guide &guide, int bandSize); 
+int AlignmentToGuide(blasr::Alignment &alignment, Guide &guide, int bandSize);
 
-template<typename QSequence, typename TSequence, typename T_ScoreFn>
-int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &guideAlignment,
-        T_ScoreFn &scoreFn,
-        int bandSize,
-        blasr::Alignment &alignment,
-        std::vector<int>    &scoreMat,
-        std::vector<Arrow>  &pathMat,
-        std::vector<double> &probMat,
-        std::vector<double> &optPathProbMat,
-        std::vector<float>  &lnSubPValueVect,
-        std::vector<float>  &lnInsPValueVect,
-        std::vector<float>  &lnDelPValueVect,
-        std::vector<float>  &lnMatchPValueVect,
-        AlignmentType alignType=Global, 
-        bool computeProb=false) {
+//
+// Small integer codes of the cells of a guided alignment matrix,
+// packed bitsPerCell bits to a cell, where bitsPerCell is 1, 2, 4 or
+// 8.  Cells are indexed as in the score and path matrices, through
+// GetBufferIndexFunctor.
+//
+class PackedArrowMatrix {
+public:
+    PackedArrowMatrix();
 
-    Guide guide;
-    AlignmentToGuide(guideAlignment, guide, bandSize);
-    StoreMatrixOffsets(guide);
-    ComputeMatrixNElem(guide);
+    void Resize(unsigned int nElem, int bitsPerCellP, int value);
 
-    //
-    // Make a copy of the sequences that is guaranteed to be in 3-bit format for faster alignment.
-    // (mabybe eventually reuse the qseq and tseq memory)
-    //
-    QSequence qSeq;
-    TSequence tSeq;
-    qSeq.Assign(origQSeq);
-    tSeq.Assign(origTSeq);
+    int Get(unsigned int index) {
+        unsigned int bit = index * bitsPerCell;
+        return (cells[bit / 8] >> (bit % 8)) & cellMask;
+    }
 
-    unsigned int matrixNElem = ComputeMatrixNElem(guide);
-    assert(matrixNElem >= 0);
-    StoreMatrixOffsets(guide);
+    void Set(unsigned int index, int value) {
+        unsigned int bit = index * bitsPerCell;
+        unsigned char &cell = cells[bit / 8];
+        cell = (cell & ~(cellMask << (bit % 8))) | ((value & cellMask) << (bit % 8));
+    }
 
-    /*
-     * The following code is useful to produce images of the dp-matrix.
-     * Make sure the sequenences are less than 5kb each though.
+    unsigned long ByteSize();
 
-     Matrix<float> probMatrix;
-     probMatrix.Resize(qSeq.length, tSeq.length);
-     probMatrix.Initialize(0);
-     ofstream matrixOut;
-     stringstream matrixOutNameStrm;
-     matrixOutNameStrm << "probMatrix_"<< runIndex << ".dat";
-     matrixOut.open(matrixOutNameStrm.str().c_str());
-     */
+private:
+    std::vector<unsigned char> cells;
+    int bitsPerCell;
+    int cellMask;
+};
 
-    if (computeProb) { 
-        //
-        // Convert phred scale to proper ln for faster manipulation later on.
-        //
-        QVToLogPScale(qSeq.substitutionQV, qSeq.length, lnSubPValueVect);
-        QVToLogPScale(qSeq.insertionQV,    qSeq.length, lnInsPValueVect);
-        QVToLogPScale(qSeq.deletionQV,     qSeq.length, lnDelPValueVect);
-        if (lnMatchPValueVect.size() < qSeq.length) {
-            lnMatchPValueVect.resize(qSeq.length);
-        }
-        //
-        // Normalize probability vectors so that the probability of transition from each cell is 1.
-        //
-        unsigned int i;
-        for (i = 0; i < qSeq.length; i++) {
-            float subSum  = LogSumOfTwo(lnSubPValueVect[i], QVToLogPScale(scoreFn.substitutionPrior)); // prior on substitution rate
-            float denominator = LogSumOfThree(lnDelPValueVect[i], lnInsPValueVect[i], subSum);
-            lnDelPValueVect[i] = lnDelPValueVect[i] - denominator;
-            lnSubPValueVect[i]   = lnSubPValueVect[i] - denominator;
-            lnInsPValueVect[i]   = lnInsPValueVect[i] - denominator;
-            lnMatchPValueVect[i] = subSum - denominator;
-        }
+//
+// The score matrices of a guided alignment and the arrows of their
+// cells, indexed through GetBufferIndexFunctor.  AlignAlongGuide and
+// AffineAlignAlongGuide run one recurrence over either of two layouts.
+//
+// GuidedAlignFullMatrices keeps every cell, in the score, path and
+// probability buffers of the caller.  The affine gap matrices are its
+// own.
+//
+// GuidedAlignCompactMatrices keeps the scores and probabilities of
+// only the previous and current row, and packs the arrows of a cell
+// into 2 bits, or 1 byte with the affine gap matrices.  That is a small
+// fraction of the full matrices, which reach hundreds of megabytes for
+// long reads and wide bands.
+//
+// Rows are filled in order, each begun by StartRow with the index of
+// its first cell, and only cells of the current and previous row are
+// read or written.
+//
+class GuidedAlignFullMatrices {
+public:
+    GuidedAlignFullMatrices(std::vector<int> &scoreMatP,
+                            std::vector<Arrow> &pathMatP,
+                            std::vector<double> &probMatP,
+                            std::vector<double> &optPathProbMatP);
+
+    void Initialize(Guide &guide, unsigned int matrixNElem, 
+                    bool computeProb, bool affine);
+
+    void StartRow(int rowIndex) {}
+
+    int &Score(int index)    { return scoreMat[index]; }
+    int &InsScore(int index) { return insScoreMat[index]; }
+    int &DelScore(int index) { return delScoreMat[index]; }
+    double &Prob(int index)  { return probMat[index]; }
+    void SetOptPathProb(int index, double prob) { optPathProbMat[index] = prob; }
+
+    Arrow GetArrow(int index)    { return pathMat[index]; }
+    Arrow GetInsArrow(int index) { return insPathMat[index]; }
+    Arrow GetDelArrow(int index) { return delPathMat[index]; }
+    void SetArrow(int index, Arrow arrow)    { pathMat[index] = arrow; }
+    void SetInsArrow(int index, Arrow arrow) { insPathMat[index] = arrow; }
+    void SetDelArrow(int index, Arrow arrow) { delPathMat[index] = arrow; }
+
+private:
+    std::vector<int>    &scoreMat;
+    std::vector<Arrow>  &pathMat;
+    std::vector<double> &probMat;
+    std::vector<double> &optPathProbMat;
+    std::vector<int>    insScoreMat, delScoreMat;
+    std::vector<Arrow>  insPathMat, delPathMat;
+};
 
-    }
+class GuidedAlignCompactMatrices {
+public:
+    GuidedAlignCompactMatrices();
 
+    void Initialize(Guide &guide, unsigned int matrixNElem, 
+                    bool computeProb, bool affine);
 
+    void StartRow(int rowIndex);
 
-    // 
-    // Make sure the alignments can fit in the reused buffers.
-    //
+    int &Score(int index) { 
+        int r = Row(index);
+        return score[r][index - rowIndex[r]]; 
+    }
+    int &InsScore(int index) { 
+        int r = Row(index);
+        return insScore[r][index - rowIndex[r]]; 
+    }
+    int &DelScore(int index) { 
+        int r = Row(index);
+        return delScore[r][index - rowIndex[r]]; 
+    }
+    double &Prob(int index) {
+        int r = Row(index);
+        return prob[r][index - rowIndex[r]]; 
+    }
+    void SetOptPathProb(int index, double prob) {}
 
-    if (scoreMat.size() < matrixNElem) {
-        scoreMat.resize(matrixNElem);
-        pathMat.resize(matrixNElem);
-        fill(scoreMat.begin(), scoreMat.end(), 0);
-        fill(pathMat.begin(), pathMat.end(), NoArrow);
+    Arrow GetArrow(int index) {
+        return MatchArrows[arrows.Get(index) & MatchArrowMask];
     }
-    if (computeProb) {
-        if (probMat.size() < matrixNElem) {
-            probMat.resize(matrixNElem);
-            optPathProbMat.resize(matrixNElem);
-        }
+    Arrow GetInsArrow(int index) {
+        return (arrows.Get(index) & InsOpenBit) ? AffineInsOpen : AffineInsUp;
+    }
+    Arrow GetDelArrow(int index) {
+        return (arrows.Get(index) & DelOpenBit) ? AffineDelOpen : AffineDelLeft;
+    }
+    void SetArrow(int index, Arrow arrow) {
+        arrows.Set(index, (arrows.Get(index) & ~MatchArrowMask) | MatchArrowCode(arrow));
+    }
+    void SetInsArrow(int index, Arrow arrow) {
+        SetBit(index, InsOpenBit, arrow == AffineInsOpen);
+    }
+    void SetDelArrow(int index, Arrow arrow) {
+        SetBit(index, DelOpenBit, arrow == AffineDelOpen);
     }
 
-    // 
-    // Initialze matrices.  Only initialize up to matrixNElem rather
-    // than matrix.size() because the matrix.size() unnecessary space
-    // may be allocated.
+private:
     //
+    // A cell holds the arrow of the match matrix as an index into
+    // MatchArrows, and whether the insertion and deletion matrices
+    // open a gap there.  Without affine gaps only the first four
+    // arrows occur, which fit in 2 bits.
+    //
+    static const Arrow MatchArrows[6];
+    static const int MatchArrowMask = 7;
+    static const int InsOpenBit = 8;
+    static const int DelOpenBit = 16;
+
+    PackedArrowMatrix arrows;
+    std::vector<int>    score[2], insScore[2], delScore[2];
+    std::vector<double> prob[2];
+    int rowIndex[2];
+    int curRow;
+
+    int Row(int index) {
+        return index >= rowIndex[curRow] ? curRow : 1 - curRow;
+    }
 
-    std::fill(scoreMat.begin(), scoreMat.begin() + matrixNElem, 0);
-    std::fill(pathMat.begin(), pathMat.begin() + matrixNElem, NoArrow);
-    if (computeProb) {
-        std::fill(probMat.begin(), probMat.begin() + matrixNElem, 0);	
-        std::fill(optPathProbMat.begin(), optPathProbMat.begin() + matrixNElem, 0);
+    int MatchArrowCode(Arrow arrow) {
+        int code = 0;
+        while (MatchArrows[code] != arrow) {
+            code++;
+        }
+        return code;
     }
-    //
-    // Initialize boundary conditions.
-    //
-    int q, t;
-    int bufferIndex;
+
+    void SetBit(int index, int bit, bool value) {
+        int cell = arrows.Get(index);
+        arrows.Set(index, value ? (cell | bit) : (cell & ~bit));
+    }
+};
+
+//
+// Fill matrices along guide and store the alignment that ends at the
+// end of the guide.  qSeq and tSeq are the 3-bit copies made by
+// GuidedAlign.
+//
+template<typename QSequence, typename TSequence, typename T_ScoreFn, typename T_Matrices>
+int AlignAlongGuide(QSequence &qSeq, TSequence &tSeq, Guide &guide,
+        T_ScoreFn &scoreFn,
+        T_Matrices &matrices,
+        blasr::Alignment &alignment,
+        AlignmentType alignType,
+        bool computeProb) {
+
     // start alignemnt at the beginning of the guide, and align to the
     // end of the guide.
     if (guide.size() == 0) {
-        qSeq.Free();
-        tSeq.Free();
         return 0;
     }
+    unsigned int matrixNElem = ComputeMatrixNElem(guide);
+    matrices.Initialize(guide, matrixNElem, computeProb, false);
+
+    //
+    // Initialize boundary conditions.
+    //
+    int q, t;
+    int bufferIndex;
     int qStart = guide[1].q;
     int tStart = guide[1].t;
     int qEnd   = guide[guide.size()-1].q+1;
@@ -182,28 +259,28 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
     GetBufferIndexFunctor GetBufferIndex;
     GetBufferIndex.seqRowOffset = qStart;
     GetBufferIndex.guideSize    = guide.size();
-    int indicesAreValid, delIndexIsValid, insIndexIsValid;
+    int indicesAreValid, delIndexIsValid;
+    matrices.StartRow(guide[0].matrixOffset - guide[0].tPre);
     bufferIndex = -1;
     indicesAreValid = GetBufferIndex(guide, qStart-1, tStart-1, bufferIndex);
     assert(indicesAreValid);
-    scoreMat[bufferIndex] = 0;
-    pathMat[bufferIndex]  = NoArrow;
+    matrices.Score(bufferIndex) = 0;
+    matrices.SetArrow(bufferIndex, NoArrow);
     int matchIndex, insIndex, delIndex, curIndex;
 
     //
     // Initialize deletion row.
     //
-    if (computeProb) {
-        probMat[0] = optPathProbMat[0] = 0;
-    }
     for (t = tStart; t < tStart + guide[0].tPost; t++) {
         curIndex=-1;
         indicesAreValid = GetBufferIndex(guide, qStart-1, t, curIndex);
         if (indicesAreValid == 0 ) {
+            qSeq.ToAscii();
+            tSeq.ToAscii();
             std::cout << "QSeq" << std::endl;
-            (static_cast<DNASequence*>(&origQSeq))->PrintSeq(std::cout);
+            (static_cast<DNASequence*>(&qSeq))->PrintSeq(std::cout);
             std::cout << "TSeq" << std::endl;
-            (static_cast<DNASequence*>(&origTSeq))->PrintSeq(std::cout);
+            (static_cast<DNASequence*>(&tSeq))->PrintSeq(std::cout);
             assert(0);
         }
         delIndex = -1;
@@ -211,77 +288,41 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
 
         if (delIndexIsValid) {
             if (alignType == Global) {
-                scoreMat[curIndex] = scoreMat[delIndex] + scoreFn.del;
+                matrices.Score(curIndex) = matrices.Score(delIndex) + scoreFn.del;
             }
             else if (alignType == Local) {
-                scoreMat[curIndex] = 0;
+                matrices.Score(curIndex) = 0;
             }
-            pathMat[curIndex] = Left;
+            matrices.SetArrow(curIndex, Left);
             if (computeProb) {
                 if (qSeq.qual.Empty() == false) {
-                    optPathProbMat[curIndex] = probMat[curIndex] = probMat[delIndex] + QVToLogPScale(scoreFn.globalDeletionPrior);
+                    matrices.Prob(curIndex) = matrices.Prob(delIndex) + QVToLogPScale(scoreFn.globalDeletionPrior);
+                    matrices.SetOptPathProb(curIndex, matrices.Prob(curIndex));
                 }
             }
         }
     }
 
-    // 
-    // Initialize stripe along the top of the grid.
     //
-    for (q = qStart ; q < qStart + bandSize and q < qEnd; q++) {
-        insIndex = -1;
-        insIndexIsValid = GetBufferIndex(guide, q-1, tStart-1, // diagonal from t-start
-                insIndex);
-        curIndex = -1;
-        indicesAreValid = GetBufferIndex(guide, q, tStart-1, curIndex);
-
-        if (insIndexIsValid and indicesAreValid) {
-            assert(insIndex >= 0);
-            assert(curIndex >= 0);
-            if (alignType == Global) {
-                scoreMat[curIndex] = scoreMat[insIndex] + scoreFn.ins;
-            }
-            else {
-                scoreMat[curIndex] = 0;
-            }
-            pathMat[curIndex] = Up;
-            if (computeProb) {
-                if (qSeq.qual.Empty() == false) {
-                    optPathProbMat[curIndex] = probMat[curIndex] = probMat[insIndex] + QVToLogPScale(scoreFn.Insertion(tSeq,(DNALength) 0, qSeq, (DNALength)q));
-                }
-            }
-        }
-    }
-
+    // The cells along column tStart-1 in the first rows are in the band
+    // of their row, so they are computed with the rest of the row.
+    //
     int matchScore, insScore, delScore;
 
     for (q = qStart; q < qEnd; q++) {
         int qi = q - qStart + 1;
         int tp = guide[qi].t;
         curIndex = matchIndex = insIndex = delIndex = -1;
+        matrices.StartRow(guide[qi].matrixOffset - guide[qi].tPre);
 
         //
-        // Do some work that will help define when matchIndex and insIndex
-        // may be used.  Once delIndex is computed once, it is valid for
-        // all t positions.
+        // Define the boundaries of the column which may access
+        // previously computed cells with a match.  Once delIndex is
+        // computed once, it is valid for all t positions.
         //
-        int prevRowTEnd = -1;
-        if ( qi > 0) { 
-            //
-            // Define the boundaries of the column which may access previously
-            // computed cells with a match.
-            //
-            prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
-        }    
+        int prevRowTEnd = guide[qi-1].t + guide[qi-1].tPost;
 
         for (t = tp - guide[qi].tPre ; t < guide[qi].t + guide[qi].tPost +1; t++) {
-
-
-            if (q < qStart + bandSize and t == tp - guide[qi].tPre - 1) {
-                // On the boundary condition, don't access the 1st element;
-                t++;
-                continue;
-            }
             // Make sure the index is not past the end of the sequence.
             if (t < -1) continue;
             if (t >= tEnd) continue;
@@ -305,7 +346,7 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
 
             if (GetBufferIndex(guide, q-1,t-1, matchIndex)) {
                 assert(matchIndex >= 0);
-                matchScore = scoreMat[matchIndex] + scoreFn.Match(tSeq, t, qSeq, q);
+                matchScore = matrices.Score(matchIndex) + scoreFn.Match(tSeq, t, qSeq, q);
             }
             else {
                 matchScore = INF_INT;
@@ -313,14 +354,14 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
 
             if (GetBufferIndex(guide, q-1, t, insIndex)) {
                 assert(insIndex >= 0);
-                insScore = scoreMat[insIndex] + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
+                insScore = matrices.Score(insIndex) + scoreFn.Insertion(tSeq,(DNALength) t, qSeq, (DNALength)q);
             }
             else {
                 insScore = INF_INT;
             }
             if (GetBufferIndex(guide, q, t-1, delIndex)) {
                 assert(delIndex >= 0);
-                delScore = scoreMat[delIndex] + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
+                delScore = matrices.Score(delIndex) + scoreFn.Deletion(tSeq, (DNALength) t, qSeq, (DNALength)q);
             }
             else {
                 delScore = INF_INT;
@@ -331,78 +372,74 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
             // This should only loop over valid cells.
             assert(result);
             assert(curIndex >= 0);
-            scoreMat[curIndex] = minScore;
+            matrices.Score(curIndex) = minScore;
             if (minScore == INF_INT) {
-                pathMat[curIndex] = NoArrow;
+                matrices.SetArrow(curIndex, NoArrow);
                 if (computeProb) {
-                    probMat[curIndex] = 1;
-                    optPathProbMat[curIndex] = 0;
+                    matrices.Prob(curIndex) = 1;
+                    matrices.SetOptPathProb(curIndex, 0);
                 }
+                continue;
+            }
+            if (minScore == matchScore) {
+                matrices.SetArrow(curIndex, Diagonal);
+            }
+            else if (minScore == delScore) {
+                matrices.SetArrow(curIndex, Left);
             }
             else {
-                assert(result == 1);
-                if (minScore == matchScore) {
-                    pathMat[curIndex] = Diagonal;
+                matrices.SetArrow(curIndex, Up);
+            }
+
+            if (computeProb) {
+                // Assign these to anything over 1 to signal they are not assigned.
+                float pMisMatch = 2, pIns = 2, pDel = 2;
+                if (matchScore != INF_INT) {
+                    pMisMatch = QVToLogPScale(scoreFn.NormalizedMatch(tSeq, t, qSeq, q));
                 }
-                else if (minScore == delScore) {
-                    pathMat[curIndex] = Left;
+                if (insScore != INF_INT) {
+                    pIns = QVToLogPScale(scoreFn.NormalizedInsertion(tSeq, t, qSeq, q));
                 }
-                else {
-                    pathMat[curIndex] = Up;
+                if (delScore != INF_INT) {
+                    pDel = QVToLogPScale(scoreFn.NormalizedDeletion(tSeq, t, qSeq, q));
                 }
 
-                float pMisMatch, pIns, pDel;
-                // Assign these to anything over 1 to signal they are not assigned.
-                pMisMatch = 2;
-                pIns      = 2;
-                pDel      = 2;
-                if (computeProb) {
-                    if (matchScore != INF_INT) {
-                        pMisMatch = QVToLogPScale(scoreFn.NormalizedMatch(tSeq, t, qSeq, q));
+                if (qSeq.qual.Empty() == false) {
+                    double &prob = matrices.Prob(curIndex);
+                    if (matchScore != INF_INT and delScore != INF_INT and insScore != INF_INT) {
+                        prob = LogSumOfThree(matrices.Prob(matchIndex) + pMisMatch,
+                                matrices.Prob(delIndex) + pDel,
+                                matrices.Prob(insIndex) + pIns);
                     }
-                    if (insScore != INF_INT) {
-                        pIns = QVToLogPScale(scoreFn.NormalizedInsertion(tSeq, t, qSeq, q));
+                    else if (matchScore != INF_INT and delScore != INF_INT) {
+                        prob = LogSumOfTwo(matrices.Prob(matchIndex) + pMisMatch,
+                                matrices.Prob(delIndex) + pDel);
                     }
-                    if (delScore != INF_INT) {
-                        pDel = QVToLogPScale(scoreFn.NormalizedDeletion(tSeq, t, qSeq, q));
+                    else if (matchScore != INF_INT and insScore != INF_INT) {
+                        prob = LogSumOfTwo(matrices.Prob(matchIndex) + pMisMatch,
+                                matrices.Prob(insIndex) + pIns);
                     }
-
-                    if (qSeq.qual.Empty() == false) {
-                        if (matchScore != INF_INT and delScore != INF_INT and insScore != INF_INT) {
-                            probMat[curIndex] = LogSumOfThree(probMat[matchIndex] + pMisMatch,
-                                    probMat[delIndex] + pDel,
-                                    probMat[insIndex] + pIns);
-                        }
-                        else if (matchScore != INF_INT and delScore != INF_INT) {
-                            probMat[curIndex] = LogSumOfTwo(probMat[matchIndex] + pMisMatch,
-                                    probMat[delIndex] + pDel);
-                        }
-                        else if (matchScore != INF_INT and insScore != INF_INT) {
-                            probMat[curIndex] = LogSumOfTwo(probMat[matchIndex] + pMisMatch,
-                                    probMat[insIndex] + pIns);					
-                        }
-                        else if (insScore != INF_INT and delScore != INF_INT) {
-                            probMat[curIndex] = LogSumOfTwo(probMat[delIndex] + pDel,
-                                    probMat[insIndex] + pIns);
-                        }
-                        else if (matchScore != INF_INT) {
-                            probMat[curIndex] = probMat[matchIndex] + pMisMatch;
-                        }
-                        else if (delScore != INF_INT) {
-                            probMat[curIndex] = probMat[delIndex] + pDel;
-                        }
-                        else if (insScore != INF_INT) {
-                            probMat[curIndex] = probMat[insIndex] + pIns;
-                        }
-                        //
-                        // Not normalizing probabilities, but using value as if it
-                        // was a probability later on, so cap at 0 (= log 1).
-                        //
-                        if (probMat[curIndex] > 0) {
-                            probMat[curIndex] = 0;
-                        }
-                        assert(!std::isnan(probMat[curIndex]));
+                    else if (insScore != INF_INT and delScore != INF_INT) {
+                        prob = LogSumOfTwo(matrices.Prob(delIndex) + pDel,
+                                matrices.Prob(insIndex) + pIns);
+                    }
+                    else if (matchScore != INF_INT) {
+                        prob = matrices.Prob(matchIndex) + pMisMatch;
+                    }
+                    else if (delScore != INF_INT) {
+                        prob = matrices.Prob(delIndex) + pDel;
                     }
+                    else if (insScore != INF_INT) {
+                        prob = matrices.Prob(insIndex) + pIns;
+                    }
+                    //
+                    // Not normalizing probabilities, but using value as if it
+                    // was a probability later on, so cap at 0 (= log 1).
+                    //
+                    if (prob > 0) {
+                        prob = 0;
+                    }
+                    assert(!std::isnan(prob));
                 }
             }
         }
@@ -418,7 +455,7 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
         assert(bufferIndexIsValid);
         assert(bufferIndex >= 0);
         Arrow arrow;
-        arrow = pathMat[bufferIndex];
+        arrow = matrices.GetArrow(bufferIndex);
         if (arrow == NoArrow) {
             tSeq.ToAscii();
             qSeq.ToAscii();
@@ -447,28 +484,118 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
         }
     }
 
-    alignment.nCells = ComputeMatrixNElem(guide);
+    alignment.nCells = matrixNElem;
     std::reverse(optAlignment.begin(), optAlignment.end());
     alignment.qPos = qStart;
     alignment.tPos = tStart;
     alignment.ArrowPathToAlignment(optAlignment);
     RemoveAlignmentPrefixGaps(alignment);
-    int lastIndex = 0;
-    tSeq.Free();
-    qSeq.Free();
-    lastIndex = -1;
+    int lastIndex = -1;
     if (GetBufferIndex(guide, qEnd - 1, tEnd - 1, lastIndex)) {
-        alignment.score = scoreMat[lastIndex];
+        alignment.score = matrices.Score(lastIndex);
         if (computeProb) {
-            alignment.probScore = probMat[lastIndex];
+            alignment.probScore = matrices.Prob(lastIndex);
         }
-        return scoreMat[lastIndex];
+        return alignment.score;
     }
     else {
         return 0;
     }
 }
 
+//
+// When compactTraceback is true, the alignment is computed in
+// GuidedAlignCompactMatrices, and scoreMat, pathMat, probMat and
+// optPathProbMat are left untouched.  Use it for long reads and wide
+// bands.
+//
+template<typename QSequence, typename TSequence, typename T_ScoreFn>
+int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &guideAlignment,
+        T_ScoreFn &scoreFn,
+        int bandSize,
+        blasr::Alignment &alignment,
+        std::vector<int>    &scoreMat,
+        std::vector<Arrow>  &pathMat,
+        std::vector<double> &probMat,
+        std::vector<double> &optPathProbMat,
+        std::vector<float>  &lnSubPValueVect,
+        std::vector<float>  &lnInsPValueVect,
+        std::vector<float>  &lnDelPValueVect,
+        std::vector<float>  &lnMatchPValueVect,
+        AlignmentType alignType=Global,
+        bool computeProb=false,
+        bool compactTraceback=false) {
+
+    Guide guide;
+    AlignmentToGuide(guideAlignment, guide, bandSize);
+    StoreMatrixOffsets(guide);
+    ComputeMatrixNElem(guide);
+
+    //
+    // Make a copy of the sequences that is guaranteed to be in 3-bit format for faster alignment.
+    // (mabybe eventually reuse the qseq and tseq memory)
+    //
+    QSequence qSeq;
+    TSequence tSeq;
+    qSeq.Assign(origQSeq);
+    tSeq.Assign(origTSeq);
+
+    /*
+     * The following code is useful to produce images of the dp-matrix.
+     * Make sure the sequenences are less than 5kb each though.
+
+     Matrix<float> probMatrix;
+     probMatrix.Resize(qSeq.length, tSeq.length);
+     probMatrix.Initialize(0);
+     ofstream matrixOut;
+     stringstream matrixOutNameStrm;
+     matrixOutNameStrm << "probMatrix_"<< runIndex << ".dat";
+     matrixOut.open(matrixOutNameStrm.str().c_str());
+     */
+
+    if (computeProb) { 
+        //
+        // Convert phred scale to proper ln for faster manipulation later on.
+        //
+        QVToLogPScale(qSeq.substitutionQV, qSeq.length, lnSubPValueVect);
+        QVToLogPScale(qSeq.insertionQV,    qSeq.length, lnInsPValueVect);
+        QVToLogPScale(qSeq.deletionQV,     qSeq.length, lnDelPValueVect);
+        if (lnMatchPValueVect.size() < qSeq.length) {
+            lnMatchPValueVect.resize(qSeq.length);
+        }
+        //
+        // Normalize probability vectors so that the probability of transition from each cell is 1.
+        //
+        unsigned int i;
+        for (i = 0; i < qSeq.length; i++) {
+            float subSum  = LogSumOfTwo(lnSubPValueVect[i], QVToLogPScale(scoreFn.substitutionPrior)); // prior on substitution rate
+            float denominator = LogSumOfThree(lnDelPValueVect[i], lnInsPValueVect[i], subSum);
+            lnDelPValueVect[i] = lnDelPValueVect[i] - denominator;
+            lnSubPValueVect[i]   = lnSubPValueVect[i] - denominator;
+            lnInsPValueVect[i]   = lnInsPValueVect[i] - denominator;
+            lnMatchPValueVect[i] = subSum - denominator;
+        }
+
+    }
+
+
+
+    int score;
+    if (compactTraceback) {
+        GuidedAlignCompactMatrices matrices;
+        score = AlignAlongGuide(qSeq, tSeq, guide, scoreFn, matrices, 
+                                alignment, alignType, computeProb);
+    }
+    else {
+        GuidedAlignFullMatrices matrices(scoreMat, pathMat, probMat, optPathProbMat);
+        score = AlignAlongGuide(qSeq, tSeq, guide, scoreFn, matrices, 
+                                alignment, alignType, computeProb);
+    }
+    tSeq.Free();
+    qSeq.Free();
+    return score;
+}
+
 template<typename QSequence, typename TSequence, typename T_ScoreFn> //, typename T_BufferCache>
 int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
         T_ScoreFn &scoreFn,
@@ -477,7 +604,8 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
         blasr::Alignment &alignment,
         AlignmentType alignType=Global,
         bool computeProb = false,
-        int sdpTupleSize= 8) {
+        int sdpTupleSize= 8,
+        bool compactTraceback = false) {
     blasr::Alignment sdpAlignment;
 
     int alignScore = SDPAlign(origQSeq, origTSeq,
@@ -495,7 +623,7 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
 
     return GuidedAlign(origQSeq, origTSeq, sdpAlignment, scoreFn, bandSize, alignment,
             // fill in optional parameters
-            alignType, computeProb);
+            alignType, computeProb, compactTraceback);
 
 }
 
@@ -514,7 +642,8 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
         blasr::Alignment &alignment, 
         AlignmentType alignType=Global,
         bool computeProb = false,
-        int sdpTupleSize= 8) {
+        int sdpTupleSize= 8,
+        bool compactTraceback = false) {
 
     blasr::Alignment sdpAlignment;
 
@@ -533,7 +662,45 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,
 
     return GuidedAlign(origQSeq, origTSeq, sdpAlignment, scoreFn, bandSize, buffers, alignment,
             // fill in optional parameters
-            alignType, computeProb);
+            alignType, computeProb, compactTraceback);
+}
+
+//
+// As above, also keeping the working storage of SDPAlign in
+// sdpScratch, so that SDPAlign does not allocate once it has grown.
+//
+
+template<typename QSequence, typename TSequence, typename T_ScoreFn, typename T_BufferCache>
+int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq, 
+        T_ScoreFn &scoreFn,
+        int bandSize,
+        int sdpIns, int sdpDel, float sdpIndelRate,
+        T_BufferCache &buffers,
+        SDPAlignScratch &sdpScratch,
+        blasr::Alignment &alignment, 
+        AlignmentType alignType=Global,
+        bool computeProb = false,
+        int sdpTupleSize= 8,
+        bool compactTraceback = false) {
+
+    blasr::Alignment sdpAlignment;
+
+    int alignScore = SDPAlign(origQSeq, origTSeq,
+            scoreFn, sdpTupleSize, 
+            sdpIns, sdpDel, sdpIndelRate,
+            sdpAlignment, buffers, sdpScratch, Local, false, false);
+
+    int b;
+    for (b = 0; b < sdpAlignment.blocks.size(); b++) {
+        sdpAlignment.blocks[b].qPos += sdpAlignment.qPos;
+        sdpAlignment.blocks[b].tPos += sdpAlignment.tPos;
+    }
+    sdpAlignment.tPos = 0;
+    sdpAlignment.qPos = 0;
+
+    return GuidedAlign(origQSeq, origTSeq, sdpAlignment, scoreFn, bandSize, buffers, alignment,
+            // fill in optional parameters
+            alignType, computeProb, compactTraceback);
 }
 
 //
@@ -546,7 +713,8 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
         T_BufferCache &buffers,
         blasr::Alignment &alignment, 
         AlignmentType alignType=Global, 
-        bool computeProb=false) {
+        bool computeProb=false,
+        bool compactTraceback=false) {
     return GuidedAlign(origQSeq, origTSeq, guideAlignment, scoreFn, bandSize, alignment, 
             buffers.scoreMat,
             buffers.pathMat,
@@ -555,7 +723,7 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
             buffers.lnSubPValueMat,
             buffers.lnInsPValueMat,
             buffers.lnDelPValueMat,
-            buffers.lnMatchPValueMat, alignType, computeProb);
+            buffers.lnMatchPValueMat, alignType, computeProb, compactTraceback);
 }
 
 //
@@ -574,7 +742,8 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
         int bandSize,
         blasr::Alignment &alignment, 
         AlignmentType alignType=Global, 
-        bool computeProb=false) {
+        bool computeProb=false,
+        bool compactTraceback=false) {
 
     //  Make synonyms for members of the buffers class for easier typing.
     std::vector<int>    scoreMat;
@@ -594,7 +763,7 @@ int GuidedAlign(QSequence &origQSeq, TSequence &origTSeq,  blasr::Alignment &gui
             lnSubPValueVect,
             lnInsPValueVect,
             lnDelPValueVect,
-            lnMatchPValueVect, alignType, computeProb);
+            lnMatchPValueVect, alignType, computeProb, compactTraceback);
 }
 
 #endif // _BLASR_GUIDE_ALIGNMENT_HPP_
@@ -10,6 +10,7 @@
 #include "matrix/FlatMatrix.hpp"
 #include "datastructures/alignment/Alignment.hpp"
 #include "statistics/StatUtils.hpp"
+#include "AntiDiagonalKBandAlign.hpp"
 
 class DefaultGuide {
  public:
@@ -47,6 +48,64 @@ void CreateThreeBitSequence(T_Sequence &origSeq, T_Sequence &threeBitSeq) {
 }
 
 
+//
+// Alignments scored by a plain substitution matrix are computed by the
+// anti-diagonal engine.  Every other score function may depend on the
+// position in the sequences, so the generic version declines.  The
+// engine uses one gap cost for the boundary and the interior of the
+// band, so it also declines when the ins and del given for the
+// boundary are not those of the score function.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn>
+bool KBandAlignByAntiDiagonals(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
+							 DNALength qLen, DNALength tLen, int k, int ins, int del,
+							 T_ScoreFn &scoreFn, AlignmentType alignType,
+							 std::vector<Arrow> &optAlignment, int &q, int &t, int &optScore) {
+	return false;
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence,
+         typename T_RefSequence, typename T_ScoreQuerySequence>
+bool KBandAlignByAntiDiagonals(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
+							 DNALength qLen, DNALength tLen, int k, int ins, int del,
+							 DistanceMatrixScoreFunction<T_RefSequence, T_ScoreQuerySequence> &scoreFn,
+							 AlignmentType alignType,
+							 std::vector<Arrow> &optAlignment, int &q, int &t, int &optScore) {
+	if (ins != scoreFn.ins or del != scoreFn.del) {
+		return false;
+	}
+	return AntiDiagonalKBandAlign(qSeq.seq, qLen, tSeq.seq, tLen,
+							 scoreFn.scoreMatrix, scoreFn.ins, scoreFn.del, k, alignType,
+							 optAlignment, q, t, optScore);
+}
+
+//
+// Store the traceback of KBandAlign, which stopped at row q and band
+// column t, in alignment.
+//
+template<typename T_Alignment>
+void KBandTracebackToAlignment(std::vector<Arrow> &optAlignment, int q, int t,
+							 int k, T_Alignment &alignment) {
+	alignment.qPos = q;
+	
+	//
+	// Use a little extra logic to deal with the unsignedness of indices.
+	//
+	if (t < k) {
+		alignment.tPos = (k - t) - q;
+	}
+	else {
+		alignment.tPos = (t - k) - q;
+	}
+	std::reverse(optAlignment.begin(), optAlignment.end());
+	alignment.ArrowPathToAlignment(optAlignment);
+}
+
+//
+// When scoreFn is a DistanceMatrixScoreFunction and paths are not
+// sampled, the band is filled by AntiDiagonalKBandAlign, and scoreMat
+// and pathMat are left untouched.
+//
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
 int KBandAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
 							 int matchMat[5][5], int ins, int del, int k,
@@ -72,6 +131,17 @@ int KBandAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
   DNALength nCols = 2*k + 1;
 	DNALength totalMatSize = (qLen + 1) * nCols;
 	alignment.nCells = totalMatSize;
+
+	int q, t;
+	std::vector<Arrow> bandAlignment;
+	int bandScore;
+	if (samplePaths == false and 
+			KBandAlignByAntiDiagonals(qSeq, tSeq, qLen, tLen, k, ins, del, scoreFn, alignType,
+																bandAlignment, q, t, bandScore)) {
+		KBandTracebackToAlignment(bandAlignment, q, t, k, alignment);
+		return bandScore;
+	}
+
 	if (scoreMat.size() < totalMatSize) {
 		scoreMat.resize(totalMatSize);
 		pathMat.resize(totalMatSize);
@@ -86,7 +156,6 @@ int KBandAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
 	//
 	// Initialize the boundaries of the score and path matrices.
 	//
-	int q, t;
 
 	for (q = 1; q <= k && q < qLen + 1; q++) {
 		scoreMat[rc2index(q, k - q, nCols)] = q * ins;
@@ -362,19 +431,7 @@ int KBandAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
 	//optAlignment.pop_back();
 	//	qSeq.Free();
 	//	tSeq.Free();
-	alignment.qPos = q;
-	
-	//
-	// Use a little extra logic to deal with the unsignedness of indices.
-	//
-	if (t < k) {
-		alignment.tPos = (k - t) - q;
-	}
-	else {
-		alignment.tPos = (t - k) - q;
-	}
-	std::reverse(optAlignment.begin(), optAlignment.end());
-	alignment.ArrowPathToAlignment(optAlignment);
+	KBandTracebackToAlignment(optAlignment, q, t, k, alignment);
 	return optScore;
 }
 
@@ -1,17 +1,47 @@
 #ifndef _BLASR_SDP_ALIGN_HPP_
 #define _BLASR_SDP_ALIGN_HPP_
 
+#include <deque>
+#include <vector>
 #include "DNASequence.hpp"
 #include "tuples/TupleMatching.hpp"
 #include "sdp/SDPFragment.hpp"
+#include "sdp/SparseDynamicProgramming.hpp"
 #include "FASTASequence.hpp"
 #include "FASTQSequence.hpp"
 #include "DistanceMatrixScoreFunction.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "datastructures/alignment/Path.h"
+#include "matrix/FlatMatrix.hpp"
+#include "AlignmentUtils.hpp"
 
 #define SDP_DETAILED_WORD_SIZE 5
 #define SDP_PREFIX_LENGTH 50
 #define SDP_SUFFIX_LENGTH 50
 
+//
+// The working storage of SDPAlign apart from its fragment and tuple
+// lists.  It grows to the largest alignment made with it and is not
+// freed between calls.  The alignments that SDPAlign keeps while it
+// recurses are held once for each level of recursion.
+//
+class SDPAlignScratch {
+public:
+    SDPSweepBuffers sweepBuffers;
+    TupleExtractor extractor;
+    std::vector<int> scoreMat;
+    std::vector<Arrow> pathMat, optAlignment;
+    std::vector<blasr::GapList> spareGapLists;
+    FlatMatrix2D<int> graphScoreMat, graphBins;
+    FlatMatrix2D<Arrow> graphPathMat;
+    std::vector<bool> onOptPath, blockIsGood;
+    std::vector<int> recurseFragmentChain;
+    std::deque<blasr::Alignment> chainAlignments, fragAlignments, frontAlignments;
+    int level;
+
+    SDPAlignScratch() : level(0) {}
+};
+
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn>
 int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         T_ScoreFn &scoreFn, int wordSize, 
@@ -38,6 +68,25 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool fastSDP=true,
         unsigned int minFragmentsToUseGraphPaper=100000);
 
+//
+// As above, with the rest of the working storage kept by the caller as
+// well, typically one scratch per thread, so that SDPAlign does not
+// allocate once the buffers have grown.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_BufferCache>
+int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
+        T_ScoreFn &scoreFn, int wordSize, 
+        int sdpIns, int sdpDel, float indelRate,
+        blasr::Alignment &alignment, 
+        T_BufferCache &buffers,
+        SDPAlignScratch &scratch,
+        AlignmentType alignType=Global,
+        bool detailedAlignment=true,
+        bool extendFrontByLocalAlignment=true, 
+        DNALength noRecurseUnder=10000,
+        bool fastSDP=true,
+        unsigned int minFragmentsToUseGraphPaper=100000);
+
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_TupleList>
 int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         T_ScoreFn &scoreFn,
@@ -59,6 +108,27 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool fastSDP=true,
         unsigned int minFragmentsToUseGraphPaper=100000);
 
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_TupleList>
+int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
+        T_ScoreFn &scoreFn,
+        int wordSize, 
+        int sdpIns, int sdpDel, float indelRate,
+        blasr::Alignment &alignment, 
+        std::vector<Fragment> &fragmentSet,
+        std::vector<Fragment> &prefixFragmentSet,
+        std::vector<Fragment> &suffixFragmentSet,
+        T_TupleList &targetTupleList,
+        T_TupleList &targetPrefixTupleList,
+        T_TupleList &targetSuffixTupleList,
+        std::vector<int> &maxFragmentChain,
+        SDPAlignScratch &scratch,
+        AlignmentType alignType=Global,
+        bool detailedAlignment=true,
+        bool extendFrontByLocalAlignment=true, 
+        DNALength noRecurseUnder=10000,
+        bool fastSDP=true,
+        unsigned int minFragmentsToUseGraphPaper=100000);
+
 #include "SDPAlignImpl.hpp"
 
 #endif // _BLASR_SDP_ALIGN_HPP_
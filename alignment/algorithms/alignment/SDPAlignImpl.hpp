@@ -41,6 +41,7 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     TupleList<PositionDNATuple> targetPrefixTupleList;
     TupleList<PositionDNATuple> targetSuffixTupleList;
     std::vector<int> maxFragmentChain;
+    SDPAlignScratch scratch;
 
     return SDPAlign(query, target,
             scoreFn, wordSize, 
@@ -49,10 +50,12 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
             fragmentSet, prefixFragmentSet, suffixFragmentSet, 
             targetTupleList, targetPrefixTupleList, targetSuffixTupleList,
             maxFragmentChain,
+            scratch,
             alignType,
             detailedAlignment,
             extendFrontByLocalAlignment,
             noRecurseUnder,
+            fastSDP,
             minFragmentsToUseGraphPaper);
 }
 
@@ -69,6 +72,32 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         bool fastSDP,
         unsigned int minFragmentsToUseGraphPaper) {
 
+    SDPAlignScratch scratch;
+
+    return SDPAlign(query, target, scoreFn, wordSize, 
+            sdpIns, sdpDel, indelRate,
+            alignment,  
+            buffers,
+            scratch,
+            alignType, detailedAlignment, 
+            extendFrontByLocalAlignment, noRecurseUnder,
+            fastSDP, minFragmentsToUseGraphPaper);
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_BufferCache>
+int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
+        T_ScoreFn &scoreFn, int wordSize, 
+        int sdpIns, int sdpDel, float indelRate,
+        blasr::Alignment &alignment, 
+        T_BufferCache &buffers,
+        SDPAlignScratch &scratch,
+        AlignmentType alignType,
+        bool detailedAlignment,
+        bool extendFrontByLocalAlignment, 
+        DNALength noRecurseUnder,
+        bool fastSDP,
+        unsigned int minFragmentsToUseGraphPaper) {
+
     return SDPAlign(query, target, scoreFn, wordSize, 
             sdpIns, sdpDel, indelRate,
             alignment,  
@@ -79,6 +108,7 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
             buffers.sdpCachedTargetPrefixTupleList,
             buffers.sdpCachedTargetSuffixTupleList,
             buffers.sdpCachedMaxFragmentChain,
+            scratch,
             alignType, detailedAlignment, 
             extendFrontByLocalAlignment, noRecurseUnder,
             fastSDP, minFragmentsToUseGraphPaper);
@@ -104,9 +134,59 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         DNALength noRecurseUnder,
         bool fastSDP,
         unsigned int minFragmentsToUseGraphPaper) {
+
+    SDPAlignScratch scratch;
+
+    return SDPAlign(query, target, scoreFn, wordSize, 
+            sdpIns, sdpDel, indelRate,
+            alignment,  
+            fragmentSet, prefixFragmentSet, suffixFragmentSet,
+            targetTupleList, targetPrefixTupleList, targetSuffixTupleList,
+            maxFragmentChain,
+            scratch,
+            alignType, detailedAlignment, 
+            extendFrontByLocalAlignment, noRecurseUnder,
+            fastSDP, minFragmentsToUseGraphPaper);
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn, typename T_TupleList>
+int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
+        T_ScoreFn &scoreFn,
+        int wordSize, 
+        int sdpIns, int sdpDel, float indelRate,
+        blasr::Alignment &alignment, 
+        std::vector<Fragment> &fragmentSet,
+        std::vector<Fragment> &prefixFragmentSet,
+        std::vector<Fragment> &suffixFragmentSet,
+        T_TupleList &targetTupleList,
+        T_TupleList &targetPrefixTupleList,
+        T_TupleList &targetSuffixTupleList,
+        std::vector<int> &maxFragmentChain,
+        SDPAlignScratch &scratch,
+        AlignmentType alignType,
+        bool detailedAlignment,
+        bool extendFrontByLocalAlignment, 
+        DNALength noRecurseUnder,
+        bool fastSDP,
+        unsigned int minFragmentsToUseGraphPaper) {
     // minFragmentsToUseGraphPaper: minimum number of fragments to 
     // use Graph Paper for speed up.
 
+    //
+    // The alignments kept across a recursive call belong to this level
+    // of recursion.  A deque does not move its elements as it grows, so
+    // a deeper level may add its own.
+    //
+    if (scratch.chainAlignments.size() <= (size_t) scratch.level) {
+        scratch.chainAlignments.resize(scratch.level + 1);
+        scratch.fragAlignments.resize(scratch.level + 1);
+        scratch.frontAlignments.resize(scratch.level + 1);
+    }
+    blasr::Alignment &chainAlignment = scratch.chainAlignments[scratch.level];
+    blasr::Alignment &fragAlignment  = scratch.fragAlignments[scratch.level];
+    chainAlignment.Clear();
+    fragAlignment.Clear(scratch.spareGapLists);
+
     fragmentSet.clear();
     prefixFragmentSet.clear();
     suffixFragmentSet.clear();
@@ -177,9 +257,9 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     qSuffix.length = qSuffixLength;
 
 	fragmentSet.clear();
-    SequenceToTupleList(prefix, tmSmall, targetPrefixTupleList);
-    SequenceToTupleList(suffix, tmSmall, targetSuffixTupleList);
-    SequenceToTupleList(middle, tm, targetTupleList);
+    SequenceToTupleList(prefix, tmSmall, targetPrefixTupleList, scratch.extractor);
+    SequenceToTupleList(suffix, tmSmall, targetSuffixTupleList, scratch.extractor);
+    SequenceToTupleList(middle, tm, targetTupleList, scratch.extractor);
 
     targetPrefixTupleList.Sort();
     targetSuffixTupleList.Sort();
@@ -190,9 +270,9 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     // Store in fragmentSet the tuples that match between the target
     // and query.
     //
-    StoreMatchingPositions(qPrefix, tmSmall, targetPrefixTupleList, prefixFragmentSet);
-    StoreMatchingPositions(qSuffix, tmSmall, targetSuffixTupleList, suffixFragmentSet);
-    StoreMatchingPositions(qMiddle, tm, targetTupleList, fragmentSet); 
+    StoreMatchingPositions(qPrefix, tmSmall, targetPrefixTupleList, prefixFragmentSet, scratch.extractor);
+    StoreMatchingPositions(qSuffix, tmSmall, targetSuffixTupleList, suffixFragmentSet, scratch.extractor);
+    StoreMatchingPositions(qMiddle, tm, targetTupleList, fragmentSet, scratch.extractor); 
 
     // 
     // The method to store matching positions is not weight aware.
@@ -228,22 +308,15 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     fragmentSet.insert(fragmentSet.begin(), prefixFragmentSet.begin(), prefixFragmentSet.end());
     fragmentSet.insert(fragmentSet.end(), suffixFragmentSet.begin(), suffixFragmentSet.end());
 
-    FlatMatrix2D<int> graphScoreMat;
-    FlatMatrix2D<Arrow> graphPathMat;
-    FlatMatrix2D<int> graphBins;
     int nOnOpt = fragmentSet.size();
     if (fragmentSet.size() > minFragmentsToUseGraphPaper and fastSDP) {
         int nCol = 50;
-        vector<bool> onOptPath(fragmentSet.size(), false);
         nOnOpt = GraphPaper<Fragment>(fragmentSet, nCol, nCol,
-                                      graphBins, graphScoreMat, 
-                                      graphPathMat, onOptPath);
+                                      scratch.graphBins, scratch.graphScoreMat, 
+                                      scratch.graphPathMat, scratch.onOptPath);
         int prev = fragmentSet.size();
-        RemoveOffOpt(fragmentSet, onOptPath);
+        RemoveOffOpt(fragmentSet, scratch.onOptPath);
     } 
-    graphScoreMat.Clear();
-    graphPathMat.Clear();
-    graphBins.Clear();
 
     //
     // Because there are fragments from multiple overlapping regions, remove
@@ -272,18 +345,18 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     //
     // Find the longest chain of anchors.
     //
-    SDPLongestCommonSubsequence(query.length, fragmentSet, tm.tupleSize, sdpIns, sdpDel, scoreFn.scoreMatrix[0][0], maxFragmentChain, alignType);
+    SDPLongestCommonSubsequence(query.length, fragmentSet, tm.tupleSize, sdpIns, sdpDel, scoreFn.scoreMatrix[0][0], maxFragmentChain, alignType,
+                                &scratch.sweepBuffers);
 
     //
     // Now turn the max fragment chain into a real alignment.
     //
     int startF;
-    blasr::Alignment chainAlignment;
     alignment.qPos = 0;
     alignment.tPos = 0;
     Block block;
-    std::vector<int> fragScoreMat;
-    std::vector<Arrow> fragPathMat;
+    std::vector<int> &fragScoreMat = scratch.scoreMat;
+    std::vector<Arrow> &fragPathMat = scratch.pathMat;
 
     //
     // Patch the sdp fragments into an alignment, possibly breaking the
@@ -343,7 +416,7 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
         // compare the alignment distances.  
     }
 
-    std::vector<bool> blockIsGood;
+    std::vector<bool> &blockIsGood = scratch.blockIsGood;
     blockIsGood.resize(chainAlignment.size());
     fill(blockIsGood.begin(), blockIsGood.end(), true);
 
@@ -388,7 +461,6 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
     if (chainAlignment.blocks.size() > 0) {
         T_QuerySequence  qFragment;
         T_TargetSequence tFragment;
-        blasr::Alignment fragAlignment;
         unsigned int fb;
         if (alignType == Global) {
             //
@@ -417,7 +489,9 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
 
                 tFragment.seq = (Nucleotide*) &target.seq[0];
                 tFragment.length = chainAlignment.blocks[0].tPos;
-                blasr::Alignment frontAlignment;
+                blasr::Alignment &frontAlignment = scratch.frontAlignments[scratch.level];
+                frontAlignment.Clear(scratch.spareGapLists);
+                frontAlignment.qPos = frontAlignment.tPos = 0;
                 int frontAlignmentScore;
                 // Currently, there might be some space between the beginning
                 // of the alignment and the beginning of the read.  Run an
@@ -427,10 +501,12 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
                 if (extendFrontByLocalAlignment) {
                     if (noRecurseUnder == 0 or qFragment.length * tFragment.length < noRecurseUnder) {
                         frontAlignmentScore  = 
-                            SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat, frontAlignment, scoreFn, EndAnchored);
+                            SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat,
+                                    scratch.optAlignment, scratch.spareGapLists,
+                                    frontAlignment, scoreFn, EndAnchored);
                     } else {
                         // cout << "running recursive sdp alignment. " << endl;
-                        vector<int> recurseFragmentChain;
+                        scratch.level++;
                         SDPAlign(qFragment, tFragment, scoreFn,
                                 std::max(wordSize/2, 5),
                                 sdpIns, sdpDel,  indelRate,
@@ -441,9 +517,11 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
                                 targetTupleList,
                                 targetPrefixTupleList,
                                 targetSuffixTupleList,
-                                recurseFragmentChain,
+                                scratch.recurseFragmentChain,
+                                scratch,
                                 alignType, detailedAlignment, 
                                 extendFrontByLocalAlignment, 0);
+                        scratch.level--;
                     }
 
                     unsigned int anchorBlock;
@@ -474,7 +552,7 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
             //
             // Do a detaied smith-waterman alignment between blocks, if this
             // is specified.  
-            fragAlignment.Clear();
+            fragAlignment.Clear(scratch.spareGapLists);
             qFragment.Free();
             qFragment.ReferenceSubstring(query, chainAlignment.blocks[b].qPos + chainAlignment.blocks[b].length);
             qFragment.length = chainAlignment.blocks[b+1].qPos - 
@@ -489,11 +567,13 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
                     detailedAlignment == true) {
 
                 if (noRecurseUnder == 0 or qFragment.length * tFragment.length < noRecurseUnder) {
-                    alignScore = SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat, fragAlignment, scoreFn, Global);
+                    alignScore = SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat,
+                            scratch.optAlignment, scratch.spareGapLists,
+                            fragAlignment, scoreFn, Global);
                 }
                 else {
                     //          cout << "running recursive sdp alignment on " << qFragment.length * tFragment.length << endl;
-                    std::vector<int> recurseFragmentChain;
+                    scratch.level++;
                     SDPAlign(qFragment, tFragment, scoreFn,
                             std::max(wordSize/2, 5),
                             sdpIns, sdpDel,  indelRate,
@@ -504,8 +584,10 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
                             targetTupleList,
                             targetPrefixTupleList,
                             targetSuffixTupleList,
-                            recurseFragmentChain,
+                            scratch.recurseFragmentChain,
+                            scratch,
                             alignType, detailedAlignment, 0, 0);
+                    scratch.level--;
                 }
                 fragAlignment.qPos = 0;
                 fragAlignment.tPos = 0;
@@ -544,16 +626,18 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
 
                         if (extendFrontByLocalAlignment) {
 
-                            fragAlignment.Clear();
+                            fragAlignment.Clear(scratch.spareGapLists);
                             if (qFragment.length * tFragment.length > 10000) {
                                 //              cout << "Cautin: slow alignment crossing! " << qFragment.length  << " " << tFragment.length << endl;
                             }
 
                             if (noRecurseUnder == 0 or qFragment.length * tFragment.length < noRecurseUnder) {
-                                SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat, fragAlignment, scoreFn, EndAnchored);
+                                SWAlign(qFragment, tFragment, fragScoreMat, fragPathMat,
+                                        scratch.optAlignment, scratch.spareGapLists,
+                                        fragAlignment, scoreFn, EndAnchored);
                             }
                             else {
-                                std::vector<int> recurseFragmentChain;
+                                scratch.level++;
                                 SDPAlign(qFragment, tFragment, scoreFn,
                                         std::max(wordSize/2, 5),
                                         sdpIns, sdpDel,  indelRate,
@@ -564,8 +648,10 @@ int SDPAlign(T_QuerySequence &query, T_TargetSequence &target,
                                         targetTupleList,
                                         targetPrefixTupleList,
                                         targetSuffixTupleList,
-                                        recurseFragmentChain,
+                                        scratch.recurseFragmentChain,
+                                        scratch,
                                         alignType, detailedAlignment, extendFrontByLocalAlignment, 0);
+                                scratch.level--;
                             }
 
 
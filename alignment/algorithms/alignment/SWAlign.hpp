@@ -1,10 +1,37 @@
 #ifndef _BLASR_SW_ALIGN_HPP_
 #define _BLASR_SW_ALIGN_HPP_
 
+#include <vector>
+#include "datastructures/alignment/Alignment.hpp"
+
+//
+// When only the score is requested (ScoreLocal, ScoreGlobal or
+// ScoreQueryFit) with a DistanceMatrixScoreFunction, the score is
+// computed by StripedSWAlignScore, and scoreMat and pathMat are left
+// untouched.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
+int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq, 
+        std::vector<int> &scoreMat,
+        std::vector<Arrow> &pathMat, 
+        T_Alignment &alignment,
+        T_ScoreFn &scoreFn,
+        AlignmentType alignType = Local,
+        bool trustSequences = false,
+        bool printMatrix = false
+        ); 
+
+//
+// As above, tracing the optimal path back into optAlignment and taking
+// the gap lists of the alignment from spareGapLists, so that callers
+// that align many fragments may keep both.
+//
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
 int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq, 
         std::vector<int> &scoreMat,
         std::vector<Arrow> &pathMat, 
+        std::vector<Arrow> &optAlignment,
+        std::vector<blasr::GapList> &spareGapLists,
         T_Alignment &alignment,
         T_ScoreFn &scoreFn,
         AlignmentType alignType = Local,
@@ -12,18 +12,64 @@
 #include "datastructures/alignment/AlignmentStats.hpp"
 #include "datastructures/alignment/Alignment.hpp"
 #include "AlignmentUtils.hpp"
+#include "DistanceMatrixScoreFunction.hpp"
+#include "StripedSWAlign.hpp"
 #include "SWAlign.hpp"
 
+//
+// Score-only alignments with a plain substitution matrix are computed
+// by the striped kernel.  Every other score function needs the full
+// matrix, so the generic version declines.
+//
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_ScoreFn>
+bool SWAlignScoreOnly(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
+        T_ScoreFn &scoreFn, AlignmentType alignType, int &score) {
+    return false;
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence,
+         typename T_RefSequence, typename T_ScoreQuerySequence>
+bool SWAlignScoreOnly(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
+        DistanceMatrixScoreFunction<T_RefSequence, T_ScoreQuerySequence> &scoreFn,
+        AlignmentType alignType, int &score) {
+    return StripedSWAlignScore(qSeq.seq, qSeq.length, tSeq.seq, tSeq.length,
+            scoreFn.scoreMatrix, scoreFn.ins, scoreFn.del, alignType, score);
+}
+
+template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
+int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq, 
+        std::vector<int> &scoreMat,
+        std::vector<Arrow> &pathMat, 
+        T_Alignment &alignment,
+        T_ScoreFn &scoreFn,
+        AlignmentType alignType,
+        bool trustSequences,
+        bool printMatrix
+        ) {
+    std::vector<Arrow> optAlignment;
+    std::vector<blasr::GapList> spareGapLists;
+    return SWAlign(qSeq, tSeq, scoreMat, pathMat, optAlignment, spareGapLists,
+            alignment, scoreFn, alignType, trustSequences, printMatrix);
+}
+
 template<typename T_QuerySequence, typename T_TargetSequence, typename T_Alignment, typename T_ScoreFn>
 int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq, 
         std::vector<int> &scoreMat,
         std::vector<Arrow> &pathMat, 
+        std::vector<Arrow> &optAlignment,
+        std::vector<blasr::GapList> &spareGapLists,
         T_Alignment &alignment,
         T_ScoreFn &scoreFn,
         AlignmentType alignType,
         bool trustSequences,
         bool printMatrix
         ) {
+    int score;
+    if (printMatrix == false and 
+            SWAlignScoreOnly(qSeq, tSeq, scoreFn, alignType, score)) {
+        return score;
+    }
+
     VectorIndex nRows = qSeq.length + 1;
     VectorIndex nCols = tSeq.length + 1;
 
@@ -319,7 +365,7 @@ int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
             alignType != ScoreOverlap and 
             alignType != ScoreTPrefixQSuffix and
             alignType != ScoreTSuffixQPrefix) {
-        std::vector<Arrow>  optAlignment;
+        optAlignment.clear();
         Arrow arrow;
         while (((alignType == Global   or alignType == FrontAnchored ) and (r > 0 or c > 0)) or // global alignment stops at top corner
                 ((alignType == QueryFit or 
@@ -357,7 +403,7 @@ int SWAlign(T_QuerySequence &qSeq, T_TargetSequence &tSeq,
         if (optAlignment.size() > 1) 
             std::reverse(optAlignment.begin(), optAlignment.end());
         if (optAlignment.size() > 0) 
-            alignment.ArrowPathToAlignment(optAlignment);
+            alignment.ArrowPathToAlignment(optAlignment, spareGapLists);
 
         //
         // If running a local alignment, the alignment does not
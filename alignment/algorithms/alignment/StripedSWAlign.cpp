@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <vector>
+#include <limits.h>
+#include <stdlib.h>
+#include "algorithms/alignment/StripedSWAlign.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+//
+// The kernel works with scores negated relative to SWAlign, so that
+// the best alignment has the maximum score and saturating adds clamp
+// toward the ends of the 16-bit range.
+//
+static const int StripedLanes = 8;
+
+//
+// Query positions past the end of the query score this against every
+// target base, so that they never look better than real positions.
+//
+static const short StripedPadScore = -16384;
+
+static inline short HorizontalMax(__m128i v) {
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+    return (short) _mm_extract_epi16(v, 0);
+}
+
+static inline short HorizontalMin(__m128i v) {
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 2));
+    return (short) _mm_extract_epi16(v, 0);
+}
+
+static inline short Lane(__m128i v, int lane) {
+    short lanes[StripedLanes];
+    _mm_storeu_si128((__m128i*) lanes, v);
+    return lanes[lane];
+}
+
+//
+// Shift every lane up by one, so lane k holds the value of lane k-1,
+// and put fill in lane 0.
+//
+static inline __m128i ShiftLanes(__m128i v, short fill) {
+    return _mm_insert_epi16(_mm_slli_si128(v, 2), fill, 0);
+}
+#endif
+
+bool StripedSWAlignScore(Nucleotide *query, DNALength queryLength,
+    Nucleotide *target, DNALength targetLength,
+    int scoreMatrix[5][5], int ins, int del,
+    AlignmentType alignType, int &score) {
+
+#ifndef __SSE2__
+    return false;
+#else
+    if (alignType != ScoreLocal and alignType != ScoreGlobal and
+        alignType != ScoreQueryFit) {
+        return false;
+    }
+    if (queryLength == 0 or targetLength == 0) {
+        return false;
+    }
+    //
+    // Padding past the end of the query is only guaranteed to score
+    // below the last query position when gaps have a cost.
+    //
+    if (ins <= 0 or del <= 0) {
+        return false;
+    }
+    bool local = (alignType == ScoreLocal);
+    int segLen = (queryLength + StripedLanes - 1) / StripedLanes;
+
+    //
+    // The gap costs along the first row and column must fit before the
+    // kernel starts.  Scores inside the matrix are checked at the end.
+    //
+    const long scoreLimit = SHRT_MAX / 2;
+    if (labs((long) ins) * (segLen * StripedLanes + 1) > scoreLimit or
+        labs((long) del) * (targetLength + 1) > scoreLimit) {
+        return false;
+    }
+    int i, j;
+    for (i = 0; i < 5; i++) {
+        for (j = 0; j < 5; j++) {
+            if (abs(scoreMatrix[i][j]) > scoreLimit) {
+                return false;
+            }
+        }
+    }
+
+    DNALength q, c;
+    for (q = 0; q < queryLength; q++) {
+        if (ThreeBit[query[q]] > 4) {
+            return false;
+        }
+    }
+    for (c = 0; c < targetLength; c++) {
+        if (ThreeBit[target[c]] > 4) {
+            return false;
+        }
+    }
+
+    //
+    // profile[code*segLen + s], lane k, is the score of query position
+    // k*segLen + s against a target base with ThreeBit value code.
+    //
+    __m128i *profile = (__m128i*) _mm_malloc(7 * segLen * sizeof(__m128i), 
+                                             sizeof(__m128i));
+    __m128i *hPrev = profile + 5 * segLen;
+    __m128i *hCur  = hPrev + segLen;
+    short lanes[StripedLanes];
+    int code, s, k;
+    for (code = 0; code < 5; code++) {
+        for (s = 0; s < segLen; s++) {
+            for (k = 0; k < StripedLanes; k++) {
+                q = k * segLen + s;
+                if (q < queryLength) {
+                    lanes[k] = -scoreMatrix[code][ThreeBit[query[q]]];
+                }
+                else {
+                    lanes[k] = StripedPadScore;
+                }
+            }
+            profile[code * segLen + s] = _mm_loadu_si128((__m128i*) lanes);
+        }
+    }
+
+    //
+    // Column 0 of the matrix.  Local alignments are free to start
+    // anywhere; global and query-fit alignments pay for skipping query
+    // bases.
+    //
+    for (s = 0; s < segLen; s++) {
+        for (k = 0; k < StripedLanes; k++) {
+            lanes[k] = local ? 0 : -ins * (k * segLen + s + 1);
+        }
+        hPrev[s] = _mm_loadu_si128((__m128i*) lanes);
+    }
+
+    __m128i vIns  = _mm_set1_epi16(ins);
+    __m128i vDel  = _mm_set1_epi16(del);
+    __m128i vZero = _mm_setzero_si128();
+    __m128i vMax  = _mm_set1_epi16(SHRT_MIN);
+    __m128i vMin  = _mm_set1_epi16(SHRT_MAX);
+
+    int lastSeg  = (queryLength - 1) % segLen;
+    int lastLane = (queryLength - 1) / segLen;
+
+    //
+    // For local alignments, the best cell is the first in row-major
+    // order (query-major) with the best score, and like SWAlign the
+    // score returned is that of the cell diagonally before it.
+    //
+    int localBest = 0, localBestRow = -1, localBestPred = 0;
+    int queryFitBest = 0;
+
+    for (c = 0; c < targetLength; c++) {
+        __m128i *prof = &profile[ThreeBit[target[c]] * segLen];
+        //
+        // Row 0 of the matrix at columns c and c+1.
+        //
+        short diagBoundary = (alignType == ScoreGlobal) ? -del * c : 0;
+        short upBoundary   = (alignType == ScoreGlobal) ? -del * (c + 1) : 0;
+
+        __m128i vH = ShiftLanes(hPrev[segLen - 1], diagBoundary);
+        __m128i vF = ShiftLanes(_mm_set1_epi16(SHRT_MIN), upBoundary - ins);
+        __m128i vColMax = _mm_set1_epi16(SHRT_MIN);
+        for (s = 0; s < segLen; s++) {
+            vH = _mm_adds_epi16(vH, prof[s]);
+            vH = _mm_max_epi16(vH, _mm_subs_epi16(hPrev[s], vDel));
+            vH = _mm_max_epi16(vH, vF);
+            if (local) {
+                vH = _mm_max_epi16(vH, vZero);
+            }
+            hCur[s]  = vH;
+            vColMax  = _mm_max_epi16(vColMax, vH);
+            vMin     = _mm_min_epi16(vMin, vH);
+            vF = _mm_subs_epi16(vH, vIns);
+            vH = hPrev[s];
+        }
+
+        //
+        // Carry gaps in the query across segment boundaries until they no
+        // longer improve any cell.
+        //
+        vF = ShiftLanes(vF, SHRT_MIN);
+        s = 0;
+        while (_mm_movemask_epi8(_mm_cmpgt_epi16(vF, hCur[s])) != 0) {
+            hCur[s] = _mm_max_epi16(hCur[s], vF);
+            vColMax = _mm_max_epi16(vColMax, hCur[s]);
+            vF = _mm_subs_epi16(vF, vIns);
+            if (++s == segLen) {
+                s = 0;
+                vF = ShiftLanes(vF, SHRT_MIN);
+            }
+        }
+        vMax = _mm_max_epi16(vMax, vColMax);
+
+        if (local) {
+            int colMax = HorizontalMax(vColMax);
+            if (colMax > localBest or (colMax == localBest and localBest > 0)) {
+                //
+                // Find the first query position holding the column maximum.
+                //
+                __m128i vColBest = _mm_set1_epi16(colMax);
+                int colBest = colMax, colBestRow = -1;
+                for (s = 0; s < segLen; s++) {
+                    int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(hCur[s], vColBest));
+                    for (k = 0; mask != 0; k++, mask >>= 2) {
+                        int row = k * segLen + s;
+                        if ((mask & 1) and row < (int) queryLength and 
+                            (colBestRow < 0 or row < colBestRow)) {
+                            colBestRow = row;
+                        }
+                    }
+                }
+                if (colBest == 0) {
+                    colBestRow = -1;
+                }
+                if (colBestRow >= 0 and
+                    (colBest > localBest or colBestRow < localBestRow)) {
+                    localBest    = colBest;
+                    localBestRow = colBestRow;
+                    if (colBestRow == 0) {
+                        localBestPred = 0;
+                    }
+                    else {
+                        localBestPred = Lane(hPrev[(colBestRow - 1) % segLen],
+                                             (colBestRow - 1) / segLen);
+                    }
+                }
+            }
+        }
+        else if (alignType == ScoreQueryFit) {
+            int lastRow = Lane(hCur[lastSeg], lastLane);
+            if (c == 0 or lastRow > queryFitBest) {
+                queryFitBest = lastRow;
+            }
+        }
+        std::swap(hPrev, hCur);
+    }
+
+    int globalScore = Lane(hPrev[lastSeg], lastLane);
+    _mm_free(profile);
+
+    //
+    // A saturated cell means the scores did not fit in 16 bits.
+    //
+    if (HorizontalMax(vMax) == SHRT_MAX or HorizontalMin(vMin) == SHRT_MIN) {
+        return false;
+    }
+
+    if (local) {
+        score = -localBestPred;
+    }
+    else if (alignType == ScoreQueryFit) {
+        score = -queryFitBest;
+    }
+    else {
+        score = -globalScore;
+    }
+    return true;
+#endif
+}
@@ -0,0 +1,24 @@
+#ifndef _BLASR_STRIPED_SW_ALIGN_HPP_
+#define _BLASR_STRIPED_SW_ALIGN_HPP_
+
+#include "Types.h"
+#include "NucConversion.hpp"
+#include "AlignmentUtils.hpp"
+
+//
+// Compute the score that SWAlign returns for a ScoreLocal, ScoreGlobal
+// or ScoreQueryFit alignment with a substitution matrix and constant
+// gap costs, without filling a score or path matrix.  This is a striped
+// (Farrar) kernel over eight 16-bit SSE2 lanes.
+//
+// Returns false when the kernel does not apply, and the caller should
+// run the full dynamic programming instead: any other alignment type,
+// no SSE2, an empty sequence, a character that is not ACGTN, gap costs
+// that are not positive, or scores that do not fit in 16 bits.
+//
+bool StripedSWAlignScore(Nucleotide *query, DNALength queryLength,
+    Nucleotide *target, DNALength targetLength,
+    int scoreMatrix[5][5], int ins, int del,
+    AlignmentType alignType, int &score);
+
+#endif // _BLASR_STRIPED_SW_ALIGN_HPP_
@@ -0,0 +1,119 @@
+#include "SDPPredecessorSet.hpp"
+
+static inline int HighBit(ULong word) {
+    return 63 - __builtin_clzll(word);
+}
+
+static inline int LowBit(ULong word) {
+    return __builtin_ctzll(word);
+}
+
+SDPPredecessorSet::SDPPredecessorSet() {
+    size = 0;
+    nLevels = 0;
+}
+
+void SDPPredecessorSet::Initialize(UInt sizeP) {
+    size = sizeP;
+    nLevels = 0;
+    UInt nWords = 0;
+    UInt nBits = (size > 0 ? size : 1);
+    do {
+        levelStart[nLevels] = nWords;
+        levelWords[nLevels] = (nBits + 63) / 64;
+        nWords += levelWords[nLevels];
+        nBits = levelWords[nLevels];
+        nLevels++;
+    } while (nBits > 1);
+    words.assign(nWords, 0);
+}
+
+void SDPPredecessorSet::Insert(UInt key) {
+    int level;
+    for (level = 0; level < nLevels; level++) {
+        ULong &word = words[levelStart[level] + (key >> 6)];
+        bool wasEmpty = (word == 0);
+        word |= ((ULong) 1) << (key & 63);
+        if (!wasEmpty) {
+            return;
+        }
+        key >>= 6;
+    }
+}
+
+void SDPPredecessorSet::Delete(UInt key) {
+    int level;
+    for (level = 0; level < nLevels; level++) {
+        ULong &word = words[levelStart[level] + (key >> 6)];
+        word &= ~(((ULong) 1) << (key & 63));
+        if (word != 0) {
+            return;
+        }
+        key >>= 6;
+    }
+}
+
+int SDPPredecessorSet::Member(UInt key) {
+    return (words[key >> 6] >> (key & 63)) & 1;
+}
+
+int SDPPredecessorSet::Predecessor(UInt key, UInt &pred) {
+    if (size == 0) {
+        return 0;
+    }
+    if (key >= size) {
+        key = size - 1;
+    }
+    //
+    // Climb until a word has a bit at or below key, then descend
+    // through the highest bits.
+    //
+    int level = 0;
+    while (true) {
+        ULong word = words[levelStart[level] + (key >> 6)] & (~((ULong) 0) >> (63 - (key & 63)));
+        if (word != 0) {
+            key = (key & ~((UInt) 63)) | HighBit(word);
+            break;
+        }
+        if (level == nLevels - 1 or (key >> 6) == 0) {
+            return 0;
+        }
+        key = (key >> 6) - 1;
+        level++;
+    }
+    while (level > 0) {
+        level--;
+        key = key * 64 + HighBit(words[levelStart[level] + key]);
+    }
+    pred = key;
+    return 1;
+}
+
+int SDPPredecessorSet::Successor(UInt key, UInt &succ) {
+    if (key + 1 >= size or key + 1 == 0) {
+        return 0;
+    }
+    key++;
+    int level = 0;
+    while (true) {
+        if ((key >> 6) >= levelWords[level]) {
+            return 0;
+        }
+        ULong word = words[levelStart[level] + (key >> 6)] & (~((ULong) 0) << (key & 63));
+        if (word != 0) {
+            key = (key & ~((UInt) 63)) | LowBit(word);
+            break;
+        }
+        if (level == nLevels - 1) {
+            return 0;
+        }
+        key = (key >> 6) + 1;
+        level++;
+    }
+    while (level > 0) {
+        level--;
+        key = key * 64 + LowBit(words[levelStart[level] + key]);
+    }
+    succ = key;
+    return 1;
+}
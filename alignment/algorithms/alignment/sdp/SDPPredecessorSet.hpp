@@ -0,0 +1,55 @@
+#ifndef _BLASR_SDP_PREDECESSOR_SET_HPP_
+#define _BLASR_SDP_PREDECESSOR_SET_HPP_
+
+#include <vector>
+#include "Types.h"
+
+/*
+ * A set of integers in [0, size), stored as a tree of bit vectors in
+ * one array: a bit at one level is set when the 64-bit word below it is
+ * not empty.  Insert, Delete, Predecessor and Successor each visit one
+ * word per level, which is at most six levels for 32-bit keys, and
+ * nothing is allocated once the set has been initialized for a size.
+ */
+class SDPPredecessorSet {
+public:
+    SDPPredecessorSet();
+
+    /*
+     * Empty the set and size it for keys in [0, size).  Storage is
+     * kept from earlier calls.
+     */
+    void Initialize(UInt size);
+
+    void Insert(UInt key);
+
+    void Delete(UInt key);
+
+    int Member(UInt key);
+
+    /*
+     * Set pred to the largest value <= key.
+     * Returns 1 if such a value exists, 0 otherwise.
+     */
+    int Predecessor(UInt key, UInt &pred);
+
+    /*
+     * Set succ to the smallest value > key.
+     * Returns 1 if such a value exists, 0 otherwise.
+     */
+    int Successor(UInt key, UInt &succ);
+
+private:
+    static const int MaxLevels = 7;
+    UInt size;
+    int nLevels;
+    //
+    // Level 0 holds one bit per key, and each level above one bit per
+    // word of the level below, up to a level of one word.
+    //
+    UInt levelStart[MaxLevels];
+    UInt levelWords[MaxLevels];
+    std::vector<ULong> words;
+};
+
+#endif // _BLASR_SDP_PREDECESSOR_SET_HPP_
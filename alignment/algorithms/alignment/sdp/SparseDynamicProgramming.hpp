@@ -8,6 +8,7 @@
 #include "DNASequence.hpp"
 #include "datastructures/alignment/Alignment.hpp"
 #include "algorithms/alignment/AlignmentUtils.hpp"
+#include "SDPPredecessorSet.hpp"
 
 /*******************************************************************************
  *  Sparse dynamic programming implementation of Longest Common Subsequence
@@ -22,6 +23,26 @@
 
 int IndelPenalty(int x1, int y1, int x2, int y2, int insertion, int deletion); 
 
+/*
+ * The sweep structures of SDPLongestCommonSubsequence, which may be
+ * kept between calls so that their storage is reused.
+ */
+class SDPSweepBuffers {
+public:
+    //
+    // The diagonals (y - x) of the fragments in the sweep, with the
+    // number of fragments on each and the last one added.
+    //
+    SDPPredecessorSet diagSet;
+    std::vector<int> diagCount, diagLast;
+    //
+    // The columns (y) of the fragments that have left the sweep, with
+    // the lowest cost fragment of each.
+    //
+    SDPPredecessorSet colSet;
+    std::vector<int> colOpt;
+};
+
 template<typename T_Fragment>
 void StoreAbove(std::vector<T_Fragment> &fragmentSet, DNALength fragmentLength);
 
@@ -30,7 +51,8 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
         std::vector<T_Fragment> &fragmentSet, 
         DNALength fragmentLength,
         int insertion, int deletion, int match,
-        std::vector<int> &maxFragmentChain, AlignmentType alignType=Global); 
+        std::vector<int> &maxFragmentChain, AlignmentType alignType=Global,
+        SDPSweepBuffers *buffers=NULL); 
 
 #include "SparseDynamicProgrammingImpl.hpp"
 
@@ -8,9 +8,7 @@
 #include <set>
 #include <limits.h>
 #include <ostream>
-#include "SDPSet.hpp"
 #include "SDPFragment.hpp"
-#include "SDPColumn.hpp"
 #include "FragmentSort.hpp"
 
 template<typename T_Fragment>
@@ -33,7 +31,8 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
         std::vector<T_Fragment> &fragmentSet, 
         DNALength fragmentLength,
         int insertion, int deletion, int match,
-        std::vector<int> &maxFragmentChain, AlignmentType alignType) {
+        std::vector<int> &maxFragmentChain, AlignmentType alignType,
+        SDPSweepBuffers *buffers) {
 
     maxFragmentChain.clear();
     if (fragmentSet.size() < 1)
@@ -41,9 +40,6 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
 
     std::sort(fragmentSet.begin(), fragmentSet.end(), LexicographicFragmentSort<T_Fragment>());
 
-    SDPSet<Fragment> sweepSet;
-    SDPSet<SDPColumn>   colSet;
-
     unsigned int sweepRow;
     unsigned int trailRow;
     VectorIndex fSweep, fTrail;
@@ -53,8 +49,40 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
     }
 
     StoreAbove(fragmentSet, fragmentLength);
+
+    //
+    // The sweep set holds the fragments of the last fragmentLength+1
+    // rows, ordered by diagonal then row.  A fragment's predecessor in
+    // it is on the nearest diagonal at or left of its own, and is the
+    // last added to that diagonal, since fragments are added and
+    // removed in row order.  So the sweep set is kept as a set of
+    // diagonals, and the column set as a set of columns, each over the
+    // range of the fragments.
+    //
+    SDPSweepBuffers localBuffers;
+    if (buffers == NULL) {
+        buffers = &localBuffers;
+    }
+    int minDiag = INT_MAX, maxDiag = INT_MIN;
+    unsigned int maxCol = 0;
+    for (fi = 0; fi < fragmentSet.size(); fi++) {
+        int diag = (int) (fragmentSet[fi].y - fragmentSet[fi].x);
+        minDiag = std::min(minDiag, diag);
+        maxDiag = std::max(maxDiag, diag);
+        maxCol  = std::max(maxCol, fragmentSet[fi].y);
+    }
+    SDPPredecessorSet &diagSet = buffers->diagSet;
+    SDPPredecessorSet &colSet  = buffers->colSet;
+    std::vector<int> &diagCount = buffers->diagCount;
+    std::vector<int> &diagLast  = buffers->diagLast;
+    std::vector<int> &colOpt    = buffers->colOpt;
+    diagSet.Initialize(maxDiag - minDiag + 1);
+    diagCount.assign(maxDiag - minDiag + 1, 0);
+    diagLast.resize(maxDiag - minDiag + 1);
+    colSet.Initialize(maxCol + 1);
+    colOpt.resize(maxCol + 1);
+
     sweepRow = fragmentSet[0].x;
-    Fragment pred, succ;
     fSweep = 0;
     fTrail = 0;
     unsigned int maxChainLength = 0;
@@ -75,8 +103,8 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
             // Compute the cost of every fragment in the sweep.
             //
             int cp = INF_INT, cl = INF_INT, ca = INF_INT;
-            SDPColumn curCol, predCol;
-            curCol.col = fragmentSet[fSweep].y;
+            UInt predCol, predDiag;
+            int predColFragment = 0, pred = 0;
             //
             // Search preceeding fragments.
             //
@@ -84,29 +112,32 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
             // Compute the cost of fragment_f
             int foundPrev = 0;
             int drift, driftPenalty;
-            if (colSet.Predecessor(curCol, predCol)) {
+            if (colSet.Predecessor(fragmentSet[fSweep].y, predCol)) {
                 //
-                // predCol points to the fragment with greatest value less than curCol.
+                // predCol is the greatest column not greater than this one.
                 // 
                 // Baker and Giancarlo LCS cost
+                predColFragment = colOpt[predCol];
                 driftPenalty = IndelPenalty(fragmentSet[fSweep].x, fragmentSet[fSweep].y,
-                                            fragmentSet[predCol.optFragment].x, 
-                                            fragmentSet[predCol.optFragment].y,
+                                            fragmentSet[predColFragment].x, 
+                                            fragmentSet[predColFragment].y,
                                             insertion, deletion);
-                cp = fragmentSet[predCol.optFragment].cost + driftPenalty;
+                cp = fragmentSet[predColFragment].cost + driftPenalty;
                 foundPrev = 1;
             }
 
             // Search overlapping fragments.
-            if (sweepSet.Predecessor(fragmentSet[fSweep], pred)) {
+            if (diagSet.Predecessor((int) (fragmentSet[fSweep].y - fragmentSet[fSweep].x) - minDiag, 
+                                    predDiag)) {
                 //
                 //	Baker and Giancarlo LCS cost
                 //  Cost with insertion and deletion penalty.
                 //
-                cl = pred.cost + 
-                     MIN((int)(fragmentLength - (fragmentSet[fSweep].y - pred.y)) * match, 0) + 
+                pred = diagLast[predDiag];
+                cl = fragmentSet[pred].cost + 
+                     MIN((int)(fragmentLength - (fragmentSet[fSweep].y - fragmentSet[pred].y)) * match, 0) + 
                      IndelPenalty(fragmentSet[fSweep].x, fragmentSet[fSweep].y,
-                                  pred.x, pred.y, insertion, deletion);
+                                  fragmentSet[pred].x, fragmentSet[pred].y, insertion, deletion);
                 foundPrev = 1;
             }
 
@@ -136,10 +167,10 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
                 (alignType == Local and minCost < 0))) {
                 fragmentSet[fSweep].cost = minCost - fragmentSet[fSweep].weight;
                 if (minCost == cp) {
-                    fragmentSet[fSweep].chainPrev = predCol.optFragment;
+                    fragmentSet[fSweep].chainPrev = predColFragment;
                 }
                 else if (minCost == cl) {
-                    fragmentSet[fSweep].chainPrev = pred.index;
+                    fragmentSet[fSweep].chainPrev = fragmentSet[pred].index;
                 }
                 else if (minCost == ca) {
                     fragmentSet[fSweep].chainPrev = aboveIndex;
@@ -183,8 +214,11 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
         fSweep = startF;
         while (fSweep < fragmentSetSize and 
                 fragmentSet[fSweep].x == sweepRow) {
-            //			cout << "inserting sweep set with index" << fragmentSet[fSweep].index << endl;
-            sweepSet.Insert(fragmentSet[fSweep]);
+            int diag = (int) (fragmentSet[fSweep].y - fragmentSet[fSweep].x) - minDiag;
+            if (diagCount[diag]++ == 0) {
+                diagSet.Insert(diag);
+            }
+            diagLast[diag] = fSweep;
             ++fSweep;
         }
 
@@ -197,12 +231,11 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
                 // These elements are removed from the sweep set since they are done being processed.
                 // If they are the lowest cost in the value, update colSet
                 //
-                SDPColumn col;
+                UInt col = fragmentSet[fTrail].y;
                 int storeCol = 0;
-                col.col = fragmentSet[fTrail].y;
 
                 if (colSet.Member(col)) {
-                    if (fragmentSet[col.optFragment].cost < fragmentSet[fTrail].cost) {
+                    if (fragmentSet[colOpt[col]].cost < fragmentSet[fTrail].cost) {
                         storeCol = 1;
                     }
                 }
@@ -210,12 +243,11 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
                     storeCol = 1;
                 }
                 if (storeCol) {
-                    col.col = fragmentSet[fTrail].y;
-                    col.optFragment = fTrail;
                     // 
                     // Insert new column or replace col with a more optimal one.
                     //
                     colSet.Insert(col);
+                    colOpt[col] = fTrail;
 
                     // 
                     // The invariant structure of the colSet is that
@@ -233,10 +265,10 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
                     //
                     // Since fragments are processed at most once, this remains O(M).
 
-                    SDPColumn successorCol = col;
+                    UInt successorCol;
 
                     while (colSet.Successor(col, successorCol) and
-                           fragmentSet[successorCol.optFragment].cost > fragmentSet[fTrail].cost) {
+                           fragmentSet[colOpt[successorCol]].cost > fragmentSet[fTrail].cost) {
                         colSet.Delete(successorCol);
                     }
                 }
@@ -244,9 +276,11 @@ int SDPLongestCommonSubsequence(DNALength queryLength,
                 //
                 // Now remove this fragment, it is at the end of the sweep line.
                 //
-                int deleted;
-                deleted = sweepSet.Delete(fragmentSet[fTrail]);
-                assert(deleted);
+                int diag = (int) (fragmentSet[fTrail].y - fragmentSet[fTrail].x) - minDiag;
+                assert(diagCount[diag] > 0);
+                if (--diagCount[diag] == 0) {
+                    diagSet.Delete(diag);
+                }
 
                 ++fTrail;
             }
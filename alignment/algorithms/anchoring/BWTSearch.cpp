@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "algorithms/anchoring/BWTSearch.hpp"
 
 int MapReadToGenome(BWT & bwt,
@@ -83,3 +84,150 @@ int MapReadToGenome(BWT & bwt,
         params, numBasesAnchored, spv, epv);
 }
 
+
+//
+// Find the SMEMs that contain position x, as in bwt_smem1 of bwa
+// (Li, "Exploring single-sample SNP and INDEL calling with whole-genome
+// de novo assembly", 2012).  The match starting at x is extended
+// forward, keeping the intervals where the number of occurrences
+// drops.  Those are then extended backward together; a match is an
+// SMEM when it can go no further back and no longer match survives.
+// Returns the end of the longest match starting at x, where the next
+// search starts.
+//
+static DNALength FindSMEMsAt(BidirectionalBWT & bwt,
+    FASTASequence & seq,
+    DNALength start, DNALength end, DNALength x,
+    std::vector<BiInterval> & mems,
+    std::vector<BiInterval> & prev,
+    std::vector<BiInterval> & curr) {
+
+    mems.clear();
+    Nucleotide c = ThreeBit[seq[x]];
+    BiInterval ik, ok;
+    if (c > 3 or bwt.SetInterval(c, ik) == false) {
+        return x + 1;
+    }
+    ik.qStart = x;
+    ik.qEnd   = x + 1;
+
+    curr.clear();
+    DNALength i;
+    for (i = x + 1; i < end; i++) {
+        c = ThreeBit[seq[i]];
+        if (c > 3) {
+            //
+            // Matches always stop at an ambiguous base.
+            //
+            curr.push_back(ik);
+            break;
+        }
+        bwt.ExtendForward(ik, c, ok);
+        if (ok.size != ik.size) {
+            curr.push_back(ik);
+            if (ok.size == 0) {
+                break;
+            }
+        }
+        ik = ok;
+        ik.qStart = x;
+        ik.qEnd   = i + 1;
+    }
+    if (i == end) {
+        curr.push_back(ik);
+    }
+    //
+    // Visit the longest matches first.
+    //
+    std::reverse(curr.begin(), curr.end());
+    DNALength next = curr[0].qEnd;
+    prev.swap(curr);
+
+    long j;
+    for (j = ((long) x) - 1; j >= ((long) start) - 1; j--) {
+        c = (j < (long) start) ? 4 : ThreeBit[seq[j]];
+        curr.clear();
+        DNALength k;
+        for (k = 0; k < prev.size(); k++) {
+            BiInterval &p = prev[k];
+            bool extended = false;
+            if (c < 4) {
+                extended = bwt.ExtendBackward(p, c, ok);
+            }
+            if (extended == false) {
+                //
+                // A longer match that is still being extended contains
+                // this one, as does one already reported that starts
+                // at or before it.
+                //
+                if (curr.size() == 0 and
+                    (mems.size() == 0 or j + 1 < (long) mems.back().qStart)) {
+                    p.qStart = j + 1;
+                    mems.push_back(p);
+                }
+            }
+            else if (curr.size() == 0 or ok.size != curr.back().size) {
+                ok.qStart = j;
+                ok.qEnd   = p.qEnd;
+                curr.push_back(ok);
+            }
+        }
+        if (curr.size() == 0) {
+            break;
+        }
+        prev.swap(curr);
+    }
+    std::reverse(mems.begin(), mems.end());
+    return next;
+}
+
+int FindSMEMs(BidirectionalBWT & bwt,
+    FASTASequence & seq,
+    DNALength start, DNALength end,
+    DNALength minMatchLength,
+    std::vector<BiInterval> & smems) {
+
+    smems.clear();
+    std::vector<BiInterval> mems, prev, curr;
+    DNALength x = start;
+    while (x < end) {
+        x = FindSMEMsAt(bwt, seq, start, end, x, mems, prev, curr);
+        DNALength m;
+        for (m = 0; m < mems.size(); m++) {
+            if (mems[m].Length() >= minMatchLength) {
+                smems.push_back(mems[m]);
+            }
+        }
+    }
+    return smems.size();
+}
+
+int MapReadToGenome(BidirectionalBWT & bwt,
+	FASTASequence & seq,
+    DNALength subreadStart, DNALength subreadEnd,
+    std::vector<ChainedMatchPos> &matchPosList,
+	AnchorParameters & params, int &numBasesAnchored,
+    std::vector<BiInterval> & smems) {
+
+    numBasesAnchored = 0;
+    if (subreadEnd - subreadStart < params.minMatchLength) {
+        return 0;
+    }
+    FindSMEMs(bwt, seq, subreadStart, subreadEnd, params.minMatchLength, smems);
+
+    std::vector<DNALength> matches;
+    DNALength s, m;
+    for (s = 0; s < smems.size(); s++) {
+        if (smems[s].size >= (DNALength) params.maxAnchorsPerPosition) {
+            continue;
+        }
+        matches.clear();
+        bwt.Locate(smems[s], matches);
+        numBasesAnchored += smems[s].Length();
+        for (m = 0; m < matches.size(); m++) {
+            matchPosList.push_back(ChainedMatchPos(matches[m], smems[s].qStart,
+                smems[s].Length(), matches.size()));
+        }
+    }
+    return matchPosList.size();
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include "FASTASequence.hpp"
 #include "bwt/BWT.hpp"
+#include "bwt/BidirectionalBWT.hpp"
 #include "datastructures/anchoring/MatchPos.hpp"
 #include "datastructures/anchoring/AnchorParameters.hpp"
 
@@ -23,6 +24,32 @@ int MapReadToGenome(BWT & bwt,
 	AnchorParameters  & params, int &numBasesAnchored);
 
 
+//
+// Find the super-maximal exact matches (SMEMs) of seq[start, end) that
+// are at least minMatchLength long, in order of their start.  An SMEM
+// is a match that cannot be extended on either side and is not
+// contained in another match.  Each read position is visited by a
+// forward and a backward pass of bidirectional extensions, instead of
+// a backward search restarted from every position.
+//
+int FindSMEMs(BidirectionalBWT & bwt,
+    FASTASequence & seq,
+    DNALength start, DNALength end,
+    DNALength minMatchLength,
+    std::vector<BiInterval> & smems);
+
+//
+// Anchor a read on the SMEMs found by FindSMEMs that have fewer than
+// params.maxAnchorsPerPosition occurrences.  numBasesAnchored is the
+// number of read bases in those SMEMs.
+//
+int MapReadToGenome(BidirectionalBWT & bwt,
+	FASTASequence & seq,
+    DNALength subreadStart, DNALength subreadEnd,
+    std::vector<ChainedMatchPos> &matchPosList,
+	AnchorParameters & params, int &numBasesAnchored,
+    std::vector<BiInterval> & smems);
+
 template<typename T_MappingBuffers>
 int MapReadToGenome(BWT & bwt,
     FASTASequence & seq,
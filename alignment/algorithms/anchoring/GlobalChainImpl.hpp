@@ -5,6 +5,7 @@
 #include "Types.h"
 #include "DNASequence.hpp"
 #include "algorithms/anchoring/PrioritySearchTree.hpp"
+#include "algorithms/anchoring/PrefixMaxTree.hpp"
 
 using namespace std;
 
@@ -33,56 +34,105 @@ UInt RestrictedGlobalChain(T_Fragment *fragments,
     vector<UInt> &prevOpt) {
 	// assume fragments are sorted by t
 	
+	if (nFragments == 0) {
+		return 0;
+	}
 	UInt f1, f2;
 	scores.resize(nFragments);
 	prevOpt.resize(nFragments);
-	std::fill(scores.begin(), scores.end(), 0);
-
-	UInt globalOptScore = 0;
-	UInt globalOptIndex = 0;
 	for (f1 = 0; f1 < nFragments; f1++) {
 		prevOpt[f1] = f1;
 		scores[f1] = 1;
 	}
-	
-	for (f1 = 0; f1 < nFragments - 1; f1++) {
-		UInt maxF1Score = 0;
-		UInt maxF1Prev  = f1;
-		for (f2 = f1+1; f2 < nFragments; f2++ ){ 
-			//
-			//  Check to see if the fragments may be connected within the
-			//  expected indel rate.
-			//
-			if (fragments[f2].GetQ() > fragments[f1].GetQ() + fragments[f1].GetW() 
-                and
-			    fragments[f2].GetT() > fragments[f1].GetT() + fragments[f1].GetW()) {
-				//
-				// Compute drift from diagonal.
-				//
-				UInt tDiff, qDiff;
-				tDiff = fragments[f2].GetT() - (fragments[f1].GetT() + fragments[f1].GetW());
-				qDiff = fragments[f2].GetQ() - (fragments[f1].GetQ() + fragments[f1].GetW());
-				UInt tIns, qIns;
-				tIns = qIns = 0;
-				UInt maxDiff = max(tDiff, qDiff);
-				UInt minDiff = min(tDiff, qDiff);
-				if (maxDiff - minDiff < minDiff*maxIndelRate) {
-					//
-					// The fragment is sufficiently close to the diagonal to
-					// consider it as a chain.  
-					//
-					if (scores[f2] < scores[f1] + 1) {
-						scores[f2] = scores[f1] + 1;
-						prevOpt[f2] = f1;
-						if (scores[f2] > globalOptScore) {
-							globalOptScore = scores[f2];
-							globalOptIndex = f2;
-						}
-					}
+
+	//
+	// Fragment f2 may follow f1 when the gaps from the end of f1 to the
+	// start of f2, tDiff and qDiff, differ by less than maxIndelRate
+	// times the smaller gap.  With c = 1 + maxIndelRate, this is
+	//   tDiff < c*qDiff and qDiff < c*tDiff,
+	// which also requires both gaps to be positive.  Writing
+	// x = c*t - q and y = c*q - t, f2 may follow f1 exactly when
+	// x(end of f1) < x(start of f2) and y(end of f1) < y(start of f2).
+	//
+	// So the fragments are chained with a sweep in x: the start of
+	// each fragment finds the best scoring end before it in y, and then
+	// its end is added.  The end of f1 is never before its start in x,
+	// so each score is final before it is added.  Of equal scores, the
+	// lowest fragment index is kept as the previous fragment.
+	//
+	// The gaps were once compared in float, where minDiff*maxIndelRate
+	// rounds to the gap difference when the two are equal in decimal
+	// (as for gaps of 10 and 11 at a rate of 0.1), so such fragments do
+	// not chain.  Lowering the rate by one part in 2^23 keeps this for
+	// read-sized gaps.  Positions are taken relative to the first
+	// fragment so that the keys stay small.
+	//
+	if (maxIndelRate > 0) {
+		double c = 1 + maxIndelRate * (1 - 1.0 / (1 << 23));
+		double tOrigin = fragments[0].GetT(), qOrigin = fragments[0].GetQ();
+		vector<double> startY(nFragments);
+		vector<pair<double, UInt> > endY(nFragments);
+		//
+		// Events are ordered by x, and at equal x starts come before
+		// ends; ends are numbered after starts.
+		//
+		vector<pair<double, ULong> > events(2*nFragments);
+		for (f1 = 0; f1 < nFragments; f1++) {
+			double t = fragments[f1].GetT() - tOrigin;
+			double q = fragments[f1].GetQ() - qOrigin;
+			double w = fragments[f1].GetW();
+			events[2*f1]   = make_pair(c*t - q, (ULong) f1);
+			events[2*f1+1] = make_pair(c*(t+w) - (q+w), (ULong) nFragments + f1);
+			startY[f1] = c*q - t;
+			endY[f1]   = make_pair(c*(q+w) - (t+w), f1);
+		}
+		std::sort(events.begin(), events.end());
+		std::sort(endY.begin(), endY.end());
+
+		vector<UInt> endRank(nFragments);
+		vector<double> sortedEndY(nFragments);
+		for (f1 = 0; f1 < nFragments; f1++) {
+			endRank[endY[f1].second] = f1;
+			sortedEndY[f1] = endY[f1].first;
+		}
+
+		PrefixMaxTree tree;
+		tree.Initialize(nFragments);
+		VectorIndex e;
+		for (e = 0; e < events.size(); e++) {
+			if (events[e].second < nFragments) {
+				f2 = events[e].second;
+				UInt nBefore = std::lower_bound(sortedEndY.begin(), sortedEndY.end(), 
+                                                startY[f2]) - sortedEndY.begin();
+				UInt prevScore, prevIndex;
+				if (tree.FindMax(nBefore, prevScore, prevIndex)) {
+					scores[f2]  = prevScore + 1;
+					prevOpt[f2] = prevIndex;
 				}
 			}
+			else {
+				f1 = events[e].second - nFragments;
+				tree.Update(endRank[f1], scores[f1], f1);
+			}
 		}
 	}
+
+	//
+	// The chain ends at the highest scoring fragment; of those, the one
+	// with the lowest previous fragment, then the lowest index.  When
+	// no fragments chain, it is the first fragment.
+	//
+	UInt globalOptScore = 1;
+	UInt globalOptIndex = 0;
+	for (f2 = 0; f2 < nFragments; f2++) {
+		if (scores[f2] > globalOptScore or 
+		    (scores[f2] == globalOptScore and globalOptScore > 1 and
+		     prevOpt[f2] < prevOpt[globalOptIndex])) {
+			globalOptScore = scores[f2];
+			globalOptIndex = f2;
+		}
+	}
+
 	UInt index = globalOptIndex;
 	UInt prevIndex;
 	while(index != prevOpt[index]) {
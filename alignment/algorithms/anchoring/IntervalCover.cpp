@@ -0,0 +1,34 @@
+#include "algorithms/anchoring/IntervalCover.hpp"
+
+bool IntervalCover::CoversStart(DNALength pos) {
+    std::map<DNALength, DNALength>::iterator it = intervals.upper_bound(pos);
+    if (it == intervals.begin()) {
+        return false;
+    }
+    --it;
+    return pos < it->second;
+}
+
+bool IntervalCover::CoversEnd(DNALength pos) {
+    std::map<DNALength, DNALength>::iterator it = intervals.lower_bound(pos);
+    if (it == intervals.begin()) {
+        return false;
+    }
+    --it;
+    return pos <= it->second;
+}
+
+void IntervalCover::Add(DNALength start, DNALength end) {
+    if (end <= start) {
+        return;
+    }
+    //
+    // Intervals that start inside the new one are inside it.
+    //
+    intervals.erase(intervals.lower_bound(start), intervals.lower_bound(end));
+    intervals[start] = end;
+}
+
+void IntervalCover::Clear() {
+    intervals.clear();
+}
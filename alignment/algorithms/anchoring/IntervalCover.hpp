@@ -0,0 +1,41 @@
+#ifndef _BLASR_INTERVAL_COVER_HPP_
+#define _BLASR_INTERVAL_COVER_HPP_
+
+#include <map>
+#include "Types.h"
+
+//
+// A set of intervals [start, end) in which no interval has an end point
+// inside another: two intervals are either disjoint or one contains
+// the other.  Only the outermost intervals are stored, so a point is
+// looked up in O(log n).
+//
+class IntervalCover {
+public:
+    //
+    // Whether pos is in [start, end) of an interval.
+    //
+    bool CoversStart(DNALength pos);
+
+    //
+    // Whether pos is in (start, end] of an interval.
+    //
+    bool CoversEnd(DNALength pos);
+
+    //
+    // Add [start, end), for which neither CoversStart(start) nor
+    // CoversEnd(end) may hold.  Empty intervals cover nothing and are
+    // not kept.
+    //
+    void Add(DNALength start, DNALength end);
+
+    void Clear();
+
+private:
+    //
+    // The outermost intervals, which are disjoint, keyed by start.
+    //
+    std::map<DNALength, DNALength> intervals;
+};
+
+#endif // _BLASR_INTERVAL_COVER_HPP_
@@ -5,6 +5,7 @@
 #include "datastructures/anchoring/MatchPos.hpp"
 #include "tuples/TupleCountTable.hpp"
 #include "algorithms/anchoring/ScoreAnchors.hpp"
+#include "algorithms/anchoring/IntervalCover.hpp"
 
 template<typename T_MatchPos>
 void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis, 
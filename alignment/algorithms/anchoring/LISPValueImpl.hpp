@@ -28,31 +28,27 @@ void StoreNonOverlappingIndices(std::vector<T_MatchPos> &lis,
 	if (lis.size() == 1) return;
 
 	//
-	// Next, add matches as long as they do not overlap.
+	// Next, add matches as long as they do not overlap: neither end of a
+	// match may fall within an added match, in either t or q.  Added
+	// matches then either are disjoint or nest in each of t and q, so
+	// each end is looked up among the outermost added matches.
+	//
+	IntervalCover tCover, qCover;
+	tCover.Add(lis[0].t, lis[0].t + lis[0].GetLength());
+	qCover.Add(lis[0].q, lis[0].q + lis[0].GetLength());
 	for (i = 1; i < lis.size(); i++ ){
-		VectorIndex j;
-		int lts = lis[i].t;
-		int lte = lis[i].t + lis[i].GetLength();
-		int lqs = lis[i].q;
-		int lqe = lis[i].q + lis[i].GetLength();
+		DNALength lts = lis[i].t;
+		DNALength lte = lis[i].t + lis[i].GetLength();
+		DNALength lqs = lis[i].q;
+		DNALength lqe = lis[i].q + lis[i].GetLength();
 
-		int ovpFound = 0;
-		for (j =0; j < noOvpLis.size(); j++ ){
-			int tIntvStart = noOvpLis[j].t;
-			int tIntvEnd   = noOvpLis[j].t + noOvpLis[j].GetLength();
-			int qIntvStart = noOvpLis[j].q;
-			int qIntvEnd   = noOvpLis[j].q + noOvpLis[j].GetLength();
-			if ((lts >= tIntvStart and lts < tIntvEnd) or 
-					(lte >  tIntvStart and lte <= tIntvEnd) or
-					(lqs >= qIntvStart and lqs < qIntvEnd) or
-					(lqe >  qIntvStart and lqe <= qIntvEnd)) {
-				ovpFound = 1;
-				break;
-			}
-		}
-		if (!ovpFound) {
-			noOvpLis.push_back(lis[i]);
+		if (tCover.CoversStart(lts) or tCover.CoversEnd(lte) or
+		    qCover.CoversStart(lqs) or qCover.CoversEnd(lqe)) {
+			continue;
 		}
+		noOvpLis.push_back(lis[i]);
+		tCover.Add(lts, lte);
+		qCover.Add(lqs, lqe);
 	}
 	
 	//
@@ -8,6 +8,12 @@
 #include "algorithms/alignment/SWAlign.hpp"
 #include "algorithms/alignment/ScoreMatrices.hpp"
 
+//
+// The number of read positions whose suffix array searches are run
+// together by LocateAnchorBoundsInSuffixArray.
+//
+static const DNALength MapBySuffixArraySearchBlockSize = 256;
+
 /*
  * Parameters:
  * Eventually this should be strongly typed, since this is specific to
@@ -21,13 +27,16 @@
  *              match for the read at pos p.
  *   matchHigh -The same array but for the upper bound.
  *   saMatchLength - The length of the lcp.
+ * The bounds are positions in the suffix array, so they have the
+ * suffix array's index type.
  */
 template<typename T_SuffixArray, 
          typename T_RefSequence, 
          typename T_Sequence>
 int LocateAnchorBoundsInSuffixArray(T_RefSequence &reference,
 	T_SuffixArray &sa, T_Sequence &read, unsigned int minPrefixMatchLength,
-	std::vector<DNALength> &matchLow, std::vector<DNALength> &matchHigh,
+	std::vector<typename T_SuffixArray::IndexType> &matchLow, 
+	std::vector<typename T_SuffixArray::IndexType> &matchHigh,
 	std::vector<DNALength> &matchLength, AnchorParameters &params);
 
 template<typename T_SuffixArray, 
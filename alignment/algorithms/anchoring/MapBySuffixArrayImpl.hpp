@@ -22,7 +22,8 @@ template<typename T_SuffixArray,
          typename T_Sequence>
 int LocateAnchorBoundsInSuffixArray(T_RefSequence &reference,
 	T_SuffixArray &sa, T_Sequence &read, unsigned int minPrefixMatchLength,
-	std::vector<DNALength> &matchLow, std::vector<DNALength> &matchHigh,
+	std::vector<typename T_SuffixArray::IndexType> &matchLow, 
+	std::vector<typename T_SuffixArray::IndexType> &matchHigh,
 	std::vector<DNALength> &matchLength, AnchorParameters &params) {
 
     //
@@ -47,23 +48,47 @@ int LocateAnchorBoundsInSuffixArray(T_RefSequence &reference,
     std::fill(matchLength.begin(), matchLength.end(), 0);
     std::fill(matchLow.begin(), matchLow.end(), 0);
     std::fill(matchHigh.begin(), matchHigh.end(), 0);
-    vector<SAIndex> lowMatchBound, highMatchBound;	
+    //
+    // The positions of the read are searched in blocks with
+    // BatchStoreLCPBounds so that the suffix array lookups of different
+    // positions overlap.  When exact matches are advanced over, the next
+    // position searched depends on the result of the previous one, so
+    // each block is a single position.
+    //
+    DNALength searchBlockSize = params.advanceExactMatches ? 1 : 
+        MapBySuffixArraySearchBlockSize;
+    std::vector<typename T_SuffixArray::CharType*> blockQueries;
+    std::vector<DNALength> blockQueryLengths, blockLCPLengths;
+    std::vector<std::vector<typename T_SuffixArray::IndexType> > blockLowBounds, blockHighBounds;
+    DNALength blockStart = read.subreadStart, blockEnd = read.subreadStart;
 
     for (m = 0, p = read.subreadStart; p < matchEnd; p++, m++) {
-        DNALength lcpLow, lcpHigh, lcpLength;
-        lowMatchBound.clear(); highMatchBound.clear();
-        lcpLow = 0;
-        lcpHigh = 0;
-        lcpLength = sa.StoreLCPBounds(reference.seq, reference.length, 
-            &read.seq[p], matchEnd - p,
-            params.useLookupTable,
-            params.maxLCPLength,
-            //
-            // Store the positions in the SA
-            // that are searched.
-            //
-            lowMatchBound, highMatchBound, 
-            params.stopMappingOnceUnique);
+        if (p >= blockEnd) {
+            blockStart = p;
+            blockEnd = MIN(p + searchBlockSize, matchEnd);
+            blockQueries.clear();
+            blockQueryLengths.clear();
+            DNALength q;
+            for (q = blockStart; q < blockEnd; q++) {
+                blockQueries.push_back(&read.seq[q]);
+                blockQueryLengths.push_back(matchEnd - q);
+            }
+            sa.BatchStoreLCPBounds(reference.seq, reference.length,
+                blockQueries, blockQueryLengths,
+                params.useLookupTable,
+                params.maxLCPLength,
+                //
+                // Store the positions in the SA
+                // that are searched.
+                //
+                blockLowBounds, blockHighBounds, blockLCPLengths,
+                params.stopMappingOnceUnique);
+        }
+        std::vector<typename T_SuffixArray::IndexType> &lowMatchBound = 
+            blockLowBounds[p - blockStart];
+        std::vector<typename T_SuffixArray::IndexType> &highMatchBound = 
+            blockHighBounds[p - blockStart];
+        DNALength lcpLength = blockLCPLengths[p - blockStart];
 
         //
         // Possibly print the lcp bounds for debugging
@@ -219,7 +244,8 @@ int MapReadToGenome(T_RefSequence &reference,
     vector<T_MatchPos> &matchPosList,
     AnchorParameters &anchorParameters) {
 
-    vector<DNALength> matchLow, matchHigh, matchLength;
+    vector<typename T_SuffixArray::IndexType> matchLow, matchHigh;
+    vector<DNALength> matchLength;
 
     int minMatchLen = anchorParameters.minMatchLength;
     if (read.subreadEnd - read.subreadStart < minMatchLen) {
@@ -281,7 +307,7 @@ int MapReadToGenome(T_RefSequence &reference,
         assert(matchIndex < matchHigh.size());
         if (matchHigh[matchIndex] - matchLow[matchIndex] <= 
             anchorParameters.maxAnchorsPerPosition) {
-            DNALength mp;
+            typename T_SuffixArray::IndexType mp;
             for (mp = matchLow[matchIndex]; mp < matchHigh[matchIndex]; mp++) {
                 if (matchLength[matchIndex] < minMatchLen) {
                     continue;
@@ -0,0 +1,34 @@
+#include "algorithms/anchoring/PrefixMaxTree.hpp"
+
+//
+// A score of 0 marks a node that holds no score.
+//
+void PrefixMaxTree::Initialize(UInt size) {
+    scores.assign(size + 1, 0);
+    indices.assign(size + 1, 0);
+}
+
+void PrefixMaxTree::Update(UInt pos, UInt score, UInt index) {
+    UInt node;
+    for (node = pos + 1; node < scores.size(); node += node & (~node + 1)) {
+        if (scores[node] < score or
+            (scores[node] == score and index < indices[node])) {
+            scores[node]  = score;
+            indices[node] = index;
+        }
+    }
+}
+
+bool PrefixMaxTree::FindMax(UInt end, UInt &score, UInt &index) {
+    score = 0;
+    index = 0;
+    UInt node;
+    for (node = end; node > 0; node -= node & (~node + 1)) {
+        if (scores[node] > score or
+            (scores[node] == score and scores[node] > 0 and indices[node] < index)) {
+            score = scores[node];
+            index = indices[node];
+        }
+    }
+    return score > 0;
+}
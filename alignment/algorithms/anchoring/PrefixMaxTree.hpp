@@ -0,0 +1,31 @@
+#ifndef _BLASR_PREFIX_MAX_TREE_HPP_
+#define _BLASR_PREFIX_MAX_TREE_HPP_
+
+#include <vector>
+#include "Types.h"
+
+//
+// A binary indexed (Fenwick) tree over positions [0, size) that holds a
+// score and an index at each position, and finds the best score over
+// any prefix of positions in O(log size).  A higher score is better,
+// and of equal scores the lower index is better.  Scores may only be
+// raised.
+//
+class PrefixMaxTree {
+public:
+    void Initialize(UInt size);
+
+    void Update(UInt pos, UInt score, UInt index);
+
+    //
+    // Find the best score and its index over positions [0, end).
+    // Return false when no score has been stored in them.
+    //
+    bool FindMax(UInt end, UInt &score, UInt &index);
+
+private:
+    std::vector<UInt> scores;
+    std::vector<UInt> indices;
+};
+
+#endif // _BLASR_PREFIX_MAX_TREE_HPP_
@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include "LightweightSuffixArray.hpp"
 
 UInt DiffMod(UInt a, UInt b, UInt d) {
@@ -241,7 +242,79 @@ int DiffCoverCompareSuffices::operator()(UInt a, UInt b) {
     return (lOrder[aDCIndex] < lOrder[bDCIndex]);
 }
 
-bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize) {
+class DiffCoverSortBucketsTask {
+public:
+    unsigned char *text;
+    UInt *index;
+    UInt begin, end;
+    int diffCoverSize;
+    DiffCoverCompareSuffices lOrderComparator;
+};
+
+void DiffCoverSortBuckets(unsigned char text[], UInt *index, UInt begin, UInt end,
+        int diffCoverSize, DiffCoverCompareSuffices &lOrderComparator) {
+    UInt setBegin, setEnd;
+    setBegin = begin;
+    while(setBegin < end) {
+        setEnd = setBegin;
+        while(setEnd < end and
+                NCompareSuffices(text, index[setBegin], index[setEnd], diffCoverSize) == 0) {
+            setEnd++;
+        }
+        std::sort(&index[setBegin], &index[setEnd], lOrderComparator);
+        setBegin = setEnd;
+    }
+}
+
+void *DiffCoverSortBucketsThread(void *data) {
+    DiffCoverSortBucketsTask *task = (DiffCoverSortBucketsTask*) data;
+    DiffCoverSortBuckets(task->text, task->index, task->begin, task->end,
+            task->diffCoverSize, task->lOrderComparator);
+    return NULL;
+}
+
+/*
+ * Split the v-ordered index into nProc ranges that do not divide a
+ * bucket of suffixes sharing a diffCoverSize prefix, and sort the
+ * buckets of each range on its own thread.
+ */
+void ParallelDiffCoverSortBuckets(unsigned char text[], UInt textLength, UInt *index,
+        int diffCoverSize, DiffCoverCompareSuffices &lOrderComparator, int nProc) {
+    std::vector<UInt> rangeStart(nProc + 1);
+    int t;
+    rangeStart[0] = 0;
+    rangeStart[nProc] = textLength;
+    for (t = 1; t < nProc; t++) {
+        UInt start = (UInt) (((unsigned long) textLength * t) / nProc);
+        if (start < rangeStart[t-1]) {
+            start = rangeStart[t-1];
+        }
+        while (start > 0 and start < textLength and 
+               NCompareSuffices(text, index[start-1], index[start], diffCoverSize) == 0) {
+            start++;
+        }
+        rangeStart[t] = start;
+    }
+    std::vector<DiffCoverSortBucketsTask> tasks(nProc);
+    std::vector<pthread_t> threads(nProc);
+    for (t = 0; t < nProc; t++) {
+        tasks[t].text  = text;
+        tasks[t].index = index;
+        tasks[t].begin = rangeStart[t];
+        tasks[t].end   = rangeStart[t+1];
+        tasks[t].diffCoverSize = diffCoverSize;
+        tasks[t].lOrderComparator = lOrderComparator;
+        if (pthread_create(&threads[t], NULL, DiffCoverSortBucketsThread, &tasks[t]) != 0) {
+            std::cout << "ERROR, could not start a suffix array sorting thread." << std::endl;
+            exit(1);
+        }
+    }
+    for (t = 0; t < nProc; t++) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize, int nProc) {
     //
     // index is an array of length textLength that contains all
     // suffices.
@@ -290,7 +363,7 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     }
     UInt dSetSize = dIndex;
     std::cerr << "Sorting " << diffCoverSize << "-prefixes of the genome." << std::endl;
-    MediankeyBoundedQuicksort(text, index, dIndex, 0, dSetSize, 0, diffCoverSize);
+    ParallelMediankeyBoundedQuicksort(text, index, dSetSize, textLength, diffCoverSize, nProc);
     UInt i;
 
     //
@@ -361,7 +434,7 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     for (i = 0; i < textLength; i++ ){
         index[i] = i;
     }
-    MediankeyBoundedQuicksort(text, index, textLength, 0, textLength, 0, diffCoverSize);
+    ParallelMediankeyBoundedQuicksort(text, index, textLength, textLength, diffCoverSize, nProc);
 
     // Step 2.2. For each group of suffixes that remains unsorted
     // (shares a prefix of length diffCoverSize, complete the sorting
@@ -375,24 +448,30 @@ bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, i
     lOrderComparator.diffCoverSize = diffCoverSize;
     lOrderComparator.diffCoverLength=diffCoverLength;
     lOrderComparator.diffCoverReverseLookup = mu.diffCoverReverseLookup;
-    UInt setBegin, setEnd;
-    setBegin = setEnd = 0;
-    std::cerr << "Sorting buckets." << std::endl;
-    int percentDone = 0;
-    int curPercentage = 0;
-    while(setBegin < textLength) {
-        setEnd = setBegin;
-        percentDone = (int)(((1.0*setBegin) / textLength) * 100);
-        if ( percentDone > curPercentage) {
-            std::cerr << " " << percentDone << "% of buckets sorted."  << std::endl;
-            curPercentage = percentDone;
-        }
-        while(setEnd < textLength and
-                NCompareSuffices(text, index[setBegin], index[setEnd], diffCoverSize) == 0) {
-            setEnd++;
+    if (nProc > 1) {
+        std::cerr << "Sorting buckets on " << nProc << " threads." << std::endl;
+        ParallelDiffCoverSortBuckets(text, textLength, index, diffCoverSize, lOrderComparator, nProc);
+    }
+    else {
+        UInt setBegin, setEnd;
+        setBegin = setEnd = 0;
+        std::cerr << "Sorting buckets." << std::endl;
+        int percentDone = 0;
+        int curPercentage = 0;
+        while(setBegin < textLength) {
+            setEnd = setBegin;
+            percentDone = (int)(((1.0*setBegin) / textLength) * 100);
+            if ( percentDone > curPercentage) {
+                std::cerr << " " << percentDone << "% of buckets sorted."  << std::endl;
+                curPercentage = percentDone;
+            }
+            while(setEnd < textLength and
+                    NCompareSuffices(text, index[setBegin], index[setEnd], diffCoverSize) == 0) {
+                setEnd++;
+            }
+            std::sort(&index[setBegin], &index[setEnd], lOrderComparator);
+            setBegin = setEnd;
         }
-        std::sort(&index[setBegin], &index[setEnd], lOrderComparator);
-        setBegin = setEnd;
     }
 
     // diffCover was allocated in DifferenceCovers.cpp -> 
@@ -2,6 +2,7 @@
 #define ALGORITHMS_SORTING_LIGHTWEIGHT_SUFFIX_ARRAY_H_
 
 #include <algorithm>
+#include <vector>
 #include "qsufsort.hpp"
 #include "MultikeyQuicksort.hpp"
 #include "DifferenceCovers.hpp"
@@ -98,6 +99,12 @@ public:
     int operator()(UInt a, UInt b); 
 };
 
-bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize); 
+/*
+ * Build the suffix array of text in index using a difference cover of
+ * size diffCoverSize.  When nProc > 1 the v-ordering and the sorting of
+ * buckets are run on nProc threads; the result is the same as the
+ * serial sort.
+ */
+bool LightweightSuffixSort(unsigned char text[], UInt textLength, UInt *index, int diffCoverSize, int nProc=1); 
 
 #endif
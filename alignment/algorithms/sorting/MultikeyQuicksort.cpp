@@ -1,4 +1,7 @@
 #include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <pthread.h>
 #include "MultikeyQuicksort.hpp"
 
 void UIntSwap(unsigned int &a, unsigned int &b) {
@@ -195,3 +198,177 @@ void MediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
 
     if (deleteFreq) {delete [] freq; freq = NULL;}
 }
+
+void MultikeyBucketKey::Initialize(unsigned char text[], UInt textLength, int bound, UInt maxBuckets) {
+    //
+    // The sort reads up to 'bound' characters past the end of the
+    // text, so those must be ranked as well.
+    //
+    bool present[256];
+    std::fill(present, present + 256, false);
+    UInt i;
+    for (i = 0; i < textLength + bound; i++) {
+        present[text[i]] = true;
+    }
+    sigma = 0;
+    maxChar = 0;
+    int c;
+    for (c = 0; c < 256; c++) {
+        charRank[c] = sigma;
+        if (present[c]) {
+            sigma++;
+            maxChar = c;
+        }
+    }
+    if (sigma == 0) {
+        sigma = 1;
+    }
+    keyLength = 1;
+    nBuckets  = sigma;
+    while (keyLength <= bound and nBuckets * sigma <= maxBuckets) {
+        nBuckets *= sigma;
+        keyLength++;
+    }
+}
+
+class MultikeyCountTask {
+public:
+    unsigned char *text;
+    UInt *index;
+    UInt begin, end;
+    MultikeyBucketKey *key;
+    std::vector<UInt> counts;
+};
+
+void *MultikeyCountBuckets(void *data) {
+    MultikeyCountTask *task = (MultikeyCountTask*) data;
+    task->counts.resize(task->key->nBuckets, 0);
+    UInt i;
+    for (i = task->begin; i < task->end; i++) {
+        task->counts[(*task->key)(task->text, task->index[i])]++;
+    }
+    return NULL;
+}
+
+class MultikeySortTask {
+public:
+    unsigned char *text;
+    UInt *index;
+    UInt length;
+    std::vector<UInt> *bucketStart;
+    UInt *nextBucket;
+    pthread_mutex_t *nextBucketLock;
+    int depth, bound;
+    UInt maxChar;
+};
+
+void *MultikeySortBuckets(void *data) {
+    MultikeySortTask *task = (MultikeySortTask*) data;
+    UInt nBuckets = task->bucketStart->size() - 1;
+    //
+    // The characters deeper in a bucket may be larger than those at
+    // its first position, so size the frequency table for the whole
+    // text.
+    //
+    std::vector<UInt> freq(task->maxChar + 1);
+    while (true) {
+        pthread_mutex_lock(task->nextBucketLock);
+        UInt b = *task->nextBucket;
+        (*task->nextBucket)++;
+        pthread_mutex_unlock(task->nextBucketLock);
+        if (b >= nBuckets) {
+            break;
+        }
+        MediankeyBoundedQuicksort(task->text, task->index, task->length,
+                (*task->bucketStart)[b], (*task->bucketStart)[b+1],
+                task->depth, task->bound, task->maxChar, &freq[0]);
+    }
+    return NULL;
+}
+
+void ParallelMediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
+        UInt textLength, int bound, int nProc) {
+    if (nProc <= 1 or length < (UInt) nProc) {
+        MediankeyBoundedQuicksort(text, index, length, 0, length, 0, bound);
+        return;
+    }
+    MultikeyBucketKey key;
+    key.Initialize(text, textLength, bound);
+
+    //
+    // Count the bucket sizes on all threads.
+    //
+    std::vector<MultikeyCountTask> countTasks(nProc);
+    std::vector<pthread_t> threads(nProc);
+    int t;
+    for (t = 0; t < nProc; t++) {
+        countTasks[t].text  = text;
+        countTasks[t].index = index;
+        countTasks[t].begin = (UInt) (((unsigned long) length * t) / nProc);
+        countTasks[t].end   = (UInt) (((unsigned long) length * (t+1)) / nProc);
+        countTasks[t].key   = &key;
+        if (pthread_create(&threads[t], NULL, MultikeyCountBuckets, &countTasks[t]) != 0) {
+            std::cout << "ERROR, could not start a suffix bucket counting thread." << std::endl;
+            exit(1);
+        }
+    }
+    for (t = 0; t < nProc; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    std::vector<UInt> bucketStart(key.nBuckets + 1, 0);
+    UInt b;
+    for (b = 0; b < key.nBuckets; b++) {
+        UInt bucketSize = 0;
+        for (t = 0; t < nProc; t++) {
+            bucketSize += countTasks[t].counts[b];
+        }
+        bucketStart[b+1] = bucketStart[b] + bucketSize;
+    }
+    countTasks.clear();
+
+    //
+    // Permute the index into buckets in place (American flag sort).
+    //
+    std::vector<UInt> next(bucketStart.begin(), bucketStart.end() - 1);
+    for (b = 0; b < key.nBuckets; b++) {
+        while (next[b] < bucketStart[b+1]) {
+            UInt v  = index[next[b]];
+            UInt vb = key(text, v);
+            while (vb != b) {
+                UIntSwap(v, index[next[vb]]);
+                next[vb]++;
+                vb = key(text, v);
+            }
+            index[next[b]] = v;
+            next[b]++;
+        }
+    }
+
+    //
+    // Every suffix in a bucket shares the first key.keyLength
+    // characters, so each bucket is sorted from that depth.
+    //
+    pthread_mutex_t nextBucketLock;
+    pthread_mutex_init(&nextBucketLock, NULL);
+    UInt nextBucket = 0;
+    std::vector<MultikeySortTask> sortTasks(nProc);
+    for (t = 0; t < nProc; t++) {
+        sortTasks[t].text  = text;
+        sortTasks[t].index = index;
+        sortTasks[t].length = length;
+        sortTasks[t].bucketStart = &bucketStart;
+        sortTasks[t].nextBucket = &nextBucket;
+        sortTasks[t].nextBucketLock = &nextBucketLock;
+        sortTasks[t].depth = key.keyLength;
+        sortTasks[t].bound = bound;
+        sortTasks[t].maxChar = key.maxChar;
+        if (pthread_create(&threads[t], NULL, MultikeySortBuckets, &sortTasks[t]) != 0) {
+            std::cout << "ERROR, could not start a suffix bucket sorting thread." << std::endl;
+            exit(1);
+        }
+    }
+    for (t = 0; t < nProc; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    pthread_mutex_destroy(&nextBucketLock);
+}
@@ -45,4 +45,41 @@ void TransformBackSequence(Nucleotide text[], UInt textLength);
 void MediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
         UInt low, UInt high, int depth, int bound, UInt maxChar= 0, UInt *freq=NULL); 
 
+/*
+ * Maps the first keyLength characters of a suffix to a bucket number
+ * that preserves their lexicographic order.  Only characters present
+ * in the text are given a rank, so that more characters fit into a
+ * bucket number for small alphabets.
+ */
+class MultikeyBucketKey {
+public:
+    UInt charRank[256];
+    UInt sigma;
+    UInt maxChar;
+    int  keyLength;
+    UInt nBuckets;
+
+    void Initialize(unsigned char text[], UInt textLength, int bound, UInt maxBuckets=65536);
+
+    UInt operator()(unsigned char text[], UInt pos) {
+        UInt key = 0;
+        int k;
+        for (k = 0; k < keyLength; k++) {
+            key = key * sigma + charRank[text[pos + k]];
+        }
+        return key;
+    }
+};
+
+/*
+ * Sort index[0 ... length) to depth 'bound' like
+ * MediankeyBoundedQuicksort, using nProc threads.  The suffixes are
+ * first distributed in place into buckets by their first
+ * characters, and the buckets are then sorted concurrently.  As with
+ * the serial sort, suffixes that share a prefix of length 'bound' are
+ * left in no particular order.  text is read up to textLength + bound.
+ */
+void ParallelMediankeyBoundedQuicksort(unsigned char text[], UInt index[], UInt length,
+        UInt textLength, int bound, int nProc);
+
 #endif // _BLASR_MULTIKEY_QUICKSORT_HPP_
@@ -56,7 +56,7 @@ public:
 
     void update_group(T_Index *pl, T_Index *pm)
     {
-        int g;
+        T_Index g;
 
         g=pm-I;                      /* group number.*/
         V[*pl]=g;                    /* update group number of first position.*/
@@ -273,7 +273,7 @@ set to the number of old symbols grouped into one. Only x[n] is 0.*/
             b=b<<s|(x[r]-l+1);        /* b is start of x in chunk alphabet.*/
             d=c;                      /* d is max symbol in chunk alphabet.*/
         }
-        m=(1<<(r-1)*s)-1;            /* m masks off top old symbol from chunk.*/
+        m=(((T_Index) 1)<<(r-1)*s)-1;            /* m masks off top old symbol from chunk.*/
         x[n]=l-1;                    /* emulate zero terminator.*/
         if (d<=n) {                  /* if bucketing possible, compact alphabet.*/
             for (pi=p; pi<=p+d; ++pi)
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <fstream>
 #include "Occ.hpp"
+#include "PackedOcc.hpp"
 #include "Pos.hpp"
 #include "suffixarray/SuffixArray.hpp"
 #include "PackedDNASequence.hpp"
@@ -39,11 +40,22 @@ public:
 	}
 };
 
+/*
+ * The occurrence bins of an index file, computed from the BWT held in
+ * a PackedOcc when the file is written.
+ */
+typedef Occ <PackedOcc, unsigned int, unsigned short> PackedGbOcc;
+
 template<typename T_BWT_Sequence, typename T_DNASequence>
 class Bwt {
  public:
+	//
+	// Once occ is built, it holds the only copy of the BWT, and
+	// bwtSequence only records its length.  The index file keeps the
+	// format of the GbOcc tables.
+	//
 	T_BWT_Sequence bwtSequence;
-	GbOcc occ;
+	PackedOcc occ;
 	Pos<T_BWT_Sequence>   pos;
 	static const int CharCountSize = 7;
 	int useDebugData;
@@ -61,28 +73,33 @@ class Bwt {
 	void PrintBWTString(std::ostream &out) {
 		DNALength p;
 		for (p = 0; p < bwtSequence.length; p++) {
-			out << (char) ThreeBitToAscii[bwtSequence[p]];
+			out << (char) ThreeBitToAscii[occ[p]];
 			if (p % 50 == 49) out << std::endl;
 		}
 		if(p % 50 != 0) out << std::endl;
 	}
 
 	void Write(std::ostream &bwtOut) {
-		bwtSequence.Write(bwtOut);
+		occ.WriteSequence(bwtOut);
 		bwtOut.write((char*)charCount, sizeof(DNALength)*CharCountSize);
 		bwtOut.write((char*)&firstCharPos, sizeof(DNALength));
 		bwtOut.write((char*)&useDebugData, sizeof(useDebugData));
 		if (useDebugData) {
 			bwtOut.write((char*)&saCopy[0], (bwtSequence.length-1) * sizeof(DNALength));
 		}
-		occ.Write(bwtOut);
+		PackedGbOcc binnedOcc;
+		binnedOcc.Initialize(occ, 4096, 64, useDebugData);
+		binnedOcc.Write(bwtOut);
 		pos.Write(bwtOut);
 	}
 
 	int Read(std::string inName) {
 		std::ifstream bwtIn;
-		DNALength seqStorageSize;
 		CrucialOpen(inName, bwtIn, std::ios::binary|std::ios::in);
+		return Read(bwtIn);
+	}
+
+	int Read(std::istream &bwtIn) {
 		bwtSequence.Read(bwtIn);
 		bwtIn.read((char*)charCount, sizeof(DNALength)*CharCountSize);
 		bwtIn.read((char*)&firstCharPos, sizeof(DNALength));
@@ -91,18 +108,33 @@ class Bwt {
 			saCopy.resize(bwtSequence.length-1);
 			bwtIn.read((char*)&saCopy[0], (bwtSequence.length-1) * sizeof(DNALength));
 		}
-		occ.Read(bwtIn, useDebugData);
+		//
+		// The binned tables are only read to get past them.
+		//
+		{
+			GbOcc binnedOcc;
+			binnedOcc.Read(bwtIn, useDebugData);
+		}
 		pos.Read(bwtIn);
-		occ.InitializeBWT(bwtSequence);
+		InitializeOcc();
 		return 1;
 	}
 
+	void InitializeOcc() {
+		occ.Initialize(bwtSequence);
+		if (bwtSequence.seq) {
+			delete [] bwtSequence.seq;
+			bwtSequence.seq = NULL;
+		}
+		bwtSequence.arrayLength = 0;
+	}
+
 	void Print(std::ofstream &out) {
 		bwtSequence.Print(out);
 	}
 
 	DNALength LFBacktrack(DNALength bwtPos) {
-		Nucleotide curNuc = bwtSequence.Get(bwtPos);
+		Nucleotide curNuc = occ.Get(bwtPos);
 		assert(curNuc < 5);
 		DNALength bwtPrevPos = charCount[curNuc] + occ.Count(curNuc, bwtPos) - 1;
 		return bwtPrevPos;
@@ -136,20 +168,114 @@ class Bwt {
 		return seqPos + offset;
 	}
 	
+	//
+	// Locate the rows sp .. ep together.  The rows of an interval that
+	// are preceded by the same character map by LF to one interval, so
+	// a step takes one rank of the interval start and a scan of its
+	// rows rather than a rank per row.  On a repetitive genome, the hits
+	// of copies that share their preceding sequence stay in one interval
+	// until they reach a sample.  Positions are added in row order.
+	//
 	DNALength Locate(DNALength sp, DNALength ep, std::vector<DNALength> &positions, 
         int maxCount = 0) {
-		DNALength bwtPos;
-		DNALength seqPos;
-		if (sp <= ep and (maxCount == 0 or ep - sp < maxCount)) {
-			for (bwtPos = sp; bwtPos <= ep; bwtPos++) {
-				if ((seqPos = Locate(bwtPos))) {
-					positions.push_back(seqPos);
-				}
+		if (sp > ep or (maxCount != 0 and ep - sp >= (DNALength) maxCount)) {
+			return ep - sp + 1;
+		}
+		//
+		// Interval i starts at row starts[i], and its rows hold the hits
+		// hits[ends[i-1] .. ends[i]), indices into seqPos.
+		//
+		std::vector<DNALength> seqPos(ep - sp + 1, 0);
+		std::vector<DNALength> starts(1, sp), ends(1, ep - sp + 1), hits(ep - sp + 1);
+		std::vector<DNALength> nextStarts, nextEnds, nextHits;
+		std::vector<DNALength> nucHits[5];
+		DNALength h, i, offset;
+		for (h = 0; h < hits.size(); h++) {
+			hits[h] = h;
+		}
+		for (offset = 0; starts.size() > 0; offset++) {
+			nextStarts.clear();
+			nextEnds.clear();
+			nextHits.clear();
+			DNALength begin = 0;
+			for (i = 0; i < starts.size(); i++) {
+				LocateStep(starts[i], &hits[begin], ends[i] - begin, offset, seqPos, nucHits,
+				           nextStarts, nextEnds, nextHits);
+				begin = ends[i];
+			}
+			starts.swap(nextStarts);
+			ends.swap(nextEnds);
+			hits.swap(nextHits);
+		}
+		for (h = 0; h < seqPos.size(); h++) {
+			if (seqPos[h]) {
+				positions.push_back(seqPos[h]);
 			}
 		}
 		return ep - sp + 1;
 	}
 
+	//
+	// Resolve the hits of one interval that are at a sample, and map the
+	// rest to the intervals of the next step, one per preceding
+	// character.  Rows that are resolved are kept inside an interval
+	// when unresolved rows surround them.
+	//
+	void LocateStep(DNALength start, const DNALength *hits, DNALength nHits, DNALength offset,
+	                std::vector<DNALength> &seqPos, std::vector<DNALength> nucHits[5],
+	                std::vector<DNALength> &nextStarts, std::vector<DNALength> &nextEnds,
+	                std::vector<DNALength> &nextHits) {
+		const DNALength resolved = (DNALength) -1;
+		DNALength before[5] = {0, 0, 0, 0, 0};
+		if (start > 0) {
+			occ.CountNucleotides(start - 1, before);
+			before[4] = start - before[0] - before[1] - before[2] - before[3] -
+				(occ.dollarPos < start ? 1 : 0);
+		}
+		Nucleotide n;
+		for (n = 0; n < 5; n++) {
+			nucHits[n].clear();
+		}
+		DNALength h, samplePos;
+		for (h = 0; h < nHits; h++) {
+			DNALength row = start + h;
+			DNALength hit = hits[h];
+			Nucleotide nuc = occ.Get(row);
+			if (hit != resolved) {
+				if (pos.Lookup(row, samplePos)) {
+					seqPos[hit] = samplePos + offset;
+					hit = resolved;
+				}
+				else if (nuc == PackedOcc::Dollar) {
+					//
+					// The suffix of this row is the whole text.
+					//
+					seqPos[hit] = offset;
+					hit = resolved;
+				}
+			}
+			if (nuc < 5) {
+				nucHits[nuc].push_back(hit);
+			}
+		}
+		for (n = 0; n < 5; n++) {
+			std::vector<DNALength> &rowHits = nucHits[n];
+			DNALength first = 0, last = rowHits.size();
+			while (first < last and rowHits[first] == resolved) {
+				first++;
+			}
+			while (last > first and rowHits[last - 1] == resolved) {
+				last--;
+			}
+			if (first == last) {
+				continue;
+			}
+			nextStarts.push_back(charCount[n] + before[n] + first);
+			nextHits.insert(nextHits.end(), rowHits.begin() + first, rowHits.begin() + last);
+			nextEnds.push_back(nextHits.size());
+		}
+	}
+
 	DNALength Locate(T_DNASequence &seq, std::vector<DNALength> &positions, 
         int maxCount =0) {
 		DNALength ep, sp;
@@ -299,14 +425,17 @@ class Bwt {
 		}
 	}										
 
-	void InitializeFromSuffixArray(T_DNASequence &dnaSeq, DNALength saIndex[], int buildDebug=0) {
+	//
+	// One suffix array position in sampleStride is kept for Locate.
+	//
+	void InitializeFromSuffixArray(T_DNASequence &dnaSeq, DNALength saIndex[], int buildDebug=0,
+	                               DNALength sampleStride=Pos<T_BWT_Sequence>::DefaultStride) {
 		useDebugData = buildDebug;
 		InitializeBWTStringFromSuffixArray(dnaSeq, saIndex);
 		InitializeDNACharacterCount();
 
-		// sequence, major, minor bin sizes.
-		occ.Initialize(bwtSequence, 4096, 64, buildDebug);
-		pos.InitializeFromSuffixArray(saIndex, dnaSeq.length);
+		InitializeOcc();
+		pos.InitializeFromSuffixArray(saIndex, dnaSeq.length, sampleStride);
 	}
 };
 
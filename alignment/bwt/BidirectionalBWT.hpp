@@ -0,0 +1,150 @@
+#ifndef _BLASR_BIDIRECTIONAL_BWT_HPP_
+#define _BLASR_BIDIRECTIONAL_BWT_HPP_
+
+#include <fstream>
+#include <vector>
+#include "BWT.hpp"
+
+/*
+ * The rows that match a string P in both halves of a bidirectional
+ * index: [forwardStart, forwardStart+size) in the BWT of the text, and
+ * [reverseStart, reverseStart+size) in the BWT of the reversed text,
+ * whose rows match P reversed.  When P is part of a query, it is
+ * query[qStart, qEnd).
+ */
+class BiInterval {
+public:
+    DNALength forwardStart, reverseStart, size;
+    DNALength qStart, qEnd;
+
+    BiInterval() {
+        forwardStart = reverseStart = size = 0;
+        qStart = qEnd = 0;
+    }
+
+    DNALength Length() {
+        return qEnd - qStart;
+    }
+};
+
+/*
+ * A bidirectional FM-index: the BWT of the text and the BWT of the
+ * reversed text, kept in step so that a match may be extended on
+ * either side (Lam et al., "High throughput short read alignment via
+ * bi-directional BWT", 2009).  Extending on one side is a backward
+ * search step in one BWT.  The interval in the other BWT moves past
+ * the rows whose next character is smaller than the new one, which are
+ * counted in the same step.
+ */
+template<typename T_BWT_Sequence, typename T_DNASequence>
+class BidirectionalBwt {
+public:
+    Bwt<T_BWT_Sequence, T_DNASequence> forward;
+    Bwt<T_BWT_Sequence, T_DNASequence> reverse;
+
+    //
+    // reverseSeq is seq reversed (not complemented), and reverseSA its
+    // suffix array.
+    //
+    void InitializeFromSuffixArrays(T_DNASequence &seq, DNALength forwardSA[],
+                                    T_DNASequence &reverseSeq, DNALength reverseSA[],
+                                    int buildDebug=0,
+                                    DNALength sampleStride=Pos<T_BWT_Sequence>::DefaultStride) {
+        forward.InitializeFromSuffixArray(seq, forwardSA, buildDebug, sampleStride);
+        reverse.InitializeFromSuffixArray(reverseSeq, reverseSA, buildDebug, sampleStride);
+    }
+
+    void Write(std::string outName) {
+        std::ofstream out;
+        CrucialOpen(outName, out, std::ios::binary|std::ios::out);
+        Write(out);
+    }
+
+    void Write(std::ostream &out) {
+        forward.Write(out);
+        reverse.Write(out);
+    }
+
+    int Read(std::string inName) {
+        std::ifstream in;
+        CrucialOpen(inName, in, std::ios::binary|std::ios::in);
+        return Read(in);
+    }
+
+    int Read(std::istream &in) {
+        forward.Read(in);
+        return reverse.Read(in);
+    }
+
+    //
+    // Set interval to the rows of the single nucleotide tbn, which is
+    // in three-bit form.  Returns false if it does not occur.
+    //
+    bool SetInterval(Nucleotide tbn, BiInterval &interval) {
+        interval.forwardStart = forward.charCount[tbn];
+        interval.reverseStart = reverse.charCount[tbn];
+        interval.size = forward.charCount[tbn + 1] - forward.charCount[tbn];
+        return interval.size > 0;
+    }
+
+    //
+    // Extend the match of interval to tbn + P.  tbn must be one of A,
+    // C, G, or T.  Returns false if the longer match does not occur.
+    //
+    bool ExtendBackward(BiInterval &interval, Nucleotide tbn, BiInterval &extended) {
+        Extend(forward, interval.forwardStart, interval.size, interval.reverseStart, tbn,
+               extended.forwardStart, extended.size, extended.reverseStart);
+        return extended.size > 0;
+    }
+
+    //
+    // Extend the match of interval to P + tbn.
+    //
+    bool ExtendForward(BiInterval &interval, Nucleotide tbn, BiInterval &extended) {
+        Extend(reverse, interval.reverseStart, interval.size, interval.forwardStart, tbn,
+               extended.reverseStart, extended.size, extended.forwardStart);
+        return extended.size > 0;
+    }
+
+    static void Extend(Bwt<T_BWT_Sequence, T_DNASequence> &index,
+                       DNALength start, DNALength size, DNALength otherStart,
+                       Nucleotide tbn, DNALength &newStart, DNALength &newSize,
+                       DNALength &newOtherStart) {
+        assert(tbn < PackedOcc::CountsPerBlock);
+        DNALength before[PackedOcc::CountsPerBlock] = {0, 0, 0, 0};
+        DNALength through[PackedOcc::CountsPerBlock];
+        if (start > 0) {
+            index.occ.CountNucleotides(start - 1, before);
+        }
+        index.occ.CountNucleotides(start + size - 1, through);
+        newStart = index.charCount[tbn] + before[tbn];
+        newSize  = through[tbn] - before[tbn];
+        //
+        // In the other BWT, the rows of P followed by '$' come first,
+        // then those followed by A, C, and so on.
+        //
+        newOtherStart = otherStart;
+        if (index.occ.dollarPos >= start and index.occ.dollarPos < start + size) {
+            newOtherStart++;
+        }
+        Nucleotide n;
+        for (n = 0; n < tbn; n++) {
+            newOtherStart += through[n] - before[n];
+        }
+    }
+
+    //
+    // Add the text positions where the match of interval starts.
+    //
+    DNALength Locate(BiInterval &interval, std::vector<DNALength> &positions) {
+        if (interval.size == 0) {
+            return 0;
+        }
+        return forward.Locate(interval.forwardStart,
+                              interval.forwardStart + interval.size - 1, positions);
+    }
+};
+
+typedef BidirectionalBwt<PackedDNASequence, FASTASequence> BidirectionalBWT;
+
+#endif // _BLASR_BIDIRECTIONAL_BWT_HPP_
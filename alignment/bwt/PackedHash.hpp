@@ -330,6 +330,13 @@ public:
     void Read(std::istream &in) {
         Free();
         in.read((char*)&tableLength, sizeof(tableLength));
+        ReadTables(in);
+    }
+
+    //
+    // Read the tables that follow tableLength, which is already set.
+    //
+    void ReadTables(std::istream &in) {
         if (tableLength > 0) {
             table  = new uint32_t[tableLength];
             values = new uint64_t[tableLength];
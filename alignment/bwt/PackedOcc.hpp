@@ -0,0 +1,256 @@
+#ifndef _BLASR_PACKED_OCC_HPP_
+#define _BLASR_PACKED_OCC_HPP_
+
+#include <stdlib.h>
+#include <algorithm>
+#include <fstream>
+#include "DNASequence.hpp"
+#include "NucConversion.hpp"
+#include "PackedDNASequence.hpp"
+#include "utils.hpp"
+
+/*
+ * An occurrence table that interleaves the counts with the packed BWT
+ * so that Count() touches a single cache line.  Each block is one
+ * 64-byte line holding the number of A, C, G, and T before the block,
+ * followed by 12 PackedDNASequence words (120 nucleotides, 3 bits
+ * each).  The count of N before a block is what remains after A, C, G,
+ * T, and the '$' are taken out of the block start.  Counts inside a
+ * block add up the match words of PackedDNASequence::MatchThreeBitInWord
+ * four at a time and count their bits with one multiply, so no
+ * popcount instruction is needed.  The words are stored in the same
+ * order as in PackedDNASequence, so the table may replace the BWT
+ * sequence.
+ */
+class PackedOcc {
+public:
+    static const DNALength CountsPerBlock = 4;
+    static const DNALength WordsPerBlock  = 12;
+    static const DNALength BlockSize      = CountsPerBlock + WordsPerBlock;
+    static const DNALength NucsPerBlock   = WordsPerBlock * PackedDNASequence::NucsPerWord;
+    static const Nucleotide Dollar        = 5;
+    PackedDNAWord *blocks;
+    DNALength nBlocks;
+    DNALength length;
+    DNALength dollarPos;
+
+    //
+    // Match words have at most one bit per 3-bit position, so four of
+    // them add up to fields of at most 4.  Pair the fields into 6-bit
+    // fields, then sum those into the top field with a multiply; no
+    // partial sum reaches 64.
+    //
+    static inline DNALength CountMatchesInSum(PackedDNAWord matchSum) {
+        const PackedDNAWord evenFields = 0x071C71C7; // octal 0707070707
+        PackedDNAWord pairs = (matchSum & evenFields) + ((matchSum >> 3) & evenFields);
+        return ((pairs * 0x01041041) >> 24) & 0x3F;
+    }
+
+    PackedOcc() {
+        blocks  = NULL;
+        nBlocks = length = dollarPos = 0;
+    }
+
+    ~PackedOcc() {
+        Free();
+    }
+
+    void Free() {
+        if (blocks) {
+            free(blocks);
+        }
+        blocks  = NULL;
+        nBlocks = length = dollarPos = 0;
+    }
+
+    unsigned long ByteSize() {
+        return ((unsigned long) nBlocks) * BlockSize * sizeof(PackedDNAWord);
+    }
+
+    void Initialize(PackedDNASequence &bwtSeq) {
+        Free();
+        length  = bwtSeq.length;
+        nBlocks = CeilOfFraction(length, NucsPerBlock);
+        if (nBlocks == 0) {
+            nBlocks = 1;
+        }
+        void *storage;
+        if (posix_memalign(&storage, BlockSize * sizeof(PackedDNAWord),
+                           nBlocks * BlockSize * sizeof(PackedDNAWord)) != 0) {
+            std::cout << "ERROR, could not allocate the occurrence table." << std::endl;
+            exit(1);
+        }
+        blocks = (PackedDNAWord*) storage;
+        std::fill(blocks, blocks + nBlocks * BlockSize, 0);
+
+        //
+        // Copy the words in, counting the nucleotides of each block as
+        // the running total for the next one.  All words before the
+        // last block are whole.
+        //
+        dollarPos = length;
+        DNALength runningTotal[CountsPerBlock] = {0, 0, 0, 0};
+        DNALength b, w, n;
+        for (b = 0; b < nBlocks; b++) {
+            PackedDNAWord *block = &blocks[b * BlockSize];
+            std::copy(runningTotal, runningTotal + CountsPerBlock, block);
+            for (w = 0; w < WordsPerBlock and b * WordsPerBlock + w < bwtSeq.arrayLength; w++) {
+                PackedDNAWord word = bwtSeq.seq[b * WordsPerBlock + w];
+                block[CountsPerBlock + w] = word;
+                for (n = 0; n < CountsPerBlock; n++) {
+                    runningTotal[n] += CountMatchesInSum(PackedDNASequence::MatchThreeBitInWord(word,
+                        PackedDNASequence::MaskLR[PackedDNASequence::NucsPerWord - 1], n));
+                }
+            }
+        }
+        DNALength p;
+        for (p = 0; p < length; p++) {
+            if (Get(p) == Dollar) {
+                dollarPos = p;
+                break;
+            }
+        }
+    }
+
+    Nucleotide Get(DNALength pos) {
+        DNALength b = pos / NucsPerBlock;
+        DNALength offset = pos - b * NucsPerBlock;
+        PackedDNAWord word = blocks[b * BlockSize + CountsPerBlock +
+                                    offset / PackedDNASequence::NucsPerWord];
+        return (word >> (3 * (offset % PackedDNASequence::NucsPerWord))) & PackedDNASequence::NucMask;
+    }
+
+    Nucleotide operator[](DNALength pos) {
+        return Get(pos);
+    }
+
+    //
+    // Return the number of nuc in positions 0 .. p, inclusive, with the
+    // same conventions as Occ::Count.
+    //
+    DNALength Count(Nucleotide nuc, DNALength p) {
+        Nucleotide tbn = ThreeBit[nuc];
+        DNALength b = p / NucsPerBlock;
+        DNALength nInBlock = p - b * NucsPerBlock + 1;
+        const PackedDNAWord *block = &blocks[b * BlockSize];
+        DNALength nocc;
+        if (tbn < CountsPerBlock) {
+            nocc = block[tbn];
+        }
+        else {
+            DNALength blockStart = b * NucsPerBlock;
+            nocc = blockStart - block[0] - block[1] - block[2] - block[3] -
+                (dollarPos < blockStart ? 1 : 0);
+        }
+        return nocc + CountInBlock(block, nInBlock, tbn);
+    }
+
+    //
+    // Add the match words of a word to planes: positions that hold any
+    // of A, C, G, or T, then C or T, G or T, and T alone.  The four
+    // share the bits of the word, so counting all nucleotides costs
+    // little more than counting one.
+    //
+    static inline void AddNucleotidePlanes(PackedDNAWord word, PackedDNAWord wordMask,
+                                           PackedDNAWord planes[CountsPerBlock]) {
+        PackedDNAWord low    = word & PackedDNASequence::Mask0All;
+        PackedDNAWord middle = (word >> 1) & PackedDNASequence::Mask0All;
+        PackedDNAWord notHigh = ~(word >> 2) & PackedDNASequence::Mask0All & wordMask;
+        planes[0] += notHigh;
+        planes[1] += low & notHigh;
+        planes[2] += middle & notHigh;
+        planes[3] += low & middle & notHigh;
+    }
+
+    //
+    // Set counts[n] to Count(n, p) for A, C, G, and T, from one block.
+    //
+    void CountNucleotides(DNALength p, DNALength counts[CountsPerBlock]) {
+        DNALength b = p / NucsPerBlock;
+        DNALength nInBlock = p - b * NucsPerBlock + 1;
+        const PackedDNAWord *block = &blocks[b * BlockSize];
+        const PackedDNAWord *words = block + CountsPerBlock;
+        const PackedDNAWord wholeWord = PackedDNASequence::MaskLR[PackedDNASequence::NucsPerWord - 1];
+        DNALength nWholeWords = nInBlock / PackedDNASequence::NucsPerWord;
+        DNALength planeCounts[CountsPerBlock] = {0, 0, 0, 0};
+        PackedDNAWord planes[CountsPerBlock];
+        DNALength w, n;
+        for (w = 0; w < nWholeWords; ) {
+            //
+            // Sum at most four words before counting, as in CountInBlock.
+            //
+            std::fill(planes, planes + CountsPerBlock, 0);
+            DNALength groupEnd = w + 4;
+            for (; w < groupEnd and w < nWholeWords; w++) {
+                AddNucleotidePlanes(words[w], wholeWord, planes);
+            }
+            for (n = 0; n < CountsPerBlock; n++) {
+                planeCounts[n] += CountMatchesInSum(planes[n]);
+            }
+        }
+        DNALength nInWord = nInBlock % PackedDNASequence::NucsPerWord;
+        if (nInWord > 0) {
+            std::fill(planes, planes + CountsPerBlock, 0);
+            AddNucleotidePlanes(words[w], PackedDNASequence::MaskLR[nInWord - 1], planes);
+            for (n = 0; n < CountsPerBlock; n++) {
+                planeCounts[n] += CountMatchesInSum(planes[n]);
+            }
+        }
+        DNALength nT = planeCounts[3];
+        counts[0] = block[0] + planeCounts[0] - planeCounts[1] - planeCounts[2] + nT;
+        counts[1] = block[1] + planeCounts[1] - nT;
+        counts[2] = block[2] + planeCounts[2] - nT;
+        counts[3] = block[3] + nT;
+    }
+
+    //
+    // Count tbn in the first nInBlock positions of a block.
+    //
+    DNALength CountInBlock(const PackedDNAWord *block, DNALength nInBlock, Nucleotide tbn) {
+        DNALength nocc = 0;
+        const PackedDNAWord *words = block + CountsPerBlock;
+        const PackedDNAWord wholeWord = PackedDNASequence::MaskLR[PackedDNASequence::NucsPerWord - 1];
+        DNALength nWholeWords = nInBlock / PackedDNASequence::NucsPerWord;
+        DNALength w;
+        for (w = 0; w + 4 <= nWholeWords; w += 4) {
+            nocc += CountMatchesInSum(
+                PackedDNASequence::MatchThreeBitInWord(words[w],   wholeWord, tbn) +
+                PackedDNASequence::MatchThreeBitInWord(words[w+1], wholeWord, tbn) +
+                PackedDNASequence::MatchThreeBitInWord(words[w+2], wholeWord, tbn) +
+                PackedDNASequence::MatchThreeBitInWord(words[w+3], wholeWord, tbn));
+        }
+        //
+        // At most three whole words and the partial word remain.
+        //
+        PackedDNAWord matchSum = 0;
+        for (; w < nWholeWords; w++) {
+            matchSum += PackedDNASequence::MatchThreeBitInWord(words[w], wholeWord, tbn);
+        }
+        DNALength nInWord = nInBlock % PackedDNASequence::NucsPerWord;
+        if (nInWord > 0) {
+            matchSum += PackedDNASequence::MatchThreeBitInWord(words[w],
+                PackedDNASequence::MaskLR[nInWord - 1], tbn);
+        }
+        return nocc + CountMatchesInSum(matchSum);
+    }
+
+    //
+    // Write the BWT in the format of PackedDNASequence::Write.
+    //
+    void WriteSequence(std::ostream &out) {
+        DNALength arrayLength = CeilOfFraction(length, PackedDNASequence::NucsPerWord);
+        out.write((char*) &arrayLength, sizeof(arrayLength));
+        out.write((char*) &length, sizeof(length));
+        DNALength b;
+        for (b = 0; b < nBlocks and b * WordsPerBlock < arrayLength; b++) {
+            DNALength nWords = arrayLength - b * WordsPerBlock;
+            if (nWords > WordsPerBlock) {
+                nWords = WordsPerBlock;
+            }
+            out.write((char*) &blocks[b * BlockSize + CountsPerBlock],
+                      sizeof(PackedDNAWord) * nWords);
+        }
+    }
+};
+
+#endif // _BLASR_PACKED_OCC_HPP_
@@ -1,7 +1,9 @@
 #ifndef _BLASR_POS_HPP_
 #define _BLASR_POS_HPP_
 
+#include <stdlib.h>
 #include <fstream>
+#include <iostream>
 #include <vector>
 
 #include "PackedHash.hpp"
@@ -10,35 +12,141 @@
 #include "Types.h"
 #include "utils/BitUtils.hpp"
 
+/*
+ * The sampled suffix array of a BWT.  The suffix array position of
+ * every stride'th text position is kept, so Locate takes at most stride
+ * LF steps.  Sampled rows are marked in a bit vector, with the number of
+ * samples before each 32-bit word stored beside it.  The value of a
+ * row is therefore found by one rank in a flat array of values.  A
+ * larger stride makes a smaller index but a slower Locate.
+ */
 template< typename T_BWT_Sequence>
 class Pos {
 public:
-    static const unsigned int stride=8;
-    PackedHash packedHash;
-    std::vector<int> hashCount;
-    std::vector<int> fullPos;
+    static const DNALength DefaultStride = 8;
+    static const DNALength BitsPerWord   = 32;
+    //
+    // Files written before the stride was a parameter start with the
+    // length of a PackedHash table, which is never this.
+    //
+    static const DNALength FlatFormatTag = 0xFFFFFFFF;
+    DNALength stride;
+    DNALength length;
+    std::vector<uint32_t> sampled;
+    std::vector<DNALength> samplesBefore;
+    std::vector<DNALength> values;
     int hasDebugInformation;
+
+    Pos() {
+        stride = DefaultStride;
+        length = 0;
+        hasDebugInformation = 0;
+    }
+
+    DNALength ByteSize() {
+        return sampled.size() * sizeof(uint32_t) + samplesBefore.size() * sizeof(DNALength) +
+            values.size() * sizeof(DNALength);
+    }
+
     void Write(std::ostream &out) {
-        packedHash.Write(out);
+        DNALength tag = FlatFormatTag;
+        DNALength nValues = values.size();
+        out.write((char*) &tag, sizeof(tag));
+        out.write((char*) &stride, sizeof(stride));
+        out.write((char*) &length, sizeof(length));
+        out.write((char*) &nValues, sizeof(nValues));
+        if (sampled.size() > 0) {
+            out.write((char*) &sampled[0], sampled.size() * sizeof(uint32_t));
+        }
+        if (nValues > 0) {
+            out.write((char*) &values[0], nValues * sizeof(DNALength));
+        }
     }
 
     void Read(std::istream &in) {
-        packedHash.Read(in);
+        DNALength tag;
+        in.read((char*) &tag, sizeof(tag));
+        if (tag != FlatFormatTag) {
+            ReadPackedHash(in, tag);
+            return;
+        }
+        DNALength nValues;
+        in.read((char*) &stride, sizeof(stride));
+        in.read((char*) &length, sizeof(length));
+        in.read((char*) &nValues, sizeof(nValues));
+        sampled.resize(CeilOfFraction(length, BitsPerWord));
+        values.resize(nValues);
+        if (sampled.size() > 0) {
+            in.read((char*) &sampled[0], sampled.size() * sizeof(uint32_t));
+        }
+        if (nValues > 0) {
+            in.read((char*) &values[0], nValues * sizeof(DNALength));
+        }
+        InitializeRanks();
     }
 
-    void InitializeFromSuffixArray(DNALength suffixArray[], DNALength suffixArrayLength) {
+    //
+    // Read the samples of an older index, kept in a PackedHash, whose
+    // table length has already been read.  Its tables mark the same
+    // rows 32 to a word, with values in row order.
+    //
+    void ReadPackedHash(std::istream &in, DNALength tableLength) {
+        PackedHash packedHash;
+        packedHash.tableLength = tableLength;
+        packedHash.ReadTables(in);
+        stride = DefaultStride;
+        length = tableLength * BitsPerWord;
+        sampled.assign(packedHash.table, packedHash.table + tableLength);
+        values.clear();
+        DNALength p, value;
+        for (p = 0; p < length; p++) {
+            if (packedHash.LookupValue(p, value)) {
+                values.push_back(value);
+            }
+        }
+        InitializeRanks();
+    }
+
+    void InitializeRanks() {
+        samplesBefore.resize(sampled.size());
+        DNALength w, total = 0;
+        for (w = 0; w < sampled.size(); w++) {
+            samplesBefore[w] = total;
+            total += CountBits(sampled[w]);
+        }
+    }
+
+    void InitializeFromSuffixArray(DNALength suffixArray[], DNALength suffixArrayLength,
+                                   DNALength strideParam = DefaultStride) {
+        if (strideParam == 0) {
+            std::cout << "ERROR, the suffix array sampling stride must be positive." << std::endl;
+            exit(1);
+        }
+        stride = strideParam;
+        length = suffixArrayLength;
+        sampled.resize(CeilOfFraction(length, BitsPerWord));
+        std::fill(sampled.begin(), sampled.end(), 0);
+        values.clear();
+        values.reserve(length / stride + 1);
         DNALength p;
-        packedHash.Allocate(suffixArrayLength);
-        std::fill(hashCount.begin(), hashCount.end(), 0);
         for (p = 0; p < suffixArrayLength; p++ ){
-            if (suffixArray[p] % stride==0){
-                packedHash.AddValue(p,suffixArray[p]);
+            if (suffixArray[p] % stride == 0) {
+                sampled[p / BitsPerWord] |= ((uint32_t) 1) << (p % BitsPerWord);
+                values.push_back(suffixArray[p]);
             }
         }
+        InitializeRanks();
     }
 
     int Lookup(DNALength bwtPos, DNALength &seqPos) {
-        return packedHash.LookupValue(bwtPos-1, seqPos);
+        DNALength p = bwtPos - 1;
+        uint32_t word = sampled[p / BitsPerWord];
+        uint32_t bit  = ((uint32_t) 1) << (p % BitsPerWord);
+        if ((word & bit) == 0) {
+            return 0;
+        }
+        seqPos = values[samplesBefore[p / BitsPerWord] + CountBits(word & (bit - 1))];
+        return 1;
     }
 
 };
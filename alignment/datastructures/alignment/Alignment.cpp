@@ -42,6 +42,16 @@ void Alignment::Clear() {
     gaps.clear();
 }
 
+void Alignment::Clear(std::vector<GapList> &spareGapLists) {
+    VectorIndex g;
+    for (g = 0; g < gaps.size(); g++) {
+        gaps[g].clear();
+        spareGapLists.push_back(GapList());
+        spareGapLists.back().swap(gaps[g]);
+    }
+    Clear();
+}
+
 Alignment& Alignment::operator=(const Alignment &rhs) {
     qName = rhs.qName;
     tName = rhs.tName;
@@ -158,6 +168,12 @@ void Alignment::AppendAlignment(Alignment &next) {
    */
 
 void Alignment::ArrowPathToAlignment(std::vector<Arrow> &optPath) {
+    std::vector<GapList> spareGapLists;
+    ArrowPathToAlignment(optPath, spareGapLists);
+}
+
+void Alignment::ArrowPathToAlignment(std::vector<Arrow> &optPath,
+                                     std::vector<GapList> &spareGapLists) {
     int q, t;
     VectorIndex a = 1;
     q = 0; t = 0;
@@ -185,6 +201,10 @@ void Alignment::ArrowPathToAlignment(std::vector<Arrow> &optPath) {
             }
         }
         gaps.push_back(GapList());
+        if (spareGapLists.size() > 0) {
+            gaps.back().swap(spareGapLists.back());
+            spareGapLists.pop_back();
+        }
         int curGapList = gaps.size() - 1;
         //
         // Add gaps as condensed blocks of insertions or deletions.  It
@@ -73,6 +73,12 @@ public:
     //
     void Clear();
 
+    //
+    // As Clear, but the emptied gap lists are moved to spareGapLists
+    // with their storage, to be reused by ArrowPathToAlignment.
+    //
+    void Clear(std::vector<GapList> &spareGapLists);
+
     Alignment& operator=(const Alignment &rhs);
 
     unsigned int size(); 
@@ -99,6 +105,13 @@ public:
 
     void ArrowPathToAlignment(std::vector<Arrow> &optPath); 
 
+    //
+    // As above, taking the gap lists from spareGapLists while there
+    // are any.
+    //
+    void ArrowPathToAlignment(std::vector<Arrow> &optPath,
+                              std::vector<GapList> &spareGapLists); 
+
     //
     // samtools / picard do not like the pattern
     // insertion/deletion/insertion (or the opposite).  To get around
@@ -0,0 +1,47 @@
+#ifndef _BLASR_READ_BATCH_QUEUE_HPP_
+#define _BLASR_READ_BATCH_QUEUE_HPP_
+
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+//
+// A bounded first-in first-out queue of read batches that is shared
+// between threads.  Push blocks while the queue holds maxBatches
+// batches, and Pop blocks while it is empty.  Once Close is called, Pop
+// drains the batches that remain and then returns false.
+//
+// Batches are passed by pointer; ownership moves with the batch, so
+// the thread that pops a batch is responsible for deleting it.
+//
+template<typename T_Sequence>
+class ReadBatchQueue {
+public:
+    typedef std::vector<T_Sequence> Batch;
+
+    ReadBatchQueue(int maxBatches=4);
+    ~ReadBatchQueue();
+
+    void Push(Batch *batch);
+
+    bool Pop(Batch *&batch);
+
+    void Close();
+
+    bool IsClosed();
+
+private:
+    std::deque<Batch*> batches;
+    int maxBatches;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty, notFull;
+
+    // Not copyable: the queue owns its mutex and the batches in it.
+    ReadBatchQueue(const ReadBatchQueue &rhs);
+    ReadBatchQueue &operator=(const ReadBatchQueue &rhs);
+};
+
+#include "files/ReadBatchQueueImpl.hpp"
+
+#endif
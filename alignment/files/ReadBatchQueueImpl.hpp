@@ -0,0 +1,78 @@
+#ifndef _BLASR_READ_BATCH_QUEUE_IMPL_HPP_
+#define _BLASR_READ_BATCH_QUEUE_IMPL_HPP_
+
+template<typename T_Sequence>
+ReadBatchQueue<T_Sequence>::ReadBatchQueue(int maxBatchesP) {
+    maxBatches = maxBatchesP < 1 ? 1 : maxBatchesP;
+    closed = false;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&notEmpty, NULL);
+    pthread_cond_init(&notFull, NULL);
+}
+
+template<typename T_Sequence>
+ReadBatchQueue<T_Sequence>::~ReadBatchQueue() {
+    while (batches.size() > 0) {
+        delete batches.front();
+        batches.pop_front();
+    }
+    pthread_cond_destroy(&notFull);
+    pthread_cond_destroy(&notEmpty);
+    pthread_mutex_destroy(&lock);
+}
+
+template<typename T_Sequence>
+void ReadBatchQueue<T_Sequence>::Push(Batch *batch) {
+    pthread_mutex_lock(&lock);
+    while ((int) batches.size() >= maxBatches and not closed) {
+        pthread_cond_wait(&notFull, &lock);
+    }
+    if (closed) {
+        //
+        // Nobody will consume this batch.
+        //
+        pthread_mutex_unlock(&lock);
+        delete batch;
+        return;
+    }
+    batches.push_back(batch);
+    pthread_cond_signal(&notEmpty);
+    pthread_mutex_unlock(&lock);
+}
+
+template<typename T_Sequence>
+bool ReadBatchQueue<T_Sequence>::Pop(Batch *&batch) {
+    pthread_mutex_lock(&lock);
+    while (batches.size() == 0 and not closed) {
+        pthread_cond_wait(&notEmpty, &lock);
+    }
+    if (batches.size() == 0) {
+        pthread_mutex_unlock(&lock);
+        batch = NULL;
+        return false;
+    }
+    batch = batches.front();
+    batches.pop_front();
+    pthread_cond_signal(&notFull);
+    pthread_mutex_unlock(&lock);
+    return true;
+}
+
+template<typename T_Sequence>
+void ReadBatchQueue<T_Sequence>::Close() {
+    pthread_mutex_lock(&lock);
+    closed = true;
+    pthread_cond_broadcast(&notEmpty);
+    pthread_cond_broadcast(&notFull);
+    pthread_mutex_unlock(&lock);
+}
+
+template<typename T_Sequence>
+bool ReadBatchQueue<T_Sequence>::IsClosed() {
+    pthread_mutex_lock(&lock);
+    bool isClosed = closed;
+    pthread_mutex_unlock(&lock);
+    return isClosed;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _BLASR_READER_PIPELINE_HPP_
+#define _BLASR_READER_PIPELINE_HPP_
+
+#include <pthread.h>
+#include <assert.h>
+#include <vector>
+#include "files/ReaderAgglomerate.hpp"
+#include "files/ReadBatchQueue.hpp"
+
+//
+// ReaderPipeline reads from a ReaderAgglomerate on its own producer
+// thread and hands the reads to any number of worker threads in
+// batches.  The producer fills batches with ReadChunkByNReads (the
+// default) or ReadChunkBySize and pushes them onto a bounded
+// ReadBatchQueue, so at most queueLength batches are held in memory
+// ahead of the workers.
+//
+// Thread safety:
+//
+//   - The ReaderAgglomerate, and the HDF readers inside it, are used
+//     only by the producer thread between Start and Join.  Nothing
+//     else may call it in that time.  Open it before Start, and Close
+//     it after Join.
+//
+//   - GetNextBatch may be called from any number of threads at once.
+//
+//   - The index structures shared by the workers, SuffixArray,
+//     SequenceIndexDatabase and TupleCountTable, may be searched from
+//     any number of threads at once once they are fully built or read:
+//     their query methods (the SuffixArray Search* and StoreLCPBounds
+//     family, SequenceIndexDatabase::SearchFor*, GetName,
+//     GetLengthOfSeq, and TupleCountTable::GetCount) do not
+//     modify them.  Everything that modifies them (Read, MapRead,
+//     the Build* methods, BuildLookupTable, AddSequence, Finalize,
+//     SequenceTitleLinesToNames, InitCountTable, IncrementCount,
+//     AddSequenceTupleCountsLR) must finish before the workers start.
+//     A single copy of each index is therefore shared by all workers.
+//
+//   - Anything a worker writes, such as alignment output, must be
+//     protected by the caller.
+//
+template<typename T_Sequence>
+class ReaderPipeline {
+public:
+    typedef std::vector<T_Sequence> Batch;
+
+    ReaderPipeline(ReaderAgglomerate &readerP, int queueLength=4);
+
+    ~ReaderPipeline();
+
+    //
+    // Choose how the producer sizes batches.  The default is 
+    // ChunkByNReads(1000).
+    //
+    void ChunkByNReads(int nReads);
+
+    void ChunkBySize(int nBytes);
+
+    //
+    // Start the producer thread.  Returns false if it could not be
+    // created.
+    //
+    bool Start();
+
+    //
+    // Replace the contents of reads with the next batch.  Blocks until
+    // a batch is available, and returns false once all reads have been
+    // handed out.  Safe to call from several threads.
+    //
+    bool GetNextBatch(Batch &reads);
+
+    //
+    // Wait for the producer to finish.  All batches must have been taken
+    // with GetNextBatch, or Stop called, before Join can return.
+    //
+    void Join();
+
+    //
+    // Make the producer stop reading after its current batch, for
+    // example when a worker fails.  Batches already queued are still
+    // handed out by GetNextBatch.
+    //
+    void Stop();
+
+    //
+    // Start the producer, run nWorkers threads that each call
+    // worker(reads, workerIndex) on batches until the input is
+    // exhausted, and wait for all of them.  Returns the number of
+    // worker threads that could be started.
+    //
+    template<typename T_Worker>
+    int Run(int nWorkers, T_Worker &worker);
+
+    //
+    // The number of reads the producer has read.  Only final after Join.
+    //
+    long NumReads();
+
+private:
+    ReaderAgglomerate &reader;
+    ReadBatchQueue<T_Sequence> queue;
+    int batchNReads;
+    int batchSize;
+    bool started;
+    long nReads;
+    pthread_t producer;
+
+    void Produce();
+
+    static void* ProduceThread(void *data);
+
+    template<typename T_Worker>
+    class WorkerTask {
+    public:
+        ReaderPipeline<T_Sequence> *pipeline;
+        T_Worker *worker;
+        int workerIndex;
+    };
+
+    template<typename T_Worker>
+    static void* WorkerThread(void *data);
+
+    ReaderPipeline(const ReaderPipeline &rhs);
+    ReaderPipeline &operator=(const ReaderPipeline &rhs);
+};
+
+#include "files/ReaderPipelineImpl.hpp"
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef _BLASR_READER_PIPELINE_IMPL_HPP_
+#define _BLASR_READER_PIPELINE_IMPL_HPP_
+
+template<typename T_Sequence>
+ReaderPipeline<T_Sequence>::ReaderPipeline(ReaderAgglomerate &readerP,
+    int queueLength) : reader(readerP), queue(queueLength) {
+    batchNReads = 1000;
+    batchSize   = 0;
+    started     = false;
+    nReads      = 0;
+}
+
+template<typename T_Sequence>
+ReaderPipeline<T_Sequence>::~ReaderPipeline() {
+    if (started) {
+        Stop();
+        Join();
+    }
+}
+
+template<typename T_Sequence>
+void ReaderPipeline<T_Sequence>::ChunkByNReads(int nReadsP) {
+    assert(not started);
+    batchNReads = nReadsP < 1 ? 1 : nReadsP;
+    batchSize   = 0;
+}
+
+template<typename T_Sequence>
+void ReaderPipeline<T_Sequence>::ChunkBySize(int nBytes) {
+    assert(not started);
+    batchSize   = nBytes < 1 ? 1 : nBytes;
+    batchNReads = 0;
+}
+
+template<typename T_Sequence>
+bool ReaderPipeline<T_Sequence>::Start() {
+    assert(not started);
+    if (pthread_create(&producer, NULL, ProduceThread, this) != 0) {
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+template<typename T_Sequence>
+void* ReaderPipeline<T_Sequence>::ProduceThread(void *data) {
+    ((ReaderPipeline<T_Sequence>*) data)->Produce();
+    return NULL;
+}
+
+template<typename T_Sequence>
+void ReaderPipeline<T_Sequence>::Produce() {
+    while (not queue.IsClosed()) {
+        Batch *batch = new Batch;
+        int nBatchReads;
+        if (batchSize > 0) {
+            nBatchReads = ReadChunkBySize(reader, *batch, batchSize);
+        }
+        else {
+            //
+            // Reserve the batch so that reads are copied once, not again
+            // each time the vector grows.
+            //
+            batch->reserve(batchNReads);
+            nBatchReads = ReadChunkByNReads(reader, *batch, batchNReads);
+        }
+        if (nBatchReads == 0) {
+            delete batch;
+            break;
+        }
+        nReads += nBatchReads;
+        queue.Push(batch);
+    }
+    queue.Close();
+}
+
+template<typename T_Sequence>
+bool ReaderPipeline<T_Sequence>::GetNextBatch(Batch &reads) {
+    Batch *batch;
+    if (queue.Pop(batch) == false) {
+        reads.clear();
+        return false;
+    }
+    reads.swap(*batch);
+    delete batch;
+    return true;
+}
+
+template<typename T_Sequence>
+void ReaderPipeline<T_Sequence>::Join() {
+    if (started) {
+        pthread_join(producer, NULL);
+        started = false;
+    }
+}
+
+template<typename T_Sequence>
+void ReaderPipeline<T_Sequence>::Stop() {
+    queue.Close();
+}
+
+template<typename T_Sequence>
+long ReaderPipeline<T_Sequence>::NumReads() {
+    return nReads;
+}
+
+template<typename T_Sequence>
+template<typename T_Worker>
+void* ReaderPipeline<T_Sequence>::WorkerThread(void *data) {
+    WorkerTask<T_Worker> *task = (WorkerTask<T_Worker>*) data;
+    Batch reads;
+    while (task->pipeline->GetNextBatch(reads)) {
+        (*task->worker)(reads, task->workerIndex);
+    }
+    return NULL;
+}
+
+template<typename T_Sequence>
+template<typename T_Worker>
+int ReaderPipeline<T_Sequence>::Run(int nWorkers, T_Worker &worker) {
+    if (Start() == false) {
+        return 0;
+    }
+    std::vector<pthread_t> threads(nWorkers);
+    std::vector<WorkerTask<T_Worker> > tasks(nWorkers);
+    int nStarted = 0;
+    int t;
+    for (t = 0; t < nWorkers; t++) {
+        tasks[t].pipeline    = this;
+        tasks[t].worker      = &worker;
+        tasks[t].workerIndex = t;
+        if (pthread_create(&threads[t], NULL, WorkerThread<T_Worker>, &tasks[t]) != 0) {
+            break;
+        }
+        nStarted++;
+    }
+    if (nStarted == 0) {
+        //
+        // Nothing can consume batches; release the producer.
+        //
+        Stop();
+    }
+    for (t = 0; t < nStarted; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    Join();
+    return nStarted;
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <stdint.h>
 #include "format/SAMPrinter.hpp"
+#include "format/BGZFWriter.hpp"
 #include "pbbam/BamHeader.h"
 #include "pbbam/BamWriter.h"
 
@@ -21,6 +22,27 @@ void PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read,
         PacBio::BAM::BamWriter &bamWriter, AlignmentContext &context, 
         SupplementalQVList & qvList, Clipping clipping, 
         bool cigarUseSeqMatch=false);
+
+//
+// Append the binary BAM encoding of bamRecord to out.
+//
+inline void AppendBamRecord(PacBio::BAM::BamRecord &bamRecord,
+        SAMOutput::OutputBuffer &out);
+
+//
+// Write to a BGZFWriter rather than a BamWriter, so that records are
+// encoded by the calling thread and compressed on the writer's pool.
+// Records collect in recordBuffer, which belongs to the calling thread,
+// and are passed to the writer when it is full; flush it to the writer
+// when done.
+//
+template<typename T_Sequence>
+void PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read,
+        BGZFWriter &bgzfWriter, SAMOutput::OutputBuffer &recordBuffer,
+        AlignmentContext &context, SupplementalQVList & qvList,
+        Clipping clipping, bool cigarUseSeqMatch=false);
+
+inline void FlushRecords(SAMOutput::OutputBuffer &recordBuffer, BGZFWriter &bgzfWriter);
 }
 
 #include "BAMPrinterImpl.hpp"
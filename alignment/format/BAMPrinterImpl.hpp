@@ -4,11 +4,14 @@
 #ifdef USE_PBBAM
 
 #include <algorithm>
+#include <string.h>
+#include "CCSSequence.hpp"
 #include "utils/SMRTTitle.hpp"
 using namespace BAMOutput;
 using namespace std;
 #include "pbbam/BamRecord.h"
 #include "pbbam/BamFile.h"
+#include "htslib/sam.h"
 
 template<typename T_Sequence>
 void AlignmentToBamRecord(T_AlignmentCandidate & alignment, 
@@ -163,6 +166,55 @@ void BAMOutput::PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read
     AlignmentToBamRecord(alignment, read, bamRecord, context, qvList, clipping, cigarUseSeqMatch);
     bamWriter.Write(bamRecord);
 }
+
+inline void BAMOutput::AppendBamRecord(PacBio::BAM::BamRecord &bamRecord,
+        SAMOutput::OutputBuffer &out) {
+    //
+    // The record in memory is the record on disk, less its size and the
+    // padding htslib may add after the name.  pbbam does not set the
+    // bin, so it is computed from the aligned region.
+    //
+    const bam1_t *b = bamRecord.Impl().RawData().get();
+    const bam1_core_t &core = b->core;
+    uint32_t nameLength = strlen(bam_get_qname(b)) + 1;
+    uint32_t restLength = b->l_data - core.l_qname;
+    uint32_t bin = BAMRegionToBin(core.pos, bam_endpos(b));
+    uint32_t fields[9];
+    fields[0] = 32 + nameLength + restLength;
+    fields[1] = core.tid;
+    fields[2] = core.pos;
+    fields[3] = bin << 16 | ((uint32_t) core.qual) << 8 | nameLength;
+    fields[4] = ((uint32_t) core.flag) << 16 | core.n_cigar;
+    fields[5] = core.l_qseq;
+    fields[6] = core.mtid;
+    fields[7] = core.mpos;
+    fields[8] = core.isize;
+    out.Append((const char*) fields, sizeof(fields));
+    out.Append((const char*) b->data, nameLength);
+    out.Append((const char*) b->data + core.l_qname, restLength);
+}
+
+template<typename T_Sequence>
+void BAMOutput::PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read,
+        BGZFWriter &bgzfWriter, SAMOutput::OutputBuffer &recordBuffer,
+        AlignmentContext &context, SupplementalQVList & qvList,
+        Clipping clipping, bool cigarUseSeqMatch) {
+
+    PacBio::BAM::BamRecord bamRecord;
+    AlignmentToBamRecord(alignment, read, bamRecord, context, qvList, clipping, cigarUseSeqMatch);
+    AppendBamRecord(bamRecord, recordBuffer);
+    if (recordBuffer.Full()) {
+        FlushRecords(recordBuffer, bgzfWriter);
+    }
+}
+
+inline void BAMOutput::FlushRecords(SAMOutput::OutputBuffer &recordBuffer,
+        BGZFWriter &bgzfWriter) {
+    if (recordBuffer.size > 0) {
+        bgzfWriter.Write(&recordBuffer.data[0], recordBuffer.size);
+    }
+    recordBuffer.Clear();
+}
 #endif
 
 #endif
@@ -0,0 +1,303 @@
+#include "BGZFWriter.hpp"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+static void StoreUInt16(char *dest, uint32_t value) {
+    dest[0] = (char) (value & 0xff);
+    dest[1] = (char) ((value >> 8) & 0xff);
+}
+
+static void StoreUInt32(char *dest, uint32_t value) {
+    StoreUInt16(dest, value & 0xffff);
+    StoreUInt16(dest + 2, value >> 16);
+}
+
+static void AppendUInt32(string &dest, uint32_t value) {
+    char bytes[4];
+    StoreUInt32(bytes, value);
+    dest.append(bytes, 4);
+}
+
+BGZFBlock::BGZFBlock() {
+    inputSize  = 0;
+    outputSize = 0;
+    compressed = false;
+}
+
+BGZFWriter::BGZFWriter() {
+    out = NULL;
+    compressionLevel = Z_DEFAULT_COMPRESSION;
+    closed = true;
+    nSubmitted = nTaken = nWritten = 0;
+    stopping = false;
+    pthread_mutex_init(&writeLock, NULL);
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&blockSubmitted, NULL);
+    pthread_cond_init(&blockCompressed, NULL);
+}
+
+BGZFWriter::~BGZFWriter() {
+    Close();
+    pthread_mutex_destroy(&writeLock);
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&blockSubmitted);
+    pthread_cond_destroy(&blockCompressed);
+}
+
+void BGZFWriter::Initialize(ostream *outParam, int nThreads,
+                            int compressionLevelParam, int blocksPerThread) {
+    Close();
+    out = outParam;
+    compressionLevel = compressionLevelParam;
+    closed   = false;
+    stopping = false;
+    nSubmitted = nTaken = nWritten = 0;
+    //
+    // One block more than are compressed at once, so that there is
+    // always one to fill.
+    //
+    blocks.clear();
+    blocks.resize(max(nThreads, 0) * max(blocksPerThread, 1) + 1);
+    for (size_t b = 0; b < blocks.size(); b++) {
+        blocks[b].input.resize(MaxBlockInput);
+        blocks[b].output.resize(MaxBlockSize);
+    }
+    threads.resize(max(nThreads, 0));
+    for (size_t t = 0; t < threads.size(); t++) {
+        if (pthread_create(&threads[t], NULL, CompressBlocksThread, this) != 0) {
+            cout << "ERROR, could not start a BGZF compression thread." << endl;
+            exit(1);
+        }
+    }
+}
+
+void BGZFWriter::Write(const char *data, size_t length) {
+    pthread_mutex_lock(&writeLock);
+    while (length > 0) {
+        BGZFBlock &block = CurrentBlock();
+        size_t nCopied = min(length, (size_t) (MaxBlockInput - block.inputSize));
+        memcpy(&block.input[block.inputSize], data, nCopied);
+        block.inputSize += nCopied;
+        data   += nCopied;
+        length -= nCopied;
+        if (block.inputSize == MaxBlockInput) {
+            SubmitBlock();
+        }
+    }
+    WriteCompressedBlocks(false);
+    pthread_mutex_unlock(&writeLock);
+}
+
+void BGZFWriter::Write(const string &data) {
+    Write(data.c_str(), data.size());
+}
+
+void BGZFWriter::Flush() {
+    if (closed) {
+        return;
+    }
+    pthread_mutex_lock(&writeLock);
+    if (CurrentBlock().inputSize > 0) {
+        SubmitBlock();
+    }
+    WriteCompressedBlocks(true);
+    out->flush();
+    pthread_mutex_unlock(&writeLock);
+}
+
+void BGZFWriter::Close() {
+    if (closed) {
+        return;
+    }
+    Flush();
+    pthread_mutex_lock(&lock);
+    stopping = true;
+    pthread_cond_broadcast(&blockSubmitted);
+    pthread_mutex_unlock(&lock);
+    for (size_t t = 0; t < threads.size(); t++) {
+        pthread_join(threads[t], NULL);
+    }
+    threads.clear();
+    //
+    // Readers recognize the end of a BGZF file by an empty block.
+    //
+    char eofBlock[MaxBlockSize];
+    int eofSize = CompressBlock("", 0, eofBlock, compressionLevel);
+    out->write(eofBlock, eofSize);
+    out->flush();
+    closed = true;
+}
+
+BGZFBlock &BGZFWriter::CurrentBlock() {
+    return blocks[nSubmitted % blocks.size()];
+}
+
+void BGZFWriter::SubmitBlock() {
+    BGZFBlock &block = CurrentBlock();
+    if (threads.size() == 0) {
+        block.outputSize = CompressBlock(&block.input[0], block.inputSize,
+                                         &block.output[0], compressionLevel);
+        block.compressed = true;
+        nSubmitted++;
+        nTaken++;
+    }
+    else {
+        pthread_mutex_lock(&lock);
+        nSubmitted++;
+        pthread_cond_signal(&blockSubmitted);
+        pthread_mutex_unlock(&lock);
+    }
+    //
+    // Free the next block to fill.
+    //
+    WriteCompressedBlocks(false);
+}
+
+//
+// Write the compressed blocks at the head of the queue, in order.  Wait
+// for blocks still being compressed if waitForAll is set, or if there is
+// no free block left to fill.  Only the thread holding writeLock changes
+// nSubmitted and nWritten.
+//
+void BGZFWriter::WriteCompressedBlocks(bool waitForAll) {
+    while (nWritten < nSubmitted) {
+        BGZFBlock &block = blocks[nWritten % blocks.size()];
+        bool queueFull = (nSubmitted - nWritten == blocks.size());
+        pthread_mutex_lock(&lock);
+        if (not block.compressed and not waitForAll and not queueFull) {
+            pthread_mutex_unlock(&lock);
+            return;
+        }
+        while (not block.compressed) {
+            pthread_cond_wait(&blockCompressed, &lock);
+        }
+        pthread_mutex_unlock(&lock);
+        out->write(&block.output[0], block.outputSize);
+        block.inputSize  = 0;
+        block.compressed = false;
+        nWritten++;
+    }
+}
+
+void *BGZFWriter::CompressBlocksThread(void *writerPtr) {
+    ((BGZFWriter*) writerPtr)->CompressBlocks();
+    return NULL;
+}
+
+void BGZFWriter::CompressBlocks() {
+    pthread_mutex_lock(&lock);
+    while (true) {
+        while (nTaken == nSubmitted and not stopping) {
+            pthread_cond_wait(&blockSubmitted, &lock);
+        }
+        if (nTaken == nSubmitted) {
+            break;
+        }
+        BGZFBlock &block = blocks[nTaken % blocks.size()];
+        nTaken++;
+        pthread_mutex_unlock(&lock);
+        block.outputSize = CompressBlock(&block.input[0], block.inputSize,
+                                         &block.output[0], compressionLevel);
+        pthread_mutex_lock(&lock);
+        block.compressed = true;
+        pthread_cond_signal(&blockCompressed);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+int BGZFWriter::CompressBlock(const char *input, int inputSize, char *output,
+                              int compressionLevel) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    //
+    // A raw deflate stream, since the gzip header and trailer carry the
+    // block size and so are written here.
+    //
+    if (deflateInit2(&zs, compressionLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        cout << "ERROR, could not initialize BGZF compression." << endl;
+        exit(1);
+    }
+    zs.next_in   = (Bytef*) input;
+    zs.avail_in  = inputSize;
+    zs.next_out  = (Bytef*) (output + HeaderSize);
+    zs.avail_out = MaxBlockSize - HeaderSize - FooterSize;
+    int status = deflate(&zs, Z_FINISH);
+    int compressedSize = zs.total_out;
+    deflateEnd(&zs);
+    if (status != Z_STREAM_END) {
+        //
+        // Input that does not compress is stored, which always fits.
+        //
+        if (compressionLevel != 0) {
+            return CompressBlock(input, inputSize, output, 0);
+        }
+        cout << "ERROR, could not compress a BGZF block." << endl;
+        exit(1);
+    }
+    int blockSize = HeaderSize + compressedSize + FooterSize;
+
+    //
+    // A gzip member with the BC extra field holding the block size - 1.
+    //
+    const unsigned char header[] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0};
+    memcpy(output, header, sizeof(header));
+    StoreUInt16(output + sizeof(header), blockSize - 1);
+
+    uLong crc = crc32(crc32(0L, Z_NULL, 0), (const Bytef*) input, inputSize);
+    StoreUInt32(output + HeaderSize + compressedSize, crc);
+    StoreUInt32(output + HeaderSize + compressedSize + 4, inputSize);
+    return blockSize;
+}
+
+void WriteBAMHeader(BGZFWriter &writer, const string &samHeader) {
+    string bamHeader("BAM\1", 4);
+    AppendUInt32(bamHeader, samHeader.size());
+    bamHeader.append(samHeader);
+
+    vector<string> names;
+    vector<uint32_t> lengths;
+    stringstream headerIn(samHeader);
+    string line;
+    while (getline(headerIn, line)) {
+        if (line.compare(0, 4, "@SQ\t") != 0) {
+            continue;
+        }
+        string name;
+        uint32_t length = 0;
+        stringstream fieldsIn(line);
+        string field;
+        while (getline(fieldsIn, field, '\t')) {
+            if (field.compare(0, 3, "SN:") == 0) {
+                name = field.substr(3);
+            }
+            else if (field.compare(0, 3, "LN:") == 0) {
+                length = strtoul(field.c_str() + 3, NULL, 10);
+            }
+        }
+        names.push_back(name);
+        lengths.push_back(length);
+    }
+    AppendUInt32(bamHeader, names.size());
+    for (size_t r = 0; r < names.size(); r++) {
+        AppendUInt32(bamHeader, names[r].size() + 1);
+        bamHeader.append(names[r].c_str(), names[r].size() + 1);
+        AppendUInt32(bamHeader, lengths[r]);
+    }
+    writer.Write(bamHeader);
+}
+
+int BAMRegionToBin(int beg, int end) {
+    --end;
+    if (beg >> 14 == end >> 14) return ((1 << 15) - 1) / 7 + (beg >> 14);
+    if (beg >> 17 == end >> 17) return ((1 << 12) - 1) / 7 + (beg >> 17);
+    if (beg >> 20 == end >> 20) return ((1 << 9) - 1) / 7 + (beg >> 20);
+    if (beg >> 23 == end >> 23) return ((1 << 6) - 1) / 7 + (beg >> 23);
+    if (beg >> 26 == end >> 26) return ((1 << 3) - 1) / 7 + (beg >> 26);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef _BLASR_FORMAT_BGZF_WRITER_HPP_
+#define _BLASR_FORMAT_BGZF_WRITER_HPP_
+
+#include <pthread.h>
+#include <zlib.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//
+// Writes BGZF, the blocked gzip format of BAM files, compressing the
+// blocks on a pool of threads.  Data is cut into blocks of at most
+// MaxBlockInput bytes.  Each full block is queued for the pool, and the
+// compressed blocks are written out in order by whichever thread calls
+// Write next, so callers only pay for copying their bytes in.
+//
+// Write may be called from several threads.  Each call is written
+// contiguously, so a call that holds whole records keeps them together.
+// With no pool threads, blocks are compressed by the writing thread.
+//
+class BGZFBlock {
+public:
+    std::vector<char> input;
+    std::vector<char> output;
+    int inputSize;
+    int outputSize;
+    bool compressed;
+
+    BGZFBlock();
+};
+
+class BGZFWriter {
+public:
+    //
+    // The largest input of a block, as in htslib, so that a block that
+    // does not compress still fits in the 64 KB a block may take.
+    //
+    static const int MaxBlockInput = 0xff00;
+    static const int MaxBlockSize  = 0x10000;
+    static const int HeaderSize    = 18;
+    static const int FooterSize    = 8;
+
+    BGZFWriter();
+    ~BGZFWriter();
+
+    //
+    // Start writing to out.  There are blocksPerThread blocks in flight
+    // for each pool thread.
+    //
+    void Initialize(std::ostream *out, int nThreads=0,
+                    int compressionLevel=Z_DEFAULT_COMPRESSION,
+                    int blocksPerThread=4);
+
+    void Write(const char *data, size_t length);
+
+    void Write(const std::string &data);
+
+    //
+    // End the current block, and wait until every block is written.
+    //
+    void Flush();
+
+    //
+    // Flush, write the end-of-file block, and stop the pool.
+    //
+    void Close();
+
+    //
+    // Compress input into one complete BGZF block in output, which must
+    // hold MaxBlockSize bytes.  Returns the size of the block.
+    //
+    static int CompressBlock(const char *input, int inputSize, char *output,
+                             int compressionLevel);
+
+private:
+    std::ostream *out;
+    int compressionLevel;
+    bool closed;
+    std::vector<BGZFBlock> blocks;
+    //
+    // Blocks are numbered in the order they are filled.  Blocks
+    // nWritten .. nSubmitted-1 are in flight, of which the pool has
+    // taken up to nTaken-1; block nSubmitted is being filled.
+    //
+    unsigned long nSubmitted, nTaken, nWritten;
+    std::vector<pthread_t> threads;
+    bool stopping;
+    //
+    // writeLock orders the callers of Write; lock guards the block
+    // counts and the compressed flags.
+    //
+    pthread_mutex_t writeLock;
+    pthread_mutex_t lock;
+    pthread_cond_t blockSubmitted, blockCompressed;
+
+    BGZFBlock &CurrentBlock();
+
+    void SubmitBlock();
+
+    void WriteCompressedBlocks(bool waitForAll);
+
+    static void *CompressBlocksThread(void *writerPtr);
+
+    void CompressBlocks();
+
+    // Not copyable: the writer owns its threads.
+    BGZFWriter(const BGZFWriter &rhs);
+    BGZFWriter &operator=(const BGZFWriter &rhs);
+};
+
+//
+// Write the binary BAM header for a SAM header, with the reference
+// list taken from its @SQ lines.
+//
+void WriteBAMHeader(BGZFWriter &writer, const std::string &samHeader);
+
+//
+// The BAM index bin of the 0-based region [beg, end), computed as by
+// reg2bin in the SAM specification.  An unmapped record with position
+// -1 and end 0 is in bin 4680.
+//
+int BAMRegionToBin(int beg, int end);
+
+#endif // _BLASR_FORMAT_BGZF_WRITER_HPP_
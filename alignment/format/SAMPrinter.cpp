@@ -1,5 +1,6 @@
 #include "SAMPrinter.hpp"
 #include <algorithm> //reverse
+#include <string.h> //strlen
 
 using namespace SAMOutput; 
 
@@ -178,11 +179,96 @@ void SAMOutput::CreateNoClippingCigarOps(T_AlignmentCandidate &alignment,
 
 void SAMOutput::CigarOpsToString(std::vector<int> &opSize, std::vector<char> &opChar, 
         std::string &cigarString) {
-    std::stringstream sstrm;
+    OutputBuffer out;
+    AppendCIGAR(out, opSize, opChar, 0, 0, 0, 0);
+    cigarString.assign(out.data.empty() ? "" : &out.data[0], out.size);
+}
+
+void SAMOutput::AppendCIGAR(OutputBuffer &out, std::vector<int> &opSize, std::vector<char> &opChar,
+        DNALength prefixHardClip, DNALength prefixSoftClip,
+        DNALength suffixSoftClip, DNALength suffixHardClip) {
+    if (prefixHardClip > 0) {
+        out.AppendInt(prefixHardClip);
+        out.Append('H');
+    }
+    if (prefixSoftClip > 0) {
+        out.AppendInt(prefixSoftClip);
+        out.Append('S');
+    }
     int i, nElem;
     for (i = 0, nElem = opSize.size(); i < nElem; i++) {
-        sstrm << opSize[i] << opChar[i];
+        out.AppendInt(opSize[i]);
+        out.Append(opChar[i]);
+    }
+    if (suffixSoftClip > 0) {
+        out.AppendInt(suffixSoftClip);
+        out.Append('S');
+    }
+    if (suffixHardClip > 0) {
+        out.AppendInt(suffixHardClip);
+        out.Append('H');
+    }
+}
+
+SAMOutput::OutputBuffer::OutputBuffer(size_t flushSizeP) {
+    size      = 0;
+    flushSize = flushSizeP;
+}
+
+bool SAMOutput::OutputBuffer::Full() {
+    return size >= flushSize;
+}
+
+void SAMOutput::OutputBuffer::Clear() {
+    size = 0;
+}
+
+void SAMOutput::OutputBuffer::Flush(std::ostream &out) {
+    if (size > 0) {
+        out.write(&data[0], size);
+    }
+    size = 0;
+}
+
+void SAMOutput::OutputBuffer::Grow(size_t minSize) {
+    size_t newSize = std::max(data.size() * 2, (size_t) 4096);
+    while (newSize < minSize) {
+        newSize *= 2;
+    }
+    data.resize(newSize);
+}
+
+void SAMOutput::OutputBuffer::Append(const char *s, size_t n) {
+    if (n > 0) {
+        memcpy(Reserve(n), s, n);
+        size += n;
+    }
+}
+
+void SAMOutput::OutputBuffer::Append(const char *s) {
+    Append(s, strlen(s));
+}
+
+void SAMOutput::OutputBuffer::Append(const std::string &s) {
+    Append(s.c_str(), s.size());
+}
+
+void SAMOutput::OutputBuffer::AppendInt(long long value) {
+    //
+    // Write the digits backwards into a scratch buffer, then copy them.
+    //
+    char digits[24];
+    int  nDigits = 0;
+    unsigned long long magnitude = value < 0 ? -(unsigned long long) value : value;
+    do {
+        digits[sizeof(digits) - 1 - nDigits] = '0' + magnitude % 10;
+        magnitude /= 10;
+        nDigits++;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[sizeof(digits) - 1 - nDigits] = '-';
+        nDigits++;
     }
-    cigarString = sstrm.str();
+    Append(&digits[sizeof(digits) - nDigits], nDigits);
 }
 
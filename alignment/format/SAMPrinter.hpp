@@ -3,6 +3,8 @@
 
 #include <sstream>
 #include <stdint.h>
+#include <string>
+#include <vector>
 #include "SMRTSequence.hpp"
 #include "datastructures/alignment/AlignmentCandidate.hpp"
 #include "datastructures/alignment/AlignmentContext.hpp"
@@ -27,6 +29,58 @@ namespace SAMOutput {
 
 enum Clipping {hard, soft, subread, none};
 
+//
+// A byte buffer that records are formatted into without intermediate
+// strings.  Keep one per thread and reuse it, so it stops growing after
+// the first records; call Flush when Full(), and once at the end, under
+// the output lock if threads share the output.
+//
+class OutputBuffer {
+public:
+    std::vector<char> data;
+    size_t size;
+    size_t flushSize;
+    //
+    // Space for the CIGAR operations of the record being formatted.
+    //
+    std::vector<int> opSize;
+    std::vector<char> opChar;
+
+    OutputBuffer(size_t flushSizeP = 1 << 20);
+
+    bool Full();
+
+    void Clear();
+
+    void Flush(std::ostream &out);
+
+    void Grow(size_t minSize);
+
+    //
+    // Return space for n more bytes, which the caller fills and then
+    // adds to size.
+    //
+    inline char *Reserve(size_t n) {
+        if (size + n > data.size()) {
+            Grow(size + n);
+        }
+        return &data[size];
+    }
+
+    inline void Append(char c) {
+        Reserve(1)[0] = c;
+        size++;
+    }
+
+    void Append(const char *s, size_t n);
+
+    void Append(const char *s);
+
+    void Append(const std::string &s);
+
+    void AppendInt(long long value);
+};
+
 void BuildFlag(T_AlignmentCandidate &alignment, AlignmentContext &context, uint16_t &flag); 
 
 //
@@ -59,6 +113,14 @@ template<typename T_Sequence>
 void SetAlignedSequence(T_AlignmentCandidate &alignment, T_Sequence &read,
     T_Sequence &alignedSeq, Clipping clipping = none); 
 
+//
+// The part of the read, in forward coordinates, that is printed for
+// a clipping.
+//
+template<typename T_Sequence>
+void GetAlignedRange(T_AlignmentCandidate &alignment, T_Sequence &read,
+    Clipping clipping, DNALength &clippedStartPos, DNALength &clippedReadLength);
+
 template<typename T_Sequence>
 void SetSoftClip(T_AlignmentCandidate &alignment, T_Sequence &read, 
     DNALength hardClipPrefix, DNALength hardClipSuffix,
@@ -71,6 +133,32 @@ void SetHardClip(T_AlignmentCandidate &alignment, T_Sequence &read,
 void CigarOpsToString(std::vector<int> &opSize, std::vector<char> &opChar, 
         std::string &cigarString);
 
+//
+// Set the clipping lengths at each end of the CIGAR string, in the
+// orientation of the alignment.
+//
+template<typename T_Sequence>
+void SetClipping(T_AlignmentCandidate &alignment, T_Sequence &read,
+        Clipping clipping,
+        DNALength &prefixSoftClip, DNALength &suffixSoftClip,
+        DNALength &prefixHardClip, DNALength &suffixHardClip);
+
+//
+// Append the operations with the clipping around them: hard, then
+// soft clipping before, and soft, then hard clipping after.
+//
+void AppendCIGAR(OutputBuffer &out, std::vector<int> &opSize, std::vector<char> &opChar,
+        DNALength prefixHardClip, DNALength prefixSoftClip,
+        DNALength suffixSoftClip, DNALength suffixHardClip);
+
+//
+// Append the optional quality value fields of read[start, start+length),
+// reverse complemented for the reverse strand.
+//
+template<typename T_Sequence>
+void AppendQVOptionalFields(SupplementalQVList &qvList, T_Sequence &read,
+        DNALength start, DNALength length, int strand, OutputBuffer &out);
+
 //
 // Straight forward: create the cigar string allowing some clipping
 // The read is provided to give length and hq information.
@@ -87,6 +175,16 @@ void PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read,
         std::ostream &samFile, AlignmentContext &context, 
         SupplementalQVList & qvList, Clipping clipping = none,
         bool cigarUseSeqMatch = false); 
+
+//
+// Append a record to samBuffer, which the caller flushes.  The read is
+// reverse complemented as it is written, and is not modified.
+//
+template<typename T_Sequence>
+void PrintAlignment(T_AlignmentCandidate &alignment, T_Sequence &read,
+        OutputBuffer &samBuffer, AlignmentContext &context,
+        SupplementalQVList & qvList, Clipping clipping = none,
+        bool cigarUseSeqMatch = false);
 }
 
 #include "SAMPrinterImpl.hpp"
@@ -1,20 +1,21 @@
 #include <algorithm> //max
 #include <utility> //swap
 #include <assert.h> //assert
+#include <string.h> //memcpy
 
 using namespace SAMOutput; 
 
 
 template<typename T_Sequence>
-void SAMOutput::SetAlignedSequence(T_AlignmentCandidate &alignment, T_Sequence &read,
-        T_Sequence &alignedSeq,
-        Clipping clipping) {
+void SAMOutput::GetAlignedRange(T_AlignmentCandidate &alignment, T_Sequence &read,
+        Clipping clipping,
+        DNALength &clippedStartPos, DNALength &clippedReadLength) {
     //
     // In both no, and hard clipping, the dna sequence that is output
     // solely corresponds to the aligned sequence.
     //
-    DNALength clippedReadLength = 0;
-    DNALength clippedStartPos   = 0;
+    clippedReadLength = 0;
+    clippedStartPos   = 0;
 
     if (clipping == none or clipping == hard) {
         DNALength qStart = alignment.QAlignStart();
@@ -34,6 +35,14 @@ void SAMOutput::SetAlignedSequence(T_AlignmentCandidate &alignment, T_Sequence &
         std::cout <<" ERROR! The clipping must be none, hard, subread, or soft when setting the aligned sequence." << std::endl;
         assert(0);
     }
+}
+
+template<typename T_Sequence>
+void SAMOutput::SetAlignedSequence(T_AlignmentCandidate &alignment, T_Sequence &read,
+        T_Sequence &alignedSeq,
+        Clipping clipping) {
+    DNALength clippedReadLength, clippedStartPos;
+    GetAlignedRange(alignment, read, clipping, clippedStartPos, clippedReadLength);
 
     //
     // Set the aligned sequence according to the clipping boundaries.
@@ -86,37 +95,19 @@ void SAMOutput::SetHardClip(T_AlignmentCandidate &alignment,
 }
 
 
-//
-// Straight forward: create the cigar string allowing some clipping
-// The read is provided to give length and hq information.
-//
 template<typename T_Sequence>
-void SAMOutput::CreateCIGARString(T_AlignmentCandidate &alignment,
+void SAMOutput::SetClipping(T_AlignmentCandidate &alignment,
         T_Sequence &read,
-        std::string &cigarString,
         Clipping clipping,
         DNALength & prefixSoftClip, DNALength & suffixSoftClip, 
-        DNALength & prefixHardClip, DNALength & suffixHardClip,
-        bool cigarUseSeqMatch) {
-
-    cigarString = "";
-    // All cigarString use the no clipping core
-    std::vector<int> opSize;
-    std::vector<char> opChar;
-    CreateNoClippingCigarOps(alignment, opSize, opChar, cigarUseSeqMatch);
-
-    // Clipping needs to be added
+        DNALength & prefixHardClip, DNALength & suffixHardClip) {
 
+    if (clipping == none) {
+      prefixSoftClip = suffixSoftClip = 0;
+      prefixHardClip = suffixHardClip = 0;
+    }
     if (clipping == hard) {
       SetHardClip(alignment, read, prefixHardClip, suffixHardClip);
-      if (prefixHardClip > 0) {
-        opSize.insert(opSize.begin(), prefixHardClip);
-        opChar.insert(opChar.begin(), 'H');
-      }
-      if (suffixHardClip > 0) {
-        opSize.push_back(suffixHardClip);
-        opChar.push_back('H');
-      }
       prefixSoftClip = 0;
       suffixSoftClip = 0;
     }
@@ -140,35 +131,83 @@ void SAMOutput::CreateCIGARString(T_AlignmentCandidate &alignment,
         std::swap(prefixHardClip, suffixHardClip);
         std::swap(prefixSoftClip, suffixSoftClip);
       }
-
-      //
-      // Insert the hard and soft clipping so that they are in the
-      // order H then S if both exist.
-      //
-      if (prefixSoftClip > 0) {
-        opSize.insert(opSize.begin(), prefixSoftClip);
-        opChar.insert(opChar.begin(), 'S');
-      }
-      if (prefixHardClip > 0) {
-        opSize.insert(opSize.begin(), prefixHardClip);
-        opChar.insert(opChar.begin(), 'H');
-      }
-      
-      //
-      // Append the hard and soft clipping so they are in the order S
-      // then H. 
-      //
-      if (suffixSoftClip > 0) {
-        opSize.push_back(suffixSoftClip);
-        opChar.push_back('S');
-      }
-      if (suffixHardClip > 0) {
-        opSize.push_back(suffixHardClip);
-        opChar.push_back('H');
-      }
     }
+}
 
-    CigarOpsToString(opSize, opChar, cigarString);
+//
+// Straight forward: create the cigar string allowing some clipping
+// The read is provided to give length and hq information.
+//
+template<typename T_Sequence>
+void SAMOutput::CreateCIGARString(T_AlignmentCandidate &alignment,
+        T_Sequence &read,
+        std::string &cigarString,
+        Clipping clipping,
+        DNALength & prefixSoftClip, DNALength & suffixSoftClip, 
+        DNALength & prefixHardClip, DNALength & suffixHardClip,
+        bool cigarUseSeqMatch) {
+
+    // All cigarString use the no clipping core
+    OutputBuffer out;
+    CreateNoClippingCigarOps(alignment, out.opSize, out.opChar, cigarUseSeqMatch);
+    SetClipping(alignment, read, clipping, prefixSoftClip, suffixSoftClip,
+                prefixHardClip, suffixHardClip);
+    AppendCIGAR(out, out.opSize, out.opChar, prefixHardClip, prefixSoftClip,
+                suffixSoftClip, suffixHardClip);
+    cigarString.assign(out.data.empty() ? "" : &out.data[0], out.size);
+}
+
+template<typename T_Sequence>
+void SAMOutput::AppendQVOptionalFields(SupplementalQVList &qvList, T_Sequence &read,
+        DNALength start, DNALength length, int strand, OutputBuffer &out) {
+    int i;
+    DNALength p;
+    for (i = 0; i < SupplementalQVList::nqvTags; i++) {
+        if (read.GetQVPointerByIndex(i+1)->data == NULL) {
+            // mask off this quality value since it does not exist
+            qvList.useqv = qvList.useqv & ~(1 << i);
+        }
+    }
+    for (i = 0; i < SupplementalQVList::nqvTags; i++) {
+        if ((qvList.useqv & (1 << i)) == 0) {
+            continue;
+        }
+        out.Append('\t');
+        out.Append(SupplementalQVList::qvTags[i]);
+        out.Append(":Z:");
+        const unsigned char *qvs = read.GetQVPointerByIndex(i+1)->data + start;
+        char *dest = out.Reserve(length);
+        for (p = 0; p < length; p++) {
+            unsigned char qv = (strand == 0) ? qvs[p] : qvs[length - p - 1];
+            //
+            // The same conversion as QualityVectorToPrintable.
+            //
+            if (qv == MAX_STORED_QUALITY) {
+                qv = MAX_PRINTED_QUALITY;
+            }
+            if (qv == SENTINAL) {
+                qv = MAP_SENTINAL;
+            }
+            dest[p] = static_cast<char>(static_cast<uint8_t>(qv + FASTQSequence::charToQuality));
+        }
+        out.size += length;
+    }
+    Nucleotide *tags[] = {read.substitutionTag, read.deletionTag};
+    int tagIndex[] = {I_SubstitutionTag, I_DeletionTag};
+    for (i = 0; i < 2; i++) {
+        if (tags[i] == NULL or (qvList.useqv & (1 << (tagIndex[i] - 1))) == 0) {
+            continue;
+        }
+        out.Append('\t');
+        out.Append(SupplementalQVList::qvTags[tagIndex[i] - 1]);
+        out.Append(":Z:");
+        const Nucleotide *tag = tags[i] + start;
+        char *dest = out.Reserve(length);
+        for (p = 0; p < length; p++) {
+            dest[p] = (strand == 0) ? tag[p] : ReverseComplementNuc[tag[length - p - 1]];
+        }
+        out.size += length;
+    }
 }
 
 template<typename T_Sequence>
@@ -179,77 +218,87 @@ void SAMOutput::PrintAlignment(T_AlignmentCandidate &alignment,
         SupplementalQVList & qvList,
         Clipping clipping,
         bool cigarUseSeqMatch) {
+    OutputBuffer samBuffer;
+    PrintAlignment(alignment, read, samBuffer, context, qvList, clipping, cigarUseSeqMatch);
+    samBuffer.Flush(samFile);
+}
+
+template<typename T_Sequence>
+void SAMOutput::PrintAlignment(T_AlignmentCandidate &alignment,
+        T_Sequence &read,
+        OutputBuffer &samBuffer,
+        AlignmentContext &context,
+        SupplementalQVList & qvList,
+        Clipping clipping,
+        bool cigarUseSeqMatch) {
 
-    std::string cigarString;
     uint16_t flag;
-    T_Sequence alignedSequence;
     DNALength prefixSoftClip = 0, suffixSoftClip = 0;
     DNALength prefixHardClip = 0, suffixHardClip = 0;
+    DNALength alignedStart, alignedLength;
 
-    CreateCIGARString(alignment, read, cigarString, clipping, prefixSoftClip, suffixSoftClip, prefixHardClip, suffixHardClip, cigarUseSeqMatch);
-    SetAlignedSequence(alignment, read, alignedSequence, clipping);
+    CreateNoClippingCigarOps(alignment, samBuffer.opSize, samBuffer.opChar, cigarUseSeqMatch);
+    SetClipping(alignment, read, clipping, prefixSoftClip, suffixSoftClip, prefixHardClip, suffixHardClip);
+    GetAlignedRange(alignment, read, clipping, alignedStart, alignedLength);
     BuildFlag(alignment, context, flag);
-    samFile << alignment.qName << "\t" 
-            << flag << "\t" 
-            << alignment.tName << "\t";   // RNAME
+    samBuffer.Append(alignment.qName);
+    samBuffer.Append('\t');
+    samBuffer.AppendInt(flag);
+    samBuffer.Append('\t');
+    samBuffer.Append(alignment.tName); // RNAME
+    samBuffer.Append('\t');
     if (alignment.tStrand == 0) {
-      samFile << alignment.TAlignStart() + 1 << "\t"; 
       // POS, add 1 to get 1 based coordinate system
+      samBuffer.AppendInt(alignment.TAlignStart() + 1);
     }
     else {
-      samFile << alignment.tLength - (alignment.TAlignStart() + alignment.TEnd()) + 1 << "\t"; // includes - 1 for rev-comp,  +1 for one-based
+      // includes - 1 for rev-comp,  +1 for one-based
+      samBuffer.AppendInt(alignment.tLength - (alignment.TAlignStart() + alignment.TEnd()) + 1);
     }
-    samFile << (int) alignment.mapQV << "\t"// MAPQ
-            << cigarString << "\t"; // CIGAR
-      
-      //
-      // Determine RNEXT
+    samBuffer.Append('\t');
+    samBuffer.AppendInt((int) alignment.mapQV); // MAPQ
+    samBuffer.Append('\t');
+    AppendCIGAR(samBuffer, samBuffer.opSize, samBuffer.opChar, prefixHardClip,
+                prefixSoftClip, suffixSoftClip, suffixHardClip);
 
-    std::string rNext;
-    rNext = "*";
-    /*
-    if (context.hasNextSubreadPos == false) {
-      rNext = "*";
+    //
+    // RNEXT and PNEXT are not set without multiple segments, and since
+    // SAM v1.5, TLEN is 0 for a single-segment template.
+    //
+    samBuffer.Append("\t*\t0\t0\t");
+
+    //
+    // SEQ, reverse complemented in place of a copy of the read.
+    //
+    DNALength p;
+    char *dest = samBuffer.Reserve(alignedLength);
+    const Nucleotide *bases = read.seq + alignedStart;
+    if (alignment.tStrand == 0) {
+        memcpy(dest, bases, alignedLength);
     }
     else {
-      if (context.rNext == alignment.tName) {
-        rNext = "=";
-      }
-      else {
-        rNext = context.rNext;
-      }
+        for (p = 0; p < alignedLength; p++) {
+            dest[p] = ReverseComplementNuc[bases[alignedLength - p - 1]];
+        }
     }
-    */
-    samFile << rNext << "\t"; // RNEXT
-    
-    DNALength nextSubreadPos = 0;
-    /*
-    if (context.hasNextSubreadPos) {
-      nextSubreadPos = context.nextSubreadPos + 1;
-      }*/
-    samFile << nextSubreadPos << "\t"; // RNEXT, add 1 for 1 based
-                                           // indexing
-
-    //DNALength tLen = alignment.GenomicTEnd() - alignment.GenomicTBegin();
-    //SAM v1.5, tLen is set as 0 for single-segment template
-    samFile << 0 << "\t"; // TLEN
-    // Print the sequence on one line, and suppress printing the
-    // newline (by setting the line length to alignedSequence.length
-    (static_cast<DNASequence*>(&alignedSequence))->PrintSeq(samFile, 0);  // SEQ
-    samFile << "\t";
-    if (alignedSequence.qual.data != NULL && qvList.useqv == 0) {
-        alignedSequence.PrintAsciiQual(samFile, 0);  // QUAL
+    samBuffer.size += alignedLength;
+    samBuffer.Append('\t');
+    if (read.qual.data != NULL && qvList.useqv == 0) {
+        // QUAL
+        const unsigned char *qual = read.qual.data + alignedStart;
+        dest = samBuffer.Reserve(alignedLength);
+        for (p = 0; p < alignedLength; p++) {
+            unsigned char qv = (alignment.tStrand == 0) ? qual[p] : qual[alignedLength - p - 1];
+            dest[p] = static_cast<char>(static_cast<uint8_t>(qv + FASTQSequence::charToQuality));
+        }
+        samBuffer.size += alignedLength;
     }
     else {
-      samFile <<"*";
+        samBuffer.Append('*');
     }
-    samFile << "\t";
+    samBuffer.Append('\t');
     //
     // Add optional fields
-    //
-    samFile << "RG:Z:" << context.readGroupId << "\t";
-    samFile << "AS:i:" << alignment.score << "\t";
-
     //
     // "RG" read group Id
     // "AS" alignment score
@@ -261,13 +310,19 @@ void SAMOutput::PrintAlignment(T_AlignmentCandidate &alignment,
     // "NM" edit distance 
     // "FI" read alignment start position (1 based) 
     //
-    
+    samBuffer.Append("RG:Z:");
+    samBuffer.Append(context.readGroupId);
+    samBuffer.Append("\tAS:i:");
+    samBuffer.AppendInt(alignment.score);
+
     DNALength qAlignStart = alignment.QAlignStart();
     DNALength qAlignEnd = alignment.QAlignEnd();
 
     if (clipping == none) {
-      samFile << "XS:i:" << qAlignStart + 1 << "\t";
-      samFile << "XE:i:" << qAlignEnd + 1 << "\t";
+      samBuffer.Append("\tXS:i:");
+      samBuffer.AppendInt(qAlignStart + 1);
+      samBuffer.Append("\tXE:i:");
+      samBuffer.AppendInt(qAlignEnd + 1);
     }
     else if (clipping == hard or clipping == soft or clipping == subread) {
         DNALength xs = prefixHardClip;
@@ -276,29 +331,35 @@ void SAMOutput::PrintAlignment(T_AlignmentCandidate &alignment,
             xs = suffixHardClip;
             xe = read.length - prefixHardClip;
         }
-        samFile << "XS:i:" << xs + 1 << "\t"; // add 1 for 1-based indexing in sam
-        assert(read.length - suffixHardClip == prefixHardClip + alignedSequence.length);
-        samFile << "XE:i:" << xe + 1 << "\t";
+        assert(read.length - suffixHardClip == prefixHardClip + alignedLength);
+        samBuffer.Append("\tXS:i:");
+        samBuffer.AppendInt(xs + 1); // add 1 for 1-based indexing in sam
+        samBuffer.Append("\tXE:i:");
+        samBuffer.AppendInt(xe + 1);
     }
-    samFile << "YS:i:" << read.subreadStart << "\t";
-    samFile << "YE:i:" << read.subreadEnd << "\t";
-    samFile << "ZM:i:" << read.zmwData.holeNumber << "\t";
-    samFile << "XL:i:" << alignment.qAlignedSeq.length << "\t";
-    samFile << "XT:i:1\t"; // reads are allways continuous reads, not
-                        // referenced based circular consensus when
-                        // output by blasr.
-    samFile << "NM:i:" << context.editDist << "\t";
-    samFile << "FI:i:" << alignment.qAlignedSeqPos + 1;
+    samBuffer.Append("\tYS:i:");
+    samBuffer.AppendInt(read.subreadStart);
+    samBuffer.Append("\tYE:i:");
+    samBuffer.AppendInt(read.subreadEnd);
+    samBuffer.Append("\tZM:i:");
+    samBuffer.AppendInt(read.zmwData.holeNumber);
+    samBuffer.Append("\tXL:i:");
+    samBuffer.AppendInt(alignment.qAlignedSeq.length);
+    // reads are allways continuous reads, not referenced based circular
+    // consensus when output by blasr.
+    samBuffer.Append("\tXT:i:1\tNM:i:");
+    samBuffer.AppendInt(context.editDist);
+    samBuffer.Append("\tFI:i:");
+    samBuffer.AppendInt(alignment.qAlignedSeqPos + 1);
     // Add query sequence length
-    samFile << "\t" << "XQ:i:" << alignment.qLength;
+    samBuffer.Append("\tXQ:i:");
+    samBuffer.AppendInt(alignment.qLength);
 
     //
-	// Write out optional quality values.  If qvlist does not 
-	// have any qv's signaled to print, this is a no-op.
-	//
-	// First transform characters that are too large to printable ones.
-	qvList.FormatQVOptionalFields(alignedSequence);
-	qvList.PrintQVOptionalFields(alignedSequence, samFile);
+    // Write out optional quality values.  If qvlist does not 
+    // have any qv's signaled to print, this is a no-op.
+    //
+    AppendQVOptionalFields(qvList, read, alignedStart, alignedLength, alignment.tStrand, samBuffer);
 
-    samFile << std::endl;
+    samBuffer.Append('\n');
 }
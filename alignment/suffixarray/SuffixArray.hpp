@@ -3,8 +3,14 @@
 
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <string>
 #include <vector>
 #include "LCPTable.hpp"
@@ -56,30 +62,107 @@ public:
 
 typedef uint32_t SAIndex;
 typedef uint32_t SAIndexLength;
+typedef uint64_t SAIndex64;
+
+//
+// Version 2 of the .sa file is laid out so that it may be mapped
+// read-only and used in place.  After the magic number comes this
+// header, and then each component starts on a page boundary:
+//
+//   magic | header | pad | index | pad | startPosTable | pad | endPosTable
+//
+// Offsets are from the start of the file.  Components that are not
+// present have an offset of 0.
+//
+static const unsigned int SuffixArrayMappedMagicNumber = 0xacac0002;
+static const uint64_t SuffixArrayMappedAlignment = 4096;
+
+class SuffixArrayMappedHeader {
+public:
+    uint32_t version;
+    uint32_t indexWordSize;
+    int32_t  componentList[2];
+    uint64_t length;
+    uint64_t lookupTableLength;
+    uint64_t lookupPrefixLength;
+    uint64_t indexOffset;
+    uint64_t startPosTableOffset;
+    uint64_t endPosTableOffset;
+    uint64_t fileLength;
+};
+
+//
+// Software prefetch used by the batched searches.  Compilers without
+// the builtin simply do not prefetch.
+//
+#if defined(__GNUC__)
+#define SUFFIX_ARRAY_PREFETCH(addr) __builtin_prefetch((const void*) (addr))
+#else
+#define SUFFIX_ARRAY_PREFETCH(addr)
+#endif
+
+//
+// The number of queries whose searches are interleaved by
+// BatchStoreLCPBounds.  This should be enough that the prefetches
+// issued for one query have arrived by the time the search returns to
+// it.
+//
+static const int SuffixArrayDefaultSearchBatchSize = 32;
+
+//
+// The state of one query's LCP search in BatchStoreLCPBounds.  The
+// query is in the middle of a left or right bound binary search over
+// [lo, hi), and m is the suffix array position it will compare next.
+//
+template<typename Index>
+class SuffixArrayLCPSearchState {
+public:
+    enum Phase { LeftBound, RightBound, Done };
+    int query;
+    Phase phase;
+    long l, r;
+    long lo, hi, m;
+    DNALength lcpLength;
+};
 
+//
+// Index is the type of the positions stored in the suffix array and
+// the lookup tables.  The 32-bit SAIndex is the default; SAIndex64 is
+// used for texts of 4 Gbp or more.  Only the version 2 (mappable)
+// layout may be used to store a suffix array with a 64-bit index.
+//
 template<typename T, 
     typename Sigma,
     typename Compare = DefaultCompareStrings<T>,
-    typename Tuple   = DNATuple >
+    typename Tuple   = DNATuple,
+    typename Index   = SAIndex >
 class SuffixArray {
 public:
-    SAIndex *index;
+    Index *index;
     bool deleteStructures;
     T*  target;
-    SAIndex length;
-    SAIndex *startPosTable, *endPosTable;
+    Index length;
+    Index *startPosTable, *endPosTable;
     SAIndexLength lookupTableLength;
     SAIndex lookupPrefixLength;
     TupleMetrics tm;
     unsigned int magicNumber;
     unsigned int ckMagicNumber;
     typedef Compare CompareType;
+    typedef Index IndexType;
+    typedef T CharType;
     enum Component { CompArray, CompLookupTable, CompLCPTable};
     static const int ComponentListLength = 2;
     static const int FullSearch = -1;
     int componentList[ComponentListLength];
+    //
+    // When the suffix array is loaded with MapRead, index and the
+    // lookup tables point into this read-only mapping of the file.
+    //
+    char *mappedFile;
+    size_t mappedFileLength;
 
-    // vector<SAIndex> leftBound, rightBound;
+    // vector<Index> leftBound, rightBound;
 
     inline	int LengthLongestCommonPrefix(T *a, int alen, T *b, int blen) {
         int i;
@@ -106,8 +189,11 @@ public:
         // Must create a suffix array, but for now make it null.
         target = NULL;
         index = NULL;
+        mappedFile = NULL;
+        mappedFileLength = 0;
     }
     ~SuffixArray() {
+        UnmapFile();
         if (deleteStructures == false) {
             //
             // It is possible this class is referencing another structrue. In
@@ -166,7 +252,7 @@ public:
     void PrintSuffices(T *target, int targetLength, int maxPrintLength) {
         std::string seq;
         seq.resize(maxPrintLength+1);
-        SAIndex i, s;
+        Index i, s;
         seq[maxPrintLength] = '\0';
         for (i = 0; i < length; i++) {
             DNALength suffixLength = maxPrintLength;
@@ -183,34 +269,34 @@ public:
         }
     }
 
-    void BuildLookupTable(T *target, SAIndexLength targetLength, int prefixLengthP) { 
+    void BuildLookupTable(T *target, Index targetLength, int prefixLengthP) { 
 
         //
         // pprefixLength is the length used to lookup the index boundaries
         // given a string.
         //
 
-        SAIndexLength i;
+        Index i;
         tm.tupleSize = lookupPrefixLength = prefixLengthP;
         tm.InitializeMask();
         lookupTableLength = 1 << (2*lookupPrefixLength);
 
         if (startPosTable) {delete [] startPosTable;}
-        startPosTable = ProtectedNew<SAIndex>(lookupTableLength);
+        startPosTable = ProtectedNew<Index>(lookupTableLength);
 
         if (endPosTable) {delete [] endPosTable;}
-        endPosTable   = ProtectedNew<SAIndex>(lookupTableLength);
+        endPosTable   = ProtectedNew<Index>(lookupTableLength);
         deleteStructures = true;
 
         Tuple curPrefix, nextPrefix;
-        SAIndex tablePrefixIndex = 0;
+        Index tablePrefixIndex = 0;
 
         for (i = 0; i < lookupTableLength; i++) {
             startPosTable[i] = endPosTable[i] = 0;
         }
         i = 0;
         VectorIndex tablePos;
-        SAIndex     indexPos;
+        Index     indexPos;
         indexPos = 0;
         do {
             // Advance to the first position that may be translated into a tuple.
@@ -247,47 +333,57 @@ public:
                (uint32_t(curPrefix.tuple) < uint32_t(lookupTableLength - 1)));
     }
 
-    void AllocateSuffixArray(SAIndexLength stringLength) {
+    void AllocateSuffixArray(Index stringLength) {
         assert(index == NULL or not deleteStructures);
-        index = ProtectedNew<SAIndex>(stringLength + 1);
+        index = ProtectedNew<Index>(stringLength + 1);
         deleteStructures = true;
         length = stringLength;
     }
 
-    void LarssonBuildSuffixArray(T* target, SAIndexLength targetLength, Sigma &alphabet) {
+    void LarssonBuildSuffixArray(T* target, Index targetLength, Sigma &alphabet) {
         assert(index == NULL or not deleteStructures);
-        index =  ProtectedNew<SAIndex>(targetLength+1);
+        index =  ProtectedNew<Index>(targetLength+1);
         deleteStructures = true;
-        SAIndex *p = ProtectedNew<SAIndex>(targetLength+1);
-        SAIndexLength i;
+        Index *p = ProtectedNew<Index>(targetLength+1);
+        Index i;
         for (i = 0; i < targetLength; i++) { index[i] = target[i] + 1;}
-        SAIndexLength maxVal = 0;
+        Index maxVal = 0;
         for (i = 0; i < targetLength; i++) { maxVal = index[i] > maxVal ?  index[i] : maxVal;}
         index[targetLength] = 0;
-        LarssonSuffixSort<SAIndex, UINT_MAX> sorter;
-        sorter(index, p, ((SAIndex) targetLength), ((SAIndex) maxVal+1), (SAIndex) 1 );
+        LarssonSuffixSort<Index, (sizeof(Index) < sizeof(long) ? 
+                                  (long) std::numeric_limits<Index>::max() : LONG_MAX)> sorter;
+        sorter(index, p, ((Index) targetLength), ((Index) maxVal+1), (Index) 1 );
         for (i = 0; i < targetLength; i++ ){ index[i] = p[i+1];};
         length = targetLength;
         delete[] p;
     }
 
-    void LightweightBuildSuffixArray(T*target, SAIndexLength targetLength, int diffCoverSize=2281) {
+    void LightweightBuildSuffixArray(T*target, Index targetLength, int diffCoverSize=2281, int nProc=1) {
         assert(index == NULL or not deleteStructures);
-        index = ProtectedNew<SAIndex>(targetLength+1);
+        if (sizeof(Index) != sizeof(UInt)) {
+            //
+            // The difference cover sort is written for 32-bit
+            // indices, so build wide suffix arrays with qsufsort.
+            //
+            Sigma alphabet;
+            LarssonBuildSuffixArray(target, targetLength, alphabet);
+            return;
+        }
+        index = ProtectedNew<Index>(targetLength+1);
         deleteStructures = true;
         length = targetLength;
         DNALength pos;
         for (pos = 0; pos < targetLength; pos++) {
             target[pos]++;
         }
-        LightweightSuffixSort(target, targetLength, index, diffCoverSize);
+        LightweightSuffixSort(target, targetLength, (UInt*) index, diffCoverSize, nProc);
         for (pos = 0; pos < targetLength; pos++) {
             target[pos]--;
         }
 
     }
 
-    void MMBuildSuffixArray(T* target, SAIndexLength targetLength, Sigma &alphabet) {
+    void MMBuildSuffixArray(T* target, Index targetLength, Sigma &alphabet) {
         /*
          * Manber and Myers suffix array construction.
          */
@@ -308,21 +404,21 @@ public:
         std::fill(b2h.begin(), b2h.end(), false);
         std::fill(count.begin(), count.end(), 0);
         assert(index == NULL or not deleteStructures);
-        index = ProtectedNew<SAIndex>(targetLength);
-        //index = new SAIndex[targetLength];
+        index = ProtectedNew<Index>(targetLength);
+        //index = new Index[targetLength];
         deleteStructures = true;
         for (a = 0; a < alphabet.size(); a++ ) {
             bucket[a] = -1;
         }
 
-        SAIndexLength i;
+        Index i;
         for (i = 0; i < targetLength; i++) {
             index[i] = bucket[target[i]];
             bucket[target[i]] = i;
         }
 
         int j;
-        SAIndex c;
+        Index c;
         std::fill(prm.begin(), prm.end(), -1);
         //
         // Prepare the buckets.
@@ -350,9 +446,9 @@ public:
             index[prm[i]] = i;
         }
 
-        SAIndex h;
+        Index h;
         h = 1;
-        SAIndex l, r;
+        Index l, r;
 
         while (h < targetLength) {
             // re-order the buckets;
@@ -371,8 +467,8 @@ public:
                 }
             }
 
-            SAIndex d = targetLength - h;
-            SAIndex e = prm[d]; 
+            Index d = targetLength - h;
+            Index e = prm[d]; 
 
             /*
              * Phase 1: Set up the buckets in the index and bh list.
@@ -381,7 +477,7 @@ public:
             //
             // suffix d needs to be moved to the front of it's bucket.
             // d should exist in the bucket starting at prm[d]
-            SAIndex i;
+            Index i;
 
             l = 0;
             r = 1;
@@ -441,7 +537,7 @@ public:
                             }
 
                             e = j;
-                            SAIndex f;
+                            Index f;
                             for (f = prm[d] + 1; f <= e - 1; f++) { 
                                 b2h[f] = false;
                             }
@@ -464,13 +560,13 @@ public:
         }
     }
 
-    void BuildSuffixArray(T* target, SAIndex targetLength, Sigma &alphabet) {
+    void BuildSuffixArray(T* target, Index targetLength, Sigma &alphabet) {
         length = targetLength;
         assert(index == NULL or not deleteStructures);
-        index  = ProtectedNew<SAIndex>(length);
+        index  = ProtectedNew<Index>(length);
         deleteStructures = true;
         CompareSuffixes<T*> cmp(target, length);
-        SAIndex i;
+        Index i;
         for (i = 0; i < length; i++ ){ 
             index[i] = i;
         }
@@ -486,8 +582,8 @@ public:
 
         out.write((char*) &lookupTableLength, sizeof(SAIndex));
         out.write((char*) &lookupPrefixLength, sizeof(SAIndex));
-        out.write((char*) startPosTable, sizeof(SAIndex) * (lookupTableLength));
-        out.write((char*) endPosTable, sizeof(SAIndex) * (lookupTableLength));
+        out.write((char*) startPosTable, sizeof(Index) * (lookupTableLength));
+        out.write((char*) endPosTable, sizeof(Index) * (lookupTableLength));
     }
 
     void WriteComponentList(std::ofstream &out) {
@@ -521,6 +617,10 @@ public:
         //   2 - The components.
         //
         // 
+        if (HasLegacyLayout() == false) {
+            WriteMappable(outFileName);
+            return;
+        }
         std::ofstream suffixArrayOut;
         suffixArrayOut.open(outFileName.c_str(), std::ios::binary);
         if (!suffixArrayOut.good()) {
@@ -540,6 +640,13 @@ public:
         }
         suffixArrayOut.close();
     }
+    //
+    // The original .sa layout stores 32-bit positions only.
+    //
+    static bool HasLegacyLayout() {
+        return sizeof(Index) == sizeof(int);
+    }
+
     void WriteMagicNumber(std::ofstream &out) {
         out.write((char*) &magicNumber, sizeof(int));
     }
@@ -571,7 +678,7 @@ public:
     void ReadArray(std::ifstream &in) {
         in.read((char*) &length, sizeof(int));
         assert(index == NULL or not deleteStructures);
-        index = ProtectedNew<SAIndex>(length);
+        index = ProtectedNew<Index>(length);
         deleteStructures = true;
         ReadAllocatedArray(in);
     }
@@ -591,8 +698,8 @@ public:
         tm.Initialize(lookupPrefixLength);
         assert(startPosTable == NULL or not deleteStructures);
         assert(endPosTable == NULL or not deleteStructures);
-        startPosTable = ProtectedNew<SAIndex>(lookupTableLength);
-        endPosTable   = ProtectedNew<SAIndex>(lookupTableLength);
+        startPosTable = ProtectedNew<Index>(lookupTableLength);
+        endPosTable   = ProtectedNew<Index>(lookupTableLength);
         deleteStructures = true;
         ReadAllocatedLookupTable(in);
     }
@@ -607,7 +714,12 @@ public:
         saIn.open(inFileName.c_str(), std::ios::binary);
         int hasMagicNumber;
         hasMagicNumber = ReadMagicNumber(saIn);
-        if (hasMagicNumber == 1) {
+        if (ckMagicNumber == SuffixArrayMappedMagicNumber) {
+            bool success = ReadMappedLayout(saIn, false);
+            saIn.close();
+            return success;
+        }
+        if (hasMagicNumber == 1 and HasLegacyLayout()) {
             ReadComponentList(saIn);
             LightReadArray(saIn);
             ReadLookupTable(saIn);
@@ -625,7 +737,12 @@ public:
         saIn.open(inFileName.c_str(), std::ios::binary);
         int hasMagicNumber;
         hasMagicNumber = ReadMagicNumber(saIn);
-        if (hasMagicNumber == 1) {
+        if (ckMagicNumber == SuffixArrayMappedMagicNumber) {
+            bool success = ReadMappedLayout(saIn, true);
+            saIn.close();
+            return success;
+        }
+        if (hasMagicNumber == 1 and HasLegacyLayout()) {
             ReadComponentList(saIn);
             if (componentList[CompArray]) {
                 ReadArray(saIn);
@@ -642,13 +759,272 @@ public:
         }
     }
 
-    int SearchLCP(T* target, T* query, DNALength queryLength, SAIndex &low, SAIndex &high, DNALength &lcpLength, DNALength maxlcp) {
+    static uint64_t AlignMappedOffset(uint64_t offset) {
+        return ((offset + SuffixArrayMappedAlignment - 1) / 
+                SuffixArrayMappedAlignment) * SuffixArrayMappedAlignment;
+    }
+
+    void WritePadding(std::ofstream &out, uint64_t toOffset) {
+        uint64_t pos = out.tellp();
+        for (; pos < toOffset; pos++) {
+            out.put('\0');
+        }
+    }
+
+    void FillMappedHeader(SuffixArrayMappedHeader &header) {
+        memset(&header, 0, sizeof(header));
+        header.version       = 1;
+        header.indexWordSize = sizeof(Index);
+        header.componentList[CompArray]       = (index != NULL);
+        header.componentList[CompLookupTable] = (startPosTable != NULL);
+        header.length             = length;
+        header.lookupTableLength  = lookupTableLength;
+        header.lookupPrefixLength = lookupPrefixLength;
+        uint64_t offset = sizeof(unsigned int) + sizeof(header);
+        if (header.componentList[CompArray]) {
+            header.indexOffset = AlignMappedOffset(offset);
+            offset = header.indexOffset + sizeof(Index) * header.length;
+        }
+        if (header.componentList[CompLookupTable]) {
+            header.startPosTableOffset = AlignMappedOffset(offset);
+            offset = header.startPosTableOffset + sizeof(Index) * header.lookupTableLength;
+            header.endPosTableOffset   = AlignMappedOffset(offset);
+            offset = header.endPosTableOffset + sizeof(Index) * header.lookupTableLength;
+        }
+        header.fileLength = offset;
+    }
+
+    //
+    // Write the suffix array in the version 2 layout, which may be
+    // loaded either with Read (copying) or MapRead (in place).
+    //
+    void WriteMappable(std::string &outFileName) {
+        std::ofstream suffixArrayOut;
+        suffixArrayOut.open(outFileName.c_str(), std::ios::binary);
+        if (!suffixArrayOut.good()) {
+            std::cout << "Could not open " << outFileName << std::endl;
+            exit(1);
+        }
+        SuffixArrayMappedHeader header;
+        FillMappedHeader(header);
+        unsigned int mappedMagicNumber = SuffixArrayMappedMagicNumber;
+        suffixArrayOut.write((char*) &mappedMagicNumber, sizeof(unsigned int));
+        suffixArrayOut.write((char*) &header, sizeof(header));
+        if (header.componentList[CompArray]) {
+            WritePadding(suffixArrayOut, header.indexOffset);
+            suffixArrayOut.write((char*) index, sizeof(Index) * header.length);
+        }
+        if (header.componentList[CompLookupTable]) {
+            WritePadding(suffixArrayOut, header.startPosTableOffset);
+            suffixArrayOut.write((char*) startPosTable, sizeof(Index) * header.lookupTableLength);
+            WritePadding(suffixArrayOut, header.endPosTableOffset);
+            suffixArrayOut.write((char*) endPosTable, sizeof(Index) * header.lookupTableLength);
+        }
+        suffixArrayOut.close();
+    }
+
+    bool ReadMappedHeader(std::ifstream &in, SuffixArrayMappedHeader &header) {
+        in.read((char*) &header, sizeof(header));
+        if (!in.good() or header.indexWordSize != sizeof(Index)) {
+            return false;
+        }
+        return true;
+    }
+
+    //
+    // Read a version 2 file into heap memory.  The magic number has
+    // already been consumed.  When readArray is false only the lookup
+    // table is loaded, as in LightRead.
+    //
+    bool ReadMappedLayout(std::ifstream &in, bool readArray) {
+        SuffixArrayMappedHeader header;
+        if (ReadMappedHeader(in, header) == false) {
+            return false;
+        }
+        componentList[CompArray]       = header.componentList[CompArray];
+        componentList[CompLookupTable] = header.componentList[CompLookupTable];
+        length = header.length;
+        if (readArray and componentList[CompArray]) {
+            assert(index == NULL or not deleteStructures);
+            index = ProtectedNew<Index>(length);
+            deleteStructures = true;
+            in.seekg(header.indexOffset, std::ios_base::beg);
+            in.read((char*) index, sizeof(Index) * length);
+        }
+        if (componentList[CompLookupTable]) {
+            lookupTableLength  = header.lookupTableLength;
+            lookupPrefixLength = header.lookupPrefixLength;
+            tm.Initialize(lookupPrefixLength);
+            assert(startPosTable == NULL or not deleteStructures);
+            assert(endPosTable == NULL or not deleteStructures);
+            startPosTable = ProtectedNew<Index>(lookupTableLength);
+            endPosTable   = ProtectedNew<Index>(lookupTableLength);
+            deleteStructures = true;
+            in.seekg(header.startPosTableOffset, std::ios_base::beg);
+            in.read((char*) startPosTable, sizeof(Index) * lookupTableLength);
+            in.seekg(header.endPosTableOffset, std::ios_base::beg);
+            in.read((char*) endPosTable, sizeof(Index) * lookupTableLength);
+        }
+        return in.good();
+    }
+
+    //
+    // Map the suffix array file read-only and use the index and lookup
+    // tables in place, without copying them to the heap.  Because the
+    // mapping is shared, all processes on a host that map the same file
+    // share one copy in the page cache.  Both the version 2 layout and
+    // the original layout (whose components are 4-byte aligned) may be
+    // mapped.  The mapped arrays must not be modified.
+    //
+    bool MapRead(std::string &inFileName) {
+        int fd = open(inFileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 or 
+            (uint64_t) fileStat.st_size < sizeof(unsigned int) + sizeof(int) * ComponentListLength) {
+            close(fd);
+            return false;
+        }
+        size_t fileLength = fileStat.st_size;
+        void *mapped = mmap(NULL, fileLength, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        assert(index == NULL or not deleteStructures);
+        UnmapFile();
+        mappedFile = (char*) mapped;
+        mappedFileLength = fileLength;
+
+        bool success;
+        memcpy(&ckMagicNumber, mappedFile, sizeof(unsigned int));
+        if (ckMagicNumber == SuffixArrayMappedMagicNumber) {
+            success = MapVersion2Layout();
+        }
+        else if (ckMagicNumber == magicNumber and HasLegacyLayout()) {
+            success = MapVersion1Layout();
+        }
+        else {
+            success = false;
+        }
+        if (success == false) {
+            UnmapFile();
+            index = NULL;
+            startPosTable = endPosTable = NULL;
+            return false;
+        }
+        //
+        // Lookups in the suffix array are binary searches, so do not
+        // let the kernel read ahead on a fault.
+        //
+        madvise(mappedFile, mappedFileLength, MADV_RANDOM);
+        deleteStructures = false;
+        if (startPosTable != NULL) {
+            tm.Initialize(lookupPrefixLength);
+        }
+        return true;
+    }
+
+    bool MapVersion2Layout() {
+        SuffixArrayMappedHeader header;
+        if (mappedFileLength < sizeof(unsigned int) + sizeof(header)) {
+            return false;
+        }
+        memcpy(&header, mappedFile + sizeof(unsigned int), sizeof(header));
+        if (header.indexWordSize != sizeof(Index) or 
+            header.fileLength > mappedFileLength) {
+            return false;
+        }
+        componentList[CompArray]       = header.componentList[CompArray];
+        componentList[CompLookupTable] = header.componentList[CompLookupTable];
+        length = header.length;
+        index  = NULL;
+        startPosTable = endPosTable = NULL;
+        //
+        // A truncated or corrupt file must not place a section outside
+        // the mapping.
+        //
+        if (componentList[CompArray] and 
+            MappedSectionFits(header.indexOffset, header.length) == false) {
+            return false;
+        }
+        if (componentList[CompLookupTable] and
+            (header.lookupPrefixLength > 16 or 
+             header.lookupTableLength != (uint64_t(1) << (2*header.lookupPrefixLength)) or
+             MappedSectionFits(header.startPosTableOffset, header.lookupTableLength) == false or
+             MappedSectionFits(header.endPosTableOffset, header.lookupTableLength) == false)) {
+            return false;
+        }
+        if (componentList[CompArray]) {
+            index = (Index*) (mappedFile + header.indexOffset);
+        }
+        if (componentList[CompLookupTable]) {
+            lookupTableLength  = header.lookupTableLength;
+            lookupPrefixLength = header.lookupPrefixLength;
+            startPosTable = (Index*) (mappedFile + header.startPosTableOffset);
+            endPosTable   = (Index*) (mappedFile + header.endPosTableOffset);
+        }
+        return true;
+    }
+
+    //
+    // True when nElem Index values at offset lie inside the mapped file
+    // and are aligned for Index.
+    //
+    bool MappedSectionFits(uint64_t offset, uint64_t nElem) {
+        return (offset % sizeof(Index) == 0 and
+                offset <= mappedFileLength and
+                nElem <= (mappedFileLength - offset) / sizeof(Index));
+    }
+
+    bool MapVersion1Layout() {
+        uint64_t offset = sizeof(unsigned int);
+        memcpy(componentList, mappedFile + offset, sizeof(int) * ComponentListLength);
+        offset += sizeof(int) * ComponentListLength;
+        index  = NULL;
+        startPosTable = endPosTable = NULL;
+        if (componentList[CompArray]) {
+            if (offset + sizeof(int) > mappedFileLength) {
+                return false;
+            }
+            memcpy(&length, mappedFile + offset, sizeof(int));
+            offset += sizeof(int);
+            index   = (Index*) (mappedFile + offset);
+            offset += sizeof(int) * (uint64_t) length;
+        }
+        if (componentList[CompLookupTable]) {
+            if (offset + 2 * sizeof(int) > mappedFileLength) {
+                return false;
+            }
+            memcpy(&lookupTableLength, mappedFile + offset, sizeof(int));
+            memcpy(&lookupPrefixLength, mappedFile + offset + sizeof(int), sizeof(int));
+            offset += 2 * sizeof(int);
+            startPosTable = (Index*) (mappedFile + offset);
+            offset += sizeof(int) * (uint64_t) lookupTableLength;
+            endPosTable   = (Index*) (mappedFile + offset);
+            offset += sizeof(int) * (uint64_t) lookupTableLength;
+        }
+        return offset <= mappedFileLength;
+    }
+
+    void UnmapFile() {
+        if (mappedFile != NULL) {
+            munmap(mappedFile, mappedFileLength);
+            mappedFile = NULL;
+            mappedFileLength = 0;
+        }
+    }
+
+    int SearchLCP(T* target, T* query, DNALength queryLength, Index &low, Index &high, DNALength &lcpLength, DNALength maxlcp) {
         //		cout << "searching lcp with query of length: " << queryLength << endl;
         lcpLength = 0;
         if (startPosTable != NULL and
                 queryLength >= lookupPrefixLength) {
             Tuple lookupTuple;
-            int left, right;
+            Index left, right;
             // just in case this was changed.
             lookupTuple.FromStringLR(query, tm);
             left  = startPosTable[lookupTuple.tuple];
@@ -674,8 +1050,8 @@ public:
             low = 0; high = length - 1;
             lcpLength = 0;
         }		
-        int prevLow = low;
-        int prevHigh = high;
+        Index prevLow = low;
+        Index prevHigh = high;
         int prevLCPLength = lcpLength - 1;
 
         // When the boundaries and the string share a prefix, it is not necessary
@@ -721,7 +1097,7 @@ public:
         return lcpLength;
     }
 
-    int Search(T* target, T* query, DNALength queryLength, SAIndex left, SAIndex right, SAIndex &low, SAIndex &high, unsigned int offset=0) {
+    int Search(T* target, T* query, DNALength queryLength, Index left, Index right, Index &low, Index &high, unsigned int offset=0) {
         if (offset >= queryLength) {
             return high - low;
         }
@@ -730,10 +1106,10 @@ public:
         return high - low;
     }
 
-    int Search(T* target, T* query, DNALength queryLength, SAIndex &low, SAIndex &high, int offset = 0) {
+    int Search(T* target, T* query, DNALength queryLength, Index &low, Index &high, int offset = 0) {
 
-        int left = 0;
-        int right = length - 1;
+        Index left = 0;
+        Index right = length - 1;
         //
         // Constrain the lookup if a lookup table exists.
         //
@@ -844,7 +1220,7 @@ public:
      * between the read and the genome.
      */
 
-    int SearchLCPBounds(T*target, long targetLength, T*query, DNALength queryLength, SAIndex &l, SAIndex &r, DNALength &refOffset, DNALength &queryOffset) {
+    int SearchLCPBounds(T*target, long targetLength, T*query, DNALength queryLength, Index &l, Index &r, DNALength &refOffset, DNALength &queryOffset) {
         //	 l = 0; r = targetLength;
         for (; refOffset < targetLength and  queryOffset < queryLength and l < r; queryOffset++, refOffset++) {
             std::cout << "bounds: " << l << ", " << r << std::endl;
@@ -875,7 +1251,7 @@ public:
 
     int StoreLCPBounds(T *target, long targetLength,
             T *query,  long queryLength,
-            SAIndex &low, SAIndex &high) {
+            Index &low, Index &high) {
 
         DNALength targetOffset = 0;
         DNALength queryOffset  = 0;
@@ -910,7 +1286,7 @@ public:
 
     }
 
-    int CountNumBranches(T* target, DNALength targetLength, DNALength targetOffset, SAIndex low, SAIndex high) {
+    int CountNumBranches(T* target, DNALength targetLength, DNALength targetOffset, Index low, Index high) {
         //
         // look to see how many different characters start suffices between
         // low and high at targetOffset
@@ -936,7 +1312,7 @@ public:
             // 'targetOffset' bases into the suffix as the first suffix in
             // the band given to this function.
             //
-            SAIndex curCharHigh = high;
+            Index curCharHigh = high;
             curCharHigh = SearchRightBound(target, targetLength, targetOffset, target[index[low]+targetOffset], low, high);
             if (curCharHigh != high) {
                 ++numBranches;
@@ -952,7 +1328,7 @@ public:
             bool useLookupTable,  // Should the indices of the first k bases be determined by a lookup table?
             int  maxMatchLength,  // Stop extending match at lcp length = maxMatchLength,
             // Vectors containing lcpLeft and lcpRight from 0 ... lcpLength.
-            std::vector<SAIndex> &lcpLeftBounds, std::vector<SAIndex> &lcpRightBounds,
+            std::vector<Index> &lcpLeftBounds, std::vector<Index> &lcpRightBounds,
             bool stopOnceUnique=false) {
 
         //
@@ -1090,10 +1466,236 @@ public:
     }
 
 
-    int SearchLow(T *target, T *query, DNALength queryLength, SAIndex l, SAIndex r, SAIndex &low, unsigned int offset=0) {
+    //
+    // Run StoreLCPBounds for many queries at once.  The binary searches
+    // of up to batchSize queries advance in lock step: in each round the
+    // text at every query's next suffix is prefetched, then every query
+    // makes its comparison and prefetches the suffix array entry for
+    // its following step.  The cache misses of different queries
+    // therefore overlap instead of being taken one at a time.
+    //
+    // The results for queries[i] are identical to calling
+    // StoreLCPBounds on it alone: lcpLengths[i] is the return value and
+    // lcpLeftBounds[i], lcpRightBounds[i] are the stored bounds.  The
+    // bound vectors are cleared before they are filled, so they may be
+    // reused between calls.
+    //
+    void BatchStoreLCPBounds(T *target, long targetLength,
+            std::vector<T*> &queries, std::vector<DNALength> &queryLengths,
+            bool useLookupTable, int maxMatchLength,
+            std::vector<std::vector<Index> > &lcpLeftBounds,
+            std::vector<std::vector<Index> > &lcpRightBounds,
+            std::vector<DNALength> &lcpLengths,
+            bool stopOnceUnique=false,
+            int batchSize=SuffixArrayDefaultSearchBatchSize) {
+
+        typedef SuffixArrayLCPSearchState<Index> State;
+        assert(queries.size() == queryLengths.size());
+        int nQueries = queries.size();
+        lcpLeftBounds.resize(nQueries);
+        lcpRightBounds.resize(nQueries);
+        lcpLengths.resize(nQueries);
+        if (batchSize < 1) {
+            batchSize = 1;
+        }
+        std::vector<State> batch(std::min(batchSize, nQueries));
+        int nextQuery = 0;
+        int nActive = 0;
+        int b;
+        for (b = 0; b < (int) batch.size(); b++) {
+            nextQuery = StartLCPSearch(batch[b], nextQuery, target, targetLength,
+                    queries, queryLengths, useLookupTable, maxMatchLength,
+                    stopOnceUnique, lcpLeftBounds, lcpRightBounds, lcpLengths);
+            if (batch[b].phase != State::Done) {
+                nActive++;
+            }
+        }
+        while (nActive > 0) {
+            for (b = 0; b < (int) batch.size(); b++) {
+                State &s = batch[b];
+                if (s.phase != State::Done and
+                        targetLength - (long) index[s.m] > (long) s.lcpLength) {
+                    SUFFIX_ARRAY_PREFETCH(&target[index[s.m] + s.lcpLength]);
+                }
+            }
+            for (b = 0; b < (int) batch.size(); b++) {
+                State &s = batch[b];
+                if (s.phase == State::Done) {
+                    continue;
+                }
+                T *query = queries[s.query];
+                long targetSufLen = targetLength - index[s.m];
+                if (s.phase == State::LeftBound) {
+                    if (targetSufLen <= s.lcpLength or
+                            Compare::Compare(target[index[s.m] + s.lcpLength], query[s.lcpLength]) < 0) {
+                        s.lo = s.m + 1;
+                    }
+                    else {
+                        s.hi = s.m;
+                    }
+                }
+                else {
+                    if (targetSufLen == s.lcpLength) {
+                        // SearchRightBound stops at the end of the text.
+                        s.hi = s.m;
+                        s.lo = s.hi;
+                    }
+                    else if (targetSufLen < s.lcpLength or
+                            Compare::Compare(target[index[s.m] + s.lcpLength], query[s.lcpLength]) > 0) {
+                        s.hi = s.m;
+                    }
+                    else {
+                        s.lo = s.m + 1;
+                    }
+                }
+                ContinueLCPSearch(s, target, targetLength, query,
+                        queryLengths[s.query], maxMatchLength, stopOnceUnique,
+                        lcpLeftBounds[s.query], lcpRightBounds[s.query]);
+                if (s.phase == State::Done) {
+                    lcpLengths[s.query] = s.lcpLength;
+                    nextQuery = StartLCPSearch(s, nextQuery, target, targetLength,
+                            queries, queryLengths, useLookupTable, maxMatchLength,
+                            stopOnceUnique, lcpLeftBounds, lcpRightBounds, lcpLengths);
+                    if (s.phase == State::Done) {
+                        nActive--;
+                    }
+                }
+            }
+        }
+    }
+
+    //
+    // Begin the search for queries[nextQuery] in s.  Queries whose
+    // search finishes without a binary search step are completed here,
+    // so s is either left searching or Done once no queries remain.
+    // Returns the next query that has not been started.
+    //
+    int StartLCPSearch(SuffixArrayLCPSearchState<Index> &s, int nextQuery,
+            T *target, long targetLength,
+            std::vector<T*> &queries, std::vector<DNALength> &queryLengths,
+            bool useLookupTable, int maxMatchLength, bool stopOnceUnique,
+            std::vector<std::vector<Index> > &lcpLeftBounds,
+            std::vector<std::vector<Index> > &lcpRightBounds,
+            std::vector<DNALength> &lcpLengths) {
+
+        typedef SuffixArrayLCPSearchState<Index> State;
+        s.phase = State::Done;
+        while (s.phase == State::Done and nextQuery < (int) queries.size()) {
+            int q = nextQuery++;
+            s.query = q;
+            s.l = 0;
+            s.r = targetLength;
+            s.lcpLength = 0;
+            lcpLeftBounds[q].clear();
+            lcpRightBounds[q].clear();
+            if (useLookupTable and startPosTable != NULL) {
+                Tuple lookupTuple;
+                if (lookupTuple.FromStringLR(queries[q], tm) == 0) {
+                    lcpLengths[q] = 0;
+                    continue;
+                }
+                s.l = startPosTable[lookupTuple.tuple];
+                s.r = endPosTable[lookupTuple.tuple];
+                if (s.l >= s.r) {
+                    lcpLengths[q] = 0;
+                    continue;
+                }
+                lcpLeftBounds[q].push_back(s.l);
+                lcpRightBounds[q].push_back(s.r);
+                s.lcpLength = lookupPrefixLength;
+            }
+            NextLCPSearchChar(s, target, targetLength, queries[q],
+                    queryLengths[q], maxMatchLength, stopOnceUnique,
+                    lcpLeftBounds[q], lcpRightBounds[q]);
+            if (s.phase == State::Done) {
+                lcpLengths[q] = s.lcpLength;
+            }
+        }
+        return nextQuery;
+    }
+
+    //
+    // After a comparison, either pick the next position of the current
+    // binary search, or finish it and move on to the next bound or
+    // character.  This follows StoreLCPBounds, SearchLeftBound and
+    // SearchRightBound exactly, and must be kept in step with them.
+    //
+    void ContinueLCPSearch(SuffixArrayLCPSearchState<Index> &s,
+            T *target, long targetLength, T *query, DNALength queryLength,
+            int maxMatchLength, bool stopOnceUnique,
+            std::vector<Index> &lcpLeftBounds, std::vector<Index> &lcpRightBounds) {
+
+        typedef SuffixArrayLCPSearchState<Index> State;
+        if (s.lo >= s.hi and s.phase == State::LeftBound) {
+            s.l = s.lo;
+            s.hi = s.r;
+            s.phase = State::RightBound;
+        }
+        if (s.lo < s.hi) {
+            s.m = (s.lo + s.hi) / 2;
+            SUFFIX_ARRAY_PREFETCH(&index[s.m]);
+            return;
+        }
+        s.r = s.hi;
+        if (s.l == s.r or
+                index[s.l] + s.lcpLength >= targetLength or
+                ThreeBit[query[s.lcpLength]] >= 4 or
+                Compare::Compare(target[index[s.l] + s.lcpLength], query[s.lcpLength]) != 0) {
+            s.phase = State::Done;
+            return;
+        }
+        lcpLeftBounds.push_back(s.l);
+        lcpRightBounds.push_back(s.r);
+        s.lcpLength++;
+        NextLCPSearchChar(s, target, targetLength, query, queryLength,
+                maxMatchLength, stopOnceUnique, lcpLeftBounds, lcpRightBounds);
+    }
+
+    void NextLCPSearchChar(SuffixArrayLCPSearchState<Index> &s,
+            T *target, long targetLength, T *query, DNALength queryLength,
+            int maxMatchLength, bool stopOnceUnique,
+            std::vector<Index> &lcpLeftBounds, std::vector<Index> &lcpRightBounds) {
+
+        typedef SuffixArrayLCPSearchState<Index> State;
+        //
+        // Once the match is unique, the remaining steps compare
+        // consecutive characters of a single suffix that is already in
+        // the cache, so run them here rather than one per round.  A step
+        // on a one-suffix range succeeds exactly when the next characters
+        // of the suffix and query are equal.
+        //
+        while (s.l == s.r - 1 and s.lcpLength < queryLength and
+                not stopOnceUnique and
+                not (maxMatchLength and s.lcpLength >= (DNALength) maxMatchLength) and
+                ThreeBit[target[index[s.l] + s.lcpLength]] < 4) {
+            if (targetLength - (long) index[s.l] <= (long) s.lcpLength or
+                    ThreeBit[query[s.lcpLength]] >= 4 or
+                    Compare::Compare(target[index[s.l] + s.lcpLength], query[s.lcpLength]) != 0) {
+                s.phase = State::Done;
+                return;
+            }
+            lcpLeftBounds.push_back(s.l);
+            lcpRightBounds.push_back(s.r);
+            s.lcpLength++;
+        }
+        if (not (s.l < s.r and s.lcpLength < queryLength) or
+                (stopOnceUnique and s.l == s.r - 1) or
+                (maxMatchLength and s.lcpLength >= (DNALength) maxMatchLength) or
+                ThreeBit[target[index[s.l] + s.lcpLength]] >= 4) {
+            s.phase = State::Done;
+            return;
+        }
+        s.lo = s.l;
+        s.hi = s.r;
+        s.phase = State::LeftBound;
+        s.m = (s.lo + s.hi) / 2;
+        SUFFIX_ARRAY_PREFETCH(&index[s.m]);
+    }
+
+    int SearchLow(T *target, T *query, DNALength queryLength, Index l, Index r, Index &low, unsigned int offset=0) {
 
         long midPos;
-        int high;
+        Index high;
         int numSteps = 0;
         // 
         // Boundary conditions, the string is either before (lexicographically) the text
@@ -1146,13 +1748,13 @@ public:
     }
 
 
-    int SearchHigh(T *target, T *query, DNALength queryLength, SAIndex l, SAIndex r,  SAIndex &high, unsigned int offset=0) {
+    int SearchHigh(T *target, T *query, DNALength queryLength, Index l, Index r,  Index &high, unsigned int offset=0) {
 
         //
         // Find the last position where the query is less than the target.
         //
         long midPos;
-        int low;
+        Index low;
         int numSteps = 0;
         // 
         // Boundary conditions, the string is either before (lexicographically) the text
@@ -1189,6 +1791,7 @@ public:
         //
         high = low;
         //		cout << "search high took: " << numSteps << " steps." << endl;
+        return high;
     }
 };
 
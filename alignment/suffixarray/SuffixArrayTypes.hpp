@@ -13,5 +13,8 @@ typedef SuffixArray<Nucleotide, std::vector<int> > DNASuffixArray;
 typedef SuffixArray<Nucleotide, std::vector<int>, 
 	                  Compare4BitCompressed<Nucleotide>,
 	                  CompressedDNATuple<FASTASequence> >       CompressedDNASuffixArray;
+typedef SuffixArray<Nucleotide, std::vector<int>,
+	                  DefaultCompareStrings<Nucleotide>,
+	                  DNATuple, SAIndex64>                       LargeDNASuffixArray;
 
 #endif // _BLASR_SUFFIX_ARRAY_TYPES_HPP_
@@ -13,6 +13,7 @@
 #include "tuples/BaseTuple.hpp"
 #include "tuples/TupleMetrics.hpp"
 #include "tuples/TupleList.hpp"
+#include "tuples/TupleExtractor.hpp"
 #include "tuples/TupleOperations.h"
 
 class DNATuple : public BaseTuple {
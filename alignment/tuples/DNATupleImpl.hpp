@@ -38,7 +38,7 @@ inline int DNATuple::ShiftAddRL(Nucleotide nuc, TupleMetrics &tm) {
     }
     else {
         tuple >>= 2;
-        tuple += (TwoBit[nuc] << ((tm.tupleSize-1)*2));
+        tuple += (((ULong) TwoBit[nuc]) << ((tm.tupleSize-1)*2));
         return 1;
     }
 }
@@ -46,101 +46,36 @@ inline int DNATuple::ShiftAddRL(Nucleotide nuc, TupleMetrics &tm) {
 
 template<typename Sequence> 
 int SearchSequenceForTuple(Sequence &seq, TupleMetrics &tm, DNATuple &queryTuple) {
-    DNALength p;
-    PositionDNATuple tempTuple, upperTuple;
-
-    p = 0;
-    DNALength cur = 0;
-    DNALength curValidEnd = 0;
-
-    //
-    // Construct the mask-off bit pair for the shifted tuple.
-    //
-    PositionDNATuple maskLeftTuple;
-    maskLeftTuple.tuple = 3;
-    maskLeftTuple.tuple = maskLeftTuple.tuple << 2*tm.tupleSize;
-    maskLeftTuple.tuple = ~maskLeftTuple.tuple;
-    PositionDNATuple testTuple;
-    while (curValidEnd < seq.length) {
-        //
-        // Search for the next available window that can be translated into a tuple.
-        //
-        cur = curValidEnd;
-        while(curValidEnd < seq.length and IsACTG[seq.seq[curValidEnd]]) {
-            curValidEnd++;
-        }
-        if (curValidEnd - cur >= tm.tupleSize) {
-            //
-            // Found a span that does not have N's in it, 
-            //
-            assert (tempTuple.FromStringRL(&(seq.seq[cur]), tm) == 1);
-            p = cur;
-            if (tempTuple.tuple == queryTuple.tuple) {
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
+    while ((nTuples = extractor.Next(tuples, NULL, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            if (tuples[t] == queryTuple.tuple) {
                 return 1;
             }
-            for (p++; p < curValidEnd - tm.tupleSize + 1; p++) {
-                tempTuple.tuple >>=2;
-                //				tempTuple.tuple &= maskLeftTuple.tuple;
-                upperTuple.tuple = TwoBit[seq.seq[p+tm.tupleSize-1]];
-                upperTuple.tuple = upperTuple.tuple << (2 * (tm.tupleSize-1));
-                tempTuple.tuple += upperTuple.tuple;
-                if (tempTuple.tuple == queryTuple.tuple) {
-                    return 1;
-                }
-            }
-        }
-        else {
-            ++curValidEnd;
         }
     }
+    return 0;
 }
 
 
 template<typename Sequence>
 int SequenceToTupleList(Sequence &seq, TupleMetrics &tm, TupleList<DNATuple> &tupleList) {
-    DNALength p;
-    PositionDNATuple tempTuple, upperTuple;
-
-    p = 0;
-    DNALength cur = 0;
-    DNALength curValidEnd = 0;
-
-    //
-    // Construct the mask-off bit pair for the shifted tuple.
-    //
-    PositionDNATuple maskLeftTuple;
-    maskLeftTuple.tuple = 3;
-    maskLeftTuple.tuple = maskLeftTuple.tuple << 2*tm.tupleSize;
-    maskLeftTuple.tuple = ~maskLeftTuple.tuple;
-    PositionDNATuple testTuple;
-    while (curValidEnd < seq.length) {
-        //
-        // Search for the next available window that can be translated into a tuple.
-        //
-        cur = curValidEnd;
-        while(curValidEnd < seq.length and IsACTG[seq.seq[curValidEnd]]) {
-            curValidEnd++;
-        }
-        if (curValidEnd - cur >= tm.tupleSize) {
-            //
-            // Found a span that does not have N's in it, 
-            //
-            assert (tempTuple.FromStringRL(&(seq.seq[cur]), tm) == 1);
-            p = cur;
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength positions[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
+    DNATuple tempTuple;
+    while ((nTuples = extractor.Next(tuples, positions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            tempTuple.tuple = tuples[t];
+            tempTuple.pos   = positions[t];
             tupleList.Append(tempTuple);
-            for (p++; p < curValidEnd - tm.tupleSize + 1; p++) {
-                tempTuple.tuple >>=2;
-                //				tempTuple.tuple &= maskLeftTuple.tuple;
-                upperTuple.tuple = TwoBit[seq.seq[p+tm.tupleSize-1]];
-                upperTuple.tuple = upperTuple.tuple << (2 * (tm.tupleSize-1));
-                tempTuple.tuple += upperTuple.tuple;
-                //testTuple.FromStringRL(&seq.seq[p], tm);
-                //assert(testTuple.tuple == tempTuple.tuple);
-                tupleList.Append(tempTuple);
-            }
-        }
-        else {
-            ++curValidEnd;
         }
     }
     return tupleList.size();
@@ -149,51 +84,18 @@ int SequenceToTupleList(Sequence &seq, TupleMetrics &tm, TupleList<DNATuple> &tu
 
 template<typename Sequence>
 int SequenceToTupleList(Sequence &seq, TupleMetrics &tm, TupleList<PositionDNATuple> &tupleList) {
-    DNALength p;
-    PositionDNATuple tempTuple, upperTuple;
-
-    p = 0;
-    DNALength cur = 0;
-    DNALength curValidEnd = 0;
-
-    //
-    // Construct the mask-off bit pair for the shifted tuple.
-    //
-    PositionDNATuple maskLeftTuple;
-    maskLeftTuple.tuple = 3;
-    maskLeftTuple.tuple = maskLeftTuple.tuple << 2*tm.tupleSize;
-    maskLeftTuple.tuple = ~maskLeftTuple.tuple;
-    PositionDNATuple testTuple;
-    while (curValidEnd < seq.length) {
-        //
-        // Search for the next available window that can be translated into a tuple.
-        //
-        cur = curValidEnd;
-        while(curValidEnd < seq.length and IsACTG[seq.seq[curValidEnd]]) {
-            curValidEnd++;
-        }
-        if (curValidEnd - cur >= tm.tupleSize) {
-            //
-            // Found a span that does not have N's in it, 
-            //
-            assert (tempTuple.FromStringRL(&(seq.seq[cur]), tm) == 1);
-            p = cur;
-            tempTuple.pos = p;
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength positions[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
+    PositionDNATuple tempTuple;
+    while ((nTuples = extractor.Next(tuples, positions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            tempTuple.tuple = tuples[t];
+            tempTuple.pos   = positions[t];
             tupleList.Append(tempTuple);
-            for (p++; p < curValidEnd - tm.tupleSize + 1; p++) {
-                tempTuple.tuple >>=2;
-                //				tempTuple.tuple &= maskLeftTuple.tuple;
-                upperTuple.tuple = TwoBit[seq.seq[p+tm.tupleSize-1]];
-                upperTuple.tuple = upperTuple.tuple << (2 * (tm.tupleSize-1));
-                tempTuple.tuple += upperTuple.tuple;
-                tempTuple.pos = p;
-                //testTuple.FromStringRL(&seq.seq[p], tm);
-                //assert(testTuple.tuple == tempTuple.tuple);
-                tupleList.Append(tempTuple);
-            }
-        }
-        else {
-            ++curValidEnd;
         }
     }
     return tupleList.size();
@@ -3,6 +3,7 @@
 
 #include "tuples/TupleList.hpp"
 #include "tuples/TupleMetrics.hpp"
+#include "tuples/TupleExtractor.hpp"
 #include "DNASequence.hpp"
 
 template<typename T_Tuple>
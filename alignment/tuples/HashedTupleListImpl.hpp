@@ -129,13 +129,17 @@ template<typename T_Tuple>
 void SequenceToHash(DNASequence &seq, HashedTupleList<T_Tuple> &hash, 
     TupleMetrics &tm) {
 
-    int i;
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength positions[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
     T_Tuple tuple;
-    int res = 0;
-    for (i = 0; i < seq.length - hash.hashLength + 1; i++ ) {
-        if ((res and 
-             (res = tuple.ShiftAddRL(seq.seq[i+tm.tupleSize-1], tm))) or
-            (!res and (res = tuple.FromStringRL(&seq.seq[i], tm)))) {
+    while ((nTuples = extractor.Next(tuples, positions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            tuple.tuple = tuples[t];
+            tuple.pos   = positions[t];
             hash.Insert(tuple);
         }
     }
@@ -6,8 +6,16 @@
 #include <iostream>
 #include <assert.h>
 #include "tuples/TupleMetrics.hpp"
+#include "tuples/TupleHashTable.hpp"
+#include "tuples/TupleExtractor.hpp"
 using namespace std;
 
+//
+// Counts of the tuples in a sequence.  Counts are kept in a table of
+// all 4^k tuples, or for tuples longer than MaxDenseTupleSize, in a
+// hash table of the tuples that occur.
+//
+
 template<typename TSequence, typename TTuple>
 class TupleCountTable {
 public:
@@ -16,14 +24,32 @@ public:
 	int nTuples;
 	TupleMetrics tm;
 	bool deleteStructures;
+	TupleHashTable<TTuple> hashTable;
+	bool hashed;
+
+	static const unsigned int MaxDenseTupleSize = 14;
+
 	void InitCountTable(TupleMetrics &ptm);
 
+	//
+	// Initialize for counting at most maxTuples tuples, with a hash
+	// table when the tuples are too long for a dense table.
+	//
+	void InitCountTable(TupleMetrics &ptm, DNALength maxTuples);
+
 	TupleCountTable();
    	~TupleCountTable();
 	void Free();
 
 	void IncrementCount(TTuple &tuple);
+	int GetCount(TTuple &tuple);
 	void AddSequenceTupleCountsLR(TSequence &seq);
+
+	//
+	// Count the tuples of seq on nThreads threads.  Counts in a dense
+	// table are added on the calling thread.
+	//
+	void AddSequenceTupleCountsLR(TSequence &seq, int nThreads);
 	void Write(ofstream &out);
 	void Read(ifstream &in);
 };
@@ -22,12 +22,29 @@ void TupleCountTable<TSequence, TTuple>::InitCountTable(TupleMetrics &ptm) {
 }
 
 
+template<typename TSequence, typename TTuple>
+void TupleCountTable<TSequence, TTuple>::InitCountTable(TupleMetrics &ptm,
+    DNALength maxTuples) {
+    if (ptm.tupleSize <= MaxDenseTupleSize) {
+        InitCountTable(ptm);
+        return;
+    }
+    Free();
+    tm = ptm;
+    tm.InitializeMask();
+    hashTable.Initialize(tm, maxTuples, TupleExtractor::LeftToRight);
+    hashed = true;
+    nTuples = 0;
+}
+
+
 template<typename TSequence, typename TTuple>
 TupleCountTable<TSequence, TTuple>::TupleCountTable() {
     countTable = NULL;
     countTableLength = 0;
     nTuples = 0;
     deleteStructures = false;
+    hashed = false;
 }
 
 
@@ -38,6 +55,11 @@ TupleCountTable<TSequence, TTuple>::~TupleCountTable() {
 
 template<typename TSequence, typename TTuple>
 void TupleCountTable<TSequence, TTuple>::Free() {
+    if (hashed) {
+        hashTable.Free();
+        hashed = false;
+        nTuples = 0;
+    }
     if (deleteStructures == false) {
         //
         // Do not delete this if it is referencing another structure
@@ -55,6 +77,11 @@ void TupleCountTable<TSequence, TTuple>::Free() {
 template<typename TSequence, typename TTuple>
 void TupleCountTable<TSequence, TTuple>::IncrementCount(
     TTuple &tuple) {
+    if (hashed) {
+        hashTable.IncrementCount(tuple);
+        ++nTuples;
+        return;
+    }
     long tupleIndex = tuple.ToLongIndex();
     assert(tupleIndex < countTableLength);
     countTable[tupleIndex]++;
@@ -62,23 +89,58 @@ void TupleCountTable<TSequence, TTuple>::IncrementCount(
 }
 
 
+template<typename TSequence, typename TTuple>
+int TupleCountTable<TSequence, TTuple>::GetCount(TTuple &tuple) {
+    if (hashed) {
+        return hashTable.GetCount(tuple);
+    }
+    return countTable[tuple.ToLongIndex()];
+}
+
+
 template<typename TSequence, typename TTuple>
 void TupleCountTable<TSequence, TTuple>::AddSequenceTupleCountsLR(
     TSequence &seq) {
-    VectorIndex i;
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::LeftToRight);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
     TTuple tuple;
-    if (seq.length>= tm.tupleSize) {
-        for (i = 0; i < seq.length - tm.tupleSize + 1; i++ ) { 
-            if (tuple.FromStringLR(&seq.seq[i], tm)) {
-                IncrementCount(tuple);
-            }
+    while ((nTuples = extractor.Next(tuples, NULL, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            tuple.tuple = tuples[t];
+            IncrementCount(tuple);
         }
     }
 }
 
 
+template<typename TSequence, typename TTuple>
+void TupleCountTable<TSequence, TTuple>::AddSequenceTupleCountsLR(
+    TSequence &seq, int nThreads) {
+    if (hashed) {
+        nTuples += hashTable.AddSequenceTupleCounts(seq, nThreads);
+    }
+    else {
+        AddSequenceTupleCountsLR(seq);
+    }
+}
+
+
 template<typename TSequence, typename TTuple>
 void TupleCountTable<TSequence, TTuple>::Write(ofstream &out) {
+    if (hashed) {
+        //
+        // A table length of -1 marks a hashed table.
+        //
+        int hashedLength = -1;
+        out.write((char*) &hashedLength, sizeof(int));
+        out.write((char*) &nTuples, sizeof(int));
+        out.write((char*) &tm.tupleSize, sizeof(int));
+        hashTable.Write(out);
+        return;
+    }
     out.write((char*) &countTableLength, sizeof(int));
     out.write((char*) &nTuples, sizeof(int));
     out.write((char*) &tm.tupleSize, sizeof(int));
@@ -93,6 +155,13 @@ void TupleCountTable<TSequence, TTuple>::Read(ifstream &in) {
     in.read((char*) &nTuples, sizeof(int));
     in.read((char*) &tm.tupleSize, sizeof(int));
     tm.InitializeMask();
+    if (countTableLength == -1) {
+        countTableLength = 0;
+        hashTable.tm = tm;
+        hashTable.Read(in);
+        hashed = true;
+        return;
+    }
     countTable = new int[countTableLength];
     deleteStructures = true;
     in.read((char*) countTable, sizeof(int) * countTableLength);
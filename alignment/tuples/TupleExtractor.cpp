@@ -0,0 +1,154 @@
+#include <algorithm>
+#include "NucConversion.hpp"
+#include "tuples/TupleExtractor.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//
+// Store the ThreeBit codes of seq[0, n) in codes.  With SSE2, sixteen
+// bases are converted at once when all of them are A, C, G or T in
+// either case; any other base sends its sixteen through the table.
+//
+static void ConvertToCodes(const Nucleotide *seq, DNALength n,
+                           unsigned char *codes) {
+    DNALength i = 0;
+#ifdef __SSE2__
+    const __m128i caseMask = _mm_set1_epi8((char) 0xdf);
+    const __m128i a = _mm_set1_epi8('A'), c = _mm_set1_epi8('C');
+    const __m128i g = _mm_set1_epi8('G'), t = _mm_set1_epi8('T');
+    const __m128i one = _mm_set1_epi8(1), two = _mm_set1_epi8(2);
+    for (; i + 16 <= n; i += 16) {
+        __m128i bases = _mm_and_si128(
+            _mm_loadu_si128((const __m128i*) &seq[i]), caseMask);
+        __m128i isA = _mm_cmpeq_epi8(bases, a);
+        __m128i isC = _mm_cmpeq_epi8(bases, c);
+        __m128i isG = _mm_cmpeq_epi8(bases, g);
+        __m128i isT = _mm_cmpeq_epi8(bases, t);
+        __m128i isNuc = _mm_or_si128(_mm_or_si128(isA, isC), _mm_or_si128(isG, isT));
+        if (_mm_movemask_epi8(isNuc) != 0xffff) {
+            DNALength j;
+            for (j = i; j < i + 16; j++) {
+                codes[j] = ThreeBit[seq[j]];
+            }
+            continue;
+        }
+        //
+        // A is 0, C 1, G 2 and T 3, so the low bit is set for C and T
+        // and the high bit for G and T.
+        //
+        __m128i low  = _mm_and_si128(_mm_or_si128(isC, isT), one);
+        __m128i high = _mm_and_si128(_mm_or_si128(isG, isT), two);
+        _mm_storeu_si128((__m128i*) &codes[i], _mm_or_si128(low, high));
+    }
+#endif
+    for (; i < n; i++) {
+        codes[i] = ThreeBit[seq[i]];
+    }
+}
+
+TupleExtractor::TupleExtractor() {
+    orientation = RightToLeft;
+    tupleSize = 0;
+    tupleMask = 0;
+    seq = NULL;
+    length = cur = nValid = 0;
+    forward = reverse = 0;
+}
+
+void TupleExtractor::Initialize(TupleMetrics &tm, Orientation orientationP) {
+    orientation = orientationP;
+    tupleSize   = tm.tupleSize;
+    if (tupleSize < 32) {
+        tupleMask = (((ULong) 1) << (2 * tupleSize)) - 1;
+    }
+    else {
+        tupleMask = ~((ULong) 0);
+    }
+    SetSequence(NULL, 0);
+}
+
+void TupleExtractor::SetSequence(Nucleotide *seqP, DNALength lengthP) {
+    seq     = seqP;
+    length  = lengthP;
+    cur     = 0;
+    nValid  = 0;
+    forward = reverse = 0;
+}
+
+//
+// Roll the tuples over codes[0, nCodes), the codes of the bases from
+// cur on.  The orientation is a template parameter so that each loop
+// is compiled without a test of it per base.
+//
+template<int T_Orientation>
+DNALength TupleExtractor::RollTuples(DNALength nCodes, ULong *tuples,
+                                     DNALength *positions) {
+    const unsigned char *codePtr = &codes[0];
+    int highShift = 2 * (tupleSize - 1);
+    DNALength nTuples = 0;
+    DNALength i;
+    for (i = 0; i < nCodes; i++) {
+        ULong code = codePtr[i];
+        if (code > 3) {
+            nValid = 0;
+            continue;
+        }
+        if (T_Orientation == LeftToRight or T_Orientation == Canonical) {
+            forward = ((forward << 2) | code) & tupleMask;
+        }
+        else {
+            forward = (forward >> 2) | (code << highShift);
+        }
+        if (T_Orientation == Canonical) {
+            reverse = (reverse >> 2) | ((3 - code) << highShift);
+        }
+        if (++nValid < tupleSize) {
+            continue;
+        }
+        if (T_Orientation == Canonical) {
+            tuples[nTuples] = std::min(forward, reverse);
+        }
+        else {
+            tuples[nTuples] = forward;
+        }
+        if (positions != NULL) {
+            positions[nTuples] = cur + i + 1 - tupleSize;
+        }
+        ++nTuples;
+    }
+    return nTuples;
+}
+
+DNALength TupleExtractor::Next(ULong *tuples, DNALength *positions,
+                               DNALength maxTuples) {
+    if (tupleSize == 0) {
+        return 0;
+    }
+    DNALength nTuples = 0;
+    while (cur < length and nTuples < maxTuples) {
+        //
+        // Each base ends at most one tuple, so a stretch of as many
+        // bases as there is room for tuples cannot overfill the buffer.
+        //
+        DNALength nCodes = std::min(length - cur, maxTuples - nTuples);
+        if (codes.size() < nCodes) {
+            codes.resize(nCodes);
+        }
+        ConvertToCodes(&seq[cur], nCodes, &codes[0]);
+        ULong *stretchTuples = &tuples[nTuples];
+        DNALength *stretchPositions = (positions == NULL ? NULL : &positions[nTuples]);
+        if (orientation == LeftToRight) {
+            nTuples += RollTuples<LeftToRight>(nCodes, stretchTuples, stretchPositions);
+        }
+        else if (orientation == RightToLeft) {
+            nTuples += RollTuples<RightToLeft>(nCodes, stretchTuples, stretchPositions);
+        }
+        else {
+            nTuples += RollTuples<Canonical>(nCodes, stretchTuples, stretchPositions);
+        }
+        cur += nCodes;
+    }
+    return nTuples;
+}
@@ -0,0 +1,65 @@
+#ifndef _BLASR_TUPLE_EXTRACTOR_HPP_
+#define _BLASR_TUPLE_EXTRACTOR_HPP_
+
+#include <vector>
+#include "Types.h"
+#include "tuples/TupleMetrics.hpp"
+
+//
+// Reads all tuples of a sequence, one buffer at a time.  Each stretch
+// of the sequence is first converted to 2-bit codes in one pass, then
+// the tuples are rolled over the codes, restarting after each base
+// that is not A, C, G or T.  The tuples are the same as those built by
+// DNATuple::FromStringLR or FromStringRL at each position.
+//
+// Canonical tuples are the lesser of the LR tuple and the LR tuple of
+// its reverse complement, so a tuple and its reverse complement are
+// read as the same tuple.
+//
+class TupleExtractor {
+public:
+    enum Orientation {RightToLeft, LeftToRight, Canonical};
+
+    //
+    // A convenient size for the buffers passed to Next.
+    //
+    static const DNALength BufferLength = 1024;
+
+    TupleExtractor();
+
+    void Initialize(TupleMetrics &tm, Orientation orientationP);
+
+    //
+    // Start reading the tuples of seq[0, length).  The sequence is
+    // not copied.
+    //
+    void SetSequence(Nucleotide *seqP, DNALength lengthP);
+
+    //
+    // Store up to maxTuples of the next tuples and their positions,
+    // and return the number stored; 0 at the end of the sequence.
+    // positions may be NULL.
+    //
+    DNALength Next(ULong *tuples, DNALength *positions, DNALength maxTuples);
+
+private:
+    Orientation orientation;
+    DNALength tupleSize;
+    ULong tupleMask;
+
+    Nucleotide *seq;
+    DNALength length;
+    //
+    // The next base to read, the tuples ending before it, and the
+    // number of A, C, G or T bases read since the last other base.
+    //
+    DNALength cur;
+    ULong forward, reverse;
+    DNALength nValid;
+    std::vector<unsigned char> codes;
+
+    template<int T_Orientation>
+    DNALength RollTuples(DNALength nCodes, ULong *tuples, DNALength *positions);
+};
+
+#endif // _BLASR_TUPLE_EXTRACTOR_HPP_
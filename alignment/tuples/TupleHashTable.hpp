@@ -0,0 +1,155 @@
+#ifndef _BLASR_TUPLE_HASH_TABLE_HPP_
+#define _BLASR_TUPLE_HASH_TABLE_HPP_
+
+#include <pthread.h>
+#include <fstream>
+#include <vector>
+#include "Types.h"
+#include "tuples/TupleMetrics.hpp"
+#include "tuples/TupleExtractor.hpp"
+
+//
+// An open-addressing hash table keyed on the tuple of a DNATuple, for
+// tuple sizes where a table of all 4^k tuples is too large.  Slots are
+// grouped into buckets of one cache line; a probe scans a bucket, then
+// the next one.
+//
+// Tuples may be counted from several threads at once: a slot is
+// claimed with a compare-and-swap on its tuple, and counts are added
+// atomically.  The table does not grow, so it is sized when it is
+// initialized for the most distinct tuples it will hold.
+//
+// Once all tuples are counted, the positions of each tuple may be
+// stored, after which FindAll returns the positions of a tuple, sorted
+// by position, in the same way as TupleList::FindAll.
+//
+template<typename T_Tuple>
+class TupleHashTable {
+public:
+    typedef T_Tuple Tuple;
+
+    class Slot {
+    public:
+        ULong tuple;
+        DNALength count;
+        //
+        // The index of the first position of the tuple in positions.
+        //
+        DNALength offset;
+    };
+
+    static const int SlotsPerBucket = 4;
+    static const int BucketSize     = SlotsPerBucket * sizeof(Slot);
+    static const ULong EmptyTuple   = ~((ULong) 0);
+
+    //
+    // Which way the tuples of a sequence are read: RL tuples are built
+    // as in TupleMatching, and LR tuples as in TupleCountTable.
+    //
+    typedef TupleExtractor::Orientation Orientation;
+
+    TupleHashTable();
+
+    ~TupleHashTable();
+
+    //
+    // Size the table for up to maxTuples distinct tuples.
+    //
+    void Initialize(TupleMetrics &ptm, DNALength maxTuples,
+                    Orientation orientationP=TupleExtractor::RightToLeft);
+
+    void Free();
+
+    //
+    // Safe to call from several threads at once.
+    //
+    void IncrementCount(T_Tuple &tuple);
+
+    void AddCount(ULong tuple, DNALength count);
+
+    DNALength GetCount(T_Tuple &tuple);
+
+    //
+    // The number of distinct tuples in the table.
+    //
+    ULong GetNumDistinctTuples();
+
+    //
+    // Count the tuples of seq using nThreads threads, and return the
+    // number counted.
+    //
+    template<typename TSequence>
+    DNALength AddSequenceTupleCounts(TSequence &seq, int nThreads=1);
+
+    //
+    // Count the tuples of seq, then store their positions.
+    //
+    template<typename TSequence>
+    void IndexSequence(TSequence &seq, int nThreads=1);
+
+    //
+    // Find the positions of a tuple in an indexed sequence.  Both
+    // iterators are at the end of the positions when it is not found.
+    //
+    void FindAll(T_Tuple &tuple,
+        typename std::vector<T_Tuple>::const_iterator &firstPos,
+        typename std::vector<T_Tuple>::const_iterator &endPos);
+
+    void Write(std::ofstream &out);
+
+    void Read(std::ifstream &in);
+
+    TupleMetrics tm;
+    Orientation orientation;
+
+private:
+    enum Pass {CountPass, PositionPass};
+
+    Slot *slots;
+    ULong nBuckets;
+    int hashShift;
+    ULong nDistinctTuples;
+    std::vector<T_Tuple> positions;
+
+    ULong Hash(ULong tuple);
+
+    Slot *LookupSlot(ULong tuple);
+
+    Slot *InsertSlot(ULong tuple);
+
+    //
+    // Count or store the positions of the tuples that start in
+    // [start, end) of seq.
+    //
+    template<typename TSequence>
+    DNALength AddSequenceTuples(TSequence &seq, DNALength start,
+                                DNALength end, Pass pass);
+
+    template<typename TSequence>
+    DNALength AddSequenceTuples(TSequence &seq, Pass pass, int nThreads);
+
+    template<typename TSequence>
+    class SequenceThread {
+    public:
+        TupleHashTable<T_Tuple> *table;
+        TSequence *seq;
+        DNALength start, end;
+        Pass pass;
+        DNALength nTuples;
+    };
+
+    template<typename TSequence>
+    static void *AddSequenceTuplesThread(void *threadPtr);
+
+    void AllocatePositions();
+
+    void FinishPositions(bool sortPositions);
+
+    // Not copyable: the table owns its slots.
+    TupleHashTable(const TupleHashTable &rhs);
+    TupleHashTable &operator=(const TupleHashTable &rhs);
+};
+
+#include "tuples/TupleHashTableImpl.hpp"
+
+#endif // _BLASR_TUPLE_HASH_TABLE_HPP_
@@ -0,0 +1,343 @@
+#ifndef _BLASR_TUPLE_HASH_TABLE_IMPL_HPP_
+#define _BLASR_TUPLE_HASH_TABLE_IMPL_HPP_
+
+#include <stdlib.h>
+#include <algorithm>
+#include <iostream>
+
+class CompareTuplePos {
+public:
+    template<typename T_Tuple>
+    bool operator()(const T_Tuple &lhs, const T_Tuple &rhs) const {
+        return lhs.pos < rhs.pos;
+    }
+};
+
+template<typename T_Tuple>
+TupleHashTable<T_Tuple>::TupleHashTable() {
+    slots = NULL;
+    nBuckets = 0;
+    hashShift = 0;
+    nDistinctTuples = 0;
+    orientation = TupleExtractor::RightToLeft;
+}
+
+template<typename T_Tuple>
+TupleHashTable<T_Tuple>::~TupleHashTable() {
+    Free();
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::Initialize(TupleMetrics &ptm,
+    DNALength maxTuples, Orientation orientationP) {
+    Free();
+    tm = ptm;
+    orientation = orientationP;
+    //
+    // An all-ones tuple marks an empty slot, so it may not be a tuple.
+    //
+    if (tm.tupleSize == 0 or tm.tupleSize >= 32) {
+        std::cout << "ERROR, a tuple hash table may only hold tuples of "
+                  << "1 to 31 bases." << std::endl;
+        exit(1);
+    }
+
+    //
+    // Keep the table at most 3/4 full.
+    //
+    ULong minSlots = ((ULong) maxTuples) + maxTuples / 3 + 1;
+    nBuckets  = 2;
+    hashShift = 63;
+    while (nBuckets * SlotsPerBucket < minSlots) {
+        nBuckets <<= 1;
+        --hashShift;
+    }
+    void *slotsPtr;
+    if (posix_memalign(&slotsPtr, BucketSize, nBuckets * BucketSize) != 0) {
+        std::cout << "ERROR, could not allocate a tuple hash table of "
+                  << nBuckets * BucketSize << " bytes." << std::endl;
+        exit(1);
+    }
+    slots = (Slot*) slotsPtr;
+    ULong s;
+    for (s = 0; s < nBuckets * SlotsPerBucket; s++) {
+        slots[s].tuple  = EmptyTuple;
+        slots[s].count  = 0;
+        slots[s].offset = 0;
+    }
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::Free() {
+    if (slots != NULL) {
+        free(slots);
+        slots = NULL;
+    }
+    nBuckets = 0;
+    nDistinctTuples = 0;
+    std::vector<T_Tuple>().swap(positions);
+}
+
+//
+// Fibonacci hashing: the top bits of the tuple times 2^64 / phi.
+//
+template<typename T_Tuple>
+ULong TupleHashTable<T_Tuple>::Hash(ULong tuple) {
+    return (tuple * 0x9E3779B97F4A7C15ULL) >> hashShift;
+}
+
+template<typename T_Tuple>
+typename TupleHashTable<T_Tuple>::Slot *
+TupleHashTable<T_Tuple>::LookupSlot(ULong tuple) {
+    if (slots == NULL) {
+        return NULL;
+    }
+    ULong bucket = Hash(tuple);
+    ULong nProbed;
+    for (nProbed = 0; nProbed < nBuckets; nProbed++) {
+        Slot *bucketSlots = &slots[bucket * SlotsPerBucket];
+        int s;
+        for (s = 0; s < SlotsPerBucket; s++) {
+            ULong slotTuple = __atomic_load_n(&bucketSlots[s].tuple, __ATOMIC_ACQUIRE);
+            if (slotTuple == tuple) {
+                return &bucketSlots[s];
+            }
+            if (slotTuple == EmptyTuple) {
+                return NULL;
+            }
+        }
+        bucket = (bucket + 1) & (nBuckets - 1);
+    }
+    return NULL;
+}
+
+template<typename T_Tuple>
+typename TupleHashTable<T_Tuple>::Slot *
+TupleHashTable<T_Tuple>::InsertSlot(ULong tuple) {
+    ULong bucket = Hash(tuple);
+    ULong nProbed;
+    for (nProbed = 0; nProbed < nBuckets; nProbed++) {
+        Slot *bucketSlots = &slots[bucket * SlotsPerBucket];
+        int s;
+        for (s = 0; s < SlotsPerBucket; s++) {
+            ULong slotTuple = __atomic_load_n(&bucketSlots[s].tuple, __ATOMIC_ACQUIRE);
+            if (slotTuple == EmptyTuple) {
+                //
+                // Claim the slot, unless another thread claimed it
+                // first.  That thread may have stored the same tuple.
+                //
+                if (__atomic_compare_exchange_n(&bucketSlots[s].tuple, &slotTuple, tuple,
+                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                    __atomic_fetch_add(&nDistinctTuples, 1, __ATOMIC_RELAXED);
+                    return &bucketSlots[s];
+                }
+            }
+            if (slotTuple == tuple) {
+                return &bucketSlots[s];
+            }
+        }
+        bucket = (bucket + 1) & (nBuckets - 1);
+    }
+    std::cout << "ERROR, the tuple hash table is full." << std::endl;
+    exit(1);
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::IncrementCount(T_Tuple &tuple) {
+    __atomic_fetch_add(&InsertSlot(tuple.tuple)->count, 1, __ATOMIC_RELAXED);
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::AddCount(ULong tuple, DNALength count) {
+    __atomic_fetch_add(&InsertSlot(tuple)->count, count, __ATOMIC_RELAXED);
+}
+
+template<typename T_Tuple>
+DNALength TupleHashTable<T_Tuple>::GetCount(T_Tuple &tuple) {
+    Slot *slot = LookupSlot(tuple.tuple);
+    if (slot == NULL) {
+        return 0;
+    }
+    return slot->count;
+}
+
+template<typename T_Tuple>
+ULong TupleHashTable<T_Tuple>::GetNumDistinctTuples() {
+    return nDistinctTuples;
+}
+
+template<typename T_Tuple>
+template<typename TSequence>
+DNALength TupleHashTable<T_Tuple>::AddSequenceTuples(TSequence &seq,
+    DNALength start, DNALength end, Pass pass) {
+    TupleExtractor extractor;
+    extractor.Initialize(tm, orientation);
+    extractor.SetSequence(&seq.seq[start], end - start + tm.tupleSize - 1);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength tuplePositions[TupleExtractor::BufferLength];
+    DNALength nTuples = 0, nRead, t;
+    T_Tuple tuple;
+    while ((nRead = extractor.Next(tuples, tuplePositions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nRead; t++) {
+            tuple.tuple = tuples[t];
+            if (pass == CountPass) {
+                IncrementCount(tuple);
+            }
+            else {
+                Slot *slot = LookupSlot(tuple.tuple);
+                DNALength index = __atomic_fetch_add(&slot->offset, 1, __ATOMIC_RELAXED);
+                positions[index] = tuple;
+                positions[index].pos = start + tuplePositions[t];
+            }
+        }
+        nTuples += nRead;
+    }
+    return nTuples;
+}
+
+template<typename T_Tuple>
+template<typename TSequence>
+void *TupleHashTable<T_Tuple>::AddSequenceTuplesThread(void *threadPtr) {
+    SequenceThread<TSequence> *thread = (SequenceThread<TSequence>*) threadPtr;
+    thread->nTuples = thread->table->AddSequenceTuples(*thread->seq,
+        thread->start, thread->end, thread->pass);
+    return NULL;
+}
+
+template<typename T_Tuple>
+template<typename TSequence>
+DNALength TupleHashTable<T_Tuple>::AddSequenceTuples(TSequence &seq,
+    Pass pass, int nThreads) {
+    if (seq.length < tm.tupleSize) {
+        return 0;
+    }
+    DNALength nStarts = seq.length - tm.tupleSize + 1;
+    if (nThreads <= 1 or nStarts < (DNALength) nThreads) {
+        return AddSequenceTuples(seq, 0, nStarts, pass);
+    }
+    //
+    // Each thread reads the tuples starting in one stretch of seq.
+    //
+    std::vector<SequenceThread<TSequence> > threads(nThreads);
+    std::vector<pthread_t> threadIds(nThreads);
+    int t;
+    for (t = 0; t < nThreads; t++) {
+        threads[t].table = this;
+        threads[t].seq   = &seq;
+        threads[t].start = (DNALength) (((ULong) nStarts) * t / nThreads);
+        threads[t].end   = (DNALength) (((ULong) nStarts) * (t + 1) / nThreads);
+        threads[t].pass  = pass;
+        threads[t].nTuples = 0;
+        if (pthread_create(&threadIds[t], NULL,
+                           AddSequenceTuplesThread<TSequence>, &threads[t]) != 0) {
+            std::cout << "ERROR, could not start a tuple hashing thread." << std::endl;
+            exit(1);
+        }
+    }
+    DNALength nTuples = 0;
+    for (t = 0; t < nThreads; t++) {
+        pthread_join(threadIds[t], NULL);
+        nTuples += threads[t].nTuples;
+    }
+    return nTuples;
+}
+
+template<typename T_Tuple>
+template<typename TSequence>
+DNALength TupleHashTable<T_Tuple>::AddSequenceTupleCounts(TSequence &seq,
+    int nThreads) {
+    return AddSequenceTuples(seq, CountPass, nThreads);
+}
+
+template<typename T_Tuple>
+template<typename TSequence>
+void TupleHashTable<T_Tuple>::IndexSequence(TSequence &seq, int nThreads) {
+    AddSequenceTuples(seq, CountPass, nThreads);
+    AllocatePositions();
+    AddSequenceTuples(seq, PositionPass, nThreads);
+    //
+    // Positions stored from one thread are already in order.
+    //
+    FinishPositions(nThreads > 1);
+}
+
+//
+// Lay out the positions of the tuples one after the other, and point
+// the offset of each slot at the first of its positions.
+//
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::AllocatePositions() {
+    DNALength nPositions = 0;
+    ULong s;
+    for (s = 0; s < nBuckets * SlotsPerBucket; s++) {
+        slots[s].offset = nPositions;
+        nPositions += slots[s].count;
+    }
+    positions.resize(nPositions);
+}
+
+//
+// Storing the positions moved each offset past the positions of its
+// tuple; move them back.
+//
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::FinishPositions(bool sortPositions) {
+    ULong s;
+    for (s = 0; s < nBuckets * SlotsPerBucket; s++) {
+        slots[s].offset -= slots[s].count;
+        if (sortPositions and slots[s].count > 1) {
+            std::sort(positions.begin() + slots[s].offset,
+                      positions.begin() + slots[s].offset + slots[s].count,
+                      CompareTuplePos());
+        }
+    }
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::FindAll(T_Tuple &tuple,
+    typename std::vector<T_Tuple>::const_iterator &firstPos,
+    typename std::vector<T_Tuple>::const_iterator &endPos) {
+    Slot *slot = LookupSlot(tuple.tuple);
+    if (slot == NULL or positions.empty()) {
+        firstPos = endPos = positions.end();
+        return;
+    }
+    firstPos = positions.begin() + slot->offset;
+    endPos   = firstPos + slot->count;
+}
+
+//
+// Only the tuples and their counts are written; positions are not.
+//
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::Write(std::ofstream &out) {
+    int orientationValue = orientation;
+    out.write((char*) &orientationValue, sizeof(int));
+    out.write((char*) &nDistinctTuples, sizeof(ULong));
+    ULong s;
+    for (s = 0; s < nBuckets * SlotsPerBucket; s++) {
+        if (slots[s].tuple != EmptyTuple) {
+            out.write((char*) &slots[s].tuple, sizeof(ULong));
+            out.write((char*) &slots[s].count, sizeof(DNALength));
+        }
+    }
+}
+
+template<typename T_Tuple>
+void TupleHashTable<T_Tuple>::Read(std::ifstream &in) {
+    int orientationValue;
+    ULong nTuples;
+    in.read((char*) &orientationValue, sizeof(int));
+    in.read((char*) &nTuples, sizeof(ULong));
+    Initialize(tm, nTuples, (Orientation) orientationValue);
+    ULong i;
+    for (i = 0; i < nTuples; i++) {
+        ULong tuple;
+        DNALength count;
+        in.read((char*) &tuple, sizeof(ULong));
+        in.read((char*) &count, sizeof(DNALength));
+        AddCount(tuple, count);
+    }
+}
+
+#endif // _BLASR_TUPLE_HASH_TABLE_IMPL_HPP_
@@ -3,19 +3,44 @@
 
 #include "tuples/TupleMetrics.hpp"
 #include "tuples/TupleList.hpp"
+#include "tuples/TupleHashTable.hpp"
 #include "tuples/BaseTuple.hpp"
 #include "tuples/DNATuple.hpp"
+#include "tuples/TupleExtractor.hpp"
 #include "tuples/TupleMatching.hpp"
 
 template<typename Sequence, typename T_TupleList> 
 int SequenceToTupleList(
     Sequence &seq, TupleMetrics &tm, T_TupleList &tupleList); 
 
+//
+// As above, reading the tuples with extractor, whose buffer is kept
+// from one call to the next.
+//
+template<typename Sequence, typename T_TupleList> 
+int SequenceToTupleList(
+    Sequence &seq, TupleMetrics &tm, T_TupleList &tupleList,
+    TupleExtractor &extractor); 
+
+//
+// Index the positions of the tuples of seq in a hash table, which may
+// then be searched by StoreMatchingPositions like a tuple list.
+//
+template<typename Sequence, typename T_Tuple>
+int SequenceToTupleHashTable(
+    Sequence &seq, TupleMetrics &tm, TupleHashTable<T_Tuple> &table,
+    int nThreads=1);
+
 template<typename TSequence, typename TMatch, typename T_TupleList>
 int StoreMatchingPositions(
     TSequence &querySeq, TupleMetrics &tm, T_TupleList &targetTupleList, 
     std::vector<TMatch> &matchSet); 
 
+template<typename TSequence, typename TMatch, typename T_TupleList>
+int StoreMatchingPositions(
+    TSequence &querySeq, TupleMetrics &tm, T_TupleList &targetTupleList, 
+    std::vector<TMatch> &matchSet, TupleExtractor &extractor); 
+
 template<typename Sequence, typename Tuple>
 int StoreUniqueTuplePosList(Sequence seq, TupleMetrics &tm, 
     std::vector<int> &uniqueTuplePosList); 
@@ -12,47 +12,67 @@ using namespace std;
 
 template<typename Sequence, typename T_TupleList> 
 int SequenceToTupleList(Sequence &seq, TupleMetrics &tm, T_TupleList &tupleList) {
-    int s;
+    TupleExtractor extractor;
+    return SequenceToTupleList(seq, tm, tupleList, extractor);
+}
+
+template<typename Sequence, typename T_TupleList> 
+int SequenceToTupleList(Sequence &seq, TupleMetrics &tm, T_TupleList &tupleList,
+    TupleExtractor &extractor) {
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(seq.seq, seq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength positions[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
     typename T_TupleList::Tuple tempTuple;
-    if (seq.size() < tm.tupleSize) {
-        return 1; 
+    while ((nTuples = extractor.Next(tuples, positions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            tempTuple.tuple = tuples[t];
+            tempTuple.pos   = positions[t];
+            tupleList.Append(tempTuple);
+        }
     }
+    return 1;
+}
 
-    // Otherwise, there is at least one tuple
 
-    tupleList.Append(tempTuple);
-    int res = 0;
-    for (s = 0; s < seq.length - tm.tupleSize + 1; s++ ) {
-        if ((res and (res = tempTuple.ShiftAddRL(seq.seq[s+tm.tupleSize-1], tm))) or
-                (!res and (res = tempTuple.FromStringRL(&seq.seq[s], tm)))) {
-            tempTuple.ShiftAddRL(seq.seq[s + tm.tupleSize - 1], tm);
-            tempTuple.pos = s;
-            tupleList.Append(tempTuple);
-        }
+template<typename Sequence, typename T_Tuple>
+int SequenceToTupleHashTable(Sequence &seq, TupleMetrics &tm, 
+    TupleHashTable<T_Tuple> &table, int nThreads) {
+    DNALength maxTuples = 0;
+    if (seq.length >= tm.tupleSize) {
+        maxTuples = seq.length - tm.tupleSize + 1;
     }
+    table.Initialize(tm, maxTuples);
+    table.IndexSequence(seq, nThreads);
     return 1;
 }
 
 
 template<typename TSequence, typename TMatch, typename T_TupleList>
 int StoreMatchingPositions(TSequence &querySeq, TupleMetrics &tm, T_TupleList &targetTupleList, vector<TMatch> &matchSet) {
-    DNALength s;
-    //	TQueryTuple queryTuple;
+    TupleExtractor extractor;
+    return StoreMatchingPositions(querySeq, tm, targetTupleList, matchSet, extractor);
+}
+
+template<typename TSequence, typename TMatch, typename T_TupleList>
+int StoreMatchingPositions(TSequence &querySeq, TupleMetrics &tm, T_TupleList &targetTupleList, vector<TMatch> &matchSet,
+    TupleExtractor &extractor) {
+    extractor.Initialize(tm, TupleExtractor::RightToLeft);
+    extractor.SetSequence(querySeq.seq, querySeq.length);
+    ULong tuples[TupleExtractor::BufferLength];
+    DNALength positions[TupleExtractor::BufferLength];
+    DNALength nTuples, t;
     typename T_TupleList::Tuple queryTuple;
     queryTuple.pos = 0;
-    if (querySeq.length >= tm.tupleSize) {
-        int res = 0;
-        for (s = 0; s < querySeq.length - tm.tupleSize + 1; s++) {
-            if ((res and (res = queryTuple.ShiftAddRL(querySeq.seq[s+tm.tupleSize-1], tm))) or
-                    (!res and (res = queryTuple.FromStringRL(&querySeq.seq[s], tm)))) {
-                int targetListIndex = 0;
-                typename vector<typename T_TupleList::Tuple>::const_iterator curIt, endIt;
-                targetTupleList.FindAll(queryTuple, curIt, endIt);
-
-                for(; curIt != endIt; curIt++) {
-                    matchSet.push_back(TMatch(s, (*curIt).pos));
-                    ++targetListIndex;
-                }
+    while ((nTuples = extractor.Next(tuples, positions, TupleExtractor::BufferLength)) > 0) {
+        for (t = 0; t < nTuples; t++) {
+            queryTuple.tuple = tuples[t];
+            typename vector<typename T_TupleList::Tuple>::const_iterator curIt, endIt;
+            targetTupleList.FindAll(queryTuple, curIt, endIt);
+
+            for(; curIt != endIt; curIt++) {
+                matchSet.push_back(TMatch(positions[t], (*curIt).pos));
             }
         }
     }
@@ -7,7 +7,15 @@ TupleMetrics::TupleMetrics() {
 }
 
 void TupleMetrics::InitializeMask() {
-    tupleMask = TupleMask[tupleSize];
+    //
+    // The mask table stops at 16 bases; longer tuples use every bit.
+    //
+    if (tupleSize < sizeof(TupleMask) / sizeof(TupleMask[0])) {
+        tupleMask = TupleMask[tupleSize];
+    }
+    else {
+        tupleMask = ~((ULong) 0);
+    }
 }
 
 void TupleMetrics::Initialize(int pTupleSize) {
@@ -131,11 +131,10 @@ void CollectSubreadIntervals(T_Sequence &read, RegionTable *regionTablePtr,
              regionIndex < regionHighIndex; regionIndex++) {
 			if (regionTablePtr->GetType(regionIndex) ==  Insert) {
 
-                RegionAnnotation & ra = regionTablePtr->table[regionIndex];
 				subreadIntervals.push_back(ReadInterval(
-                            ra.GetStart(),
-                            ra.GetEnd(),
-                            ra.GetScore()));
+                            regionTablePtr->GetStart(regionIndex),
+                            regionTablePtr->GetEnd(regionIndex),
+                            regionTablePtr->GetScore(regionIndex)));
 			}
 		}
 	}
@@ -158,19 +157,18 @@ void CollectSubreadIntervals(T_Sequence &read, RegionTable *regionTablePtr,
 		else {
             // The first subread covers [0, RegionStart of first adapter)
 			subreadIntervals.push_back(ReadInterval(0, 
-                regionTablePtr->table[adapterIntervalIndices[0]].
-                    GetStart()));
+                regionTablePtr->GetStart(adapterIntervalIndices[0])));
 
             // The subread[i] covers (RegionEnd of i-1-th adapter, RegionStart of i-th adapter)
 			for (i = 0; i + 1 < adapterIntervalIndices.size(); i++) {
 				subreadIntervals.push_back(ReadInterval(
-                    regionTablePtr->table[adapterIntervalIndices[i]].GetEnd(),
-				    regionTablePtr->table[adapterIntervalIndices[i+1]].GetStart()));
+                    regionTablePtr->GetEnd(adapterIntervalIndices[i]),
+				    regionTablePtr->GetStart(adapterIntervalIndices[i+1])));
 			}
             // The last subread covers (RegionEnd of last adapter, end of read)
 			subreadIntervals.push_back(
-                ReadInterval(regionTablePtr->table[
-                    adapterIntervalIndices[adapterIntervalIndices.size()-1]].GetEnd(),
+                ReadInterval(regionTablePtr->GetEnd(
+                    adapterIntervalIndices[adapterIntervalIndices.size()-1]),
 				read.length));
 		}
 	}
@@ -200,11 +198,10 @@ void CollectAdapterIntervals(T_Sequence &read,
          regionIndex < regionHighIndex; regionIndex++) {
 
         if (regionTablePtr->GetType(regionIndex) ==  Adapter) {
-            RegionAnnotation & ra = regionTablePtr->table[regionIndex];
             adapterIntervals.push_back(ReadInterval(
-                        ra.GetStart(),
-                        ra.GetEnd(), 
-                        ra.GetScore()));
+                        regionTablePtr->GetStart(regionIndex),
+                        regionTablePtr->GetEnd(regionIndex), 
+                        regionTablePtr->GetScore(regionIndex)));
         }
     }
 }
@@ -0,0 +1,18 @@
+#include <pthread.h>
+#include "HDF5Lock.hpp"
+
+#ifndef H5_HAVE_THREADSAFE
+static pthread_mutex_t hdf5Lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+void HDF5Lock::Lock() {
+#ifndef H5_HAVE_THREADSAFE
+    pthread_mutex_lock(&hdf5Lock);
+#endif
+}
+
+void HDF5Lock::Unlock() {
+#ifndef H5_HAVE_THREADSAFE
+    pthread_mutex_unlock(&hdf5Lock);
+#endif
+}
@@ -0,0 +1,18 @@
+#ifndef _BLASR_HDF5_LOCK_HPP_
+#define _BLASR_HDF5_LOCK_HPP_
+
+#include "H5Cpp.h"
+
+//
+// One lock for all threads that call into HDF5.  Unless HDF5 is built
+// thread-safe (H5_HAVE_THREADSAFE), only one thread may be inside the
+// library at a time; a thread-safe HDF5 serializes calls itself, and
+// then this lock does nothing.
+//
+class HDF5Lock {
+public:
+    static void Lock();
+    static void Unlock();
+};
+
+#endif // _BLASR_HDF5_LOCK_HPP_
@@ -0,0 +1,196 @@
+#ifndef _BLASR_HDF_BAS_READ_AHEAD_HPP_
+#define _BLASR_HDF_BAS_READ_AHEAD_HPP_
+
+#include <pthread.h>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "H5Cpp.h"
+#include "Types.h"
+
+//
+// The fields of a run of consecutive ZMWs, read with one hyperslab per
+// dataset.  Per-ZMW fields are indexed by read - firstRead, and per-base
+// fields by base - firstBase.  Fields that are not included are left
+// empty.
+//
+class HDFBasReadAheadBlock {
+public:
+    int firstRead, nReads;
+    DNALength firstBase, nBases;
+
+    std::vector<int> readLengths;
+    std::vector<unsigned int> holeNumbers;
+    std::vector<unsigned char> holeStatus;
+    std::vector<int16_t> holeXY;
+    std::vector<unsigned int> simulatedSequenceIndex;
+    std::vector<unsigned int> simulatedCoordinate;
+    std::vector<float> hqRegionSNR;
+    std::vector<float> readScore;
+
+    std::vector<unsigned char> baseCalls;
+    std::vector<unsigned char> qualityValues;
+    std::vector<unsigned char> deletionQV;
+    std::vector<unsigned char> deletionTag;
+    std::vector<unsigned char> insertionQV;
+    std::vector<unsigned char> substitutionQV;
+    std::vector<unsigned char> substitutionTag;
+    std::vector<unsigned char> mergeQV;
+    std::vector<uint16_t> widthInFrames;
+    std::vector<uint16_t> preBaseFrames;
+    std::vector<int> pulseIndex;
+
+    HDFBasReadAheadBlock() {
+        firstRead = nReads = 0;
+        firstBase = nBases = 0;
+    }
+
+    bool ContainsRead(int read) {
+        return read >= firstRead and read < firstRead + nReads;
+    }
+};
+
+//
+// Reads blocks of ZMWs from a bas reader on a background thread, one
+// block ahead of the block being consumed, so that the latency of the
+// next HDF5 reads overlaps with processing the current reads.
+//
+// While the thread runs it is the only one that calls HDF5 through the
+// reader.  Other threads may still read other files, so
+// T_HDFBasReader only reads ahead with a thread-safe HDF5.
+//
+template<typename T_Reader>
+class HDFBasReadAhead {
+public:
+    HDFBasReadAhead() {
+        reader     = NULL;
+        running    = false;
+        stopping   = false;
+        nFilled    = nTaken = 0;
+        nextRead   = 0;
+        nextBase   = 0;
+        blockZMWs  = 0;
+        pthread_mutex_init(&lock, NULL);
+        pthread_cond_init(&blockFilled, NULL);
+        pthread_cond_init(&blockTaken, NULL);
+    }
+
+    ~HDFBasReadAhead() {
+        Stop();
+        pthread_mutex_destroy(&lock);
+        pthread_cond_destroy(&blockFilled);
+        pthread_cond_destroy(&blockTaken);
+    }
+
+    //
+    // Start reading blocks of nZMWs ZMWs at firstRead, whose bases
+    // start at firstBase.
+    //
+    void Start(T_Reader *readerP, int firstRead, DNALength firstBase, int nZMWs) {
+        Stop();
+        reader    = readerP;
+        nextRead  = firstRead;
+        nextBase  = firstBase;
+        blockZMWs = nZMWs;
+        nFilled   = nTaken = 0;
+        stopping  = false;
+        if (pthread_create(&thread, NULL, ReadBlocksThread, this) != 0) {
+            std::cout << "ERROR, could not start the read-ahead thread." << std::endl;
+            exit(1);
+        }
+        running = true;
+    }
+
+    //
+    // Return the block after the one last returned, which is then free
+    // to be refilled.  A block with no reads marks the end of the file.
+    //
+    HDFBasReadAheadBlock *NextBlock() {
+        pthread_mutex_lock(&lock);
+        while (nFilled == nTaken) {
+            pthread_cond_wait(&blockFilled, &lock);
+        }
+        HDFBasReadAheadBlock *block = &blocks[nTaken % 2];
+        nTaken++;
+        pthread_cond_signal(&blockTaken);
+        pthread_mutex_unlock(&lock);
+        return block;
+    }
+
+    void Stop() {
+        if (not running) {
+            return;
+        }
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_signal(&blockTaken);
+        pthread_mutex_unlock(&lock);
+        pthread_join(thread, NULL);
+        running = false;
+    }
+
+    bool IsRunning() {
+        return running;
+    }
+
+private:
+    T_Reader *reader;
+    //
+    // Block k is filled into blocks[k % 2].  The consumer holds block
+    // nTaken - 1, so block nFilled may be filled once nFilled <= nTaken.
+    //
+    HDFBasReadAheadBlock blocks[2];
+    unsigned long nFilled, nTaken;
+    int nextRead;
+    DNALength nextBase;
+    int blockZMWs;
+    bool running, stopping;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t blockFilled, blockTaken;
+
+    static void *ReadBlocksThread(void *readAheadPtr) {
+        ((HDFBasReadAhead<T_Reader>*) readAheadPtr)->ReadBlocks();
+        return NULL;
+    }
+
+    void ReadBlocks() {
+        while (true) {
+            pthread_mutex_lock(&lock);
+            while (nFilled > nTaken and not stopping) {
+                pthread_cond_wait(&blockTaken, &lock);
+            }
+            if (stopping) {
+                pthread_mutex_unlock(&lock);
+                return;
+            }
+            HDFBasReadAheadBlock &block = blocks[nFilled % 2];
+            pthread_mutex_unlock(&lock);
+
+            try {
+                reader->ReadAheadBlock(block, nextRead, nextBase, blockZMWs);
+            } catch (H5::Exception &e) {
+                std::cout << "ERROR, could not read ahead ZMWs " << nextRead
+                          << " to " << nextRead + blockZMWs << std::endl;
+                exit(1);
+            }
+            nextRead += block.nReads;
+            nextBase += block.nBases;
+
+            pthread_mutex_lock(&lock);
+            nFilled++;
+            pthread_cond_signal(&blockFilled);
+            pthread_mutex_unlock(&lock);
+            if (block.nReads == 0) {
+                return;
+            }
+        }
+    }
+
+    // Not copyable: the read-ahead owns its thread.
+    HDFBasReadAhead(const HDFBasReadAhead &rhs);
+    HDFBasReadAhead &operator=(const HDFBasReadAhead &rhs);
+};
+
+#endif // _BLASR_HDF_BAS_READ_AHEAD_HPP_
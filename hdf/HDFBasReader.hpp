@@ -1,6 +1,7 @@
 #ifndef _BLASR_HDF_BAS_READER_HPP_
 #define _BLASR_HDF_BAS_READER_HPP_
 
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 #include <vector>
@@ -21,6 +22,8 @@
 #include "HDFZMWReader.hpp"
 #include "HDFScanDataReader.hpp"
 #include "HDFPulseDataFile.hpp"
+#include "HDFBasReadAhead.hpp"
+#include "HDF5Lock.hpp"
 #include "DatasetCollection.hpp"
 
 //
@@ -61,6 +64,13 @@
 //   read.PritnSeq(cout);
 // }
 //
+// * On file systems where each small read is slow, call
+// reader.SetReadAhead(nZMWs) after initializing.  The fields of the
+// next nZMWs ZMWs are then read in one hyperslab per dataset on a
+// background thread, and GetNext copies reads out of memory.  This
+// needs a thread-safe HDF5 (H5_HAVE_THREADSAFE); otherwise reads are
+// not read ahead.
+//
 
 template<typename T_Sequence>
 class T_HDFBasReader : public DatasetCollection, public HDFPulseDataFile {
@@ -117,6 +127,22 @@ public:
     ChangeListID changeList;
     QVScale qvScale;
 
+    //
+    // The number of ZMWs read ahead at a time, or 0 to read each field
+    // of each read as it is requested.  readAheadBlock holds curRead
+    // while reading ahead.
+    //
+    int readAheadZMWs;
+    HDFBasReadAhead<T_HDFBasReader<T_Sequence> > readAhead;
+    HDFBasReadAheadBlock *readAheadBlock;
+
+    //
+    // Hold HDF5Lock around each read from HDF5 while reading a read, so
+    // that readers of one file may be used from several threads, as in
+    // HDFBasReaderPool.
+    //
+    bool lockHDF5;
+
     PlatformId GetPlatform() {
         return scanDataReader.platformId;
     }
@@ -131,6 +157,7 @@ public:
         // offset positions.  Check for that and build if it does not
         // exist. 
         //
+        StopReadAhead();
         if (preparedForRandomAccess == false) {
             PrepareForRandomAccess();
         }
@@ -157,6 +184,9 @@ public:
         useBasHoleXY = true;
         hasRegionTable = false;
         qvScale = POverOneMinusP; //default 0 = POverOneMinusP
+        readAheadZMWs = 0;
+        readAheadBlock = NULL;
+        lockHDF5 = false;
         fieldNames.push_back("Basecall");
         fieldNames.push_back("DeletionQV");
         fieldNames.push_back("DeletionTag");
@@ -592,10 +622,186 @@ public:
         readTitle = readTitleStrm.str();
     }
 
+    //
+    // Read nZMWs ZMWs ahead at a time on a background thread; 0 turns
+    // reading ahead off.  While reading ahead, only the GetNext
+    // functions, GetReadAt, Advance, and Close may be used.
+    //
+    // The thread calls HDF5 while other threads may read other files,
+    // so reading ahead is left off unless HDF5 is thread-safe.
+    //
+    void SetReadAhead(int nZMWs) {
+        StopReadAhead();
+#ifdef H5_HAVE_THREADSAFE
+        readAheadZMWs = std::max(nZMWs, 0);
+#else
+        readAheadZMWs = 0;
+#endif
+    }
+
+    void StopReadAhead() {
+        readAhead.Stop();
+        readAheadBlock = NULL;
+    }
+
+    //
+    // Make readAheadBlock hold curRead.  The read-ahead thread is
+    // restarted at curRead when the reads are not taken in order.
+    //
+    void PrepareReadAhead() {
+        if (readAheadZMWs == 0 or curRead >= nReads) {
+            return;
+        }
+        if (readAheadBlock != NULL and readAheadBlock->ContainsRead(curRead)) {
+            return;
+        }
+        if (readAheadBlock == NULL or
+            curRead != readAheadBlock->firstRead + readAheadBlock->nReads or
+            curBasePos != readAheadBlock->firstBase + readAheadBlock->nBases) {
+            readAhead.Start(this, curRead, curBasePos, readAheadZMWs);
+        }
+        readAheadBlock = readAhead.NextBlock();
+        assert(readAheadBlock->ContainsRead(curRead) and
+               readAheadBlock->firstBase == curBasePos);
+    }
+
+    //
+    // Read the fields of nZMWs ZMWs starting at firstRead into block.
+    // This runs on the read-ahead thread.
+    //
+    void ReadAheadBlock(HDFBasReadAheadBlock &block, int firstRead,
+                        DNALength firstBase, int nZMWs) {
+        block.firstRead = firstRead;
+        block.firstBase = firstBase;
+        block.nReads    = std::max(std::min(nZMWs, nReads - firstRead), 0);
+        block.nBases    = 0;
+        if (block.nReads == 0) {
+            return;
+        }
+        int endRead = firstRead + block.nReads;
+        block.readLengths.resize(block.nReads);
+        zmwReader.numEventArray.Read(firstRead, endRead, &block.readLengths[0]);
+        int i;
+        for (i = 0; i < block.nReads; i++) {
+            block.nBases += block.readLengths[i];
+        }
+        block.holeNumbers.resize(block.nReads);
+        zmwReader.holeNumberArray.Read(firstRead, endRead, &block.holeNumbers[0]);
+        block.holeStatus.resize(block.nReads);
+        zmwReader.holeStatusArray.Read(firstRead, endRead, &block.holeStatus[0]);
+        if (zmwReader.readHoleXY) {
+            block.holeXY.resize(2 * block.nReads);
+            zmwReader.xyArray.Read(firstRead, endRead, &block.holeXY[0]);
+        }
+        ReadAheadField(simulatedSequenceIndexArray, "SimulatedSequenceIndex",
+                       block.simulatedSequenceIndex, firstRead, endRead);
+        ReadAheadField(simulatedCoordinateArray, "SimulatedCoordinate",
+                       block.simulatedCoordinate, firstRead, endRead);
+        ReadAheadField(readScoreArray, "ReadScore", block.readScore, firstRead, endRead);
+        if (FieldIsIncluded("HQRegionSNR")) {
+            block.hqRegionSNR.resize(4 * block.nReads);
+            hqRegionSNRMatrix.Read(firstRead, endRead, &block.hqRegionSNR[0]);
+        }
+
+        if (block.nBases == 0) {
+            return;
+        }
+        DNALength endBase = firstBase + block.nBases;
+        ReadAheadField(baseArray, "Basecall", block.baseCalls, firstBase, endBase);
+        ReadAheadField(qualArray, "QualityValue", block.qualityValues, firstBase, endBase);
+        ReadAheadField(deletionQVArray, "DeletionQV", block.deletionQV, firstBase, endBase);
+        ReadAheadField(deletionTagArray, "DeletionTag", block.deletionTag, firstBase, endBase);
+        ReadAheadField(insertionQVArray, "InsertionQV", block.insertionQV, firstBase, endBase);
+        ReadAheadField(substitutionQVArray, "SubstitutionQV", block.substitutionQV, firstBase, endBase);
+        ReadAheadField(substitutionTagArray, "SubstitutionTag", block.substitutionTag, firstBase, endBase);
+        ReadAheadField(mergeQVArray, "MergeQV", block.mergeQV, firstBase, endBase);
+        ReadAheadField(basWidthInFramesArray, "WidthInFrames", block.widthInFrames, firstBase, endBase);
+        ReadAheadField(preBaseFramesArray, "PreBaseFrames", block.preBaseFrames, firstBase, endBase);
+        ReadAheadField(pulseIndexArray, "PulseIndex", block.pulseIndex, firstBase, endBase);
+    }
+
+    template<typename T>
+    void ReadAheadField(HDFArray<T> &array, const char *fieldName,
+                           std::vector<T> &dest, UInt start, UInt end) {
+        if (FieldIsIncluded(fieldName)) {
+            dest.resize(end - start);
+            array.Read(start, end, &dest[0]);
+        }
+    }
+
+    //
+    // Read the values of a per-base field for the bases of the current
+    // read, from the read-ahead block if there is one.
+    //
+    template<typename T>
+    void ReadBaseField(HDFArray<T> &array, std::vector<T> HDFBasReadAheadBlock::*readAheadField,
+                       DNALength length, T *dest) {
+        if (readAheadBlock != NULL) {
+            const T *values = &(readAheadBlock->*readAheadField)[curBasePos - readAheadBlock->firstBase];
+            std::copy(values, values + length, dest);
+        }
+        else {
+            LockReads();
+            array.Read((int)curBasePos, (int) curBasePos + length, dest);
+            UnlockReads();
+        }
+    }
+
+    //
+    // Read the value of a per-ZMW field for the ZMW at index.
+    //
+    template<typename T>
+    void ReadZMWField(HDFArray<T> &array, std::vector<T> HDFBasReadAheadBlock::*readAheadField,
+                      int index, T *dest) {
+        if (readAheadBlock != NULL) {
+            *dest = (readAheadBlock->*readAheadField)[index - readAheadBlock->firstRead];
+        }
+        else {
+            LockReads();
+            array.Read(index, index + 1, dest);
+            UnlockReads();
+        }
+    }
+
+    void LockReads() {
+        if (lockHDF5) {
+            HDF5Lock::Lock();
+        }
+    }
+
+    void UnlockReads() {
+        if (lockHDF5) {
+            HDF5Lock::Unlock();
+        }
+    }
+
+    void GetNextZMW(ZMWGroupEntry &groupEntry) {
+        if (readAheadBlock == NULL) {
+            LockReads();
+            zmwReader.GetNext(groupEntry);
+            UnlockReads();
+            return;
+        }
+        int i = zmwReader.curZMW - readAheadBlock->firstRead;
+        if (zmwReader.readHoleNumber) {
+            groupEntry.holeNumber = readAheadBlock->holeNumbers[i];
+        }
+        if (zmwReader.readHoleStatus) {
+            groupEntry.holeStatus = readAheadBlock->holeStatus[i];
+        }
+        if (zmwReader.readHoleXY) {
+            groupEntry.x = readAheadBlock->holeXY[2 * i];
+            groupEntry.y = readAheadBlock->holeXY[2 * i + 1];
+        }
+        groupEntry.numEvents = readAheadBlock->readLengths[i];
+        zmwReader.curZMW++;
+    }
+
     int GetNext(FASTASequence &seq) {
         if (curRead == nReads) {
             return 0;
         }
+        PrepareReadAhead();
 
         int seqLength;
         try {
@@ -616,13 +822,15 @@ public:
             if (curRead == nReads) {
                 return 0;
             }
+            PrepareReadAhead();
             int seqLength = GetNextWithoutPosAdvance(seq);
             seq.length = seqLength;
 
             if (seqLength > 0 ) {
                 if (includedFields["QualityValue"]) {
                     seq.AllocateQualitySpace(seqLength);
-                    qualArray.Read((int)curBasePos, (int) curBasePos + seqLength, (unsigned char*) seq.qual.data);
+                    ReadBaseField(qualArray, &HDFBasReadAheadBlock::qualityValues,
+                                  seqLength, (unsigned char*) seq.qual.data);
                 }
             }
 
@@ -663,6 +871,7 @@ public:
             if (curRead == nReads) {
                 return 0;
             }
+            PrepareReadAhead();
 
             // must be done before GetNextWithoutPosAdvance (which increments curRead)
             // get ZMWMetrics fields
@@ -679,9 +888,8 @@ public:
                 if (seqLength > 0 ) {
                     if (includedFields["QualityValue"]) {
                         seq.AllocateQualitySpace(seqLength);
-                        qualArray.Read((int)curBasePos, 
-                                       (int) curBasePos + seqLength, 
-                                       (unsigned char*) seq.qual.data);
+                        ReadBaseField(qualArray, &HDFBasReadAheadBlock::qualityValues,
+                                      seqLength, (unsigned char*) seq.qual.data);
                     }
                 }
             }
@@ -691,7 +899,7 @@ public:
 
             seq.subreadStart = 0;
             seq.subreadEnd   = seq.length;
-            zmwReader.GetNext(seq.zmwData);
+            GetNextZMW(seq.zmwData);
             seq.xy[0] = seq.zmwData.x;
             seq.xy[1] = seq.zmwData.y;
         } catch (H5::DataSetIException e) {
@@ -723,6 +931,7 @@ public:
             if (curRead == nReads) {
                 return 0;
             }
+            PrepareReadAhead();
 
             // get ZMWMetrics fields, must be done before GetNext
             // (which calls GetNextWithoutAdvancePos, which increments curRead)
@@ -761,7 +970,7 @@ public:
             //
             seq.subreadStart = 0;
             seq.subreadEnd   = seq.length;
-            zmwReader.GetNext(seq.zmwData);
+            GetNextZMW(seq.zmwData);
             seq.xy[0] = seq.zmwData.x;
             seq.xy[1] = seq.zmwData.y;
         } catch(H5::DataSetIException e) {
@@ -816,6 +1025,7 @@ public:
         int i;
         // cannot advance past the end of this file
         if (curRead + nSeq >= nReads) { return 0; }
+        StopReadAhead();
         for (i = curRead; i < curRead + nSeq && i < nReads; i++ ) {
             int seqLength;
             zmwReader.numEventArray.Read(i, i+1, &seqLength);
@@ -829,33 +1039,33 @@ public:
     int GetNextWithoutPosAdvance(FASTASequence &seq) {
         int seqLength;
 
-        zmwReader.numEventArray.Read(curRead, curRead+1, &seqLength);
+        ReadZMWField(zmwReader.numEventArray, &HDFBasReadAheadBlock::readLengths, curRead, &seqLength);
         seq.length = 0;
         seq.seq = NULL;
 
         if (includedFields["Basecall"]) {
             if (seqLength > 0) {
                 ResizeSequence(seq, seqLength);
-                baseArray.Read(curBasePos, curBasePos + seqLength, (unsigned char*) seq.seq);
+                ReadBaseField(baseArray, &HDFBasReadAheadBlock::baseCalls, seqLength, (unsigned char*) seq.seq);
             }
         }
 
         std::string readTitle;
         unsigned int holeNumber;
         unsigned char holeStatus;
-        zmwReader.holeNumberArray.Read(curRead, curRead+1, &holeNumber);
+        ReadZMWField(zmwReader.holeNumberArray, &HDFBasReadAheadBlock::holeNumbers, curRead, &holeNumber);
         seq.StoreHoleNumber(holeNumber);
 
-        zmwReader.holeStatusArray.Read(curRead, curRead+1, &holeStatus);
+        ReadZMWField(zmwReader.holeStatusArray, &HDFBasReadAheadBlock::holeStatus, curRead, &holeStatus);
         seq.StoreHoleStatus(holeStatus);
 
         DNALength simIndex=0, simCoordinate=0;
 
         if (includedFields["SimulatedSequenceIndex"] == true) {
-            simulatedSequenceIndexArray.Read(curRead,curRead+1,&simIndex);
+            ReadZMWField(simulatedSequenceIndexArray, &HDFBasReadAheadBlock::simulatedSequenceIndex, curRead, &simIndex);
         }
         if (includedFields["SimulatedCoordinate"] == true) {
-            simulatedCoordinateArray.Read(curRead, curRead+1, &simCoordinate);
+            ReadZMWField(simulatedCoordinateArray, &HDFBasReadAheadBlock::simulatedCoordinate, curRead, &simCoordinate);
         }
 
         BuildReadTitle(scanDataReader.GetMovieName(), holeNumber, readTitle, simIndex, simCoordinate);
@@ -868,28 +1078,28 @@ public:
     int GetNextDeletionQV(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateDeletionQVSpace(seq.length);
-        deletionQVArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.deletionQV.data);
+        ReadBaseField(deletionQVArray, &HDFBasReadAheadBlock::deletionQV, seq.length, (unsigned char*) seq.deletionQV.data);
         return seq.length;
     }
 
     int GetNextMergeQV(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateMergeQVSpace(seq.length);
-        mergeQVArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.mergeQV.data);
+        ReadBaseField(mergeQVArray, &HDFBasReadAheadBlock::mergeQV, seq.length, (unsigned char*) seq.mergeQV.data);
         return seq.length;
     }
 
     int GetNextDeletionTag(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateDeletionTagSpace(seq.length);
-        deletionTagArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.deletionTag);
+        ReadBaseField(deletionTagArray, &HDFBasReadAheadBlock::deletionTag, seq.length, (unsigned char*) seq.deletionTag);
         return seq.length;
     }
 
     int GetNextInsertionQV(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateInsertionQVSpace(seq.length);
-        insertionQVArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.insertionQV.data);
+        ReadBaseField(insertionQVArray, &HDFBasReadAheadBlock::insertionQV, seq.length, (unsigned char*) seq.insertionQV.data);
         return seq.length;
     }
 
@@ -900,7 +1110,7 @@ public:
             seq.widthInFrames = NULL;
         }
         seq.widthInFrames = new HalfWord[seq.length];
-        basWidthInFramesArray.Read((int)curBasePos, (int) curBasePos + seq.length, (HalfWord*) seq.widthInFrames);
+        ReadBaseField(basWidthInFramesArray, &HDFBasReadAheadBlock::widthInFrames, seq.length, (HalfWord*) seq.widthInFrames);
         return seq.length;
     }
 
@@ -911,7 +1121,7 @@ public:
             seq.preBaseFrames = NULL;
         }
         seq.preBaseFrames = new HalfWord[seq.length];
-        preBaseFramesArray.Read((int)curBasePos, (int) curBasePos + seq.length, (HalfWord*) seq.preBaseFrames);
+        ReadBaseField(preBaseFramesArray, &HDFBasReadAheadBlock::preBaseFrames, seq.length, (HalfWord*) seq.preBaseFrames);
         return seq.length;
     }
     int GetNextPulseIndex(SMRTSequence &seq) {
@@ -921,12 +1131,20 @@ public:
             seq.pulseIndex = NULL;
         }
         seq.pulseIndex = new int[seq.length];
-        pulseIndexArray.Read((int)curBasePos, (int) curBasePos + seq.length, (int*) seq.pulseIndex);
+        ReadBaseField(pulseIndexArray, &HDFBasReadAheadBlock::pulseIndex, seq.length, (int*) seq.pulseIndex);
         return seq.length;
     }
     int GetNextHQRegionSNR(SMRTSequence &seq) {
         float snrs[4];
-        hqRegionSNRMatrix.Read(curRead, curRead + 1, snrs);
+        if (readAheadBlock != NULL) {
+            const float *values = &readAheadBlock->hqRegionSNR[4 * (curRead - readAheadBlock->firstRead)];
+            std::copy(values, values + 4, snrs);
+        }
+        else {
+            LockReads();
+            hqRegionSNRMatrix.Read(curRead, curRead + 1, snrs);
+            UnlockReads();
+        }
 
         // Get BaseMap from ScanData.
         std::map<char, size_t> baseMap = scanDataReader.BaseMap();
@@ -938,24 +1156,25 @@ public:
         return 4;
     }
     int GetNextReadScore(SMRTSequence &seq) {
-        readScoreArray.Read(curRead, curRead + 1, &seq.readScore);
+        ReadZMWField(readScoreArray, &HDFBasReadAheadBlock::readScore, curRead, &seq.readScore);
         return 1;
     }
     int GetNextSubstitutionQV(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateSubstitutionQVSpace(seq.length);
-        substitutionQVArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.substitutionQV.data);
+        ReadBaseField(substitutionQVArray, &HDFBasReadAheadBlock::substitutionQV, seq.length, (unsigned char*) seq.substitutionQV.data);
         return seq.length;
     }
 
     int GetNextSubstitutionTag(FASTQSequence &seq) {
         if (seq.length == 0) return 0;
         seq.AllocateSubstitutionTagSpace(seq.length);
-        substitutionTagArray.Read((int)curBasePos, (int) curBasePos + seq.length, (unsigned char*) seq.substitutionTag);		
+        ReadBaseField(substitutionTagArray, &HDFBasReadAheadBlock::substitutionTag, seq.length, (unsigned char*) seq.substitutionTag);
         return seq.length;
     }
 
     void Close() {
+        StopReadAhead();
 
         baseCallsGroup.Close();
         zmwXCoordArray.Close();
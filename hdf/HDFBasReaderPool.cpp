@@ -0,0 +1,119 @@
+#include "HDFBasReaderPool.hpp"
+
+using namespace std;
+
+HDFBasReaderPool::HDFBasReaderPool() {
+    fileIsOpen = false;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&readerFreed, NULL);
+}
+
+HDFBasReaderPool::~HDFBasReaderPool() {
+    Close();
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&readerFreed);
+}
+
+int HDFBasReaderPool::Initialize(const string &fileName, int nReaders,
+                                 const vector<string> &fieldNames,
+                                 const H5::FileAccPropList &fileAccPropList) {
+    Close();
+    HDF5Lock::Lock();
+    try {
+        H5::Exception::dontPrint();
+        hdfBasFile.openFile(fileName.c_str(), H5F_ACC_RDONLY, fileAccPropList);
+    }
+    catch (H5::Exception &e) {
+        HDF5Lock::Unlock();
+        cout << "ERROR, could not open hdf file " << fileName << endl;
+        return 0;
+    }
+    fileIsOpen = true;
+    if (rootGroup.Initialize(hdfBasFile, "/") == 0) {
+        HDF5Lock::Unlock();
+        return 0;
+    }
+
+    int r;
+    for (r = 0; r < max(nReaders, 1); r++) {
+        T_HDFBasReader<SMRTSequence> *reader = new T_HDFBasReader<SMRTSequence>;
+        readers.push_back(reader);
+        if (fieldNames.empty()) {
+            reader->InitializeDefaultIncludedFields();
+        }
+        else {
+            reader->InitializeAllFields(false);
+            size_t f;
+            for (f = 0; f < fieldNames.size(); f++) {
+                reader->IncludeField(fieldNames[f]);
+            }
+        }
+        if (reader->Initialize(&rootGroup) == 0) {
+            HDF5Lock::Unlock();
+            return 0;
+        }
+        //
+        // The offsets of the reads are read once and shared.
+        //
+        if (r == 0) {
+            reader->PrepareForRandomAccess();
+        }
+        else {
+            reader->eventOffset = readers[0]->eventOffset;
+            reader->preparedForRandomAccess = true;
+        }
+        reader->lockHDF5 = true;
+        freeReaders.push_back(r);
+    }
+    HDF5Lock::Unlock();
+    return 1;
+}
+
+int HDFBasReaderPool::GetNumReads() {
+    if (readers.empty()) {
+        return 0;
+    }
+    return readers[0]->GetNumReads();
+}
+
+int HDFBasReaderPool::GetReadAt(int index, SMRTSequence &read) {
+    int r = TakeReader();
+    int retVal = readers[r]->GetReadAt(index, read);
+    ReturnReader(r);
+    return retVal;
+}
+
+int HDFBasReaderPool::TakeReader() {
+    pthread_mutex_lock(&lock);
+    while (freeReaders.empty()) {
+        pthread_cond_wait(&readerFreed, &lock);
+    }
+    int r = freeReaders.back();
+    freeReaders.pop_back();
+    pthread_mutex_unlock(&lock);
+    return r;
+}
+
+void HDFBasReaderPool::ReturnReader(int r) {
+    pthread_mutex_lock(&lock);
+    freeReaders.push_back(r);
+    pthread_cond_signal(&readerFreed);
+    pthread_mutex_unlock(&lock);
+}
+
+void HDFBasReaderPool::Close() {
+    HDF5Lock::Lock();
+    size_t r;
+    for (r = 0; r < readers.size(); r++) {
+        readers[r]->Close();
+        delete readers[r];
+    }
+    readers.clear();
+    freeReaders.clear();
+    if (fileIsOpen) {
+        rootGroup.Close();
+        hdfBasFile.close();
+        fileIsOpen = false;
+    }
+    HDF5Lock::Unlock();
+}
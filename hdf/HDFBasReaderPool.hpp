@@ -0,0 +1,65 @@
+#ifndef _BLASR_HDF_BAS_READER_POOL_HPP_
+#define _BLASR_HDF_BAS_READER_POOL_HPP_
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "H5Cpp.h"
+#include "SMRTSequence.hpp"
+#include "HDFGroup.hpp"
+#include "HDFBasReader.hpp"
+#include "HDF5Lock.hpp"
+
+//
+// Random access to the reads of one bas/bax file from several threads.
+// The file is opened once, and each reader in the pool opens its own
+// handles on the datasets in it, with its own read buffers.  A thread
+// takes a free reader for each GetReadAt, so threads only wait on each
+// other when all readers are busy, or inside HDF5.
+//
+// Each read from HDF5 holds HDF5Lock, which serializes calls into HDF5
+// unless it is built thread-safe.  Copying and converting the values
+// read is done outside the lock.
+//
+class HDFBasReaderPool {
+public:
+    HDFBasReaderPool();
+    ~HDFBasReaderPool();
+
+    //
+    // Open fileName with nReaders readers, reading the fields in
+    // fieldNames, or the default fields if it is empty.
+    //
+    int Initialize(const std::string &fileName, int nReaders,
+                   const std::vector<std::string> &fieldNames = std::vector<std::string>(),
+                   const H5::FileAccPropList &fileAccPropList = H5::FileAccPropList::DEFAULT);
+
+    int GetNumReads();
+
+    //
+    // Read the read at index into read; safe to call from any thread.
+    //
+    int GetReadAt(int index, SMRTSequence &read);
+
+    void Close();
+
+private:
+    H5::H5File hdfBasFile;
+    HDFGroup rootGroup;
+    bool fileIsOpen;
+    std::vector<T_HDFBasReader<SMRTSequence>*> readers;
+    std::vector<int> freeReaders;
+    pthread_mutex_t lock;
+    pthread_cond_t readerFreed;
+
+    int TakeReader();
+
+    void ReturnReader(int r);
+
+    // Not copyable: the pool owns its readers.
+    HDFBasReaderPool(const HDFBasReaderPool &rhs);
+    HDFBasReaderPool &operator=(const HDFBasReaderPool &rhs);
+};
+
+#endif // _BLASR_HDF_BAS_READER_POOL_HPP_
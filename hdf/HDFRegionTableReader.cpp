@@ -113,11 +113,24 @@ void HDFRegionTableReader::ReadTable(RegionTable &table) {
         return;
     }
     ReadTableAttributes(table);
-    table.table.resize(nRows);
-    int i = 0;
-    while(GetNext(table.table[curRow])) {
-        i++;
+    //
+    // Read the whole dataset in one hyperslab, then split it into the
+    // columns of the table.
+    //
+    table.Resize(nRows);
+    if (nRows > 0) {
+        std::vector<int> rows(nRows * RegionAnnotation::NCOLS);
+        regions.Read(0, nRows, &rows[0]);
+        int r, c;
+        for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+            int *column = &table.columns[c][0];
+            for (r = 0; r < nRows; r++) {
+                column[r] = rows[r * RegionAnnotation::NCOLS + c];
+            }
+        }
     }
+    curRow = nRows;
+    table.IndexHoleNumbers();
 }
 
 
@@ -125,19 +138,17 @@ void HDFRegionTableReader::GetMinMaxHoleNumber(UInt &minHole,
                                                UInt &maxHole) {
     // Hole numbers may not be sorted ascendingly, so do not
     // return the first and last hole numbers as the min and max.
-    UInt saveCurRow = curRow;
-    curRow = 0;
-    bool init = false;
-    RegionAnnotation annotation;
-    while (GetNext(annotation) == 1) {
-        UInt curHole = annotation.GetHoleNumber();
-        if (not init) {
-            minHole = maxHole = curHole;
-            init = true;
-        } else {
-            minHole = (minHole > curHole)?(curHole):(minHole);
-            maxHole = (maxHole < curHole)?(curHole):(maxHole);
-        }
+    if (fileContainsRegionTable == false or nRows == 0) {
+        return;
+    }
+    std::vector<int> holeNumbers(nRows);
+    regions.Read(0, nRows, RegionAnnotation::HOLENUMBERCOL,
+                 RegionAnnotation::HOLENUMBERCOL + 1, &holeNumbers[0]);
+    minHole = maxHole = holeNumbers[0];
+    int r;
+    for (r = 1; r < nRows; r++) {
+        UInt curHole = holeNumbers[r];
+        minHole = (minHole > curHole)?(curHole):(minHole);
+        maxHole = (maxHole < curHole)?(curHole):(maxHole);
     }
-    curRow = saveCurRow;
 }
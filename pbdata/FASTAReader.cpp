@@ -3,6 +3,9 @@
 #include <iostream>
 #include <vector>
 #include <limits.h>
+#include <string.h>
+#include <pthread.h>
+#include <algorithm>
 #include <sys/types.h>
 #include <unistd.h>
 #include "sys/mman.h"
@@ -34,6 +37,8 @@ void FASTAReader::Init() {
     doToUpper = false;
     convMat = PreserveCase;
     computeMD5 = false;
+    nThreads = 1;
+    pieceSize = 1L << 23;
     filePtr = NULL;
     curPos = 0;
 }
@@ -55,6 +60,10 @@ void FASTAReader::SetSpacePadding(int _padding) {
     padding = _padding;
 }
 
+void FASTAReader::SetNumThreads(int nThreadsP) {
+    nThreads = nThreadsP;
+}
+
 void FASTAReader::SetToUpper() {
     doToUpper = true;
     convMat   = AllToUpper;
@@ -105,6 +114,192 @@ void FASTAReader::CheckValidTitleStart(long &p, char delim) {
     }
 }
 
+//
+// A stretch of the sequence lines of one record in the mapped file.
+// Bases are counted and packed a piece at a time, so that the work on
+// one long record is shared by several threads.
+//
+class FASTAPiece {
+public:
+    int record;
+    long fileStart, fileEnd;
+    long nBases;
+    long seqPos;
+};
+
+class FASTAPackState {
+public:
+    enum Pass {CountPass, PackPass, MD5Pass};
+    const char *filePtr;
+    unsigned char *convMat;
+    Nucleotide *seq;
+    std::vector<FASTAPiece> pieces;
+    std::vector<long> recordStarts, recordLengths;
+    std::vector<std::string> md5s;
+    Pass pass;
+    //
+    // The next piece or record to work on, taken atomically.
+    //
+    long next;
+};
+
+static inline bool IsFASTASpace(char c) {
+    return (c == ' ' or c == '\n' or c == '\t' or c == '\r');
+}
+
+static void *FASTAPackThread(void *statePtr) {
+    FASTAPackState *state = (FASTAPackState*) statePtr;
+    long n = (state->pass == FASTAPackState::MD5Pass ?
+              state->recordStarts.size() : state->pieces.size());
+    long i;
+    while ((i = __atomic_fetch_add(&state->next, 1, __ATOMIC_RELAXED)) < n) {
+        if (state->pass == FASTAPackState::MD5Pass) {
+            MakeMD5((const char*) &state->seq[state->recordStarts[i]],
+                    state->recordLengths[i], state->md5s[i]);
+            continue;
+        }
+        FASTAPiece &piece = state->pieces[i];
+        const char *filePtr = state->filePtr;
+        long p;
+        if (state->pass == FASTAPackState::CountPass) {
+            long nBases = 0;
+            for (p = piece.fileStart; p < piece.fileEnd; p++) {
+                nBases += not IsFASTASpace(filePtr[p]);
+            }
+            piece.nBases = nBases;
+        }
+        else {
+            Nucleotide *dest = &state->seq[piece.seqPos];
+            unsigned char *convMat = state->convMat;
+            for (p = piece.fileStart; p < piece.fileEnd; p++) {
+                char c = filePtr[p];
+                if (not IsFASTASpace(c)) {
+                    *dest = convMat[(unsigned char) c];
+                    ++dest;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+static void RunFASTAPass(FASTAPackState &state, FASTAPackState::Pass pass,
+                         int nThreads) {
+    state.pass = pass;
+    state.next = 0;
+    std::vector<pthread_t> threads(std::max(nThreads, 1) - 1);
+    size_t t;
+    for (t = 0; t < threads.size(); t++) {
+        if (pthread_create(&threads[t], NULL, FASTAPackThread, &state) != 0) {
+            cout << "ERROR, could not start a thread to read a FASTA file." << endl;
+            exit(1);
+        }
+    }
+    FASTAPackThread(&state);
+    for (t = 0; t < threads.size(); t++) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+long FASTAReader::PackAllSequences(long p, Nucleotide *&seq, long &seqLength,
+    std::vector<long> &seqStartPos, std::vector<std::string> &names,
+    std::vector<std::string> &md5s) {
+    FASTAPackState state;
+    state.filePtr = filePtr;
+    state.convMat = convMat;
+
+    //
+    // Split the file into records at each '>' outside of a title, and
+    // the records into pieces.  The first title has been read already.
+    //
+    int record = 0;
+    long recordStart = p;
+    while (true) {
+        const char *titlePtr = (const char*) memchr(&filePtr[p], '>', fileSize - p);
+        long recordEnd = (titlePtr == NULL ? fileSize : titlePtr - filePtr);
+        FASTAPiece piece;
+        piece.record = record;
+        piece.nBases = piece.seqPos = 0;
+        for (piece.fileStart = recordStart; piece.fileStart < recordEnd;
+             piece.fileStart = piece.fileEnd) {
+            piece.fileEnd = std::min(piece.fileStart + pieceSize, recordEnd);
+            state.pieces.push_back(piece);
+        }
+        if (titlePtr == NULL) {
+            break;
+        }
+        long titleStart = recordEnd + 1;
+        const char *titleEndPtr = (const char*) memchr(&filePtr[titleStart], '\n', fileSize - titleStart);
+        long titleEnd = (titleEndPtr == NULL ? fileSize : titleEndPtr - filePtr);
+        names.push_back(std::string(&filePtr[titleStart], titleEnd - titleStart));
+        p = recordStart = titleEnd;
+        ++record;
+    }
+    int nRecords = record + 1;
+
+    RunFASTAPass(state, FASTAPackState::CountPass, nThreads);
+
+    //
+    // Records are separated by an 'N', and the last one is followed by
+    // one, for consistency between different orderings of the input.
+    //
+    state.recordStarts.resize(nRecords, 0);
+    state.recordLengths.resize(nRecords, 0);
+    long seqPos = 0;
+    size_t i;
+    record = 0;
+    for (i = 0; i < state.pieces.size(); i++) {
+        FASTAPiece &piece = state.pieces[i];
+        while (record < piece.record) {
+            ++record;
+            seqPos += 1;
+            state.recordStarts[record] = seqPos;
+        }
+        piece.seqPos = seqPos;
+        seqPos += piece.nBases;
+        state.recordLengths[record] += piece.nBases;
+    }
+    while (record < nRecords - 1) {
+        ++record;
+        seqPos += 1;
+        state.recordStarts[record] = seqPos;
+    }
+    seqLength = seqPos + 1;
+
+    long memorySize = seqLength + padding + 1;
+    seq = new Nucleotide[memorySize];
+    state.seq = seq;
+    for (record = 1; record < nRecords; record++) {
+        seq[state.recordStarts[record] - 1] = 'N';
+    }
+    seq[seqLength - 1] = 'N';
+    std::fill(&seq[seqLength], &seq[memorySize], 0);
+
+    RunFASTAPass(state, FASTAPackState::PackPass, nThreads);
+    if (computeMD5) {
+        state.md5s.resize(nRecords);
+        RunFASTAPass(state, FASTAPackState::MD5Pass, nThreads);
+        md5s.swap(state.md5s);
+    }
+    seqStartPos.swap(state.recordStarts);
+    return seqLength;
+}
+
+template<typename TPos>
+static void FillFASTADatabase(SequenceIndexDatabase<FASTASequence, TPos> *seqDBPtr,
+                              std::vector<long> &seqStartPos, long seqLength,
+                              std::vector<std::string> &names,
+                              std::vector<std::string> &md5s) {
+    size_t i;
+    for (i = 1; i < seqStartPos.size(); i++) {
+        seqDBPtr->growableSeqStartPos.push_back(seqStartPos[i]);
+    }
+    seqDBPtr->growableSeqStartPos.push_back(seqLength);
+    seqDBPtr->growableName.insert(seqDBPtr->growableName.end(), names.begin(), names.end());
+    seqDBPtr->md5.insert(seqDBPtr->md5.end(), md5s.begin(), md5s.end());
+    seqDBPtr->Finalize();
+}
+
 long FASTAReader::ReadAllSequencesIntoOne(FASTASequence &seq, SequenceIndexDatabase<FASTASequence> *seqDBPtr) {
     seq.Free();
     long p = curPos;
@@ -116,102 +311,49 @@ long FASTAReader::ReadAllSequencesIntoOne(FASTASequence &seq, SequenceIndexDatab
         cout << "ERROR, sequence must have a nonempty title." << endl;
         exit(1);
     }
-    if (seqDBPtr != NULL) {
-        seqDBPtr->growableName.push_back(seq.title);
-    }
+    std::vector<long> seqStartPos;
+    std::vector<std::string> names(1, seq.title), md5s;
+    Nucleotide *seqPtr;
     long seqLength;
-    seqLength = fileSize - p;
-    long memorySize = seqLength+padding+1;
-
-    long a = memorySize;
-    if (memorySize > UINT_MAX) {
-        cout << "ERROR! Reading fasta files greater than 4Gbytes is not supported." << endl;
-        exit(1);
-    }
-    seq.Resize(memorySize);
-    long i;
-    i = 0L;
-    for (; p < fileSize; p++, i++ ) {
-        seq.seq[i] = filePtr[p];
-    }
-    i = p = 0;
-    while (p < seqLength) {
-        //
-        // If this is the beginning of another read, add an 'N' 
-        // to delineate spaces between reads.
-        //
-
-        while (p < seqLength and
-                (seq.seq[p] == ' ' or
-                 seq.seq[p] == '\n' or 
-                 seq.seq[p] == '\t' or
-                 seq.seq[p] == '\r')) {
-            p++;
-        }
-        if (p < seqLength and seq.seq[p] == '>') {
-            seq.seq[i] = 'N';
-
-            long titleStartPos = p+1;
-            i++;
-            while (p < seqLength and seq.seq[p] != '\n') p++;
-            if (seqDBPtr != NULL and p < seqLength) {
-                string title;
-                long tp;
-                for (tp = titleStartPos; tp < p; tp++) {
-                    title.push_back(seq.seq[tp]);
-                }
-
-                seqDBPtr->growableName.push_back(title);
-                seqDBPtr->growableSeqStartPos.push_back(i);
-                int nSeq = seqDBPtr->growableSeqStartPos.size();
-                if (nSeq > 1 and computeMD5) {
-                    string md5Str;
-                    MakeMD5((const char*) &seq.seq[seqDBPtr->growableSeqStartPos[nSeq-2]],
-                            seqDBPtr->growableSeqStartPos[nSeq-1] - seqDBPtr->growableSeqStartPos[nSeq-2] - 1,
-                            md5Str);
-                    seqDBPtr->md5.push_back(md5Str);
-                }
-            }
-        }
-        else if (p < seqLength)  {
-            // Otherwise, p may be at whitespace
-            // advance past that as well.
-            seq.seq[i] = convMat[seq.seq[p]];
-            i++;
-            p++;
-        }
-    }
-    if (i > UINT_MAX) {
+    PackAllSequences(p, seqPtr, seqLength, seqStartPos, names, md5s);
+    if (seqLength > UINT_MAX) {
+        delete[] seqPtr;
         cout << "ERROR! Sequences greater than 4Gbase are not supported." << endl;
         exit(1);
     }
-    //
-    // Append an 'N' at the end of the last sequence for consistency
-    // between different orderings of reference input. 
-    //
-    seq.seq[i] = 'N';
-    i++;
-    seq.length = i;
-    // fill padding.
-    for (; i < memorySize; i++ ){
-        seq.seq[i] = 0;
-    }
+    seq.seq = seqPtr;
+    seq.length = seqLength;
     seq.deleteOnExit = true;
     if (seqDBPtr != NULL) {
-        seqDBPtr->growableSeqStartPos.push_back(seq.length);
-        int nSeq = seqDBPtr->growableSeqStartPos.size();
-        if (nSeq > 1 and computeMD5) {
-            string md5Str;
-            MakeMD5((const char*) &seq.seq[seqDBPtr->growableSeqStartPos[nSeq-2]],
-                    seqDBPtr->growableSeqStartPos[nSeq-1] - seqDBPtr->growableSeqStartPos[nSeq-2] - 1,
-                    md5Str);
-            seqDBPtr->md5.push_back(md5Str);
-        }
-        seqDBPtr->Finalize();
+        FillFASTADatabase(seqDBPtr, seqStartPos, seqLength, names, md5s);
     }
     return seq.length;
 }
 
+long FASTAReader::ReadAllSequencesIntoOne(Nucleotide *&seq, uint64_t &seqLength,
+    SequenceIndexDatabase<FASTASequence, uint64_t> *seqDBPtr) {
+    long p = curPos;
+    AdvanceToTitleStart(p);
+    CheckValidTitleStart(p);
+    char *title = NULL;
+    int titleLength;
+    ReadTitle(p, title, titleLength);
+    if (title == NULL) {
+        cout << "ERROR, sequence must have a nonempty title." << endl;
+        exit(1);
+    }
+    std::vector<long> seqStartPos;
+    std::vector<std::string> names(1, std::string(title, titleLength)), md5s;
+    delete[] title;
+    long length;
+    PackAllSequences(p, seq, length, seqStartPos, names, md5s);
+    seqLength = length;
+    if (seqDBPtr != NULL) {
+        FillFASTADatabase(seqDBPtr, seqStartPos, length, names, md5s);
+    }
+    return length;
+}
+
 void FASTAReader::ReadTitle(long &p, FASTASequence & seq) {
     char * seqTitle = NULL;
     int seqTitleLen; 
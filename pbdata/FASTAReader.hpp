@@ -2,6 +2,7 @@
 #define _BLASR_FASTA_READER_HPP_
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "FASTASequence.hpp"
 #include "metagenome/SequenceIndexDatabase.hpp"
 
@@ -16,6 +17,11 @@ protected:
     char readStartDelim;
     bool doToUpper;
     unsigned char *convMat;
+    int nThreads;
+    //
+    // The most bytes of a record that one thread packs at a time.
+    //
+    long pieceSize;
     //
     // Quick check to see how much to read.
     //
@@ -23,6 +29,16 @@ protected:
 
     void ReadTitle(long &p, char *&title, int &titleLength); 
 
+    //
+    // Pack the records from p on, the first of which has had its title
+    // read, into a new sequence separated by 'N', with the records
+    // split across nThreads threads.
+    //
+    long PackAllSequences(long p, Nucleotide *&seq, long &seqLength,
+                          std::vector<long> &seqStartPos,
+                          std::vector<std::string> &names,
+                          std::vector<std::string> &md5s);
+
 public:
     bool computeMD5;
     std::string curReadMD5;
@@ -36,6 +52,11 @@ public:
     void SetSpacePadding(int _padding); 
 
     void SetToUpper(); 
+
+    //
+    // The number of threads ReadAllSequencesIntoOne reads with.
+    //
+    void SetNumThreads(int nThreadsP);
     
     //
     // Synonym for Init() for consistency.
@@ -50,6 +71,13 @@ public:
 
     long ReadAllSequencesIntoOne(FASTASequence &seq, SequenceIndexDatabase<FASTASequence> *seqDBPtr=NULL); 
 
+    //
+    // Read a reference that may be longer than 4 Gbases into seq,
+    // which the caller deletes with delete[].
+    //
+    long ReadAllSequencesIntoOne(Nucleotide *&seq, uint64_t &seqLength,
+                                 SequenceIndexDatabase<FASTASequence, uint64_t> *seqDBPtr=NULL);
+
     void ReadTitle(long &p, FASTASequence & seq);
 
     int GetNext(FASTASequence &seq); 
@@ -1,8 +1,82 @@
 #include <cstdio>
 #include <climits>
 #include <cmath>
+#include <cstring>
+#include <pthread.h>
+#include <algorithm>
 #include "FASTQReader.hpp"
 
+int FASTQBlock::size() {
+    return records.size();
+}
+
+void FASTQBlock::GetRecord(int i, FASTQSequence &seq) {
+    //
+    // Free leaves seq owning neither its title nor its bases.
+    //
+    seq.Free();
+    FASTQBlockRecord &record = records[i];
+    if (record.titleLength > 0) {
+        seq.title = (char*) &arena[record.titlePos];
+        seq.titleLength = record.titleLength;
+    }
+    seq.length = record.length;
+    if (record.length > 0) {
+        seq.seq = &arena[record.seqPos];
+        QualityValueVector<QualityValue> arenaQual;
+        arenaQual.data = &arena[record.qualPos];
+        seq.qual.ShallowCopy(arenaQual, 0, record.length);
+    }
+    else {
+        seq.qual.data = NULL;
+    }
+    seq.deleteOnExit = false;
+}
+
+//
+// Records are copied into the arena in groups, which threads take in
+// turn.
+//
+static const int FASTQCopyGroupSize = 64;
+
+class FASTQCopyState {
+public:
+    const char *filePtr;
+    FASTQBlock *block;
+    int next;
+};
+
+static void *FASTQCopyThread(void *statePtr) {
+    FASTQCopyState *state = (FASTQCopyState*) statePtr;
+    std::vector<FASTQBlockRecord> &records = state->block->records;
+    unsigned char *arena = &state->block->arena[0];
+    const char *filePtr = state->filePtr;
+    unsigned char charToQuality = FASTQSequence::charToQuality;
+    int nRecords = records.size();
+    int first;
+    while ((first = __atomic_fetch_add(&state->next, FASTQCopyGroupSize, __ATOMIC_RELAXED)) < nRecords) {
+        int last = std::min(first + FASTQCopyGroupSize, nRecords);
+        int r;
+        for (r = first; r < last; r++) {
+            FASTQBlockRecord &record = records[r];
+            memcpy(&arena[record.titlePos], &filePtr[record.fileTitlePos], record.titleLength);
+            arena[record.titlePos + record.titleLength] = '\0';
+            memcpy(&arena[record.seqPos], &filePtr[record.fileSeqPos], record.length);
+            //
+            // A branch-free loop over the quality values, which the
+            // compiler vectorizes.
+            //
+            const unsigned char *qualIn = (const unsigned char*) &filePtr[record.fileQualPos];
+            unsigned char *qualOut = &arena[record.qualPos];
+            DNALength i;
+            for (i = 0; i < record.length; i++) {
+                qualOut[i] = qualIn[i] - charToQuality;
+            }
+        }
+    }
+    return NULL;
+}
+
 FASTQReader::FASTQReader() : FASTAReader() {
     endOfReadDelim = '\n';
 }
@@ -81,6 +155,98 @@ int FASTQReader::GetNext(FASTQSequence &seq) {
 
 
 
+long FASTQReader::FindLineEnd(long p) {
+    if (p >= fileSize) {
+        return p;
+    }
+    const char *lineEnd = (const char*) memchr(&filePtr[p], '\n', fileSize - p);
+    return (lineEnd == NULL ? fileSize : lineEnd - filePtr);
+}
+
+bool FASTQReader::FindNextRecord(FASTQBlockRecord &record) {
+    char c;
+    while( curPos < fileSize and ( (c = filePtr[curPos]) == ' ' or c == '\t' or c == '\n' or c == '\r') ) {
+        curPos++;
+    }
+    if (curPos >= fileSize) {
+        return false;
+    }
+    long p = curPos;
+    AdvanceToTitleStart(p, '@');
+    CheckValidTitleStart(p,'@');
+    p++;
+    long lineEnd = FindLineEnd(p);
+    record.fileTitlePos = p;
+    record.titleLength  = lineEnd - p;
+
+    p = lineEnd + 1;
+    lineEnd = FindLineEnd(p);
+    record.fileSeqPos = p;
+    long seqLength = lineEnd - p;
+    p = lineEnd;
+
+    AdvanceToTitleStart(p,'+');
+    CheckValidTitleStart(p,'+');
+    p = FindLineEnd(p) + 1;
+    lineEnd = FindLineEnd(p);
+    record.fileQualPos = p;
+    //
+    // As in GetNext, the length of a read is the number of quality
+    // values.
+    //
+    long qualLength = lineEnd - p;
+    if (qualLength > seqLength) {
+        cout << "ERROR, a FASTQ record has more quality values than bases." << endl;
+        exit(1);
+    }
+    if (qualLength > UINT_MAX) {
+        cout << "ERROR! Reading sequences stored in more than 4Gbytes of space is not supported." << endl;
+        exit(1);
+    }
+    record.length = qualLength;
+    curPos = lineEnd;
+    return true;
+}
+
+int FASTQReader::GetNextBlock(FASTQBlock &block, int maxRecords) {
+    block.records.clear();
+    FASTQBlockRecord record;
+    long arenaSize = 0;
+    while ((int) block.records.size() < maxRecords and FindNextRecord(record)) {
+        record.titlePos = arenaSize;
+        record.seqPos   = record.titlePos + record.titleLength + 1;
+        record.qualPos  = record.seqPos + record.length;
+        arenaSize       = record.qualPos + record.length;
+        block.records.push_back(record);
+    }
+    if (block.records.empty()) {
+        return 0;
+    }
+    if (block.arena.size() < (size_t) arenaSize) {
+        block.arena.resize(arenaSize);
+    }
+
+    FASTQCopyState state;
+    state.filePtr = filePtr;
+    state.block   = &block;
+    state.next    = 0;
+    int nCopyThreads = std::min(nThreads, 
+        ((int) block.records.size() + FASTQCopyGroupSize - 1) / FASTQCopyGroupSize);
+    std::vector<pthread_t> threads(std::max(nCopyThreads, 1) - 1);
+    size_t t;
+    for (t = 0; t < threads.size(); t++) {
+        if (pthread_create(&threads[t], NULL, FASTQCopyThread, &state) != 0) {
+            cout << "ERROR, could not start a thread to read a FASTQ file." << endl;
+            exit(1);
+        }
+    }
+    FASTQCopyThread(&state);
+    for (t = 0; t < threads.size(); t++) {
+        pthread_join(threads[t], NULL);
+    }
+    return block.records.size();
+}
+
 int FASTQReader::Advance(int nSteps) {
     // An advance of a FASTQ file is simply twice the number of
     // advances of FASTA, since each nucleotide sequence has a quality
@@ -1,11 +1,44 @@
 #ifndef _BLASR_FASTQ_READER_HPP_
 #define _BLASR_FASTQ_READER_HPP_
 
+#include <vector>
 #include "FASTASequence.hpp"
 #include "FASTAReader.hpp"
 #include "FASTQSequence.hpp"
 #include "qvs/QualityValue.hpp"
 
+class FASTQBlockRecord {
+public:
+    //
+    // Where the title, bases and quality values are in the file, and
+    // then in the arena.
+    //
+    long fileTitlePos, fileSeqPos, fileQualPos;
+    long titlePos, seqPos, qualPos;
+    int titleLength;
+    DNALength length;
+};
+
+//
+// A block of FASTQ records parsed into one arena that is kept between
+// blocks, so that reading a block does not allocate once the arena is
+// large enough.  Each record holds a null-terminated title, its bases,
+// and its quality values, converted as FASTQReader::GetNext does.
+//
+class FASTQBlock {
+public:
+    std::vector<unsigned char> arena;
+    std::vector<FASTQBlockRecord> records;
+
+    int size();
+
+    //
+    // Make seq refer to record i in the arena, without copying; seq is
+    // valid until the next block is read into this one.
+    //
+    void GetRecord(int i, FASTQSequence &seq);
+};
+
 class FASTQReader : public FASTAReader {
 public:
 
@@ -17,7 +50,23 @@ public:
 
     int GetNext(FASTQSequence &seq); 
 
+    //
+    // Read up to maxRecords records into block, copying them into the
+    // arena on as many threads as SetNumThreads asks for.  Return the
+    // number of records read; 0 at the end of the file.
+    //
+    int GetNextBlock(FASTQBlock &block, int maxRecords=4096);
+
     int Advance(int nSteps); 
+
+private:
+    long FindLineEnd(long p);
+
+    //
+    // Find the parts of the next record at or after curPos without
+    // reading them, and move curPos past it.
+    //
+    bool FindNextRecord(FASTQBlockRecord &record);
 };
 
 
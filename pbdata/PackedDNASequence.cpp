@@ -151,22 +151,7 @@ DNALength PackedDNASequence::CountInWord(PackedDNAWord word, PackedDNAWord wordM
      * CountInWord(001001000000) = 2
      *
      */
-    PackedDNAWord w0,w1,w2, w;
-    PackedDNAWord w01, w12; 
-    Nucleotide tbn = ThreeBit[nuc];
-    PackedDNAWord xorMaskNuc = xorMask[tbn];
-    w0 = w1 = w2 = (word ^ xorMaskNuc);
-    w0 = (w0)  & Mask0All;
-    w1 = ((w1) & Mask1All) >> 1;
-    w2 = ((w2) & Mask2All) >> 2;
-    // Ideally the architecture will parallelize all these
-    // Do a cascaded.
-    //		w01 = (w0 & w1);
-    //		w12 = (w1 & w2);
-    //		w = w01 & w12;
-    w = ((w0 & w1) & w2) & wordMask;
-    //		++nCountInWord;
-    return CountBits(w);
+    return CountBits(MatchThreeBitInWord(word, wordMask, ThreeBit[nuc]));
 }
 
 DNALength PackedDNASequence::CountNuc(DNALength start, DNALength end, Nucleotide nuc) {
@@ -48,6 +48,18 @@ public:
 
     DNALength CountInWord(PackedDNAWord word, PackedDNAWord wordMask, Nucleotide nuc); 
 
+    //
+    // The body of CountInWord for a nucleotide that is already in
+    // three-bit form: a word with the low bit of each position that
+    // holds tbn set, and no other bits.  It is inline so that rank
+    // structures can count a run of words without a call per word.
+    //
+    static inline PackedDNAWord MatchThreeBitInWord(PackedDNAWord word, PackedDNAWord wordMask,
+                                                    Nucleotide tbn) {
+        PackedDNAWord w = word ^ xorMask[tbn];
+        return (w & Mask0All) & ((w & Mask1All) >> 1) & ((w & Mask2All) >> 2) & wordMask;
+    }
+
     DNALength CountNuc(DNALength start, DNALength end, Nucleotide nuc); 
 
     void Write(std::ostream &out); 
@@ -70,6 +70,11 @@ SMRTSequence::SMRTSequence() : FASTQSequence() {
     SetNull();
 }
 
+SMRTSequence::SMRTSequence(const SMRTSequence &rhs) : FASTQSequence() {
+    SetNull();
+    SMRTSequence::Copy(rhs);
+}
+
 void SMRTSequence::Allocate(DNALength length) {
     // Assert *this has no allocated space.
     if (not (seq == NULL && preBaseFrames == NULL &&
@@ -186,6 +191,14 @@ void SMRTSequence::Copy(const SMRTSequence &rhs, int rhsPos, int rhsLength) {
     lowQualitySuffix = rhs.lowQualitySuffix;
     highQualityRegionScore = rhs.highQualityRegionScore;
     zmwData = rhs.zmwData;
+    xy[0] = rhs.xy[0]; xy[1] = rhs.xy[1];
+    holeNumber = rhs.holeNumber;
+    readScore = rhs.readScore;
+    platform = rhs.platform;
+    readGroupId = rhs.readGroupId;
+    for (size_t i = 0; i < 4; i++) {
+        hqRegionSnr_[i] = rhs.hqRegionSnr_[i];
+    }
 
     assert(deleteOnExit); // should have control over seq and all QVs
 
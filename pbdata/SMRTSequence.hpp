@@ -93,6 +93,10 @@ public:
     SMRTSequence();
     inline ~SMRTSequence();
 
+    // Deep copy, so that reads may be stored in and moved between
+    // containers without sharing the SMRT QV arrays.
+    SMRTSequence(const SMRTSequence &rhs);
+
     // Access to HQRegion SNRs must be done via public API.
     inline float HQRegionSnr(const char base) const;
 
@@ -15,14 +15,21 @@
 
 
 #define SEQUENCE_INDEX_DATABASE_MAGIC 1233211233
-
-template<typename TSeq>
+#define SEQUENCE_INDEX_DATABASE_MAGIC_64 1233211264
+
+//
+// TPos is the type of a position in the concatenated sequence.  It is
+// DNALength unless the database indexes more than 4 Gbp, in which case
+// it is a 64-bit type; the two are written with different magic
+// numbers.
+//
+template<typename TSeq, typename TPos = DNALength>
 class SequenceIndexDatabase {
 public:
-    std::vector<DNALength> growableSeqStartPos;
+    std::vector<TPos> growableSeqStartPos;
     std::vector<std::string> growableName;
 
-	DNALength *seqStartPos;
+	TPos *seqStartPos;
 	bool deleteSeqStartPos;
 	char **names;
 	bool deleteNames;
@@ -34,6 +41,17 @@ public:
     // This is stored after reading in the sequence.
     //
     std::vector<std::string> md5;
+    //
+    // seqIndexLookup[b] is the index of the sequence that contains
+    // position b << seqIndexLookupShift, so that SearchForIndex only
+    // has to search the boundaries within one bucket.  It is built by
+    // Finalize and ReadDatabase for the seqStartPos and nSeqPos they
+    // set, and is not used if either is changed afterwards.
+    //
+    std::vector<int> seqIndexLookup;
+    int  seqIndexLookupShift;
+    TPos *seqIndexLookupStartPos;
+    int  seqIndexLookupNSeqPos;
 
     SequenceIndexDatabase(int final=0);
     ~SequenceIndexDatabase();
@@ -47,18 +65,35 @@ public:
 
     void MakeSAMSQString(std::string &sqString);
 
-    DNALength ChromosomePositionToGenome(int chrom, DNALength chromPos);
+    TPos ChromosomePositionToGenome(int chrom, DNALength chromPos);
 
-    int SearchForIndex(DNALength pos);
+    int SearchForIndex(TPos pos);
+
+    //
+    // Same as SearchForIndex(pos), but first checks the sequence at
+    // index hint, for callers that look up nearby positions in turn.
+    //
+    int SearchForIndex(TPos pos, int hint);
+
+    //
+    // Set indices[i] to SearchForIndex(positions[i]).  Sorted positions
+    // are resolved by walking forward from the previous sequence.
+    //
+    void SearchForIndices(const std::vector<TPos> &positions,
+        std::vector<int> &indices);
+
+    void BuildSeqIndexLookup();
 
     std::string GetSpaceDelimitedName(unsigned int index);
 
-    int SearchForStartBoundary(DNALength pos);
+    TPos SearchForStartBoundary(TPos pos);
 
-    int SearchForEndBoundary(DNALength pos);
+    TPos SearchForEndBoundary(TPos pos);
 
-    DNALength SearchForStartAndEnd(DNALength pos, DNALength &start,
-        DNALength &end);
+    DNALength SearchForStartAndEnd(TPos pos, TPos &start,
+        TPos &end);
+
+    static int Magic();
 
     void WriteDatabase(ofstream &out);
 
@@ -74,21 +109,26 @@ public:
 };
 
 
-template< typename TSeq >
+template< typename TSeq, typename TPos = DNALength >
 class SeqBoundaryFtr {
 public:
-    SequenceIndexDatabase<TSeq> *seqDB;
+    SequenceIndexDatabase<TSeq, TPos> *seqDB;
+    //
+    // The sequence found by the last lookup.  Anchors are usually
+    // looked up in order, so the next one is most often in it.
+    //
+    int lastIndex;
 
-    SeqBoundaryFtr(SequenceIndexDatabase<TSeq> *_seqDB);
+    SeqBoundaryFtr(SequenceIndexDatabase<TSeq, TPos> *_seqDB);
 
-    int GetIndex(DNALength pos);
+    int GetIndex(TPos pos);
 
-    int GetStartPos(int index);
+    TPos GetStartPos(int index);
 
-    DNALength operator()(DNALength pos);
+    TPos operator()(TPos pos);
 
     // This is misuse of a functor, but easier interface coding for now.
-    DNALength Length(DNALength pos);
+    DNALength Length(TPos pos);
 };
 
 #include "metagenome/SequenceIndexDatabaseImpl.hpp"
@@ -1,8 +1,8 @@
 #ifndef _BLASR_SEQUENCE_INDEX_DATABASE_IMPL_HPP_
 #define _BLASR_SEQUENCE_INDEX_DATABASE_IMPL_HPP_
 
-template<typename TSeq>
-SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+SequenceIndexDatabase<TSeq, TPos>::
 SequenceIndexDatabase(int final) {
     nSeqPos = 0;
     if (!final) {
@@ -12,24 +12,27 @@ SequenceIndexDatabase(int final) {
     nameLengths = NULL; deleteNameLengths = false;
     seqStartPos = NULL; deleteSeqStartPos = false;
     deleteStructures = false;
+    seqIndexLookupShift = 0;
+    seqIndexLookupStartPos = NULL;
+    seqIndexLookupNSeqPos = 0;
 }
 
-template<typename TSeq>
-SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+SequenceIndexDatabase<TSeq, TPos>::
 ~SequenceIndexDatabase() {
     FreeDatabase();
 }
 
-template<typename TSeq>
-DNALength SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+DNALength SequenceIndexDatabase<TSeq, TPos>::
 GetLengthOfSeq(int seqIndex) {
     assert(seqIndex < nSeqPos-1);
     return seqStartPos[seqIndex+1] - seqStartPos[seqIndex] - 1;
 }
 
 // Return index of a reference sequence with name "seqName".
-template<typename TSeq>
-int SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+int SequenceIndexDatabase<TSeq, TPos>::
 GetIndexOfSeqName(std::string seqName) {
     for(int i = 0; i < nSeqPos - 1; i++) {
         if (seqName == std::string(names[i])) {
@@ -39,15 +42,15 @@ GetIndexOfSeqName(std::string seqName) {
     return -1;
 }
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 GetName(int seqIndex, std::string &name) {
     assert(seqIndex < nSeqPos-1);
     name = names[seqIndex];
 }
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 MakeSAMSQString(std::string &sqString) {
     std::stringstream st;
     int i;
@@ -61,31 +64,112 @@ MakeSAMSQString(std::string &sqString) {
     sqString = st.str();
 }
 
-template<typename TSeq>
-DNALength SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+TPos SequenceIndexDatabase<TSeq, TPos>::
 ChromosomePositionToGenome(int chrom, DNALength chromPos) {
     assert(chrom < nSeqPos);
     return seqStartPos[chrom] + chromPos;
 
 }
 
-template<typename TSeq>
-int SequenceIndexDatabase<TSeq>::
-SearchForIndex(DNALength pos) {
+template<typename TSeq, typename TPos>
+int SequenceIndexDatabase<TSeq, TPos>::
+SearchForIndex(TPos pos) {
     // The default behavior for the case
     // that there is just one genome.
     if (nSeqPos == 1) {
         return 0;
     }
 
-    DNALength* seqPosIt = upper_bound(seqStartPos+1, 
+    if (seqIndexLookupStartPos == seqStartPos and
+        seqIndexLookupNSeqPos == nSeqPos and
+        seqIndexLookup.size() > 0) {
+        //
+        // The sequence is between the ones containing the start of this
+        // bucket and the start of the next.
+        //
+        TPos bucket = pos >> seqIndexLookupShift;
+        if (bucket >= seqIndexLookup.size()) {
+            return nSeqPos - 1;
+        }
+        int lo = seqIndexLookup[bucket];
+        int hi = (bucket + 1 < seqIndexLookup.size()) ? 
+            seqIndexLookup[bucket + 1] : nSeqPos - 1;
+        TPos* seqPosIt = upper_bound(seqStartPos + lo + 1,
+            seqStartPos + hi + 1, pos);
+        return seqPosIt - seqStartPos - 1;
+    }
+
+    TPos* seqPosIt = upper_bound(seqStartPos+1, 
         seqStartPos + nSeqPos, pos);
 
     return seqPosIt - seqStartPos - 1;
 }
 
-template<typename TSeq>
-std::string SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+int SequenceIndexDatabase<TSeq, TPos>::
+SearchForIndex(TPos pos, int hint) {
+    //
+    // Sequence index holds pos when pos is at or after its start, and
+    // before the start of the next.  The first and last sequences are
+    // open on the left and right.
+    //
+    int index;
+    for (index = hint; index >= 0 and index < nSeqPos and index <= hint + 1; index++) {
+        if ((index == 0 or seqStartPos[index] <= pos) and
+            (index == nSeqPos - 1 or pos < seqStartPos[index + 1])) {
+            return index;
+        }
+    }
+    return SearchForIndex(pos);
+}
+
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
+SearchForIndices(const std::vector<TPos> &positions,
+    std::vector<int> &indices) {
+    indices.resize(positions.size());
+    int index = 0;
+    size_t i;
+    for (i = 0; i < positions.size(); i++) {
+        index = SearchForIndex(positions[i], index);
+        indices[i] = index;
+    }
+}
+
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
+BuildSeqIndexLookup() {
+    seqIndexLookup.clear();
+    seqIndexLookupShift    = 0;
+    seqIndexLookupStartPos = seqStartPos;
+    seqIndexLookupNSeqPos  = nSeqPos;
+    if (nSeqPos <= 1) {
+        return;
+    }
+    //
+    // Use about one bucket per sequence, so the lookup costs at most
+    // two ints per sequence.
+    //
+    TPos lastStart = seqStartPos[nSeqPos - 1];
+    while ((lastStart >> (seqIndexLookupShift + 1)) >= (TPos) nSeqPos) {
+        seqIndexLookupShift++;
+    }
+    size_t nBuckets = (size_t) (lastStart >> seqIndexLookupShift) + 1;
+    seqIndexLookup.resize(nBuckets);
+    int index = 0;
+    size_t b;
+    for (b = 0; b < nBuckets; b++) {
+        TPos bucketStart = ((TPos) b) << seqIndexLookupShift;
+        while (index + 1 < nSeqPos and seqStartPos[index + 1] <= bucketStart) {
+            index++;
+        }
+        seqIndexLookup[b] = index;
+    }
+}
+
+template<typename TSeq, typename TPos>
+std::string SequenceIndexDatabase<TSeq, TPos>::
 GetSpaceDelimitedName(unsigned int index) {
     int pos;
     assert(index < nSeqPos);
@@ -101,9 +185,9 @@ GetSpaceDelimitedName(unsigned int index) {
     return name;
 }
 
-template<typename TSeq>
-int SequenceIndexDatabase<TSeq>::
-SearchForStartBoundary(DNALength pos) {
+template<typename TSeq, typename TPos>
+TPos SequenceIndexDatabase<TSeq, TPos>::
+SearchForStartBoundary(TPos pos) {
 
     int index = SearchForIndex(pos);
     if (index != -1) {
@@ -115,9 +199,9 @@ SearchForStartBoundary(DNALength pos) {
 }
 
 
-template<typename TSeq>
-int SequenceIndexDatabase<TSeq>::
-SearchForEndBoundary(DNALength pos) {
+template<typename TSeq, typename TPos>
+TPos SequenceIndexDatabase<TSeq, TPos>::
+SearchForEndBoundary(TPos pos) {
 
     int index = SearchForIndex(pos);
     if (index != -1) {
@@ -129,9 +213,9 @@ SearchForEndBoundary(DNALength pos) {
 }
 
 
-template<typename TSeq>
-DNALength SequenceIndexDatabase<TSeq>::
-SearchForStartAndEnd(DNALength pos, DNALength &start, DNALength &end) {
+template<typename TSeq, typename TPos>
+DNALength SequenceIndexDatabase<TSeq, TPos>::
+SearchForStartAndEnd(TPos pos, TPos &start, TPos &end) {
     int index = SearchForIndex(pos);
     if (index != -1) {
         start = seqStartPos[index];
@@ -145,13 +229,24 @@ SearchForStartAndEnd(DNALength pos, DNALength &start, DNALength &end) {
 }
 
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+int SequenceIndexDatabase<TSeq, TPos>::
+Magic() {
+    if (sizeof(TPos) == sizeof(DNALength)) {
+        return SEQUENCE_INDEX_DATABASE_MAGIC;
+    }
+    else {
+        return SEQUENCE_INDEX_DATABASE_MAGIC_64;
+    }
+}
+
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 WriteDatabase(std::ofstream &out) {
-    int mn = SEQUENCE_INDEX_DATABASE_MAGIC;
+    int mn = Magic();
     out.write((char*) &mn, sizeof(int));
     out.write((char*) &nSeqPos, sizeof(int));
-    out.write((char*) seqStartPos, sizeof(DNALength) * nSeqPos);
+    out.write((char*) seqStartPos, sizeof(TPos) * nSeqPos);
     int nSeq = nSeqPos - 1;
     out.write((char*) nameLengths, sizeof(int) * nSeq);
     int i;
@@ -172,14 +267,14 @@ WriteDatabase(std::ofstream &out) {
 }
 
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 ReadDatabase(std::ifstream &in) {
     int mn;
     // Make sure this is a read database, since the binary input
     // is not syntax checked.
     in.read((char*) &mn, sizeof(int));
-    if (mn != SEQUENCE_INDEX_DATABASE_MAGIC) {
+    if (mn != Magic()) {
         std::cout << "ERROR: Sequence index database is corrupt!" << std::endl;
         exit(1);
     }
@@ -191,9 +286,9 @@ ReadDatabase(std::ifstream &in) {
 
     in.read((char*) &nSeqPos, sizeof(int));
     assert(seqStartPos == NULL);
-    seqStartPos = new DNALength[nSeqPos];
+    seqStartPos = new TPos[nSeqPos];
     deleteSeqStartPos = true;
-    in.read((char*) seqStartPos, sizeof(DNALength) * nSeqPos);
+    in.read((char*) seqStartPos, sizeof(TPos) * nSeqPos);
     int nSeq = nSeqPos - 1;
 
     // Get the lengths of the strings to read.
@@ -216,10 +311,11 @@ ReadDatabase(std::ifstream &in) {
         namePtr[nameLengths[i]-1] = '\0';
         names[i] = namePtr;
     }
+    BuildSeqIndexLookup();
 }
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 SequenceTitleLinesToNames() {
     int seqIndex;
     std::vector<std::string> tmpNameArray;
@@ -246,10 +342,10 @@ SequenceTitleLinesToNames() {
     }
 }
 
-template<typename TSeq>
-VectorIndex SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+VectorIndex SequenceIndexDatabase<TSeq, TPos>::
 AddSequence(TSeq &sequence) {
-    int endPos = growableSeqStartPos[growableSeqStartPos.size() - 1];
+    TPos endPos = growableSeqStartPos[growableSeqStartPos.size() - 1];
     int growableSize = growableSeqStartPos.size();
     growableSeqStartPos.push_back(endPos + sequence.length + 1);
     std::string fastaTitle;
@@ -258,8 +354,8 @@ AddSequence(TSeq &sequence) {
     return growableName.size();
 }
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 Finalize() {
     deleteStructures  = true;
     seqStartPos = &growableSeqStartPos[0];
@@ -282,13 +378,16 @@ Finalize() {
         names[i][growableName[i].size()] = '\0';
         nameLengths[i] = growableName[i].size() + 1;
     }
+    BuildSeqIndexLookup();
 }
 
 
-template<typename TSeq>
-void SequenceIndexDatabase<TSeq>::
+template<typename TSeq, typename TPos>
+void SequenceIndexDatabase<TSeq, TPos>::
 FreeDatabase() {
     int i;
+    seqIndexLookup.clear();
+    seqIndexLookupStartPos = NULL;
     if (deleteStructures == false) {
         return;
     }
@@ -311,37 +410,38 @@ FreeDatabase() {
 }
 
 
-template< typename TSeq >
-SeqBoundaryFtr<TSeq>::
-SeqBoundaryFtr(SequenceIndexDatabase<TSeq> *_seqDB) {
+template< typename TSeq, typename TPos >
+SeqBoundaryFtr<TSeq, TPos>::
+SeqBoundaryFtr(SequenceIndexDatabase<TSeq, TPos> *_seqDB) {
     seqDB = _seqDB;
+    lastIndex = 0;
 }
 
-template< typename TSeq >
-int SeqBoundaryFtr<TSeq>::
-GetIndex(DNALength pos) {
-    return seqDB->SearchForIndex(pos);
+template< typename TSeq, typename TPos >
+int SeqBoundaryFtr<TSeq, TPos>::
+GetIndex(TPos pos) {
+    lastIndex = seqDB->SearchForIndex(pos, lastIndex);
+    return lastIndex;
 }
 
-template< typename TSeq >
-int SeqBoundaryFtr<TSeq>::
+template< typename TSeq, typename TPos >
+TPos SeqBoundaryFtr<TSeq, TPos>::
 GetStartPos(int index) {
     assert(index < seqDB->nSeqPos);
     return seqDB->seqStartPos[index];
 }
 
-template< typename TSeq >
-DNALength SeqBoundaryFtr<TSeq>::
- operator()(DNALength pos) {
-    return seqDB->SearchForStartBoundary(pos);
+template< typename TSeq, typename TPos >
+TPos SeqBoundaryFtr<TSeq, TPos>::
+ operator()(TPos pos) {
+    return seqDB->seqStartPos[GetIndex(pos)];
 }
 
-template< typename TSeq >
-DNALength SeqBoundaryFtr<TSeq>::
-Length(DNALength pos) {
-    DNALength start, end;
-    seqDB->SearchForStartAndEnd(pos, start, end);
-    return end - start;
+template< typename TSeq, typename TPos >
+DNALength SeqBoundaryFtr<TSeq, TPos>::
+Length(TPos pos) {
+    int index = GetIndex(pos);
+    return seqDB->seqStartPos[index + 1] - seqDB->seqStartPos[index];
 }
 
 #endif
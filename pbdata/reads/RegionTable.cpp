@@ -79,13 +79,174 @@ std::ostream & operator << (std::ostream & os, const RegionAnnotation& ra) {
     return os;
 }
 
+RegionTable::RegionTable() {
+    minHoleNumber = 0;
+}
+
 int RegionTable::LookupRegionsByHoleNumber(int holeNumber, int &low, int &high) const {
-    std::vector<RegionAnnotation>::const_iterator lowIt, highIt;
-    lowIt  = std::lower_bound(table.begin(), table.end(), holeNumber);
-    highIt = std::lower_bound(table.begin(), table.end(), holeNumber+1);
-    low =  lowIt - table.begin();
-    high = highIt - table.begin();
-    return high-low;
+    low = high = 0;
+    if (not HoleNumbersAreIndexed()) {
+        //
+        // The index is stale; search the hole number column.
+        //
+        const std::vector<int> &holeNumbers = columns[RegionAnnotation::HOLENUMBERCOL];
+        low  = std::lower_bound(holeNumbers.begin(), holeNumbers.end(), holeNumber) - holeNumbers.begin();
+        high = std::lower_bound(holeNumbers.begin(), holeNumbers.end(), holeNumber + 1) - holeNumbers.begin();
+        return high - low;
+    }
+    long i;
+    if (indexedHoleNumbers.empty()) {
+        i = static_cast<long>(holeNumber) - minHoleNumber;
+        if (i < 0 or i + 1 >= static_cast<long>(holeOffsets.size())) {
+            return 0;
+        }
+    }
+    else {
+        std::vector<int>::const_iterator it;
+        it = std::lower_bound(indexedHoleNumbers.begin(), indexedHoleNumbers.end(), holeNumber);
+        if (it == indexedHoleNumbers.end() or *it != holeNumber) {
+            return 0;
+        }
+        i = it - indexedHoleNumbers.begin();
+    }
+    low  = holeOffsets[i];
+    high = holeOffsets[i + 1];
+    return high - low;
+}
+
+int RegionTable::NumRegions() const {
+    return columns[RegionAnnotation::HOLENUMBERCOL].size();
+}
+
+void RegionTable::Resize(int nRegions) {
+    int c;
+    for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+        columns[c].resize(nRegions);
+    }
+}
+
+void RegionTable::Append(const RegionAnnotation &annotation) {
+    int c;
+    for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+        columns[c].push_back(annotation.row[c]);
+    }
+}
+
+RegionAnnotation RegionTable::GetAnnotation(int regionIndex) const {
+    assert(regionIndex < NumRegions());
+    assert(regionIndex >= 0);
+    RegionAnnotation annotation;
+    int c;
+    for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+        annotation.row[c] = columns[c][regionIndex];
+    }
+    return annotation;
+}
+
+std::vector<RegionAnnotation> RegionTable::GetAnnotations() const {
+    std::vector<RegionAnnotation> annotations(NumRegions());
+    int i;
+    for (i = 0; i < NumRegions(); i++) {
+        annotations[i] = GetAnnotation(i);
+    }
+    return annotations;
+}
+
+class CompareRegionHoleNumbers {
+public:
+    const std::vector<int> *holeNumbers;
+    bool operator()(int a, int b) const {
+        return (*holeNumbers)[a] < (*holeNumbers)[b];
+    }
+};
+
+void RegionTable::IndexHoleNumbers() {
+    ClearHoleIndex();
+    const std::vector<int> &holeNumbers = columns[RegionAnnotation::HOLENUMBERCOL];
+    int nRegions = NumRegions();
+    int i, nHoles = 0;
+    bool sorted = true;
+    for (i = 0; i < nRegions; i++) {
+        if (i > 0 and holeNumbers[i] < holeNumbers[i-1]) {
+            sorted = false;
+        }
+        if (i == 0 or holeNumbers[i] != holeNumbers[i-1]) {
+            nHoles++;
+        }
+    }
+    if (not sorted) {
+        //
+        // Keep the order of the regions within a hole.
+        //
+        std::vector<int> order(nRegions);
+        for (i = 0; i < nRegions; i++) {
+            order[i] = i;
+        }
+        CompareRegionHoleNumbers compare;
+        compare.holeNumbers = &holeNumbers;
+        std::stable_sort(order.begin(), order.end(), compare);
+        PermuteRegions(order);
+        nHoles = 0;
+        for (i = 0; i < nRegions; i++) {
+            if (i == 0 or holeNumbers[i] != holeNumbers[i-1]) {
+                nHoles++;
+            }
+        }
+    }
+    if (nRegions == 0) {
+        holeOffsets.push_back(0);
+        return;
+    }
+    minHoleNumber = holeNumbers[0];
+    long span = static_cast<long>(holeNumbers[nRegions-1]) - minHoleNumber + 1;
+    if (span <= 2 * static_cast<long>(nHoles)) {
+        //
+        // Holes with no regions get an empty range.
+        //
+        holeOffsets.resize(span + 1);
+        long h = 0;
+        for (i = 0; i < nRegions; i++) {
+            while (h <= holeNumbers[i] - static_cast<long>(minHoleNumber)) {
+                holeOffsets[h++] = i;
+            }
+        }
+        for (; h <= span; h++) {
+            holeOffsets[h] = nRegions;
+        }
+    }
+    else {
+        indexedHoleNumbers.reserve(nHoles);
+        holeOffsets.reserve(nHoles + 1);
+        for (i = 0; i < nRegions; i++) {
+            if (i == 0 or holeNumbers[i] != holeNumbers[i-1]) {
+                indexedHoleNumbers.push_back(holeNumbers[i]);
+                holeOffsets.push_back(i);
+            }
+        }
+        holeOffsets.push_back(nRegions);
+    }
+}
+
+bool RegionTable::HoleNumbersAreIndexed() const {
+    return (not holeOffsets.empty() and holeOffsets.back() == NumRegions());
+}
+
+void RegionTable::ClearHoleIndex() {
+    minHoleNumber = 0;
+    indexedHoleNumbers.clear();
+    holeOffsets.clear();
+}
+
+void RegionTable::PermuteRegions(const std::vector<int> &order) {
+    std::vector<int> permuted(order.size());
+    int c;
+    size_t i;
+    for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+        for (i = 0; i < order.size(); i++) {
+            permuted[i] = columns[c][order[i]];
+        }
+        columns[c].swap(permuted);
+    }
 }
 
 //
@@ -99,61 +260,79 @@ int RegionTable::LookupRegionsByHoleNumber(int holeNumber, int &low, int &high)
 //
 
 RegionType RegionTable::GetType(int regionIndex) const {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    return regionTypeEnums[table[regionIndex].GetTypeIndex()];
+    return regionTypeEnums[columns[RegionAnnotation::REGIONTYPEINDEXCOL][regionIndex]];
 }
 
 int RegionTable::GetStart(const int regionIndex) const {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    return table[regionIndex].GetStart();
+    return columns[RegionAnnotation::REGIONSTARTCOL][regionIndex];
 }
 
 void RegionTable::SetStart(int regionIndex, int start) {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    table[regionIndex].SetStart(start);
+    columns[RegionAnnotation::REGIONSTARTCOL][regionIndex] = start;
 }
 
 int RegionTable::GetEnd(const int regionIndex) const {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    return table[regionIndex].GetEnd();
+    return columns[RegionAnnotation::REGIONENDCOL][regionIndex];
 }
 
 void RegionTable::SetEnd(int regionIndex, int end) {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    table[regionIndex].SetEnd(end);
+    columns[RegionAnnotation::REGIONENDCOL][regionIndex] = end;
 }
 
 int RegionTable::GetHoleNumber(int regionIndex) const{
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    return table[regionIndex].GetHoleNumber();
+    return columns[RegionAnnotation::HOLENUMBERCOL][regionIndex];
 }
 
 void RegionTable::SetHoleNumber(int regionIndex, int holeNumber) {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    table[regionIndex].SetHoleNumber(holeNumber);
+    columns[RegionAnnotation::HOLENUMBERCOL][regionIndex] = holeNumber;
+    ClearHoleIndex();
 }
 
 int RegionTable::GetScore(int regionIndex) const{
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    return table[regionIndex].GetScore();//row[RegionAnnotationColumn::RegionScore];
+    return columns[RegionAnnotation::REGIONSCORECOL][regionIndex];
 }
 
 void RegionTable::SetScore(int regionIndex, int score) {
-    assert(regionIndex < table.size());
+    assert(regionIndex < NumRegions());
     assert(regionIndex >= 0);
-    table[regionIndex].SetScore(score);//.row[RegionAnnotationColumn::RegionScore] = score;
+    columns[RegionAnnotation::REGIONSCORECOL][regionIndex] = score;
 }
 
+class CompareRegionsByHoleNumberAndStart {
+public:
+    const RegionTable *regionTable;
+    bool operator()(int a, int b) const {
+        return regionTable->GetAnnotation(a) < regionTable->GetAnnotation(b);
+    }
+};
+
 void RegionTable::SortTableByHoleNumber() {
-    std::stable_sort(table.begin(), table.end());
+    std::vector<int> order(NumRegions());
+    size_t i;
+    for (i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    CompareRegionsByHoleNumberAndStart compare;
+    compare.regionTable = this;
+    std::stable_sort(order.begin(), order.end(), compare);
+    PermuteRegions(order);
+    IndexHoleNumbers();
 }
 
 std::vector<RegionType> RegionTable::DefaultRegionTypes(void) {
@@ -165,7 +344,11 @@ std::vector<RegionType> RegionTable::DefaultRegionTypes(void) {
 }
 
 void RegionTable::Reset() {
-    table.clear();
+    int c;
+    for (c = 0; c < RegionAnnotation::NCOLS; c++) {
+        columns[c].clear();
+    }
+    ClearHoleIndex();
     columnNames.clear();
     regionTypes.clear();
     regionDescriptions.clear();
@@ -86,6 +86,8 @@ public:
                             int start = 0, int end = 0,
                             int score = -1);
 
+    inline RegionAnnotation(const RegionAnnotation &rhs);
+
     inline bool operator<(const RegionAnnotation &rhs) const;
 
     inline bool operator<(int holeNumber) const;
@@ -118,21 +120,72 @@ public:
     friend std::ostream & operator << (std::ostream & os, const RegionAnnotation& ra);
 };
 
+//
+// The regions of a movie, stored by column: columns[c][i] is column c
+// of region i, where c is one of the column indices of
+// RegionAnnotation.  Regions are grouped by hole number in increasing
+// order, as in the Regions dataset, so the regions of a hole are one
+// range of indices.  IndexHoleNumbers maps each hole number to its
+// range, making LookupRegionsByHoleNumber constant time.
+//
+// This replaces the vector of RegionAnnotation rows that was the
+// public member table.  Read a region with GetAnnotation or the column
+// accessors, all regions with GetAnnotations, and add regions with
+// Append.
+//
 class RegionTable {
 public:
-    std::vector<RegionAnnotation> table;
+    std::vector<int> columns[RegionAnnotation::NCOLS];
     std::vector<std::string> columnNames;
     std::vector<std::string> regionTypes;
     std::vector<std::string> regionDescriptions;
     std::vector<std::string> regionSources;
     std::vector<RegionType> regionTypeEnums;
 
+    //
+    // The regions of hole h are holeOffsets[i] .. holeOffsets[i+1]-1,
+    // where i is h - minHoleNumber when indexedHoleNumbers is empty,
+    // and the position of h in indexedHoleNumbers otherwise.  The
+    // index is dense unless hole numbers are spread out enough that
+    // listing them takes less space.
+    //
+    int minHoleNumber;
+    std::vector<int> indexedHoleNumbers;
+    std::vector<int> holeOffsets;
+
+    RegionTable();
+
     // Return default region types used in a region table 
     // Note that the ORDER of region types does matter.
     static std::vector<RegionType> DefaultRegionTypes(void);
 
     int LookupRegionsByHoleNumber(int holeNumber, int &low, int &high) const; 
 
+    int NumRegions() const;
+
+    void Resize(int nRegions);
+
+    void Append(const RegionAnnotation &annotation);
+
+    RegionAnnotation GetAnnotation(int regionIndex) const;
+
+    //
+    // The regions as rows, in table order.
+    //
+    std::vector<RegionAnnotation> GetAnnotations() const;
+
+    //
+    // Build the hole number index.  If the hole numbers are not in
+    // increasing order, the regions are first stable-sorted by hole
+    // number, which changes region indices but keeps the order of the
+    // regions of each hole.  Changing hole numbers or adding regions
+    // afterwards makes lookups fall back to a binary search until the
+    // index is rebuilt.
+    //
+    void IndexHoleNumbers();
+
+    bool HoleNumbersAreIndexed() const;
+
     //
     // Define a bunch of accessor functions.
     //
@@ -165,6 +218,14 @@ public:
     void Reset(); 
 
     void CreateDefaultAttributes(); 
+
+private:
+    //
+    // Reorder the regions so that region i is the old region order[i].
+    //
+    void PermuteRegions(const std::vector<int> &order);
+
+    void ClearHoleIndex();
 };
 
 
@@ -178,6 +239,11 @@ RegionAnnotation::RegionAnnotation(UInt holeNumber,
     SetScore(score);
 }
 
+inline
+RegionAnnotation::RegionAnnotation(const RegionAnnotation &rhs) {
+    memcpy(row, rhs.row, sizeof(int)*NCOLS);
+}
+
 inline
 bool RegionAnnotation::operator<(const RegionAnnotation &rhs) const
 { 
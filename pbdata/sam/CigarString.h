@@ -1,21 +1,40 @@
 #ifndef _BLASR_SAM_CIGAR_STRING_HPP_
 #define _BLASR_SAM_CIGAR_STRING_HPP_
 
+#include <ctype.h>
 #include <string>
-#include <sstream>
+#include <vector>
 
 class CigarString : public std::string {
 public:
+    //
+    // Parse the operations in place; CIGAR strings of long reads have
+    // thousands of operations.
+    //
     void Vectorize(std::vector<int> &lengths, std::vector<char> &operations) {
-        std::stringstream strm;
-        strm.str(*this);
-        while (strm) {
-            int l;
-            char o;
-            if ((strm >> l >> o)) {
-                lengths.push_back(l);
-                operations.push_back(o);
+        const char *cur = c_str();
+        const char *end = cur + size();
+        while (cur < end) {
+            while (cur < end and isspace(*cur)) {
+                cur++;
             }
+            if (cur == end or *cur < '0' or *cur > '9') {
+                break;
+            }
+            int l = 0;
+            while (cur < end and *cur >= '0' and *cur <= '9') {
+                l = l * 10 + (*cur - '0');
+                cur++;
+            }
+            while (cur < end and isspace(*cur)) {
+                cur++;
+            }
+            if (cur == end) {
+                break;
+            }
+            lengths.push_back(l);
+            operations.push_back(*cur);
+            cur++;
         }
     }
 };
@@ -1,3 +1,5 @@
+#include <ctype.h>
+#include <string.h>
 #include "SAMAlignment.hpp"
 
 SAMAlignment::SAMAlignment() {
@@ -37,68 +39,153 @@ std::string SAMAlignment::TrimStringEnd(std::string str) {
   return newStr;
 }
 
-bool SAMAlignment::StoreValues(std::string &line,  int lineNumber) {
-  std::stringstream strm(line);
-  std::vector<bool> usedFields;
-  usedFields.resize(S_QUAL);
-  fill(usedFields.begin(), usedFields.end(), false);
-  std::string kvPair;
-  int i;
-  bool parseError = false;
-  SAMAlignmentRequiredFields field;
-  //
-  // Define a temporary mapqv value that gets over a GMAP bug that prints a mapqv < 0.
-  //
-  int tmpMapQV;
-  if (!(strm >> qName)) {
-    parseError = true;
-    field = S_QNAME;
+//
+// Find the next whitespace delimited token in [cur, end), and advance
+// cur past it.  Returns false when no token remains.
+//
+static bool NextSAMToken(const char *&cur, const char *end,
+                         const char *&token, int &tokenLength) {
+  while (cur < end and isspace(*cur)) {
+    cur++;
   }
-  else if (! (strm >> flag) ){ 
-    parseError = true;
-    field = S_FLAG;
+  if (cur == end) {
+    return false;
   }
-  else if (! (strm >> rName) ) {
-    parseError = true;
-    field = S_RNAME;
+  token = cur;
+  while (cur < end and !isspace(*cur)) {
+    cur++;
   }
-  else if (! (strm >> pos) ) {
-    parseError = true;
-    field = S_POS;
+  tokenLength = cur - token;
+  return true;
+}
+
+//
+// Parse a whole token as a decimal integer.
+//
+static bool SAMTokenToInt(const char *token, int tokenLength, long &value) {
+  int i = 0;
+  bool negative = false;
+  if (i < tokenLength and (token[i] == '-' or token[i] == '+')) {
+    negative = (token[i] == '-');
+    i++;
   }
-  else if (! (strm >> tmpMapQV)) {
-    parseError = true; field = S_MAPQV;
+  if (i == tokenLength) {
+    return false;
   }
-  else if (! (strm >> cigar)) {
-    parseError = true; field = S_CIGAR;
+  value = 0;
+  for (; i < tokenLength; i++) {
+    if (token[i] < '0' or token[i] > '9') {
+      return false;
+    }
+    value = value * 10 + (token[i] - '0');
   }
-
-  else if (! (strm >> rNext)) {
-    parseError = true; field = S_RNEXT;
+  if (negative) {
+    value = -value;
   }
+  return true;
+}
 
-  else if (! (strm >> pNext)) {
-    parseError = true; field = S_PNEXT;
-  }
-  else if (! (strm >> tLen)) {
-    parseError = true; field = S_TLEN;
+//
+// Split a typed optional field KEY:TYPE:VALUE in place, with the same
+// rules as TypedKeywordValuePair::Separate: all three parts must be
+// non-empty, and the value is everything after the second ':'.
+//
+static bool SeparateSAMTypedToken(const char *token, int tokenLength,
+                                  int &keyLength, const char *&value, int &valueLength) {
+  const char *end = token + tokenLength;
+  const char *keyEnd = (const char*) memchr(token, ':', tokenLength);
+  if (keyEnd == NULL or keyEnd == token) {
+    return false;
   }
-  else if (! (strm >> seq)) {
-    parseError = true; field = S_SEQ;
+  const char *typeEnd = (const char*) memchr(keyEnd + 1, ':', end - keyEnd - 1);
+  if (typeEnd == NULL or typeEnd == keyEnd + 1 or typeEnd + 1 == end) {
+    return false;
   }
-  else if (! (strm >> qual)) {
-    parseError = true; field = S_QUAL;
+  keyLength   = keyEnd - token;
+  value       = typeEnd + 1;
+  valueLength = end - value;
+  return true;
+}
+
+static bool SAMTokenIs(const char *token, int tokenLength, const char *key) {
+  return (tokenLength == 2 and token[0] == key[0] and token[1] == key[1]);
+}
+
+bool SAMAlignment::StoreValues(std::string &line,  int lineNumber) {
+  return StoreValues(line.c_str(), line.size(), lineNumber);
+}
+
+bool SAMAlignment::StoreValues(const char *line, int lineLength, int lineNumber) {
+  const char *cur = line;
+  const char *end = line + lineLength;
+  const char *token = NULL;
+  int tokenLength = 0;
+  long value;
+  bool parseError = false;
+  SAMAlignmentRequiredFields field;
+
+  //
+  // Optional fields are reset, since this alignment may hold the
+  // previous record.
+  //
+  score = xs = xe = as = xt = xq = nm = fi = xl = 0;
+  rg.clear(); optTagStr.clear();
+  iq.clear(); dq.clear(); sq.clear(); mq.clear(); st.clear(); dt.clear();
+
+  //
+  // Define a temporary mapqv value that gets over a GMAP bug that prints a mapqv < 0.
+  //
+  int tmpMapQV = 0;
+  for (int f = S_QNAME; f <= S_QUAL and parseError == false; f++) {
+    field = (SAMAlignmentRequiredFields) f;
+    if (NextSAMToken(cur, end, token, tokenLength) == false) {
+      parseError = true;
+      break;
+    }
+    if (field == S_FLAG or field == S_POS or field == S_MAPQV or
+        field == S_PNEXT or field == S_TLEN) {
+      if (SAMTokenToInt(token, tokenLength, value) == false) {
+        parseError = true;
+        break;
+      }
+    }
+    switch (field) {
+      case S_QNAME: qName.assign(token, tokenLength); break;
+      case S_FLAG:  flag = value; break;
+      case S_RNAME: rName.assign(token, tokenLength); break;
+      case S_POS:   pos = value; break;
+      case S_MAPQV: tmpMapQV = value; break;
+      case S_CIGAR: cigar.assign(token, tokenLength); break;
+      case S_RNEXT: rNext.assign(token, tokenLength); break;
+      case S_PNEXT: pNext = value; break;
+      case S_TLEN:  tLen = value; break;
+      case S_SEQ:   seq.assign(token, tokenLength); break;
+      case S_QUAL:  qual.assign(token, tokenLength); break;
+    }
   }
 
   mapQV = (unsigned char) tmpMapQV;
 
-  // Find posisition of the 11th tab.
-  int optTagsStartPos = FindPosOfNthChar(strm.str(), 11, '\t');
-  // Save all optional tags.
-  if (optTagsStartPos != std::string::npos) {
-      optTagStr = strm.str().substr(optTagsStartPos+1);
-      optTagStr = TrimStringEnd(optTagStr);
-  } 
+  //
+  // Save all optional tags, which follow the 11th tab.
+  //
+  const char *optTags = line;
+  int nTabs = 0;
+  while (nTabs < 11 and optTags < end) {
+    optTags = (const char*) memchr(optTags, '\t', end - optTags);
+    if (optTags == NULL) {
+      break;
+    }
+    optTags++;
+    nTabs++;
+  }
+  if (nTabs == 11) {
+    const char *optTagsEnd = end;
+    while (optTagsEnd > optTags and (optTagsEnd[-1] == '\r' or optTagsEnd[-1] == '\n')) {
+      optTagsEnd--;
+    }
+    optTagStr.assign(optTags, optTagsEnd - optTags);
+  }
 
   //
   // If not aligned, stop trying to read in elements from the sam string.
@@ -115,64 +202,60 @@ bool SAMAlignment::StoreValues(std::string &line,  int lineNumber) {
   //
   // Now parse optional data.
   //
-  while (strm) {
-    std::string kvName, kvType, kvValue;
-    std::string typedKVPair;
-    if (!(strm >> typedKVPair)) {
-      break;
-    }
-    if (TypedKeywordValuePair::Separate(typedKVPair, kvName, kvType, kvValue)) {
-      std::stringstream strm(kvValue);
-      if (kvName == "RG") {
-        rg = kvValue;
+  while (NextSAMToken(cur, end, token, tokenLength)) {
+    int keyLength, valueLength;
+    const char *kvValue;
+    if (SeparateSAMTypedToken(token, tokenLength, keyLength, kvValue, valueLength)) {
+      if (SAMTokenIs(token, keyLength, "RG")) {
+        rg.assign(kvValue, valueLength);
       }
-      else if (kvName == "AS") {
-        strm >> as;
+      else if (SAMTokenIs(token, keyLength, "AS")) {
+        as = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "XS") {
-        strm >> xs;
+      else if (SAMTokenIs(token, keyLength, "XS")) {
+        xs = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "XE") {
-        strm >> xe;
+      else if (SAMTokenIs(token, keyLength, "XE")) {
+        xe = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "XL") {
-        strm >> xl;
+      else if (SAMTokenIs(token, keyLength, "XL")) {
+        xl = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "XT") {
-        strm >> xt;
+      else if (SAMTokenIs(token, keyLength, "XT")) {
+        xt = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "NM") {
-        strm >> nm;
+      else if (SAMTokenIs(token, keyLength, "NM")) {
+        nm = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "FI") {
-        strm >> fi;
+      else if (SAMTokenIs(token, keyLength, "FI")) {
+        fi = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       }
-      else if (kvName == "XQ") {
-        strm >> xq;
+      else if (SAMTokenIs(token, keyLength, "XQ")) {
+        xq = SAMTokenToInt(kvValue, valueLength, value) ? value : 0;
       } // Add quality values, including QualityValue?, 
         // InsertionQV, DeletionQV, SubstitutionQV, 
         // MergeQV and SubstitutionTag and DeletionTag
-      else if (kvName == "iq") {
-          strm >> iq;
+      else if (SAMTokenIs(token, keyLength, "iq")) {
+        iq.assign(kvValue, valueLength);
       }
-      else if (kvName == "dq") {
-          strm >> dq;
+      else if (SAMTokenIs(token, keyLength, "dq")) {
+        dq.assign(kvValue, valueLength);
       }
-      else if (kvName == "sq") {
-          strm >> sq;
+      else if (SAMTokenIs(token, keyLength, "sq")) {
+        sq.assign(kvValue, valueLength);
       }
-      else if (kvName == "mq") {
-          strm >> mq;
+      else if (SAMTokenIs(token, keyLength, "mq")) {
+        mq.assign(kvValue, valueLength);
       }
-      else if (kvName == "st") {
-          strm >> st;
+      else if (SAMTokenIs(token, keyLength, "st")) {
+        st.assign(kvValue, valueLength);
       }
-      else if (kvName == "dt") {
-          strm >> dt;
+      else if (SAMTokenIs(token, keyLength, "dt")) {
+        dt.assign(kvValue, valueLength);
       }
     }
     else {
-      std::cout << "ERROR. Could not parse typed keyword value " << typedKVPair << std::endl;
+      std::cout << "ERROR. Could not parse typed keyword value " << std::string(token, tokenLength) << std::endl;
       exit(0);
     }
   }
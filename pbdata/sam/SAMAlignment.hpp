@@ -80,6 +80,14 @@ class SAMAlignment {
   std::string TrimStringEnd(std::string str);
 
   bool StoreValues(std::string &line,  int lineNumber=0);
+
+  //
+  // Parse a record in place from lineLength characters starting at
+  // line, which need not be null terminated.  Strings are assigned
+  // into the existing fields, so an alignment that is reused for many
+  // records stops allocating once its fields have grown.
+  //
+  bool StoreValues(const char *line, int lineLength, int lineNumber=0);
   
   // CopyQVs writes the strings from the optional QV tags to a vector. The
   // order of QVs in the vector is given by optionalQVNames[]
@@ -1,6 +1,7 @@
 #ifndef _BLASR_SAM_READER_HPP_
 #define _BLASR_SAM_READER_HPP_
 
+#include <pthread.h>
 #include "sam/SAMKeywordValuePair.hpp"
 #include "sam/ReadGroup.hpp"
 #include "sam/ReferenceSequence.hpp"
@@ -9,14 +10,32 @@
 #include "StringUtils.hpp"
 #include "utils.hpp"
 
+//
+// SAMReader reads the file in large blocks and hands out lines as
+// pointers into its buffer, so records are tokenized in place instead
+// of being copied into a string per line and a string per field.
+// Once Initialize() is called, all reading must go through the reader;
+// reading samFilePtr directly skips whatever is buffered.
+//
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 class SAMReader {
   public:
   int lineNumber;
   std::ifstream samFile;
   std::istream *samFilePtr;
+
+  std::vector<char> lineBuffer;
+  long lineBufferPos, lineBufferEnd;
+  bool lineBufferEOF;
+  std::vector<const char*> blockLines;
+  std::vector<int> blockLineLengths;
+
+  SAMReader(int lineBufferSize=1<<20);
+
   bool Initialize(std::string samFileName);
 
+  void Initialize(std::istream *samFilePtrP);
+
   void Close();
 
   enum LineType {Blank, HSHeader, HSSequence, HSReadGroup, HSProgram, HSComment, Alignment, Error};
@@ -27,7 +46,24 @@ class SAMReader {
 
   bool PeekLineIsHeader(std::istream &in);
 
+  bool PeekLineIsHeader();
+
+  //
+  // Move the unread part of the buffer to the front and read more of
+  // the file after it, growing the buffer if a line does not fit.
+  //
+  bool FillLineBuffer();
+
+  //
+  // Set line to the next line in the buffer, without its newline.  The
+  // line stays valid until the buffer is refilled, which only happens
+  // inside a call with fill=true.
+  //
+  bool GetNextLine(const char *&line, int &lineLength, bool fill=true);
+
   LineType GetLineType(std::string &line);
+
+  LineType GetLineType(const char *line, int lineLength);
  
   void StoreKVPairs(std::string line, std::vector<SAMKeywordValuePair> &kvPairs);
  
@@ -42,6 +78,9 @@ class SAMReader {
 
   void StoreAlignment(std::string & line,
                       AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments);
+
+  void StoreAlignment(const char *line, int lineLength,
+                      AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments);
     
   // Not implemented
   void StoreProgram(std::vector<SAMKeywordValuePair> &kvPairs,
@@ -54,6 +93,28 @@ class SAMReader {
   void Read(AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments);
 
   bool GetNextAlignment(SAMAlignment &alignment);
+
+  //
+  // Read up to maxAlignments records into the front of alignments and
+  // parse them on nThreads threads.  alignments is grown but never
+  // shrunk, so the strings of its alignments are reused from call to
+  // call; only the first n, for the n returned, hold records of this
+  // call.  A call reads the complete lines that are in the buffer after
+  // topping it up once, so fewer than maxAlignments may be returned
+  // before the end of the file, where 0 is returned.
+  //
+  int GetNextAlignments(std::vector<T_SAMAlignment> &alignments,
+                        int maxAlignments, int nThreads=1);
+
+  class ParseTask {
+  public:
+    SAMReader *reader;
+    std::vector<T_SAMAlignment> *alignments;
+    int start, end;
+    int firstLineNumber;
+  };
+
+  static void* ParseAlignmentsThread(void *data);
 };
 
 #include "SAMReaderImpl.hpp"
@@ -1,16 +1,36 @@
 #ifndef _BLASR_SAM_READER_IMPL_HPP_
 #define _BLASR_SAM_READER_IMPL_HPP_
+#include <ctype.h>
+#include <string.h>
 #include <iostream>
 #include "SAMReader.hpp"
 
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::SAMReader(int lineBufferSize) {
+  lineNumber = 0;
+  samFilePtr = NULL;
+  lineBuffer.resize(lineBufferSize < 1 ? 1 : lineBufferSize);
+  lineBufferPos = lineBufferEnd = 0;
+  lineBufferEOF = false;
+}
+
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::Initialize(std::string samFileName) {
   if(samFileName != "stdin") {
     CrucialOpen(samFileName, samFile, std::ios::in);
-    samFilePtr = &samFile;
+    Initialize(&samFile);
   } else {
-    samFilePtr = &std::cin;
+    Initialize(&std::cin);
   }
+  return true;
+}
+
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::Initialize(std::istream *samFilePtrP) {
+  samFilePtr = samFilePtrP;
+  lineNumber = 0;
+  lineBufferPos = lineBufferEnd = 0;
+  lineBufferEOF = false;
 }
 
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
@@ -44,21 +64,89 @@ bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::PeekLineIsHead
   }
 }
 
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::PeekLineIsHeader() {
+  if (lineBufferPos == lineBufferEnd) {
+    FillLineBuffer();
+  }
+  return (lineBufferPos < lineBufferEnd and lineBuffer[lineBufferPos] == '@');
+}
+
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::FillLineBuffer() {
+  if (lineBufferEOF or samFilePtr == NULL) {
+    return false;
+  }
+  long nUnread = lineBufferEnd - lineBufferPos;
+  if (nUnread > 0 and lineBufferPos > 0) {
+    memmove(&lineBuffer[0], &lineBuffer[lineBufferPos], nUnread);
+  }
+  lineBufferPos = 0;
+  lineBufferEnd = nUnread;
+  if (lineBufferEnd == (long) lineBuffer.size()) {
+    lineBuffer.resize(lineBuffer.size() * 2);
+  }
+  samFilePtr->read(&lineBuffer[lineBufferEnd], lineBuffer.size() - lineBufferEnd);
+  long nRead = samFilePtr->gcount();
+  if (nRead == 0) {
+    lineBufferEOF = true;
+    return false;
+  }
+  lineBufferEnd += nRead;
+  return true;
+}
+
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::GetNextLine(const char *&line, int &lineLength, bool fill) {
+  while (true) {
+    long nUnread = lineBufferEnd - lineBufferPos;
+    const char *start = &lineBuffer[0] + lineBufferPos;
+    const char *newline = (const char*) memchr(start, '\n', nUnread);
+    if (newline != NULL) {
+      line = start;
+      lineLength = newline - start;
+      lineBufferPos += lineLength + 1;
+      return true;
+    }
+    if (fill == false or FillLineBuffer() == false) {
+      //
+      // The last line of a file may have no newline.
+      //
+      if ((fill == true or lineBufferEOF) and nUnread > 0) {
+        line = start;
+        lineLength = nUnread;
+        lineBufferPos = lineBufferEnd;
+        return true;
+      }
+      return false;
+    }
+  }
+}
+
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 typename SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::LineType
 SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::GetLineType(std::string &line) {
-  if (line.length() == 0) {
+  return GetLineType(line.c_str(), line.size());
+}
+
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+typename SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::LineType
+SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::GetLineType(const char *line, int lineLength) {
+  if (lineLength == 0) {
     return Blank;
   }
   else if (line[0] == '@') {
-    std::stringstream strm(line);
-    std::string tag;
-    strm >> tag;
-    if (tag == "@HD") { return HSHeader; }
-    else if (tag == "@SQ") { return HSSequence; }
-    else if (tag == "@RG") { return HSReadGroup; }
-    else if (tag == "@PG") { return HSProgram; }
-    else if (tag == "@CO") { return HSComment; }
+    //
+    // The tag is the first whitespace delimited word.
+    //
+    if (lineLength < 3 or (lineLength > 3 and !isspace(line[3]))) {
+      return Error;
+    }
+    if (line[1] == 'H' and line[2] == 'D') { return HSHeader; }
+    else if (line[1] == 'S' and line[2] == 'Q') { return HSSequence; }
+    else if (line[1] == 'R' and line[2] == 'G') { return HSReadGroup; }
+    else if (line[1] == 'P' and line[2] == 'G') { return HSProgram; }
+    else if (line[1] == 'C' and line[2] == 'O') { return HSComment; }
     else { return Error; }
   }
   else {
@@ -81,6 +169,7 @@ template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlign
 int SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::StoreHeader(std::vector<SAMKeywordValuePair> &kvPairs,
                            AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments) {
   alignments.header.StoreValues(kvPairs, lineNumber);
+  return 0;
 }
 
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
@@ -107,6 +196,13 @@ void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::StoreAlignment
   alignments.alignments[lastAlignmentIndex].StoreValues(line, lineNumber);
 }
 
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::StoreAlignment(const char *line, int lineLength,
+                               AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments) {
+  alignments.alignments.push_back(T_SAMAlignment());   
+  alignments.alignments.back().StoreValues(line, lineLength, lineNumber);
+}
+
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::Read(std::string samFileName, AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments) {
   Initialize(samFileName);
@@ -119,8 +215,10 @@ std::vector<std::string> SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignm
   std::string line;
   LineType lineType;
   lineNumber = 0;
-  while (*samFilePtr and PeekLineIsHeader(*samFilePtr)) {
-    getline(*samFilePtr, line);
+  const char *linePtr;
+  int lineLength;
+  while (PeekLineIsHeader() and GetNextLine(linePtr, lineLength)) {
+    line.assign(linePtr, lineLength);
     lineType = GetLineType(line);
     if (LineTypeIsHeader(lineType)) {
       allHeaders.push_back(line);
@@ -154,22 +252,23 @@ std::vector<std::string> SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignm
 
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::Read(AlignmentSet<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment> &alignments) {
-  std::string line;
+  const char *line;
+  int lineLength;
   LineType lineType;
   lineNumber = 0;
   ReadHeader(alignments);
-  while (getline(*samFilePtr, line)) {
-    lineType = GetLineType(line);
+  while (GetNextLine(line, lineLength)) {
+    lineType = GetLineType(line, lineLength);
     if (LineTypeIsHeader(lineType)) {
       std::cout << "ERROR! Header line found outside of the header at " << lineNumber << std::endl;
       exit(1);
     }
     else if (lineType == Alignment) {
-      StoreAlignment(line, alignments);
+      StoreAlignment(line, lineLength, alignments);
     }
     else {
       std::cout << "Error, line type unknown at " << lineNumber << std::endl;
-      std::cout << line << std::endl;
+      std::cout << std::string(line, lineLength) << std::endl;
       exit(1);
     }
     ++lineNumber;
@@ -178,20 +277,87 @@ void SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::Read(Alignment
 
 template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
 bool SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::GetNextAlignment(SAMAlignment &alignment) {
-  if (*samFilePtr) {
-    std::string line;
-    if (getline(*samFilePtr, line)) {
-      alignment.StoreValues(line, lineNumber);
-      ++lineNumber;
-      return true;
-    }
-    else {
-      return false;
-    }
+  const char *line;
+  int lineLength;
+  if (GetNextLine(line, lineLength)) {
+    alignment.StoreValues(line, lineLength, lineNumber);
+    ++lineNumber;
+    return true;
   }
   else {
     return false;
   }
 }
 
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+void* SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::ParseAlignmentsThread(void *data) {
+  ParseTask *task = (ParseTask*) data;
+  for (int i = task->start; i < task->end; i++) {
+    (*task->alignments)[i].StoreValues(task->reader->blockLines[i],
+                                       task->reader->blockLineLengths[i],
+                                       task->firstLineNumber + i);
+  }
+  return NULL;
+}
+
+template<typename T_ReferenceSequence, typename T_ReadGroup, typename T_SAMAlignment>
+int SAMReader<T_ReferenceSequence, T_ReadGroup, T_SAMAlignment>::GetNextAlignments(std::vector<T_SAMAlignment> &alignments,
+                                  int maxAlignments, int nThreads) {
+  //
+  // Top the buffer up so that a block is as large as the buffer, then
+  // gather the lines.  Only the first line may refill the buffer again,
+  // so the rest stay valid while they are parsed.
+  //
+  if (lineBufferPos > 0 or lineBufferEnd == 0) {
+    FillLineBuffer();
+  }
+  blockLines.clear();
+  blockLineLengths.clear();
+  const char *line;
+  int lineLength;
+  while ((int) blockLines.size() < maxAlignments and
+         GetNextLine(line, lineLength, blockLines.size() == 0)) {
+    blockLines.push_back(line);
+    blockLineLengths.push_back(lineLength);
+  }
+  int nAlignments = blockLines.size();
+  if ((int) alignments.size() < nAlignments) {
+    alignments.resize(nAlignments);
+  }
+
+  if (nThreads > nAlignments) {
+    nThreads = nAlignments;
+  }
+  std::vector<ParseTask> tasks(nThreads > 1 ? nThreads : 1);
+  std::vector<pthread_t> threads(tasks.size());
+  int nStarted = 0;
+  int t;
+  for (t = 0; t < (int) tasks.size(); t++) {
+    tasks[t].reader     = this;
+    tasks[t].alignments = &alignments;
+    tasks[t].start      = ((long) nAlignments * t) / tasks.size();
+    tasks[t].end        = ((long) nAlignments * (t + 1)) / tasks.size();
+    tasks[t].firstLineNumber = lineNumber;
+  }
+  //
+  // The calling thread parses the first range itself, and any range a
+  // thread could not be started for.
+  //
+  for (t = 1; t < (int) tasks.size(); t++) {
+    if (pthread_create(&threads[t], NULL, ParseAlignmentsThread, &tasks[t]) != 0) {
+      break;
+    }
+    nStarted++;
+  }
+  ParseAlignmentsThread(&tasks[0]);
+  for (t = nStarted + 1; t < (int) tasks.size(); t++) {
+    ParseAlignmentsThread(&tasks[t]);
+  }
+  for (t = 1; t <= nStarted; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  lineNumber += nAlignments;
+  return nAlignments;
+}
+
 #endif
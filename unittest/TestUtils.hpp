@@ -0,0 +1,142 @@
+/*
+ * ============================================================================
+ *
+ *       Filename:  TestUtils.hpp
+ *
+ *    Description:  Sequences and helpers shared by the unit tests.
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ============================================================================
+ */
+
+#ifndef _BLASR_UNITTEST_TEST_UTILS_HPP_
+#define _BLASR_UNITTEST_TEST_UTILS_HPP_
+
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Types.h"
+
+//
+// A random sequence of A, C, G and T, with N as well if withN is set.
+//
+inline std::string RandomSequence(int length, bool withN = false) {
+    const char nucs[] = "ACGTN";
+    std::string s(length, 'A');
+    for (int i = 0; i < length; i++) {
+        s[i] = nucs[rand() % (withN ? 5 : 4)];
+    }
+    return s;
+}
+
+//
+// As RandomSequence, but earlier stretches of up to 50 bases are
+// repeated now and then, so that seeds have many occurrences.
+//
+inline std::string RepetitiveSequence(int length, bool withN = false) {
+    const char nucs[] = "ACGTN";
+    std::string s(length, 'A');
+    for (int i = 0; i < length; i++) {
+        s[i] = nucs[rand() % (withN ? 5 : 4)];
+        if (i > 100 and rand() % 50 == 0) {
+            int start = rand() % (i - 50);
+            int repeatLength = rand() % 50;
+            for (int j = 0; j < repeatLength and i < (int) s.size(); j++, i++) {
+                s[i] = s[start + j];
+            }
+            i--;
+        }
+    }
+    return s;
+}
+
+//
+// Copy src with about one edit in every editRate bases.  With
+// homopolymerInsertions set, doubling a base is one of the edits.
+//
+inline std::string Mutate(const std::string &src, int editRate,
+                          bool homopolymerInsertions = false) {
+    const char nucs[] = "ACGT";
+    int nEditTypes = (homopolymerInsertions ? 4 : 3);
+    std::string dest;
+    for (size_t i = 0; i < src.size(); i++) {
+        int r = rand() % (editRate * nEditTypes);
+        if (r == 0) {
+            dest.push_back(nucs[rand() % 4]);
+        }
+        else if (r == 1) {
+            dest.push_back(src[i]);
+            dest.push_back(nucs[rand() % 4]);
+        }
+        else if (homopolymerInsertions and r == 2) {
+            dest.push_back(src[i]);
+            dest.push_back(src[i]);
+        }
+        else if (r != nEditTypes - 1) {
+            dest.push_back(src[i]);
+        }
+    }
+    return dest;
+}
+
+//
+// The aligners only hand a plain score function to their SSE2 kernels,
+// so scoring through this subclass of it runs the full matrix.
+//
+template<typename T_ScoreFn>
+class FullMatrixScoreFunction : public T_ScoreFn {
+public:
+    FullMatrixScoreFunction(int scoreMatrixP[5][5], int insP, int delP) :
+        T_ScoreFn(scoreMatrixP, insP, delP) {}
+};
+
+//
+// The start, blocks and gaps of an alignment, for comparing two.
+//
+template<typename T_Alignment>
+std::string AlignmentToString(T_Alignment &alignment) {
+    std::stringstream out;
+    out << alignment.qPos << " " << alignment.tPos << " :";
+    for (size_t b = 0; b < alignment.blocks.size(); b++) {
+        out << " " << alignment.blocks[b].qPos << "," << alignment.blocks[b].tPos
+            << "," << alignment.blocks[b].length;
+    }
+    out << " :";
+    for (size_t g = 0; g < alignment.gaps.size(); g++) {
+        for (size_t i = 0; i < alignment.gaps[g].size(); i++) {
+            out << " " << g << "," << alignment.gaps[g][i].seq
+                << "," << alignment.gaps[g][i].length;
+        }
+    }
+    return out.str();
+}
+
+class SuffixLess {
+public:
+    std::string *text;
+    bool operator()(DNALength a, DNALength b) const {
+        return text->compare(a, std::string::npos, *text, b, std::string::npos) < 0;
+    }
+};
+
+//
+// Sort the suffixes of text by brute force.  The BWT orders N after T.
+//
+inline void BuildSuffixArray(const std::string &text,
+                             std::vector<DNALength> &suffixArray) {
+    suffixArray.resize(text.size());
+    for (DNALength i = 0; i < text.size(); i++) {
+        suffixArray[i] = i;
+    }
+    std::string sortText = text;
+    std::replace(sortText.begin(), sortText.end(), 'N', 'U');
+    SuffixLess less;
+    less.text = &sortText;
+    std::sort(suffixArray.begin(), suffixArray.end(), less);
+}
+
+#endif // _BLASR_UNITTEST_TEST_UTILS_HPP_
@@ -0,0 +1,192 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  GuidedAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/GuidedAlign.hpp
+ *                  and AffineGuidedAlign.hpp
+ *
+ *        Version:  1.0
+ *        Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "FASTQSequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+using namespace blasr;
+
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/IDSScoreFunction.hpp"
+#include "algorithms/alignment/ScoreMatrices.hpp"
+#include "algorithms/alignment/GuidedAlign.hpp"
+#include "algorithms/alignment/AffineGuidedAlign.hpp"
+
+class GuidedAlignTest : public ::testing::Test {
+public:
+    void SetUp() {
+        srand(11);
+        nonZeroProbScores = 0;
+    }
+
+    void MakeRead(const string &seq, FASTQSequence &read) {
+        read.DNASequence::Copy(seq);
+        read.AllocateQualitySpace(read.length);
+        read.AllocateRichQualityValues(read.length);
+        for (DNALength i = 0; i < read.length; i++) {
+            read.qual[i]            = 5 + rand() % 30;
+            read.substitutionQV[i]  = 5 + rand() % 30;
+            read.insertionQV[i]     = 5 + rand() % 30;
+            read.deletionQV[i]      = 5 + rand() % 30;
+            //
+            // IDSScoreFunction reads both tags; an N deletion tag
+            // scores the deletion by its prior.
+            //
+            read.deletionTag[i]     = "ACGTN"[rand() % 5];
+            read.substitutionTag[i] = "ACGT"[rand() % 4];
+        }
+    }
+
+    void ExpectSameAlignment(const string &q, const string &t, int bandSize) {
+        FASTQSequence qSeq;
+        DNASequence tSeq;
+        MakeRead(q, qSeq);
+        tSeq.Copy(t);
+        DistanceMatrixScoreFunction<DNASequence, FASTQSequence>
+            scoreFn(SMRTDistanceMatrix, 3, 4);
+        scoreFn.affineOpen   = 6;
+        scoreFn.affineExtend = 1;
+        //
+        // The quality values only change the probability of the
+        // alignment through IDSScoreFunction.
+        //
+        IDSScoreFunction<DNASequence, FASTQSequence>
+            probFn(SMRTDistanceMatrix, 3, 4, 20, 13);
+        AlignmentType types[] = {Global, Local, QueryFit};
+        for (int i = 0; i < 3; i++) {
+            for (int computeProb = 0; computeProb < 2; computeProb++) {
+                blasr::Alignment full, compact;
+                int fullScore = GuidedAlign(qSeq, tSeq, scoreFn, bandSize,
+                    5, 5, 0.15, full, types[i], computeProb, 8, false);
+                int compactScore = GuidedAlign(qSeq, tSeq, scoreFn, bandSize,
+                    5, 5, 0.15, compact, types[i], computeProb, 8, true);
+                EXPECT_EQ(fullScore, compactScore) << "type " << types[i];
+                EXPECT_EQ(full.score, compact.score);
+                EXPECT_EQ(AlignmentToString(full), AlignmentToString(compact))
+                    << "type " << types[i];
+                EXPECT_EQ(full.nCells, compact.nCells);
+            }
+            blasr::Alignment full, compact;
+            int fullScore = GuidedAlign(qSeq, tSeq, probFn, bandSize,
+                5, 5, 0.15, full, types[i], true, 8, false);
+            int compactScore = GuidedAlign(qSeq, tSeq, probFn, bandSize,
+                5, 5, 0.15, compact, types[i], true, 8, true);
+            EXPECT_EQ(fullScore, compactScore) << "type " << types[i];
+            EXPECT_EQ(full.probScore, compact.probScore) << "type " << types[i];
+            EXPECT_EQ(AlignmentToString(full), AlignmentToString(compact))
+                << "type " << types[i];
+            EXPECT_EQ(full.nCells, compact.nCells);
+            nonZeroProbScores += (compact.probScore != 0);
+
+            full = compact = blasr::Alignment();
+            fullScore = AffineGuidedAlign(qSeq, tSeq, scoreFn, bandSize,
+                5, 5, 0.15, full, types[i], false, 8, false);
+            compactScore = AffineGuidedAlign(qSeq, tSeq, scoreFn, bandSize,
+                5, 5, 0.15, compact, types[i], false, 8, true);
+            EXPECT_EQ(fullScore, compactScore) << "affine type " << types[i];
+            EXPECT_EQ(AlignmentToString(full), AlignmentToString(compact))
+                << "affine type " << types[i];
+            EXPECT_EQ(full.nCells, compact.nCells);
+        }
+    }
+    int nonZeroProbScores;
+};
+
+TEST_F(GuidedAlignTest, CompactTracebackMatchesFullMatrices) {
+    int bandSizes[] = {1, 4, 16};
+    for (int trial = 0; trial < 30; trial++) {
+        string t = RandomSequence(100 + rand() % 400);
+        string q = Mutate(t, 8);
+        ExpectSameAlignment(q, t, bandSizes[trial % 3]);
+    }
+    EXPECT_GT(nonZeroProbScores, 0);
+}
+
+TEST_F(GuidedAlignTest, CompactTracebackMatchesFullMatricesOnLongReads) {
+    string t = RandomSequence(5000);
+    string q = Mutate(t, 10);
+    ExpectSameAlignment(q, t, 16);
+    ExpectSameAlignment(q.substr(200, 4500), t, 16);
+}
+
+//
+// The members of the MappingBuffers of each blasr thread that
+// GuidedAlign uses, which include no SDPAlignScratch.
+//
+class GuidedAlignBufferCache {
+public:
+    vector<int>    scoreMat;
+    vector<Arrow>  pathMat;
+    vector<double> probMat;
+    vector<double> optPathProbMat;
+    vector<float>  lnSubPValueMat;
+    vector<float>  lnInsPValueMat;
+    vector<float>  lnDelPValueMat;
+    vector<float>  lnMatchPValueMat;
+    vector<Fragment> sdpFragmentSet, sdpPrefixFragmentSet, sdpSuffixFragmentSet;
+    TupleList<PositionDNATuple> sdpCachedTargetTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetPrefixTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetSuffixTupleList;
+    vector<int> sdpCachedMaxFragmentChain;
+};
+
+TEST_F(GuidedAlignTest, SDPScratchMatchesBufferCache) {
+    DistanceMatrixScoreFunction<DNASequence, FASTQSequence>
+        scoreFn(SMRTDistanceMatrix, 3, 4);
+    GuidedAlignBufferCache buffers;
+    SDPAlignScratch sdpScratch;
+    for (int trial = 0; trial < 10; trial++) {
+        string t = RandomSequence(200 + rand() % 1500);
+        string q = Mutate(t, 8);
+        FASTQSequence qSeq;
+        DNASequence tSeq;
+        MakeRead(q, qSeq);
+        tSeq.Copy(t);
+        blasr::Alignment expected, aln;
+        int expectedScore = GuidedAlign(qSeq, tSeq, scoreFn, 8, 5, 5, 0.15,
+            buffers, expected, Local);
+        int score = GuidedAlign(qSeq, tSeq, scoreFn, 8, 5, 5, 0.15,
+            buffers, sdpScratch, aln, Local);
+        EXPECT_EQ(expectedScore, score) << "trial " << trial;
+        EXPECT_EQ(AlignmentToString(expected), AlignmentToString(aln))
+            << "trial " << trial;
+        EXPECT_EQ(expected.nCells, aln.nCells);
+    }
+}
+
+TEST(PackedArrowMatrixTest, SetAndGet) {
+    int bits[] = {1, 2, 4, 8};
+    for (int b = 0; b < 4; b++) {
+        PackedArrowMatrix matrix;
+        int mask = (1 << bits[b]) - 1;
+        matrix.Resize(101, bits[b], 1);
+        EXPECT_EQ(matrix.ByteSize(), (101 * bits[b] + 7) / 8);
+        for (unsigned int i = 0; i < 101; i++) {
+            EXPECT_EQ(matrix.Get(i), 1);
+        }
+        for (unsigned int i = 0; i < 101; i++) {
+            matrix.Set(i, (i * 7) & mask);
+        }
+        for (unsigned int i = 0; i < 101; i++) {
+            EXPECT_EQ(matrix.Get(i), (int) ((i * 7) & mask));
+        }
+    }
+}
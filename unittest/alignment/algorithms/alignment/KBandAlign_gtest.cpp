@@ -0,0 +1,140 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  KBandAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/KBandAlign.hpp and
+ *                  alignment/algorithms/alignment/AffineKBandAlign.hpp
+ *
+ *        Version:  1.0
+ *        Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/ScoreMatrices.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+
+#include "algorithms/alignment/KBandAlign.hpp"
+#include "algorithms/alignment/AffineKBandAlign.hpp"
+
+//
+// Scoring through a subclass of DistanceMatrixScoreFunction keeps
+// KBandAlign from handing it to the anti-diagonal engine.
+//
+typedef FullMatrixScoreFunction<DistanceMatrixScoreFunction<DNASequence, DNASequence> >
+    FullMatrixDistanceFunction;
+
+class KBandAlignTest : public ::testing::Test {
+public:
+    void ExpectSameAlignment(const string &q, const string &t, int k) {
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        DistanceMatrixScoreFunction<DNASequence, DNASequence> 
+            bandFn(SMRTDistanceMatrix, 3, 4);
+        FullMatrixDistanceFunction fullFn(SMRTDistanceMatrix, 3, 4);
+        AlignmentType types[] = {Global, QueryFit, TargetFit, Fit, Local};
+        for (int i = 0; i < 5; i++) {
+            //
+            // KBandAlign does not choose a target fit end when the target
+            // is shorter than the band.
+            //
+            if (types[i] == TargetFit and t.size() < (size_t) k) {
+                continue;
+            }
+            blasr::Alignment bandAlignment, fullAlignment;
+            int bandScore = KBandAlign(qSeq, tSeq, SMRTDistanceMatrix, 3, 4, k,
+                scoreMat, pathMat, bandAlignment, types[i], bandFn);
+            int fullScore = KBandAlign(qSeq, tSeq, SMRTDistanceMatrix, 3, 4, k,
+                scoreMat, pathMat, fullAlignment, types[i], fullFn);
+            EXPECT_EQ(fullScore, bandScore) << "type " << types[i] << " k " << k;
+            EXPECT_EQ(AlignmentToString(fullAlignment), 
+                      AlignmentToString(bandAlignment))
+                << "type " << types[i] << " k " << k;
+        }
+
+        AlignmentType affineTypes[] = {Global, QueryFit, TargetFit};
+        for (int i = 0; i < 3; i++) {
+            blasr::Alignment bandAlignment, fullAlignment;
+            int bandScore = AffineKBandAlign(qSeq, tSeq, SMRTDistanceMatrix, 
+                3, 1, 5, 2, 4, k, scoreMat, pathMat, hpInsScoreMat, hpInsPathMat,
+                insScoreMat, insPathMat, bandAlignment, affineTypes[i]);
+            int fullScore = AffineKBandAlignFullMatrix(qSeq, tSeq, SMRTDistanceMatrix, 
+                3, 1, 5, 2, 4, k, scoreMat, pathMat, hpInsScoreMat, hpInsPathMat,
+                insScoreMat, insPathMat, fullAlignment, affineTypes[i]);
+            EXPECT_EQ(fullScore, bandScore) << "affine type " << affineTypes[i] << " k " << k;
+            EXPECT_EQ(AlignmentToString(fullAlignment), 
+                      AlignmentToString(bandAlignment))
+                << "affine type " << affineTypes[i] << " k " << k;
+        }
+    }
+    vector<int> scoreMat, hpInsScoreMat, insScoreMat;
+    vector<Arrow> pathMat, hpInsPathMat, insPathMat;
+};
+
+TEST_F(KBandAlignTest, AntiDiagonalMatchesFullMatrix) {
+    srand(5);
+    int ks[] = {0, 1, 2, 3, 4, 7, 16};
+    for (int trial = 0; trial < 200; trial++) {
+        string t = RandomSequence(1 + rand() % 80);
+        string q = Mutate(t, 6, true);
+        if (q.empty()) {
+            q = "A";
+        }
+        ExpectSameAlignment(q, t, ks[trial % 7]);
+    }
+}
+
+TEST_F(KBandAlignTest, AntiDiagonalMatchesFullMatrixOnLongReads) {
+    srand(9);
+    string t = RandomSequence(4000);
+    string q = Mutate(t, 10, true);
+    ExpectSameAlignment(q, t, 40);
+    ExpectSameAlignment(q, t.substr(0, 3950), 40);
+    ExpectSameAlignment(q.substr(0, 3950), t, 40);
+}
+
+//
+// The boundary of the band is scored by the ins and del given to
+// KBandAlign, and the interior by the score function.
+//
+TEST_F(KBandAlignTest, BoundaryGapCostsDifferFromScoreFunction) {
+    srand(13);
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> 
+        bandFn(SMRTDistanceMatrix, 3, 4);
+    FullMatrixDistanceFunction fullFn(SMRTDistanceMatrix, 3, 4);
+    AlignmentType types[] = {Global, QueryFit, Fit, Local};
+    for (int trial = 0; trial < 50; trial++) {
+        string t = RandomSequence(1 + rand() % 60);
+        string q = Mutate(t, 5, true);
+        if (q.empty()) {
+            q = "A";
+        }
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        int k = 1 + trial % 6;
+        for (int i = 0; i < 4; i++) {
+            blasr::Alignment bandAlignment, fullAlignment;
+            int bandScore = KBandAlign(qSeq, tSeq, SMRTDistanceMatrix, 7, 1, k,
+                scoreMat, pathMat, bandAlignment, types[i], bandFn);
+            int fullScore = KBandAlign(qSeq, tSeq, SMRTDistanceMatrix, 7, 1, k,
+                scoreMat, pathMat, fullAlignment, types[i], fullFn);
+            EXPECT_EQ(fullScore, bandScore) << "type " << types[i] << " k " << k;
+            EXPECT_EQ(AlignmentToString(fullAlignment), 
+                      AlignmentToString(bandAlignment))
+                << "type " << types[i] << " k " << k;
+        }
+    }
+}
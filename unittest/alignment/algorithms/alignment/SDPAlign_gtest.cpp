@@ -0,0 +1,121 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SDPAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/SDPAlign.hpp
+ *
+ *        Version:  1.0
+ *        Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/SDPAlign.hpp"
+
+using namespace std;
+
+//
+// A read of t with about one insertion, deletion or mismatch in every
+// ten bases, sometimes with an unaligned prefix or a repeat of its
+// start appended so that SDPAlign recurses on the ends.
+//
+static string MakeRead(const string &t, int trial) {
+    string q;
+    for (size_t i = 0; i < t.size(); i++) {
+        int r = rand() % 30;
+        if (r == 0) {
+            continue;
+        }
+        if (r == 1) {
+            q.push_back("ACGT"[rand() % 4]);
+        }
+        q.push_back(r == 2 ? "ACGT"[rand() % 4] : t[i]);
+    }
+    if (trial % 3 == 0) {
+        q = string(150, 'T') + q;
+    }
+    if (trial % 4 == 0) {
+        q = q + string(100, 'C') + q.substr(0, 300);
+    }
+    return q;
+}
+
+//
+// The sdp members of a T_BufferCache such as the MappingBuffers of each
+// blasr thread, which keeps no SDPAlignScratch.
+//
+class SDPBufferCache {
+public:
+    vector<Fragment> sdpFragmentSet, sdpPrefixFragmentSet, sdpSuffixFragmentSet;
+    TupleList<PositionDNATuple> sdpCachedTargetTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetPrefixTupleList;
+    TupleList<PositionDNATuple> sdpCachedTargetSuffixTupleList;
+    vector<int> sdpCachedMaxFragmentChain;
+};
+
+static void ExpectSameAlignment(blasr::Alignment &expected, blasr::Alignment &aln) {
+    EXPECT_EQ(expected.qPos, aln.qPos);
+    EXPECT_EQ(expected.tPos, aln.tPos);
+    ASSERT_EQ(expected.blocks.size(), aln.blocks.size());
+    for (size_t b = 0; b < aln.blocks.size(); b++) {
+        EXPECT_EQ(expected.blocks[b].qPos, aln.blocks[b].qPos);
+        EXPECT_EQ(expected.blocks[b].tPos, aln.blocks[b].tPos);
+        EXPECT_EQ(expected.blocks[b].length, aln.blocks[b].length);
+    }
+}
+
+TEST(SDPAlignTest, ReusedBuffersMatchFreshBuffers) {
+    srand(3);
+    int scoreMatrix[5][5];
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 5; j++) {
+            scoreMatrix[i][j] = (i == j ? -5 : 6);
+        }
+    }
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> scoreFn(scoreMatrix, 4, 5);
+
+    SDPBufferCache buffers;
+    SDPAlignScratch scratch;
+    for (int trial = 0; trial < 12; trial++) {
+        string t;
+        int length = 300 + rand() % 2000;
+        for (int i = 0; i < length; i++) {
+            t.push_back("ACGT"[rand() % 4]);
+        }
+        string q = MakeRead(t, trial);
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+
+        AlignmentType types[] = {Global, Local};
+        for (int i = 0; i < 2; i++) {
+            blasr::Alignment expected, aln;
+            //
+            // A small noRecurseUnder makes both ends and the gaps in
+            // the chain recurse.
+            //
+            int expectedScore = SDPAlign(qSeq, tSeq, scoreFn, 11, 4, 4, 0.3,
+                expected, types[i], true, true, 200);
+            int score = SDPAlign(qSeq, tSeq, scoreFn, 11, 4, 4, 0.3,
+                aln, buffers, types[i], true, true, 200);
+            EXPECT_EQ(expectedScore, score) << "trial " << trial;
+            ExpectSameAlignment(expected, aln);
+
+            blasr::Alignment scratchAln;
+            score = SDPAlign(qSeq, tSeq, scoreFn, 11, 4, 4, 0.3,
+                scratchAln, buffers, scratch, types[i], true, true, 200);
+            EXPECT_EQ(expectedScore, score) << "trial " << trial;
+            ExpectSameAlignment(expected, scratchAln);
+            EXPECT_EQ(0, scratch.level);
+        }
+    }
+}
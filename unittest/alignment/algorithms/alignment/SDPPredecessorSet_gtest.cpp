@@ -0,0 +1,72 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SDPPredecessorSet_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/sdp/SDPPredecessorSet.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <set>
+#include "gtest/gtest.h"
+#include "algorithms/alignment/sdp/SDPPredecessorSet.hpp"
+
+using namespace std;
+
+TEST(SDPPredecessorSetTest, MatchesStdSet) {
+    srand(1);
+    //
+    // Sizes on and around word and level boundaries, reusing one set.
+    //
+    UInt sizes[] = {1, 63, 64, 65, 4096, 4097, 300000};
+    SDPPredecessorSet predSet;
+    for (int s = 0; s < 7; s++) {
+        UInt size = sizes[s];
+        predSet.Initialize(size);
+        set<UInt> expected;
+        for (int op = 0; op < 20000; op++) {
+            UInt key = rand() % size;
+            int which = rand() % 4;
+            if (which == 0) {
+                predSet.Insert(key);
+                expected.insert(key);
+            }
+            else if (which == 1 and expected.size() > 0) {
+                //
+                // Delete a member, found as the successor of a random key.
+                //
+                set<UInt>::iterator it = expected.lower_bound(key);
+                if (it == expected.end()) {
+                    it = expected.begin();
+                }
+                predSet.Delete(*it);
+                expected.erase(it);
+            }
+            ASSERT_EQ(expected.count(key), predSet.Member(key));
+
+            UInt pred = 0, succ = 0;
+            set<UInt>::iterator it = expected.upper_bound(key);
+            if (it == expected.begin()) {
+                ASSERT_EQ(0, predSet.Predecessor(key, pred));
+            }
+            else {
+                --it;
+                ASSERT_EQ(1, predSet.Predecessor(key, pred));
+                ASSERT_EQ(*it, pred);
+            }
+            it = expected.upper_bound(key);
+            if (it == expected.end()) {
+                ASSERT_EQ(0, predSet.Successor(key, succ));
+            }
+            else {
+                ASSERT_EQ(1, predSet.Successor(key, succ));
+                ASSERT_EQ(*it, succ);
+            }
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SWAlign_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/SWAlign.hpp
+ *
+ *        Version:  1.0
+ *        Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "algorithms/alignment/AlignmentUtils.hpp"
+#include "datastructures/alignment/Alignment.hpp"
+#include "algorithms/alignment/DistanceMatrixScoreFunction.hpp"
+#include "algorithms/alignment/ScoreMatrices.hpp"
+#include "algorithms/alignment/SWAlign.hpp"
+#include "algorithms/alignment/StripedSWAlign.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+
+//
+// Scoring through a subclass of DistanceMatrixScoreFunction keeps
+// SWAlign from handing it to the striped kernel.
+//
+typedef FullMatrixScoreFunction<DistanceMatrixScoreFunction<DNASequence, DNASequence> >
+    FullMatrixDistanceFunction;
+
+class SWAlignTest : public ::testing::Test {
+public:
+    void ExpectSameScore(const string &q, const string &t, int scoreMatrix[5][5],
+                         int ins, int del) {
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        DistanceMatrixScoreFunction<DNASequence, DNASequence> 
+            stripedFn(scoreMatrix, ins, del);
+        FullMatrixDistanceFunction fullFn(scoreMatrix, ins, del);
+        AlignmentType types[] = {ScoreLocal, ScoreGlobal, ScoreQueryFit};
+        for (int i = 0; i < 3; i++) {
+            blasr::Alignment stripedAlignment, fullAlignment;
+            int striped = SWAlign(qSeq, tSeq, scoreMat, pathMat,
+                stripedAlignment, stripedFn, types[i]);
+            int full = SWAlign(qSeq, tSeq, scoreMat, pathMat,
+                fullAlignment, fullFn, types[i]);
+            EXPECT_EQ(full, striped) << "type " << types[i] 
+                << " query " << q << " target " << t;
+        }
+    }
+    vector<int> scoreMat;
+    vector<Arrow> pathMat;
+};
+
+TEST_F(SWAlignTest, StripedScoreMatchesFullMatrix) {
+    srand(7);
+    for (int trial = 0; trial < 300; trial++) {
+        int tLength = 1 + rand() % 120;
+        string t = RandomSequence(tLength, trial % 3 == 0);
+        string q;
+        if (trial % 2 == 0) {
+            q = RandomSequence(1 + rand() % 60, trial % 3 == 0);
+        }
+        else {
+            int start = rand() % tLength;
+            q = Mutate(t.substr(start, 1 + rand() % (tLength - start)), 5);
+            if (q.empty()) {
+                q = "A";
+            }
+        }
+        ExpectSameScore(q, t, SMRTDistanceMatrix, 3, 3);
+        ExpectSameScore(q, t, EditDistanceMatrix, 1, 1);
+        ExpectSameScore(q, t, LocalAlignLowMutationMatrix, 4, 2);
+    }
+}
+
+TEST_F(SWAlignTest, StripedScoreMatchesFullMatrixOnLongSequences) {
+    srand(11);
+    string t = RandomSequence(3000, false);
+    string q = Mutate(t.substr(500, 2000), 8);
+    ExpectSameScore(q, t, SMRTDistanceMatrix, 3, 3);
+    //
+    // Global gap costs along the first row overflow 16 bits here, so the
+    // scores come from the full matrix.
+    //
+    int score;
+    EXPECT_FALSE(StripedSWAlignScore((Nucleotide*) &q[0], q.size(),
+        (Nucleotide*) &t[0], t.size(), SMRTDistanceMatrix, 20, 20, 
+        ScoreGlobal, score));
+    ExpectSameScore(q, t, SMRTDistanceMatrix, 20, 20);
+}
+
+TEST_F(SWAlignTest, ReusedPathBuffersMatchFreshBuffers) {
+    srand(13);
+    DistanceMatrixScoreFunction<DNASequence, DNASequence> 
+        scoreFn(SMRTDistanceMatrix, 3, 3);
+    vector<Arrow> optAlignment;
+    vector<blasr::GapList> spareGapLists;
+    blasr::Alignment aln;
+    AlignmentType types[] = {Global, Local, EndAnchored, QueryFit};
+    for (int trial = 0; trial < 100; trial++) {
+        string t = RandomSequence(20 + rand() % 200, false);
+        string q = Mutate(t, 4);
+        if (q.empty()) {
+            q = "A";
+        }
+        DNASequence qSeq, tSeq;
+        qSeq.Copy(q);
+        tSeq.Copy(t);
+        for (int i = 0; i < 4; i++) {
+            blasr::Alignment expected;
+            aln.Clear(spareGapLists);
+            aln.qPos = aln.tPos = 0;
+            int expectedScore = SWAlign(qSeq, tSeq, scoreMat, pathMat,
+                expected, scoreFn, types[i]);
+            int score = SWAlign(qSeq, tSeq, scoreMat, pathMat, optAlignment,
+                spareGapLists, aln, scoreFn, types[i]);
+            EXPECT_EQ(expectedScore, score);
+            EXPECT_EQ(expected.qPos, aln.qPos);
+            EXPECT_EQ(expected.tPos, aln.tPos);
+            ASSERT_EQ(expected.blocks.size(), aln.blocks.size());
+            for (size_t b = 0; b < aln.blocks.size(); b++) {
+                EXPECT_EQ(expected.blocks[b].qPos, aln.blocks[b].qPos);
+                EXPECT_EQ(expected.blocks[b].tPos, aln.blocks[b].tPos);
+                EXPECT_EQ(expected.blocks[b].length, aln.blocks[b].length);
+            }
+            ASSERT_EQ(expected.gaps.size(), aln.gaps.size());
+            for (size_t g = 0; g < aln.gaps.size(); g++) {
+                ASSERT_EQ(expected.gaps[g].size(), aln.gaps[g].size());
+                for (size_t gi = 0; gi < aln.gaps[g].size(); gi++) {
+                    EXPECT_EQ(expected.gaps[g][gi].seq, aln.gaps[g][gi].seq);
+                    EXPECT_EQ(expected.gaps[g][gi].length, aln.gaps[g][gi].length);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SparseDynamicProgramming_gtest.cpp
+ *
+ *    Description:  Test alignment/algorithms/alignment/sdp/SparseDynamicProgramming.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <set>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "algorithms/alignment/sdp/SDPFragment.hpp"
+#include "algorithms/alignment/sdp/SparseDynamicProgramming.hpp"
+
+using namespace std;
+
+//
+// A small linear congruential generator, so that the fragment sets do
+// not depend on the platform rand().
+//
+static unsigned int NextRandom(unsigned int &state) {
+    state = state * 1103515245 + 12345;
+    return (state >> 16) & 0x7fff;
+}
+
+//
+// Fragments of length 8 scattered at random, or clustered on a few
+// diagonals as matches in a tandem repeat would be.  As in SDPAlign,
+// no two fragments start at the same cell.
+//
+static void MakeFragments(bool repeat, unsigned int seed, vector<Fragment> &fragments) {
+    fragments.clear();
+    unsigned int state = seed;
+    set<pair<unsigned int, unsigned int> > starts;
+    while (fragments.size() < 60) {
+        unsigned int x = NextRandom(state) % 300;
+        unsigned int y;
+        if (repeat) {
+            int diagonals[] = {0, 12, 24, 36};
+            y = x + diagonals[NextRandom(state) % 4] + NextRandom(state) % 3;
+        }
+        else {
+            y = NextRandom(state) % 300;
+        }
+        if (starts.insert(make_pair(x, y)).second == false) {
+            continue;
+        }
+        Fragment fragment(x, y);
+        fragment.length = 8;
+        fragments.push_back(fragment);
+    }
+}
+
+//
+// The chains found by the std::set sweep that SDPPredecessorSet
+// replaced, as the (x, y) of each fragment.
+//
+static const unsigned int randomGlobalChain[][2] = {
+    {48, 67}, {74, 110}, {113, 163}, {168, 180}, {206, 204}, {236, 224},
+    {257, 228}, {279, 258}};
+static const unsigned int randomLocalChain[][2] = {
+    {228, 265}, {230, 269}};
+static const unsigned int repeatGlobalChain[][2] = {
+    {2, 4}, {6, 6}, {34, 36}, {48, 50}, {58, 82}, {74, 98}, {93, 117},
+    {102, 138}, {103, 141}, {105, 143}, {123, 161}, {147, 184}, {159, 185},
+    {179, 205}, {197, 221}, {225, 250}, {230, 256}, {235, 271}, {273, 311},
+    {275, 313}, {294, 332}, {299, 335}, {299, 337}};
+static const unsigned int repeatLocalChain[][2] = {
+    {235, 271}, {273, 311}, {275, 313}, {294, 332}, {299, 335}, {299, 337}};
+
+static void ExpectChain(bool repeat, AlignmentType alignType,
+    const unsigned int expected[][2], int expectedLength,
+    SDPSweepBuffers *buffers) {
+    vector<Fragment> fragments;
+    vector<int> chain;
+    MakeFragments(repeat, repeat ? 8 : 7, fragments);
+    int score = SDPLongestCommonSubsequence(400, fragments, 8, 4, 5, -5,
+        chain, alignType, buffers);
+    EXPECT_EQ(expectedLength, score);
+    ASSERT_EQ((size_t) expectedLength, chain.size());
+    for (int c = 0; c < expectedLength; c++) {
+        EXPECT_EQ(expected[c][0], fragments[chain[c]].x) << "fragment " << c;
+        EXPECT_EQ(expected[c][1], fragments[chain[c]].y) << "fragment " << c;
+    }
+}
+
+TEST(SparseDynamicProgrammingTest, ChainsMatchSetSweep) {
+    ExpectChain(false, Global, randomGlobalChain, 8, NULL);
+    ExpectChain(false, Local, randomLocalChain, 2, NULL);
+    ExpectChain(true, Global, repeatGlobalChain, 23, NULL);
+    ExpectChain(true, Local, repeatLocalChain, 6, NULL);
+}
+
+TEST(SparseDynamicProgrammingTest, ReusedSweepBuffersMatchSetSweep) {
+    SDPSweepBuffers buffers;
+    ExpectChain(true, Global, repeatGlobalChain, 23, &buffers);
+    ExpectChain(false, Global, randomGlobalChain, 8, &buffers);
+    ExpectChain(true, Local, repeatLocalChain, 6, &buffers);
+    ExpectChain(false, Local, randomLocalChain, 2, &buffers);
+}
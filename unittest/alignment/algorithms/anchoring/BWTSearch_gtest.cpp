@@ -0,0 +1,184 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BWTSearch_gtest.cpp
+ *
+ *    Description:  Test alignment/bwt/BidirectionalBWT.hpp and the SMEM
+ *                  search of alignment/algorithms/anchoring/BWTSearch.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTASequence.hpp"
+#include "algorithms/anchoring/BWTSearch.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+
+//
+// A read copied from the genome with substitutions, insertions, and
+// deletions, so that matches end all along it.
+//
+static string NoisyRead(const string &genome, int length, int errorRate) {
+    int start = rand() % (genome.size() - length);
+    string read;
+    for (int i = start; i < start + length; i++) {
+        int r = rand() % 100;
+        if (r < errorRate) {
+            read.push_back("ACGTN"[rand() % 5]);
+        }
+        else if (r < 2 * errorRate) {
+            read.push_back(genome[i]);
+            read.push_back("ACGT"[rand() % 4]);
+        }
+        else if (r >= 3 * errorRate) {
+            read.push_back(genome[i]);
+        }
+    }
+    return read;
+}
+
+class BWTSearchTest : public ::testing::Test {
+public:
+    void Build(const string &genomeString) {
+        genomeText = genomeString;
+        string reverseText(genomeText.rbegin(), genomeText.rend());
+        genome.Copy(genomeText);
+        reverseGenome.Copy(reverseText);
+        vector<DNALength> forwardSA, reverseSA;
+        BuildSuffixArray(genomeText, forwardSA);
+        BuildSuffixArray(reverseText, reverseSA);
+        bwt.InitializeFromSuffixArrays(genome, &forwardSA[0], reverseGenome, &reverseSA[0]);
+    }
+
+    //
+    // The SMEMs by brute force: the longest match starting at each
+    // position, kept when it ends after the one starting just before.
+    //
+    void ExpectedSMEMs(const string &read, DNALength start, DNALength end,
+                       DNALength minMatchLength,
+                       vector<pair<DNALength, DNALength> > &smems) {
+        smems.clear();
+        DNALength prevEnd = 0;
+        for (DNALength i = start; i < end; i++) {
+            DNALength l = 0;
+            while (i + l < end and read[i + l] != 'N' and
+                   genomeText.find(read.substr(i, l + 1)) != string::npos) {
+                l++;
+            }
+            if (l > 0 and (i == start or prevEnd < i + l) and l >= minMatchLength) {
+                smems.push_back(make_pair(i, i + l));
+            }
+            prevEnd = i + l;
+        }
+    }
+
+    string genomeText;
+    FASTASequence genome, reverseGenome;
+    BidirectionalBWT bwt;
+};
+
+TEST_F(BWTSearchTest, ExtendBothWays) {
+    srand(11);
+    Build(RepetitiveSequence(3000, true));
+    for (int q = 0; q < 300; q++) {
+        int length = 2 + rand() % 10;
+        int start = rand() % (genomeText.size() - length);
+        string query = genomeText.substr(start, length);
+        if (query.find('N') != string::npos) {
+            continue;
+        }
+        //
+        // Grow the match from its middle, alternating sides; the interval
+        // must always match a search from scratch.
+        //
+        int qs = length / 2, qe = qs + 1;
+        BiInterval interval, extended;
+        ASSERT_TRUE(bwt.SetInterval(ThreeBit[(unsigned char) query[qs]], interval));
+        while (qe - qs < length) {
+            if ((qe - qs) % 2 == 0 and qs > 0) {
+                qs--;
+                ASSERT_TRUE(bwt.ExtendBackward(interval, ThreeBit[(unsigned char) query[qs]], extended));
+            }
+            else if (qe < length) {
+                ASSERT_TRUE(bwt.ExtendForward(interval, ThreeBit[(unsigned char) query[qe]], extended));
+                qe++;
+            }
+            else {
+                qs--;
+                ASSERT_TRUE(bwt.ExtendBackward(interval, ThreeBit[(unsigned char) query[qs]], extended));
+            }
+            interval = extended;
+            string sub = query.substr(qs, qe - qs);
+            string reverseSub(sub.rbegin(), sub.rend());
+            FASTASequence subSeq, reverseSubSeq;
+            subSeq.Copy(sub);
+            reverseSubSeq.Copy(reverseSub);
+            DNALength sp, ep;
+            ASSERT_EQ((int) interval.size, bwt.forward.Count(subSeq, sp, ep)) << sub;
+            ASSERT_EQ(sp, interval.forwardStart) << sub;
+            bwt.reverse.Count(reverseSubSeq, sp, ep);
+            ASSERT_EQ(sp, interval.reverseStart) << sub;
+        }
+    }
+}
+
+TEST_F(BWTSearchTest, FindSMEMs) {
+    srand(12);
+    Build(RepetitiveSequence(5000, true));
+    for (int r = 0; r < 60; r++) {
+        string read = NoisyRead(genomeText, 50 + rand() % 250, 1 + r % 8);
+        FASTASequence readSeq;
+        readSeq.Copy(read);
+        DNALength start = (r % 3 == 0) ? rand() % 10 : 0;
+        DNALength end = read.size() - ((r % 3 == 1) ? rand() % 10 : 0);
+        DNALength minMatchLength = 1 + r % 12;
+        vector<pair<DNALength, DNALength> > expected;
+        ExpectedSMEMs(read, start, end, minMatchLength, expected);
+        vector<BiInterval> smems;
+        FindSMEMs(bwt, readSeq, start, end, minMatchLength, smems);
+        vector<pair<DNALength, DNALength> > found;
+        for (size_t s = 0; s < smems.size(); s++) {
+            found.push_back(make_pair(smems[s].qStart, smems[s].qEnd));
+        }
+        ASSERT_EQ(expected, found) << read;
+    }
+}
+
+TEST_F(BWTSearchTest, MapReadToGenome) {
+    srand(13);
+    Build(RepetitiveSequence(5000, false));
+    AnchorParameters params;
+    params.minMatchLength = 12;
+    params.maxAnchorsPerPosition = 10;
+    for (int r = 0; r < 20; r++) {
+        string read = NoisyRead(genomeText, 200, 3);
+        FASTASequence readSeq;
+        readSeq.Copy(read);
+        vector<ChainedMatchPos> matchPosList;
+        vector<BiInterval> smems;
+        int numBasesAnchored;
+        MapReadToGenome(bwt, readSeq, 0, read.size(), matchPosList, params,
+                        numBasesAnchored, smems);
+        for (size_t m = 0; m < matchPosList.size(); m++) {
+            ChainedMatchPos &match = matchPosList[m];
+            ASSERT_GE(match.l, (DNALength) params.minMatchLength);
+            EXPECT_EQ(genomeText.substr(match.t, match.l), read.substr(match.q, match.l));
+        }
+        int expectedBases = 0;
+        for (size_t s = 0; s < smems.size(); s++) {
+            if (smems[s].size < (DNALength) params.maxAnchorsPerPosition) {
+                expectedBases += smems[s].Length();
+            }
+        }
+        EXPECT_EQ(expectedBases, numBasesAnchored);
+    }
+}
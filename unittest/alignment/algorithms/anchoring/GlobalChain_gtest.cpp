@@ -0,0 +1,155 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  GlobalChain_gtest.cpp
+ *
+ *    Description:  Test RestrictedGlobalChain in
+ *                  alignment/algorithms/anchoring/GlobalChain.hpp and
+ *                  StoreNonOverlappingIndices in LISPValue.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "datastructures/anchoring/MatchPos.hpp"
+#include "algorithms/anchoring/GlobalChain.hpp"
+#include "algorithms/anchoring/LISPValue.hpp"
+
+using namespace std;
+
+class CompareMatchPosByT {
+public:
+    bool operator()(const MatchPos &a, const MatchPos &b) const {
+        return a.t < b.t;
+    }
+};
+
+//
+// Anchors along a few diagonals with drifting gaps, and repeats that
+// place the same query anchors at other text positions.
+//
+static void MakeAnchors(int nAnchors, vector<MatchPos> &anchors) {
+    anchors.clear();
+    DNALength t = 1000000, q = 0;
+    while ((int) anchors.size() < nAnchors) {
+        DNALength l = 8 + rand() % 12;
+        anchors.push_back(MatchPos(t, q, l));
+        if (rand() % 4 == 0) {
+            anchors.push_back(MatchPos(t + 5000 + rand() % 20000, q, l));
+        }
+        t += l + rand() % 20;
+        q += l + rand() % 20;
+        if (rand() % 100 == 0) {
+            q = rand() % (q + 1);
+        }
+    }
+    stable_sort(anchors.begin(), anchors.end(), CompareMatchPosByT());
+}
+
+//
+// The quadratic chain that RestrictedGlobalChain replaced.  It compares
+// the gaps in float, which RestrictedGlobalChain follows at the rate of
+// 0.1 used by FindMaxInterval and at rates that float holds exactly.
+//
+static UInt QuadraticChain(vector<MatchPos> &fragments, float maxIndelRate,
+                           vector<VectorIndex> &chain) {
+    UInt n = fragments.size();
+    vector<UInt> scores(n, 1), prevOpt(n);
+    UInt globalOptScore = 0, globalOptIndex = 0;
+    for (UInt f = 0; f < n; f++) {
+        prevOpt[f] = f;
+    }
+    for (UInt f1 = 0; f1 + 1 < n; f1++) {
+        for (UInt f2 = f1 + 1; f2 < n; f2++) {
+            if (fragments[f2].GetQ() > fragments[f1].GetQ() + fragments[f1].GetW() and
+                fragments[f2].GetT() > fragments[f1].GetT() + fragments[f1].GetW()) {
+                UInt tDiff = fragments[f2].GetT() - (fragments[f1].GetT() + fragments[f1].GetW());
+                UInt qDiff = fragments[f2].GetQ() - (fragments[f1].GetQ() + fragments[f1].GetW());
+                UInt maxDiff = max(tDiff, qDiff), minDiff = min(tDiff, qDiff);
+                if (maxDiff - minDiff < minDiff*maxIndelRate and
+                    scores[f2] < scores[f1] + 1) {
+                    scores[f2] = scores[f1] + 1;
+                    prevOpt[f2] = f1;
+                    if (scores[f2] > globalOptScore) {
+                        globalOptScore = scores[f2];
+                        globalOptIndex = f2;
+                    }
+                }
+            }
+        }
+    }
+    UInt index = globalOptIndex;
+    while (index != prevOpt[index]) {
+        chain.push_back(index);
+        index = prevOpt[index];
+    }
+    chain.push_back(index);
+    reverse(chain.begin(), chain.end());
+    return chain.size();
+}
+
+TEST(GlobalChainTest, RestrictedGlobalChain) {
+    srand(1);
+    float indelRates[] = {0.0, 0.1, 0.25, 0.5};
+    vector<UInt> scores, prevOpt;
+    for (int trial = 0; trial < 30; trial++) {
+        vector<MatchPos> anchors;
+        MakeAnchors(1 + rand() % 400, anchors);
+        for (int r = 0; r < 4; r++) {
+            vector<VectorIndex> expected, chain;
+            UInt expectedSize = QuadraticChain(anchors, indelRates[r], expected);
+            UInt size = RestrictedGlobalChain(&anchors[0], anchors.size(), 
+                indelRates[r], chain, scores, prevOpt);
+            ASSERT_EQ(expectedSize, size);
+            ASSERT_EQ(expected, chain);
+        }
+    }
+}
+
+//
+// The quadratic scan of StoreNonOverlappingIndices.
+//
+static void QuadraticNonOverlapping(vector<MatchPos> &lis, vector<MatchPos> &noOvpLis) {
+    SortMatchPosListByWeight(lis);
+    for (size_t i = 0; i < lis.size(); i++) {
+        DNALength lts = lis[i].t, lte = lis[i].t + lis[i].GetLength();
+        DNALength lqs = lis[i].q, lqe = lis[i].q + lis[i].GetLength();
+        bool ovpFound = false;
+        for (size_t j = 0; j < noOvpLis.size() and !ovpFound; j++) {
+            DNALength ts = noOvpLis[j].t, te = noOvpLis[j].t + noOvpLis[j].GetLength();
+            DNALength qs = noOvpLis[j].q, qe = noOvpLis[j].q + noOvpLis[j].GetLength();
+            ovpFound = ((lts >= ts and lts < te) or (lte > ts and lte <= te) or
+                        (lqs >= qs and lqs < qe) or (lqe > qs and lqe <= qe));
+        }
+        if (!ovpFound) {
+            noOvpLis.push_back(lis[i]);
+        }
+    }
+    SortMatchPosList(noOvpLis);
+}
+
+TEST(GlobalChainTest, StoreNonOverlappingIndices) {
+    srand(2);
+    for (int trial = 0; trial < 50; trial++) {
+        vector<MatchPos> lis;
+        int n = 2 + rand() % 300;
+        for (int i = 0; i < n; i++) {
+            lis.push_back(MatchPos(rand() % 2000, rand() % 2000, rand() % 40));
+        }
+        vector<MatchPos> expectedLis(lis), expected, noOvpLis;
+        QuadraticNonOverlapping(expectedLis, expected);
+        StoreNonOverlappingIndices(lis, noOvpLis);
+        ASSERT_EQ(expected.size(), noOvpLis.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_EQ(expected[i].t, noOvpLis[i].t);
+            ASSERT_EQ(expected[i].q, noOvpLis[i].q);
+            ASSERT_EQ(expected[i].l, noOvpLis[i].l);
+        }
+    }
+}
@@ -0,0 +1,216 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BWT_gtest.cpp
+ *
+ *    Description:  Test alignment/bwt/BWT.hpp, PackedOcc.hpp, and Pos.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTASequence.hpp"
+#include "bwt/BWT.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+
+class BWTTest : public ::testing::Test {
+public:
+    void Build(const string &genomeString,
+               DNALength sampleStride = Pos<PackedDNASequence>::DefaultStride) {
+        genomeText = genomeString;
+        genome.Copy(genomeText);
+        BuildSuffixArray(genomeText, suffixArray);
+        bwt.InitializeFromSuffixArray(genome, &suffixArray[0], 0, sampleStride);
+    }
+
+    void ExpectSameMatches(Bwt<PackedDNASequence, FASTASequence> &index, int nQueries) {
+        for (int i = 0; i < nQueries; i++) {
+            int length = 1 + rand() % 12;
+            int start = rand() % (genomeText.size() - length);
+            string query = genomeText.substr(start, length);
+            if (i % 4 == 0) {
+                query[rand() % length] = "ACGTN"[rand() % 5];
+            }
+            vector<DNALength> expected;
+            size_t p = genomeText.find(query);
+            while (p != string::npos) {
+                expected.push_back(p);
+                p = genomeText.find(query, p + 1);
+            }
+            FASTASequence querySeq;
+            querySeq.Copy(query);
+            DNALength sp, ep;
+            int count = index.Count(querySeq, sp, ep);
+            ASSERT_EQ(expected.size(), (size_t) max(count, 0)) << query;
+            vector<DNALength> positions;
+            index.Locate(querySeq, positions);
+            sort(positions.begin(), positions.end());
+            //
+            // Locate(sp, ep) skips a match at position 0.
+            //
+            if (expected.size() > 0 and expected[0] == 0) {
+                expected.erase(expected.begin());
+            }
+            ASSERT_EQ(expected, positions) << query;
+        }
+    }
+
+    string genomeText;
+    FASTASequence genome;
+    vector<DNALength> suffixArray;
+    Bwt<PackedDNASequence, FASTASequence> bwt;
+};
+
+TEST_F(BWTTest, CountAndLocate) {
+    srand(3);
+    Build(RepetitiveSequence(5000, false));
+    ExpectSameMatches(bwt, 500);
+}
+
+TEST_F(BWTTest, CountAndLocateWithN) {
+    srand(4);
+    Build(RepetitiveSequence(3001, true));
+    ExpectSameMatches(bwt, 500);
+}
+
+TEST_F(BWTTest, WriteAndReadKeepFormat) {
+    srand(5);
+    Build(RepetitiveSequence(2000, true));
+
+    //
+    // The file holds the BWT and the GbOcc bins, as it did before the
+    // occurrence table was packed.
+    //
+    PackedDNASequence bwtCopy;
+    bwtCopy.Allocate(bwt.bwtSequence.length);
+    for (DNALength p = 0; p < bwt.bwtSequence.length; p++) {
+        bwtCopy.Set(p, bwt.occ[p]);
+    }
+    GbOcc binnedOcc;
+    binnedOcc.Initialize(bwtCopy, 4096, 64, 0);
+    stringstream expected;
+    bwtCopy.Write(expected);
+    expected.write((char*) bwt.charCount, sizeof(DNALength) * bwt.CharCountSize);
+    expected.write((char*) &bwt.firstCharPos, sizeof(DNALength));
+    expected.write((char*) &bwt.useDebugData, sizeof(bwt.useDebugData));
+    binnedOcc.Write(expected);
+    bwt.pos.Write(expected);
+
+    stringstream out;
+    bwt.Write(out);
+    ASSERT_EQ(expected.str(), out.str());
+
+    Bwt<PackedDNASequence, FASTASequence> readBwt;
+    stringstream in(out.str());
+    readBwt.Read(in);
+    EXPECT_EQ(readBwt.bwtSequence.length, bwt.bwtSequence.length);
+    ExpectSameMatches(readBwt, 200);
+}
+
+TEST_F(BWTTest, SampleStride) {
+    srand(9);
+    string genomeString = RepetitiveSequence(3000, true);
+    //
+    // Tandem copies keep many hits in one interval while locating.
+    //
+    string repeat = genomeString.substr(100, 57);
+    for (int i = 0; i < 40; i++) {
+        genomeString += repeat;
+    }
+    DNALength strides[] = {1, 5, 32, 200};
+    for (int s = 0; s < 4; s++) {
+        Build(genomeString, strides[s]);
+        EXPECT_EQ(bwt.pos.stride, strides[s]);
+        ExpectSameMatches(bwt, 300);
+
+        stringstream out;
+        bwt.Write(out);
+        Bwt<PackedDNASequence, FASTASequence> readBwt;
+        stringstream in(out.str());
+        readBwt.Read(in);
+        EXPECT_EQ(readBwt.pos.stride, strides[s]);
+        ExpectSameMatches(readBwt, 100);
+
+        //
+        // A batch locates the same positions as row by row.
+        //
+        FASTASequence repeatSeq;
+        repeatSeq.Copy(repeat.substr(0, 20));
+        DNALength sp, ep;
+        ASSERT_GE(bwt.Count(repeatSeq, sp, ep), 40);
+        vector<DNALength> batch, single;
+        bwt.Locate(sp, ep, batch);
+        for (DNALength row = sp; row <= ep; row++) {
+            single.push_back(bwt.Locate(row));
+        }
+        EXPECT_EQ(single, batch);
+    }
+}
+
+TEST_F(BWTTest, ReadPackedHashSamples) {
+    srand(10);
+    Build(RepetitiveSequence(2000, true));
+
+    //
+    // Indices written before the stride was stored keep the samples in
+    // a PackedHash.
+    //
+    PackedHash packedHash;
+    packedHash.Allocate(suffixArray.size());
+    for (DNALength p = 0; p < suffixArray.size(); p++) {
+        if (suffixArray[p] % 8 == 0) {
+            packedHash.AddValue(p, suffixArray[p]);
+        }
+    }
+    stringstream out;
+    packedHash.Write(out);
+    Pos<PackedDNASequence> legacyPos;
+    legacyPos.Read(out);
+    for (DNALength row = 1; row <= suffixArray.size(); row++) {
+        DNALength expected = 0, value = 0;
+        int found = bwt.pos.Lookup(row, expected);
+        ASSERT_EQ(found, legacyPos.Lookup(row, value)) << row;
+        ASSERT_EQ(expected, value) << row;
+    }
+}
+
+TEST(PackedOccTest, CountMatchesOcc) {
+    srand(6);
+    int lengths[] = {1, 119, 120, 121, 5000};
+    for (int l = 0; l < 5; l++) {
+        PackedDNASequence seq;
+        seq.Allocate(lengths[l]);
+        for (int p = 0; p < lengths[l]; p++) {
+            seq.Set(p, rand() % 5);
+        }
+        seq.Set(rand() % lengths[l], 5);
+        GbOcc binnedOcc;
+        binnedOcc.Initialize(seq, 4096, 64, 0);
+        PackedOcc occ;
+        occ.Initialize(seq);
+        EXPECT_EQ(occ.ByteSize() % 64, 0);
+        EXPECT_EQ(((unsigned long) occ.blocks) % 64, 0);
+        for (int p = 0; p < lengths[l]; p++) {
+            ASSERT_EQ(seq[p], occ[p]);
+            for (Nucleotide n = 0; n < 5; n++) {
+                ASSERT_EQ((DNALength) binnedOcc.Count(n, p), occ.Count(n, p))
+                    << "length " << lengths[l] << " pos " << p << " nuc " << (int) n;
+            }
+            DNALength counts[PackedOcc::CountsPerBlock];
+            occ.CountNucleotides(p, counts);
+            for (Nucleotide n = 0; n < 4; n++) {
+                ASSERT_EQ(occ.Count(n, p), counts[n]) << "pos " << p << " nuc " << (int) n;
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  ReadBatchQueue_gtest.cpp
+ *
+ *    Description:  Test alignment/files/ReadBatchQueue.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <pthread.h>
+#include "gtest/gtest.h"
+#include "files/ReadBatchQueue.hpp"
+
+static const int nBatches = 200;
+static const int batchLength = 10;
+
+static void* ProduceIntBatches(void *data) {
+    ReadBatchQueue<int> *queue = (ReadBatchQueue<int>*) data;
+    for (int b = 0; b < nBatches; b++) {
+        std::vector<int> *batch = new std::vector<int>;
+        for (int i = 0; i < batchLength; i++) {
+            batch->push_back(b * batchLength + i);
+        }
+        queue->Push(batch);
+    }
+    queue->Close();
+    return NULL;
+}
+
+class ConsumeTask {
+public:
+    ReadBatchQueue<int> *queue;
+    long sum;
+    int nBatches;
+};
+
+static void* ConsumeIntBatches(void *data) {
+    ConsumeTask *task = (ConsumeTask*) data;
+    std::vector<int> *batch;
+    while (task->queue->Pop(batch)) {
+        for (size_t i = 0; i < batch->size(); i++) {
+            task->sum += (*batch)[i];
+        }
+        task->nBatches++;
+        delete batch;
+    }
+    return NULL;
+}
+
+TEST(ReadBatchQueueTest, FirstInFirstOut) {
+    ReadBatchQueue<int> queue(3);
+    for (int b = 0; b < 3; b++) {
+        queue.Push(new std::vector<int>(1, b));
+    }
+    queue.Close();
+    std::vector<int> *batch;
+    for (int b = 0; b < 3; b++) {
+        ASSERT_TRUE(queue.Pop(batch));
+        EXPECT_EQ((*batch)[0], b);
+        delete batch;
+    }
+    EXPECT_FALSE(queue.Pop(batch));
+    EXPECT_TRUE(batch == NULL);
+}
+
+TEST(ReadBatchQueueTest, OneProducerManyConsumers) {
+    //
+    // The queue is much shorter than the number of batches, so the
+    // producer must block and resume.
+    //
+    ReadBatchQueue<int> queue(2);
+    const int nConsumers = 4;
+    pthread_t producer, consumers[nConsumers];
+    ConsumeTask tasks[nConsumers];
+    pthread_create(&producer, NULL, ProduceIntBatches, &queue);
+    for (int c = 0; c < nConsumers; c++) {
+        tasks[c].queue = &queue;
+        tasks[c].sum = 0;
+        tasks[c].nBatches = 0;
+        pthread_create(&consumers[c], NULL, ConsumeIntBatches, &tasks[c]);
+    }
+    pthread_join(producer, NULL);
+    long sum = 0;
+    int nConsumed = 0;
+    for (int c = 0; c < nConsumers; c++) {
+        pthread_join(consumers[c], NULL);
+        sum += tasks[c].sum;
+        nConsumed += tasks[c].nBatches;
+    }
+    long n = nBatches * batchLength;
+    EXPECT_EQ(nConsumed, nBatches);
+    EXPECT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST(ReadBatchQueueTest, PushAfterCloseIsDropped) {
+    ReadBatchQueue<int> queue(1);
+    queue.Close();
+    queue.Push(new std::vector<int>(1, 0));
+    std::vector<int> *batch;
+    EXPECT_FALSE(queue.Pop(batch));
+}
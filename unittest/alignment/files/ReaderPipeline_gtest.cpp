@@ -0,0 +1,95 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  ReaderPipeline_gtest.cpp
+ *
+ *    Description:  Test alignment/files/ReaderPipeline.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <pthread.h>
+#include "files/ReaderPipeline.hpp"
+#include "pbdata/testdata.h"
+#include <gtest/gtest.h>
+using namespace std;
+
+class CountReadsWorker {
+public:
+    pthread_mutex_t lock;
+    long nReads;
+    long nBases;
+    CountReadsWorker() : nReads(0), nBases(0) {
+        pthread_mutex_init(&lock, NULL);
+    }
+    ~CountReadsWorker() {
+        pthread_mutex_destroy(&lock);
+    }
+    void operator()(vector<SMRTSequence> &reads, int workerIndex) {
+        long batchBases = 0;
+        for (size_t i = 0; i < reads.size(); i++) {
+            batchBases += reads[i].length;
+        }
+        pthread_mutex_lock(&lock);
+        nReads += reads.size();
+        nBases += batchBases;
+        pthread_mutex_unlock(&lock);
+    }
+};
+
+static void CountSerially(string fn, long &nReads, long &nBases) {
+    ReaderAgglomerate reader;
+    reader.SetReadFileName(fn);
+    EXPECT_EQ(reader.Initialize(), 1);
+    SMRTSequence seq;
+    nReads = nBases = 0;
+    while (reader.GetNext(seq)) {
+        nReads++;
+        nBases += seq.length;
+    }
+    reader.Close();
+}
+
+TEST(ReaderPipelineTest, RunMatchesSerialRead) {
+    string fn = fastaFile1;
+    long nReads, nBases;
+    CountSerially(fn, nReads, nBases);
+
+    ReaderAgglomerate reader;
+    reader.SetReadFileName(fn);
+    EXPECT_EQ(reader.Initialize(), 1);
+    ReaderPipeline<SMRTSequence> pipeline(reader, 2);
+    pipeline.ChunkByNReads(3);
+    CountReadsWorker worker;
+    EXPECT_EQ(pipeline.Run(4, worker), 4);
+    reader.Close();
+
+    EXPECT_EQ(worker.nReads, nReads);
+    EXPECT_EQ(worker.nBases, nBases);
+    EXPECT_EQ(pipeline.NumReads(), nReads);
+}
+
+TEST(ReaderPipelineTest, GetNextBatchBySize) {
+    string fn = fastaFile1;
+    long nReads, nBases;
+    CountSerially(fn, nReads, nBases);
+
+    ReaderAgglomerate reader;
+    reader.SetReadFileName(fn);
+    EXPECT_EQ(reader.Initialize(), 1);
+    ReaderPipeline<SMRTSequence> pipeline(reader);
+    pipeline.ChunkBySize(1000);
+    EXPECT_TRUE(pipeline.Start());
+    vector<SMRTSequence> reads;
+    long nPipelineReads = 0;
+    while (pipeline.GetNextBatch(reads)) {
+        EXPECT_GT(reads.size(), 0);
+        nPipelineReads += reads.size();
+    }
+    pipeline.Join();
+    reader.Close();
+    EXPECT_EQ(nPipelineReads, nReads);
+}
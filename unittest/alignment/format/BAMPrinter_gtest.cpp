@@ -0,0 +1,113 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BAMPrinter_gtest.cpp
+ *
+ *    Description:  Test alignment/format/BAMPrinter.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#ifdef USE_PBBAM
+#include <string.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "format/BAMPrinter.hpp"
+#include "htslib/sam.h"
+
+using namespace std;
+
+static PacBio::BAM::BamRecord MakeRecord(const string &name, int32_t refId,
+        int32_t pos, const string &cigar, const string &seq, uint16_t flag) {
+    PacBio::BAM::BamRecord record;
+    record.Impl().Name(name);
+    record.Impl().SetSequenceAndQualities(seq, string(seq.size(), '5'));
+    if (cigar != "") {
+        record.Impl().CigarData(PacBio::BAM::Cigar::FromStdString(cigar));
+    }
+    record.Impl().Bin(0);
+    record.Impl().InsertSize(0);
+    record.Impl().MapQuality(static_cast<uint8_t>(refId >= 0 ? 254 : 255));
+    record.Impl().MatePosition(static_cast<PacBio::BAM::Position>(-1));
+    record.Impl().MateReferenceId(static_cast<int32_t>(-1));
+    record.Impl().Position(static_cast<PacBio::BAM::Position>(pos));
+    record.Impl().ReferenceId(refId);
+    record.Impl().Flag(static_cast<uint32_t>(flag));
+    return record;
+}
+
+TEST(BAMPrinterTest, AppendBamRecordRoundTrip) {
+    string samHeader = "@HD\tVN:1.5\tSO:unknown\n"
+                       "@SQ\tSN:ref1\tLN:100000\n"
+                       "@SQ\tSN:ref2\tLN:5000000\n";
+    vector<PacBio::BAM::BamRecord> records;
+    records.push_back(MakeRecord("m0/1/0_20", 0, 16380, "20=",
+                                 "ACGTACGTACGTACGTACGT", 0));
+    records.push_back(MakeRecord("m0/2/0_30", 1, 3000000, "10=5I5=200D10=",
+                                 "ACGTACGTACGTACGTACGTACGTACGTAC", 16));
+    records.push_back(MakeRecord("m0/3/0_8", -1, -1, "", "ACGTACGT", 4));
+
+    string fileName = "BAMPrinter_gtest.bam";
+    ofstream out(fileName.c_str(), ios::binary);
+    BGZFWriter writer;
+    writer.Initialize(&out, 2);
+    WriteBAMHeader(writer, samHeader);
+    //
+    // A tiny flush size passes each record to the writer on its own.
+    //
+    SAMOutput::OutputBuffer recordBuffer(1);
+    for (size_t i = 0; i < records.size(); i++) {
+        BAMOutput::AppendBamRecord(records[i], recordBuffer);
+        if (recordBuffer.Full()) {
+            BAMOutput::FlushRecords(recordBuffer, writer);
+        }
+    }
+    BAMOutput::FlushRecords(recordBuffer, writer);
+    writer.Close();
+    out.close();
+
+    samFile *in = sam_open(fileName.c_str(), "r");
+    ASSERT_TRUE(in != NULL);
+    bam_hdr_t *header = sam_hdr_read(in);
+    ASSERT_TRUE(header != NULL);
+    EXPECT_EQ(header->n_targets, 2);
+    EXPECT_EQ(string(header->target_name[1]), "ref2");
+    EXPECT_EQ(header->target_len[1], 5000000u);
+
+    bam1_t *b = bam_init1();
+    for (size_t i = 0; i < records.size(); i++) {
+        ASSERT_GE(sam_read1(in, header, b), 0);
+        const bam1_t *expected = records[i].Impl().RawData().get();
+        EXPECT_EQ(string(bam_get_qname(b)), string(bam_get_qname(expected)));
+        EXPECT_EQ(b->core.tid, expected->core.tid);
+        EXPECT_EQ(b->core.pos, expected->core.pos);
+        EXPECT_EQ(b->core.flag, expected->core.flag);
+        EXPECT_EQ(b->core.qual, expected->core.qual);
+        EXPECT_EQ(b->core.mtid, expected->core.mtid);
+        EXPECT_EQ(b->core.mpos, expected->core.mpos);
+        EXPECT_EQ(b->core.n_cigar, expected->core.n_cigar);
+        EXPECT_EQ(b->core.l_qseq, expected->core.l_qseq);
+        //
+        // The bin is computed from the aligned region, not copied from
+        // the record, whose bin is 0.
+        //
+        EXPECT_EQ(b->core.bin, hts_reg2bin(b->core.pos, bam_endpos(b), 14, 5));
+        int restLength = b->l_data - b->core.l_qname;
+        ASSERT_EQ(restLength, expected->l_data - expected->core.l_qname);
+        EXPECT_EQ(0, memcmp(b->data + b->core.l_qname,
+                            expected->data + expected->core.l_qname, restLength));
+    }
+    EXPECT_EQ(b->core.bin, 4680);
+    EXPECT_LT(sam_read1(in, header, b), 0);
+
+    bam_destroy1(b);
+    bam_hdr_destroy(header);
+    sam_close(in);
+    remove(fileName.c_str());
+}
+#endif
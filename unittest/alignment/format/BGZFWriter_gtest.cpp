@@ -0,0 +1,171 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  BGZFWriter_gtest.cpp
+ *
+ *    Description:  Test alignment/format/BGZFWriter.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include <string>
+#include <zlib.h>
+#include "gtest/gtest.h"
+#include "format/BGZFWriter.hpp"
+
+using namespace std;
+
+//
+// Decompress a file of concatenated gzip members.
+//
+static string Inflate(const string &compressed) {
+    string result;
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    EXPECT_EQ(inflateInit2(&zs, 15 + 16), Z_OK);
+    zs.next_in  = (Bytef*) compressed.data();
+    zs.avail_in = compressed.size();
+    char buffer[4096];
+    while (zs.avail_in > 0) {
+        zs.next_out  = (Bytef*) buffer;
+        zs.avail_out = sizeof(buffer);
+        int status = inflate(&zs, Z_NO_FLUSH);
+        result.append(buffer, sizeof(buffer) - zs.avail_out);
+        if (status == Z_STREAM_END) {
+            inflateReset(&zs);
+        }
+        else if (status != Z_OK) {
+            ADD_FAILURE() << "inflate returned " << status;
+            break;
+        }
+    }
+    inflateEnd(&zs);
+    return result;
+}
+
+static string MakeRecords(int nRecords, string &text) {
+    stringstream recordsOut;
+    for (int i = 0; i < nRecords; i++) {
+        recordsOut << "read/" << i << "\t" << rand() % 4096 << "\t";
+        int length = rand() % 500;
+        for (int j = 0; j < length; j++) {
+            recordsOut << "ACGT"[rand() % 4];
+        }
+        recordsOut << "\n";
+    }
+    text = recordsOut.str();
+    return text;
+}
+
+static string WriteRecords(const string &text, int nThreads) {
+    stringstream out;
+    BGZFWriter writer;
+    writer.Initialize(&out, nThreads, Z_DEFAULT_COMPRESSION, 2);
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start) + 1;
+        writer.Write(text.c_str() + start, end - start);
+        start = end;
+    }
+    writer.Close();
+    return out.str();
+}
+
+TEST(BGZFWriterTest, CompressInBlocks) {
+    srand(11);
+    string text;
+    MakeRecords(5000, text);
+    ASSERT_GT(text.size(), (size_t) 10 * BGZFWriter::MaxBlockInput);
+
+    string single = WriteRecords(text, 0);
+    EXPECT_EQ(text, Inflate(single));
+
+    //
+    // Each block is a gzip member whose BC field holds its size - 1,
+    // and the last is the empty end-of-file block.
+    //
+    size_t offset = 0;
+    int nBlocks = 0;
+    while (offset < single.size()) {
+        const unsigned char *block = (const unsigned char*) single.data() + offset;
+        ASSERT_EQ(block[0], 0x1f);
+        ASSERT_EQ(block[1], 0x8b);
+        ASSERT_EQ(block[12], 'B');
+        ASSERT_EQ(block[13], 'C');
+        int blockSize = block[16] + (block[17] << 8) + 1;
+        ASSERT_LE(blockSize, (int) BGZFWriter::MaxBlockSize);
+        offset += blockSize;
+        nBlocks++;
+    }
+    EXPECT_EQ(offset, single.size());
+    EXPECT_GT(nBlocks, 10);
+    const unsigned char eofBlock[] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C',
+        2, 0, 0x1b, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+    ASSERT_GE(single.size(), sizeof(eofBlock));
+    EXPECT_EQ(string((const char*) eofBlock, sizeof(eofBlock)),
+              single.substr(single.size() - sizeof(eofBlock)));
+
+    //
+    // The pool writes the same blocks in the same order.
+    //
+    EXPECT_EQ(single, WriteRecords(text, 1));
+    EXPECT_EQ(single, WriteRecords(text, 3));
+}
+
+TEST(BGZFWriterTest, IncompressibleBlock) {
+    srand(12);
+    string noise(3 * BGZFWriter::MaxBlockInput, ' ');
+    for (size_t i = 0; i < noise.size(); i++) {
+        noise[i] = (char) (rand() % 256);
+    }
+    stringstream out;
+    BGZFWriter writer;
+    writer.Initialize(&out, 2);
+    writer.Write(noise);
+    writer.Close();
+    EXPECT_EQ(noise, Inflate(out.str()));
+}
+
+TEST(BGZFWriterTest, BAMHeader) {
+    string samHeader = "@HD\tVN:1.5\tSO:unknown\n"
+                       "@SQ\tSN:chr1\tLN:1000\n"
+                       "@SQ\tSN:ref2\tLN:70000\tM5:abc\n";
+    stringstream out;
+    BGZFWriter writer;
+    writer.Initialize(&out);
+    WriteBAMHeader(writer, samHeader);
+    writer.Close();
+
+    string expected("BAM\1", 4);
+    char textLength[4] = {(char) samHeader.size(), 0, 0, 0};
+    expected.append(textLength, 4);
+    expected += samHeader;
+    expected.append("\2\0\0\0", 4);
+    expected.append("\5\0\0\0chr1\0", 9);
+    expected.append("\xe8\3\0\0", 4);
+    expected.append("\5\0\0\0ref2\0", 9);
+    expected.append("\x70\x11\1\0", 4);
+    EXPECT_EQ(expected, Inflate(out.str()));
+}
+
+TEST(BGZFWriterTest, BAMRegionToBin) {
+    // Unmapped.
+    EXPECT_EQ(BAMRegionToBin(-1, 0), 4680);
+    // Within one 16 kb window.
+    EXPECT_EQ(BAMRegionToBin(0, 1), 4681);
+    EXPECT_EQ(BAMRegionToBin(0, 1 << 14), 4681);
+    EXPECT_EQ(BAMRegionToBin(100000, 100050), 4681 + (100000 >> 14));
+    // Across 16 kb windows, within 128 kb, 1 Mb, 8 Mb and 64 Mb.
+    EXPECT_EQ(BAMRegionToBin(16380, 16390), 585);
+    EXPECT_EQ(BAMRegionToBin(3000000, 3000000 + (1 << 17)), 73 + (3000000 >> 20));
+    EXPECT_EQ(BAMRegionToBin(1 << 20, 3 << 20), 9);
+    EXPECT_EQ(BAMRegionToBin(1 << 23, 3 << 23), 1);
+    // Across 64 Mb windows.
+    EXPECT_EQ(BAMRegionToBin(0, (1 << 26) + 1), 0);
+}
@@ -0,0 +1,179 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SAMOutputBuffer_gtest.cpp
+ *
+ *    Description:  Test the buffered record formatting of
+ *                  alignment/format/SAMPrinter.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <sstream>
+#include <string>
+#include "gtest/gtest.h"
+#include "format/SAMPrinter.hpp"
+
+using namespace std;
+
+static void MakeRead(SMRTSequence &read, bool withQVs) {
+    string bases = "GATTACAGGCTTACCGATAACGGTTCAGCA";
+    read.DNASequence::Copy(bases);
+    read.subreadStart = 1;
+    read.subreadEnd = 29;
+    read.lowQualityPrefix = 1;
+    read.lowQualitySuffix = 1;
+    read.zmwData.holeNumber = 77;
+    if (withQVs) {
+        read.AllocateQualitySpace(read.length);
+        read.AllocateInsertionQVSpace(read.length);
+        read.AllocateDeletionQVSpace(read.length);
+        read.AllocateSubstitutionQVSpace(read.length);
+        read.AllocateMergeQVSpace(read.length);
+        read.AllocateDeletionTagSpace(read.length);
+        read.AllocateSubstitutionTagSpace(read.length);
+        for (DNALength i = 0; i < read.length; i++) {
+            read.qual[i] = i % 40;
+            read.insertionQV[i] = (i % 7 == 0) ? 100 : i;
+            read.deletionQV[i] = (i % 5 == 0) ? 255 : 2 * i;
+            read.substitutionQV[i] = 3 + i;
+            read.mergeQV[i] = 60 - i;
+            read.deletionTag[i] = "ACGTN"[i % 5];
+            read.substitutionTag[i] = "TGCA"[i % 4];
+        }
+    }
+}
+
+static void MakeAlignment(T_AlignmentCandidate &alignment, SMRTSequence &read,
+                          DNASequence &target, int strand) {
+    alignment.qName = "movie/1/0_30";
+    alignment.tName = "chr1";
+    alignment.tStrand = strand;
+    alignment.qStrand = 0;
+    alignment.qPos = 4;
+    alignment.tPos = 3;
+    alignment.qLength = read.length;
+    alignment.tLength = 100;
+    alignment.mapQV = 40;
+    alignment.score = -120;
+    alignment.qAlignedSeq.ReferenceSubstring(read);
+    alignment.tAlignedSeq.ReferenceSubstring(target);
+    blasr::Block b;
+    b.qPos = 0; b.tPos = 0; b.length = 6; alignment.blocks.push_back(b);
+    b.qPos = 8; b.tPos = 6; b.length = 5; alignment.blocks.push_back(b);
+    b.qPos = 13; b.tPos = 13; b.length = 6; alignment.blocks.push_back(b);
+    alignment.gaps.resize(4);
+    alignment.gaps[1].push_back(blasr::Gap(blasr::Gap::Target, 2));
+    alignment.gaps[2].push_back(blasr::Gap(blasr::Gap::Query, 2));
+}
+
+//
+// withQVs, print QVs, strand, clipping, cigarUseSeqMatch
+//
+static const int cases[][5] = {
+    {0, 0, 0, SAMOutput::none,    0}, {0, 0, 0, SAMOutput::none,    1},
+    {0, 0, 0, SAMOutput::hard,    0}, {0, 0, 0, SAMOutput::soft,    1},
+    {0, 0, 0, SAMOutput::subread, 0}, {0, 0, 1, SAMOutput::none,    1},
+    {0, 0, 1, SAMOutput::hard,    0}, {0, 0, 1, SAMOutput::soft,    0},
+    {0, 0, 1, SAMOutput::subread, 1}, {1, 0, 0, SAMOutput::soft,    0},
+    {1, 0, 1, SAMOutput::hard,    0}, {1, 1, 0, SAMOutput::none,    0},
+    {1, 1, 0, SAMOutput::subread, 0}, {1, 1, 1, SAMOutput::none,    0},
+    {1, 1, 1, SAMOutput::soft,    1}, {1, 1, 1, SAMOutput::subread, 0}};
+static const int nCases = 16;
+
+//
+// Records printed for the cases above through std::stringstream, before
+// records were formatted into a buffer.
+//
+static const char *expectedRecords[] = {
+    "movie/1/0_30\t0\tchr1\t4\t40\t6M2I5M2D6M\t*\t0\t0\tACAGGCTTACCGATAACGG\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t0\tchr1\t4\t40\t5X1=2I3X1=1X2D2=1X2=1X\t*\t0\t0\tACAGGCTTACCGATAACGG\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t256\tchr1\t4\t40\t4H6M2I5M2D6M7H\t*\t0\t0\tACAGGCTTACCGATAACGG\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t0\tchr1\t4\t40\t1H3S5X1=2I3X1=1X2D2=1X2=1X6S1H\t*\t0\t0\tATTACAGGCTTACCGATAACGGTTCAGC\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t0\tchr1\t4\t40\t1H3S6M2I5M2D6M6S1H\t*\t0\t0\tATTACAGGCTTACCGATAACGGTTCAGC\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t272\tchr1\t79\t40\t1X2=1X2=2D1X1=3X2I1=5X\t*\t0\t0\tCCGTTATCGGTAAGCCTGT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t16\tchr1\t79\t40\t7H6M2D5M2I6M4H\t*\t0\t0\tCCGTTATCGGTAAGCCTGT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t16\tchr1\t79\t40\t1H6S6M2D5M2I6M3S1H\t*\t0\t0\tGCTGAACCGTTATCGGTAAGCCTGTAAT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t272\tchr1\t79\t40\t1H6S1X2=1X2=2D1X1=3X2I1=5X3S1H\t*\t0\t0\tGCTGAACCGTTATCGGTAAGCCTGTAAT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t0\tchr1\t4\t40\t1H3S6M2I5M2D6M6S1H\t*\t0\t0\tATTACAGGCTTACCGATAACGGTTCAGC\t\"#$%&'()*+,-./0123456789:;<=\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t16\tchr1\t79\t40\t7H6M2D5M2I6M4H\t*\t0\t0\tCCGTTATCGGTAAGCCTGT\t76543210/.-,+*)('&%\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\n",
+    "movie/1/0_30\t256\tchr1\t4\t40\t6M2I5M2D6M\t*\t0\t0\tACAGGCTTACCGATAACGG\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\tiq:Z:%&'~)*+,-.~012345~7\tdq:Z:)~-/13~79;=~ACEG~KM\tsq:Z:()*+,-./0123456789:\tmq:Z:YXWVUTSRQPONMLKJIHG\tst:Z:TGCATGCATGCATGCATGC\tdt:Z:NACGTNACGTNACGTNACG\n",
+    "movie/1/0_30\t0\tchr1\t4\t40\t1H3S6M2I5M2D6M6S1H\t*\t0\t0\tATTACAGGCTTACCGATAACGGTTCAGC\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\tiq:Z:\"#$%&'~)*+,-.~012345~789:;<~\tdq:Z:#%')~-/13~79;=~ACEG~KMOQ~UWY\tsq:Z:%&'()*+,-./0123456789:;<=>?@\tmq:Z:\\[ZYXWVUTSRQPONMLKJIHGFEDCBA\tst:Z:GCATGCATGCATGCATGCATGCATGCAT\tdt:Z:CGTNACGTNACGTNACGTNACGTNACGT\n",
+    "movie/1/0_30\t16\tchr1\t79\t40\t6M2D5M2I6M\t*\t0\t0\tCCGTTATCGGTAAGCCTGT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:5\tXE:i:24\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\tiq:Z:7~543210~.-,+*)~'&%\tdq:Z:MK~GECA~=;97~31/-~)\tsq:Z::9876543210/.-,+*)(\tmq:Z:GHIJKLMNOPQRSTUVWXY\tst:Z:GCATGCATGCATGCATGCA\tdt:Z:CGTNACGTNACGTNACGTN\n",
+    "movie/1/0_30\t272\tchr1\t79\t40\t1H6S1X2=1X2=2D1X1=3X2I1=5X3S1H\t*\t0\t0\tGCTGAACCGTTATCGGTAAGCCTGTAAT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\tiq:Z:~<;:987~543210~.-,+*)~'&%$#\"\tdq:Z:YWU~QOMK~GECA~=;97~31/-~)'%#\tsq:Z:@?>=<;:9876543210/.-,+*)('&%\tmq:Z:ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\\tst:Z:ATGCATGCATGCATGCATGCATGCATGC\tdt:Z:ACGTNACGTNACGTNACGTNACGTNACG\n",
+    "movie/1/0_30\t16\tchr1\t79\t40\t1H6S6M2D5M2I6M3S1H\t*\t0\t0\tGCTGAACCGTTATCGGTAAGCCTGTAAT\t*\tRG:Z:rg1\tAS:i:-120\tXS:i:2\tXE:i:30\tYS:i:1\tYE:i:29\tZM:i:77\tXL:i:30\tXT:i:1\tNM:i:5\tFI:i:1\tXQ:i:30\tiq:Z:~<;:987~543210~.-,+*)~'&%$#\"\tdq:Z:YWU~QOMK~GECA~=;97~31/-~)'%#\tsq:Z:@?>=<;:9876543210/.-,+*)('&%\tmq:Z:ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\\tst:Z:ATGCATGCATGCATGCATGCATGCATGC\tdt:Z:ACGTNACGTNACGTNACGTNACGTNACG\n",
+};
+
+static void SetCase(int i, SMRTSequence &read, DNASequence &target, T_AlignmentCandidate &alignment,
+                    AlignmentContext &context, SupplementalQVList &qvList) {
+    MakeRead(read, cases[i][0]);
+    target.Copy("CCCGATTACTTAGGCTTACCGATAAGGTTC");
+    MakeAlignment(alignment, read, target, cases[i][2]);
+    context.readGroupId = "rg1";
+    context.editDist = 5;
+    context.isPrimary = (i % 3 != 2);
+    qvList.SetDefaultQV();
+    if (cases[i][1]) {
+        qvList.useqv |= SubstitutionTag;
+    }
+    else {
+        qvList.useqv = 0;
+    }
+}
+
+TEST(SAMOutputBufferTest, PrintAlignmentKeepsFormat) {
+    for (int i = 0; i < nCases; i++) {
+        SMRTSequence read;
+        DNASequence target;
+        T_AlignmentCandidate alignment;
+        AlignmentContext context;
+        SupplementalQVList qvList;
+        SetCase(i, read, target, alignment, context, qvList);
+        SAMOutput::Clipping clipping = (SAMOutput::Clipping) cases[i][3];
+
+        stringstream out;
+        SAMOutput::PrintAlignment(alignment, read, out, context, qvList, clipping, cases[i][4] == 1);
+        EXPECT_EQ(expectedRecords[i], out.str()) << "case " << i;
+
+        //
+        // Printing again into a buffer that is reused gives the same
+        // record, since the read is not changed.
+        //
+        SAMOutput::OutputBuffer buffer(64);
+        buffer.Append("x");
+        SAMOutput::PrintAlignment(alignment, read, buffer, context, qvList, clipping, cases[i][4] == 1);
+        SAMOutput::PrintAlignment(alignment, read, buffer, context, qvList, clipping, cases[i][4] == 1);
+        EXPECT_TRUE(buffer.Full());
+        stringstream bufferOut;
+        buffer.Flush(bufferOut);
+        EXPECT_EQ(0, buffer.size);
+        EXPECT_EQ(string("x") + expectedRecords[i] + expectedRecords[i], bufferOut.str()) << "case " << i;
+
+        DNALength prefixSoftClip = 0, suffixSoftClip = 0, prefixHardClip = 0, suffixHardClip = 0;
+        string cigar;
+        SAMOutput::CreateCIGARString(alignment, read, cigar, clipping, prefixSoftClip, suffixSoftClip,
+                                     prefixHardClip, suffixHardClip, cases[i][4] == 1);
+        string record = expectedRecords[i];
+        for (int field = 0; field < 5; field++) {
+            record = record.substr(record.find('\t') + 1);
+        }
+        EXPECT_EQ(record.substr(0, record.find('\t')), cigar) << "case " << i;
+    }
+}
+
+TEST(SAMOutputBufferTest, AppendInt) {
+    SAMOutput::OutputBuffer buffer;
+    long long values[] = {0, 7, -1, 10, 4294967295LL, -2147483648LL, 9223372036854775807LL};
+    stringstream expected;
+    for (int i = 0; i < 7; i++) {
+        buffer.AppendInt(values[i]);
+        buffer.Append(' ');
+        expected << values[i] << ' ';
+    }
+    stringstream out;
+    buffer.Flush(out);
+    EXPECT_EQ(expected.str(), out.str());
+}
@@ -0,0 +1,231 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SuffixArray_gtest.cpp
+ *
+ *    Description:  Test alignment/suffixarray/SuffixArray.hpp
+ *
+ *        Version:  1.0
+ *        Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
+#include "gtest/gtest.h"
+#include "suffixarray/SuffixArrayTypes.hpp"
+
+class SuffixArrayTest : public ::testing::Test {
+public:
+    void SetUp() {
+        const char nucs[] = "ACGT";
+        targetLength = 5000;
+        target.resize(targetLength);
+        srand(1);
+        for (DNALength i = 0; i < targetLength; i++) {
+            target[i] = nucs[rand() % 4];
+        }
+        std::vector<int> alphabet;
+        sa.LarssonBuildSuffixArray(&target[0], targetLength, alphabet);
+        sa.BuildLookupTable(&target[0], targetLength, 4);
+
+        legacyFileName = "suffixarray_gtest_legacy.sa";
+        mappableFileName = "suffixarray_gtest_mappable.sa";
+        sa.Write(legacyFileName);
+        sa.WriteMappable(mappableFileName);
+    }
+
+    void TearDown() {
+        remove(legacyFileName.c_str());
+        remove(mappableFileName.c_str());
+    }
+
+    void ExpectSameAs(DNASuffixArray &other) {
+        ASSERT_EQ(other.length, sa.length);
+        ASSERT_EQ(other.lookupTableLength, sa.lookupTableLength);
+        EXPECT_EQ(other.lookupPrefixLength, sa.lookupPrefixLength);
+        for (SAIndex i = 0; i < sa.length; i++) {
+            ASSERT_EQ(other.index[i], sa.index[i]);
+        }
+        for (SAIndex i = 0; i < sa.lookupTableLength; i++) {
+            ASSERT_EQ(other.startPosTable[i], sa.startPosTable[i]);
+            ASSERT_EQ(other.endPosTable[i], sa.endPosTable[i]);
+        }
+    }
+
+    std::vector<Nucleotide> target;
+    DNALength targetLength;
+    DNASuffixArray sa;
+    std::string legacyFileName, mappableFileName;
+};
+
+TEST_F(SuffixArrayTest, ReadMappableLayout) {
+    DNASuffixArray copy;
+    EXPECT_TRUE(copy.Read(mappableFileName));
+    EXPECT_TRUE(copy.mappedFile == NULL);
+    ExpectSameAs(copy);
+}
+
+TEST_F(SuffixArrayTest, MapReadMappableLayout) {
+    DNASuffixArray mapped;
+    EXPECT_TRUE(mapped.MapRead(mappableFileName));
+    EXPECT_TRUE(mapped.mappedFile != NULL);
+    EXPECT_EQ((size_t)mapped.index % SuffixArrayMappedAlignment, 
+              (size_t)mapped.mappedFile % SuffixArrayMappedAlignment);
+    ExpectSameAs(mapped);
+}
+
+TEST_F(SuffixArrayTest, MapReadLegacyLayout) {
+    DNASuffixArray mapped;
+    EXPECT_TRUE(mapped.MapRead(legacyFileName));
+    ExpectSameAs(mapped);
+}
+
+TEST_F(SuffixArrayTest, MappedSearchMatchesHeapSearch) {
+    DNASuffixArray mapped;
+    ASSERT_TRUE(mapped.MapRead(mappableFileName));
+    for (DNALength pos = 0; pos + 20 < targetLength; pos += 97) {
+        SAIndex low, high, mappedLow, mappedHigh;
+        sa.Search(&target[0], &target[pos], 20, low, high);
+        mapped.Search(&target[0], &target[pos], 20, mappedLow, mappedHigh);
+        EXPECT_EQ(low, mappedLow);
+        EXPECT_EQ(high, mappedHigh);
+    }
+}
+
+TEST_F(SuffixArrayTest, MapReadRejectsMissingFile) {
+    DNASuffixArray mapped;
+    std::string missing = "/nonexistingdir/nonexistingfile.sa";
+    EXPECT_FALSE(mapped.MapRead(missing));
+    EXPECT_TRUE(mapped.index == NULL);
+}
+
+TEST_F(SuffixArrayTest, MapReadRejectsCorruptSections) {
+    SuffixArrayMappedHeader header;
+    std::ifstream in(mappableFileName.c_str(), std::ios::binary);
+    in.seekg(sizeof(unsigned int));
+    in.read((char*) &header, sizeof(header));
+    in.close();
+
+    SuffixArrayMappedHeader corrupt[4];
+    for (int i = 0; i < 4; i++) { corrupt[i] = header; }
+    corrupt[0].indexOffset = header.fileLength - sizeof(SAIndex);
+    corrupt[1].length = header.fileLength;
+    corrupt[2].endPosTableOffset = header.fileLength;
+    corrupt[3].lookupTableLength = header.lookupTableLength * 4;
+
+    std::string corruptFileName = "suffixarray_gtest_corrupt.sa";
+    for (int i = 0; i < 4; i++) {
+        std::ifstream src(mappableFileName.c_str(), std::ios::binary);
+        std::ofstream dest(corruptFileName.c_str(), std::ios::binary);
+        dest << src.rdbuf();
+        dest.seekp(sizeof(unsigned int));
+        dest.write((char*) &corrupt[i], sizeof(header));
+        dest.close();
+        DNASuffixArray mapped;
+        EXPECT_FALSE(mapped.MapRead(corruptFileName)) << i;
+        EXPECT_TRUE(mapped.index == NULL);
+    }
+    remove(corruptFileName.c_str());
+}
+
+TEST_F(SuffixArrayTest, LargeIndexMatchesDefaultIndex) {
+    LargeDNASuffixArray large;
+    std::vector<int> alphabet;
+    large.LarssonBuildSuffixArray(&target[0], targetLength, alphabet);
+    large.BuildLookupTable(&target[0], targetLength, 4);
+    ASSERT_EQ(large.length, sa.length);
+    for (SAIndex i = 0; i < sa.length; i++) {
+        ASSERT_EQ(large.index[i], sa.index[i]);
+    }
+    for (SAIndex i = 0; i < sa.lookupTableLength; i++) {
+        ASSERT_EQ(large.startPosTable[i], sa.startPosTable[i]);
+        ASSERT_EQ(large.endPosTable[i], sa.endPosTable[i]);
+    }
+}
+
+TEST_F(SuffixArrayTest, LargeIndexReadWrite) {
+    LargeDNASuffixArray large, copy, mapped;
+    std::vector<int> alphabet;
+    large.LarssonBuildSuffixArray(&target[0], targetLength, alphabet);
+    large.BuildLookupTable(&target[0], targetLength, 4);
+    std::string largeFileName = "suffixarray_gtest_large.sa";
+    large.Write(largeFileName);
+
+    EXPECT_TRUE(copy.Read(largeFileName));
+    EXPECT_TRUE(mapped.MapRead(largeFileName));
+    for (SAIndex i = 0; i < sa.length; i++) {
+        ASSERT_EQ(copy.index[i], sa.index[i]);
+        ASSERT_EQ(mapped.index[i], sa.index[i]);
+    }
+    remove(largeFileName.c_str());
+
+    // A 32-bit suffix array may not be loaded into a 64-bit one.
+    LargeDNASuffixArray fromLegacy;
+    EXPECT_FALSE(fromLegacy.Read(legacyFileName));
+    EXPECT_FALSE(fromLegacy.MapRead(mappableFileName));
+}
+
+TEST_F(SuffixArrayTest, ParallelLightweightBuildIsIdentical) {
+    // The difference cover sort reads up to diffCoverSize characters
+    // past the end of the text.
+    int diffCoverSize = 64;
+    std::vector<Nucleotide> paddedTarget(target);
+    paddedTarget.resize(targetLength + diffCoverSize + 1, 0);
+
+    DNASuffixArray serial;
+    serial.LightweightBuildSuffixArray(&paddedTarget[0], targetLength, diffCoverSize, 1);
+    for (SAIndex i = 0; i < sa.length; i++) {
+        ASSERT_EQ(serial.index[i], sa.index[i]);
+    }
+    for (int nProc = 2; nProc <= 5; nProc++) {
+        DNASuffixArray parallel;
+        parallel.LightweightBuildSuffixArray(&paddedTarget[0], targetLength, diffCoverSize, nProc);
+        for (SAIndex i = 0; i < sa.length; i++) {
+            ASSERT_EQ(parallel.index[i], sa.index[i]);
+        }
+    }
+}
+
+TEST_F(SuffixArrayTest, BatchStoreLCPBoundsMatchesStoreLCPBounds) {
+    //
+    // Queries are substrings of the target with a few substitutions
+    // and N's, so that searches end at many different depths.
+    //
+    const char nucs[] = "ACGTN";
+    std::vector<std::vector<Nucleotide> > querySeqs(300);
+    std::vector<Nucleotide*> queries;
+    std::vector<DNALength> queryLengths;
+    for (size_t i = 0; i < querySeqs.size(); i++) {
+        DNALength start = rand() % (targetLength - 60);
+        querySeqs[i].assign(target.begin() + start, target.begin() + start + 60);
+        for (int e = rand() % 3; e > 0; e--) {
+            querySeqs[i][rand() % 60] = nucs[rand() % 5];
+        }
+        queries.push_back(&querySeqs[i][0]);
+        queryLengths.push_back(60 - rand() % 20);
+    }
+
+    for (int useLookupTable = 0; useLookupTable < 2; useLookupTable++) {
+        for (int stopOnceUnique = 0; stopOnceUnique < 2; stopOnceUnique++) {
+            int maxMatchLength = stopOnceUnique ? 0 : 12;
+            std::vector<std::vector<SAIndex> > lowBounds, highBounds;
+            std::vector<DNALength> lcpLengths;
+            sa.BatchStoreLCPBounds(&target[0], targetLength, queries, queryLengths,
+                    useLookupTable, maxMatchLength, lowBounds, highBounds,
+                    lcpLengths, stopOnceUnique, 7);
+            ASSERT_EQ(lcpLengths.size(), queries.size());
+            for (size_t i = 0; i < queries.size(); i++) {
+                std::vector<SAIndex> low, high;
+                DNALength lcpLength = sa.StoreLCPBounds(&target[0], targetLength,
+                        queries[i], queryLengths[i], useLookupTable,
+                        maxMatchLength, low, high, stopOnceUnique);
+                EXPECT_EQ(lcpLength, lcpLengths[i]);
+                EXPECT_EQ(low, lowBounds[i]);
+                EXPECT_EQ(high, highBounds[i]);
+            }
+        }
+    }
+}
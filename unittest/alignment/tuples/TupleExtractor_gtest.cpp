@@ -0,0 +1,161 @@
+/*
+ * ============================================================================
+ *
+ *       Filename:  TupleExtractor_gtest.cpp
+ *
+ *    Description:  Test alignment/tuples/TupleExtractor.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "tuples/DNATuple.hpp"
+#include "tuples/TupleExtractor.hpp"
+
+using namespace std;
+
+//
+// Random bases in either case, with runs of N.
+//
+static string MakeSequence(int length) {
+    string seq;
+    while ((int) seq.size() < length) {
+        if (rand() % 50 == 0) {
+            seq.append(rand() % 5 + 1, 'N');
+        }
+        else {
+            seq.push_back("ACGTacgt"[rand() % 8]);
+        }
+    }
+    return seq;
+}
+
+static void ExtractAll(TupleExtractor &extractor, DNASequence &seq,
+                       DNALength bufferLength, vector<ULong> &tuples,
+                       vector<DNALength> &positions) {
+    vector<ULong> tupleBuffer(bufferLength);
+    vector<DNALength> positionBuffer(bufferLength);
+    extractor.SetSequence(seq.seq, seq.length);
+    DNALength nTuples;
+    while ((nTuples = extractor.Next(&tupleBuffer[0], &positionBuffer[0], bufferLength)) > 0) {
+        tuples.insert(tuples.end(), tupleBuffer.begin(), tupleBuffer.begin() + nTuples);
+        positions.insert(positions.end(), positionBuffer.begin(), positionBuffer.begin() + nTuples);
+    }
+}
+
+TEST(TupleExtractorTest, MatchesDNATuple) {
+    srand(1);
+    DNASequence seq;
+    seq.Copy(MakeSequence(3000));
+    int tupleSizes[] = {1, 5, 12, 16, 31};
+    DNALength bufferLengths[] = {1, 7, TupleExtractor::BufferLength};
+
+    for (int k = 0; k < 5; k++) {
+        TupleMetrics tm;
+        tm.Initialize(tupleSizes[k]);
+        vector<ULong> expectedLR, expectedRL, expectedCanonical;
+        vector<DNALength> expectedPositions;
+        DNATuple tuple, rc;
+        for (DNALength s = 0; s + tm.tupleSize <= seq.length; s++) {
+            if (tuple.FromStringLR(&seq.seq[s], tm)) {
+                expectedLR.push_back(tuple.tuple);
+                tuple.MakeRC(rc, tm);
+                expectedCanonical.push_back(min(tuple.tuple, rc.tuple));
+                tuple.FromStringRL(&seq.seq[s], tm);
+                expectedRL.push_back(tuple.tuple);
+                expectedPositions.push_back(s);
+            }
+        }
+
+        for (int b = 0; b < 3; b++) {
+            TupleExtractor extractor;
+            vector<ULong> tuples;
+            vector<DNALength> positions;
+
+            extractor.Initialize(tm, TupleExtractor::LeftToRight);
+            ExtractAll(extractor, seq, bufferLengths[b], tuples, positions);
+            ASSERT_EQ(expectedLR, tuples) << tm.tupleSize;
+            ASSERT_EQ(expectedPositions, positions) << tm.tupleSize;
+
+            tuples.clear(); positions.clear();
+            extractor.Initialize(tm, TupleExtractor::RightToLeft);
+            ExtractAll(extractor, seq, bufferLengths[b], tuples, positions);
+            ASSERT_EQ(expectedRL, tuples) << tm.tupleSize;
+            ASSERT_EQ(expectedPositions, positions) << tm.tupleSize;
+
+            tuples.clear(); positions.clear();
+            extractor.Initialize(tm, TupleExtractor::Canonical);
+            ExtractAll(extractor, seq, bufferLengths[b], tuples, positions);
+            ASSERT_EQ(expectedCanonical, tuples) << tm.tupleSize;
+            ASSERT_EQ(expectedPositions, positions) << tm.tupleSize;
+        }
+    }
+}
+
+//
+// Bytes other than A, C, G or T in either case, including those that
+// differ from them in another bit and the codes 0 to 3, are read as
+// DNATuple reads them wherever they fall in a block of sixteen.
+//
+TEST(TupleExtractorTest, MatchesDNATupleOnOtherBytes) {
+    srand(5);
+    const unsigned char others[] = {0, 1, 2, 3, 4, 'N', 'n', '$', 'R', 'U',
+        'A' ^ 0x80, 'C' ^ 0x20 ^ 0x80, 'G' - 0x40, 'T' + 0x10, 0xff};
+    string bases = MakeSequence(2000);
+    for (size_t i = 0; i < bases.size(); i++) {
+        if (rand() % 40 == 0) {
+            bases[i] = others[rand() % sizeof(others)];
+        }
+    }
+    DNASequence seq;
+    seq.Copy(bases);
+    TupleMetrics tm;
+    tm.Initialize(8);
+    vector<ULong> expected;
+    vector<DNALength> expectedPositions;
+    DNATuple tuple;
+    for (DNALength s = 0; s + tm.tupleSize <= seq.length; s++) {
+        if (tuple.FromStringLR(&seq.seq[s], tm)) {
+            expected.push_back(tuple.tuple);
+            expectedPositions.push_back(s);
+        }
+    }
+    TupleExtractor extractor;
+    extractor.Initialize(tm, TupleExtractor::LeftToRight);
+    vector<ULong> tuples;
+    vector<DNALength> positions;
+    ExtractAll(extractor, seq, TupleExtractor::BufferLength, tuples, positions);
+    EXPECT_EQ(expected, tuples);
+    EXPECT_EQ(expectedPositions, positions);
+}
+
+TEST(TupleExtractorTest, SequenceToTupleList) {
+    DNASequence seq;
+    seq.Copy("ACGTNACGTTGCANNACGTT");
+    TupleMetrics tm;
+    tm.Initialize(4);
+    TupleList<PositionDNATuple> tupleList;
+    SequenceToTupleList(seq, tm, tupleList);
+    DNALength expectedPositions[] = {0, 5, 6, 7, 8, 9, 15, 16};
+    ASSERT_EQ(8, tupleList.size());
+    for (int i = 0; i < 8; i++) {
+        PositionDNATuple tuple;
+        tuple.FromStringRL(&seq.seq[expectedPositions[i]], tm);
+        EXPECT_EQ(tuple.tuple, tupleList[i].tuple);
+        EXPECT_EQ(expectedPositions[i], tupleList[i].pos);
+    }
+
+    DNATuple query;
+    query.FromStringRL((Nucleotide*) "TTGC", tm);
+    EXPECT_EQ(1, SearchSequenceForTuple(seq, tm, query));
+    query.FromStringRL((Nucleotide*) "GGGG", tm);
+    EXPECT_EQ(0, SearchSequenceForTuple(seq, tm, query));
+}
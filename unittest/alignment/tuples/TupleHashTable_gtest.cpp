@@ -0,0 +1,136 @@
+/*
+ * ============================================================================
+ *
+ *       Filename:  TupleHashTable_gtest.cpp
+ *
+ *    Description:  Test alignment/tuples/TupleHashTable.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ============================================================================
+ */
+
+#include <stdlib.h>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "DNASequence.hpp"
+#include "tuples/DNATuple.hpp"
+#include "tuples/TupleCountTable.hpp"
+#include "tuples/TupleHashTable.hpp"
+#include "tuples/TupleMatching.hpp"
+
+using namespace std;
+
+//
+// A sequence of randomly chosen blocks, so that its tuples repeat, with
+// an occasional N.
+//
+static string MakeRepetitiveSequence(int nBlocks, int blockLength) {
+    vector<string> blocks(20);
+    for (size_t b = 0; b < blocks.size(); b++) {
+        for (int i = 0; i < blockLength; i++) {
+            blocks[b].push_back("ACGT"[rand() % 4]);
+        }
+    }
+    string seq;
+    for (int b = 0; b < nBlocks; b++) {
+        seq += blocks[rand() % blocks.size()];
+        if (rand() % 10 == 0) {
+            seq.push_back('N');
+        }
+    }
+    return seq;
+}
+
+TEST(TupleHashTableTest, IndexMatchesTuplePositions) {
+    srand(1);
+    DNASequence seq;
+    seq.Copy(MakeRepetitiveSequence(500, 40));
+    TupleMetrics tm;
+    tm.Initialize(16);
+
+    map<ULong, vector<DNALength> > expected;
+    PositionDNATuple tuple;
+    for (DNALength s = 0; s + tm.tupleSize <= seq.length; s++) {
+        if (tuple.FromStringRL(&seq.seq[s], tm)) {
+            expected[tuple.tuple].push_back(s);
+        }
+    }
+
+    for (int nThreads = 1; nThreads <= 3; nThreads += 2) {
+        TupleHashTable<PositionDNATuple> table;
+        SequenceToTupleHashTable(seq, tm, table, nThreads);
+        ASSERT_EQ(expected.size(), table.GetNumDistinctTuples());
+
+        map<ULong, vector<DNALength> >::iterator it;
+        for (it = expected.begin(); it != expected.end(); ++it) {
+            tuple.tuple = it->first;
+            ASSERT_EQ(it->second.size(), table.GetCount(tuple));
+            vector<PositionDNATuple>::const_iterator curIt, endIt;
+            table.FindAll(tuple, curIt, endIt);
+            vector<DNALength> found;
+            for (; curIt != endIt; ++curIt) {
+                ASSERT_EQ(it->first, curIt->tuple);
+                found.push_back(curIt->pos);
+            }
+            ASSERT_EQ(it->second, found);
+        }
+
+        tuple.FromStringRL((Nucleotide*) "TTTTTTTTTTTTTTTT", tm);
+        vector<PositionDNATuple>::const_iterator curIt, endIt;
+        table.FindAll(tuple, curIt, endIt);
+        EXPECT_TRUE(curIt == endIt);
+        EXPECT_EQ(0, table.GetCount(tuple));
+    }
+}
+
+TEST(TupleHashTableTest, HashedCountTable) {
+    srand(2);
+    DNASequence seq;
+    seq.Copy(MakeRepetitiveSequence(400, 35));
+    TupleMetrics tm;
+    tm.Initialize(20);
+
+    TupleCountTable<DNASequence, DNATuple> serial, threaded;
+    serial.InitCountTable(tm, seq.length);
+    threaded.InitCountTable(tm, seq.length);
+    ASSERT_TRUE(serial.hashed);
+    serial.AddSequenceTupleCountsLR(seq);
+    threaded.AddSequenceTupleCountsLR(seq, 4);
+    EXPECT_EQ(serial.nTuples, threaded.nTuples);
+
+    map<ULong, int> expected;
+    int nTuples = 0;
+    DNATuple tuple;
+    for (DNALength s = 0; s + tm.tupleSize <= seq.length; s++) {
+        if (tuple.FromStringLR(&seq.seq[s], tm)) {
+            expected[tuple.tuple]++;
+            nTuples++;
+        }
+    }
+    EXPECT_EQ(nTuples, serial.nTuples);
+
+    string fileName = "TupleHashTable_gtest.ctab";
+    ofstream out(fileName.c_str(), ios::binary);
+    threaded.Write(out);
+    out.close();
+    TupleCountTable<DNASequence, DNATuple> readBack;
+    ifstream in(fileName.c_str(), ios::binary);
+    readBack.Read(in);
+    in.close();
+    remove(fileName.c_str());
+    ASSERT_TRUE(readBack.hashed);
+    EXPECT_EQ(nTuples, readBack.nTuples);
+
+    map<ULong, int>::iterator it;
+    for (it = expected.begin(); it != expected.end(); ++it) {
+        tuple.tuple = it->first;
+        ASSERT_EQ(it->second, serial.GetCount(tuple));
+        ASSERT_EQ(it->second, threaded.GetCount(tuple));
+        ASSERT_EQ(it->second, readBack.GetCount(tuple));
+    }
+}
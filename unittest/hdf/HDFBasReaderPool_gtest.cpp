@@ -0,0 +1,76 @@
+/*
+ * ============================================================================
+ *
+ *       Filename:  HDFBasReaderPool_gtest.cpp
+ *
+ *    Description:  Test hdf/HDFBasReaderPool.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ============================================================================
+ */
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "HDFBasReaderPool.hpp"
+#include "pbdata/testdata.h"
+
+using namespace std;
+
+class PoolReadThread {
+public:
+    HDFBasReaderPool *pool;
+    int first, step, nReads;
+    vector<string> names;
+    vector<string> bases;
+};
+
+static void *ReadFromPool(void *threadPtr) {
+    PoolReadThread *thread = (PoolReadThread*) threadPtr;
+    SMRTSequence read;
+    for (int i = thread->first; i < thread->nReads; i += thread->step) {
+        thread->pool->GetReadAt(i, read);
+        thread->names.push_back(read.GetName());
+        thread->bases.push_back(string((char*) read.seq, read.length));
+    }
+    return NULL;
+}
+
+TEST(HDFBasReaderPoolTEST, ReadFromThreads) {
+    string fileName = baxFile3;
+    HDFBasReaderPool pool;
+    ASSERT_EQ(pool.Initialize(fileName, 3), 1);
+
+    T_HDFBasReader<SMRTSequence> reader;
+    reader.InitializeDefaultIncludedFields();
+    ASSERT_EQ(reader.Initialize(fileName), 1);
+    ASSERT_EQ(pool.GetNumReads(), reader.GetNumReads());
+
+    const int nThreads = 4;
+    int nReads = min(pool.GetNumReads(), 400);
+    PoolReadThread threads[nThreads];
+    pthread_t threadIds[nThreads];
+    for (int t = 0; t < nThreads; t++) {
+        threads[t].pool   = &pool;
+        threads[t].first  = t;
+        threads[t].step   = nThreads;
+        threads[t].nReads = nReads;
+        pthread_create(&threadIds[t], NULL, ReadFromPool, &threads[t]);
+    }
+    for (int t = 0; t < nThreads; t++) {
+        pthread_join(threadIds[t], NULL);
+    }
+
+    SMRTSequence read;
+    for (int i = 0; i < nReads; i++) {
+        reader.GetReadAt(i, read);
+        PoolReadThread &thread = threads[i % nThreads];
+        ASSERT_EQ(read.GetName(), thread.names[i / nThreads]);
+        ASSERT_EQ(string((char*) read.seq, read.length), thread.bases[i / nThreads]);
+    }
+    reader.Close();
+    pool.Close();
+}
@@ -54,3 +54,55 @@ TEST_F(HDFBasReaderTEST, GetChemistryTriple) {
     EXPECT_EQ(sequencingKit, "100356200");
     EXPECT_EQ(version, "2.3");
 }
+
+TEST_F(HDFBasReaderTEST, ReadAhead) {
+    T_HDFBasReader<SMRTSequence> aheadReader;
+    aheadReader.InitializeDefaultIncludedFields();
+    ASSERT_EQ(aheadReader.Initialize(fileName), 1);
+    aheadReader.SetReadAhead(7);
+#ifndef H5_HAVE_THREADSAFE
+    EXPECT_EQ(aheadReader.readAheadZMWs, 0);
+#endif
+
+    SMRTSequence seq, aheadSeq;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(reader.GetNext(seq), aheadReader.GetNext(aheadSeq));
+        ASSERT_EQ(seq.GetName(), aheadSeq.GetName());
+        ASSERT_EQ(seq.length, aheadSeq.length);
+        ASSERT_EQ(seq.HoleNumber(), aheadSeq.HoleNumber());
+        ASSERT_EQ(seq.zmwData.x, aheadSeq.zmwData.x);
+        ASSERT_EQ(seq.zmwData.y, aheadSeq.zmwData.y);
+        ASSERT_EQ(seq.readScore, aheadSeq.readScore);
+        //
+        // Fields missing from the file are not included, and are not
+        // read by either reader.
+        //
+        for (DNALength j = 0; j < seq.length; j++) {
+            ASSERT_EQ(seq.seq[j], aheadSeq.seq[j]);
+            if (reader.includedFields["QualityValue"]) {
+                ASSERT_EQ(seq.qual[j], aheadSeq.qual[j]);
+            }
+            if (reader.includedFields["InsertionQV"]) {
+                ASSERT_EQ(seq.insertionQV[j], aheadSeq.insertionQV[j]);
+            }
+            if (reader.includedFields["DeletionTag"]) {
+                ASSERT_EQ(seq.deletionTag[j], aheadSeq.deletionTag[j]);
+            }
+            if (reader.includedFields["PreBaseFrames"]) {
+                ASSERT_EQ(seq.preBaseFrames[j], aheadSeq.preBaseFrames[j]);
+            }
+            if (reader.includedFields["PulseIndex"]) {
+                ASSERT_EQ(seq.pulseIndex[j], aheadSeq.pulseIndex[j]);
+            }
+        }
+    }
+
+    //
+    // Jumping restarts reading ahead at the new read.
+    //
+    ASSERT_EQ(reader.GetReadAt(3, seq), aheadReader.GetReadAt(3, aheadSeq));
+    EXPECT_EQ(seq.GetName(), aheadSeq.GetName());
+    ASSERT_EQ(reader.GetNext(seq), aheadReader.GetNext(aheadSeq));
+    EXPECT_EQ(seq.GetName(), aheadSeq.GetName());
+    aheadReader.Close();
+}
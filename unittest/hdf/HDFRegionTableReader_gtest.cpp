@@ -0,0 +1,85 @@
+/*
+ * ==========================================================================
+ *
+ *       Filename:  HDFRegionTableReader_gtest.cpp
+ *
+ *    Description:  Test hdf/HDFRegionTableReader.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ==========================================================================
+ */
+#include "HDFRegionTableReader.hpp"
+#include "gtest/gtest.h"
+#include "pbdata/testdata.h"
+
+using namespace std;
+
+class HDFRegionTableReaderTEST : public ::testing::Test {
+public:
+    virtual void SetUp() {
+        fileName = baxFile2;
+        HDFRegionTableReader reader;
+        ASSERT_EQ(reader.Initialize(fileName), 1);
+        RegionAnnotation annotation;
+        while (reader.GetNext(annotation)) {
+            rows.push_back(annotation);
+        }
+        reader.Close();
+        ASSERT_GT(rows.size(), (size_t) 0);
+    }
+    virtual void TearDown() {
+    }
+
+    string fileName;
+    vector<RegionAnnotation> rows;
+};
+
+TEST_F(HDFRegionTableReaderTEST, ReadTableMatchesRows) {
+    HDFRegionTableReader reader;
+    ASSERT_EQ(reader.Initialize(fileName), 1);
+    RegionTable table;
+    reader.ReadTable(table);
+    reader.Close();
+
+    EXPECT_EQ(table.columnNames.size(), (size_t) RegionAnnotation::NCOLS);
+    EXPECT_EQ(table.regionTypes.size(), table.regionTypeEnums.size());
+    ASSERT_EQ(table.NumRegions(), (int) rows.size());
+    //
+    // The Regions dataset is grouped by hole number, so the hyperslab
+    // read keeps the row order.
+    //
+    vector<RegionAnnotation> annotations = table.GetAnnotations();
+    for (size_t i = 0; i < rows.size(); i++) {
+        for (int c = 0; c < RegionAnnotation::NCOLS; c++) {
+            ASSERT_EQ(annotations[i].row[c], rows[i].row[c]);
+        }
+    }
+
+    EXPECT_TRUE(table.HoleNumbersAreIndexed());
+    int low, high;
+    for (size_t i = 0; i < rows.size(); i++) {
+        ASSERT_GT(table.LookupRegionsByHoleNumber(rows[i].GetHoleNumber(),
+                                                  low, high), 0);
+        EXPECT_LE(low, (int) i);
+        EXPECT_GT(high, (int) i);
+    }
+}
+
+TEST_F(HDFRegionTableReaderTEST, GetMinMaxHoleNumber) {
+    UInt expectedMin = rows[0].GetHoleNumber();
+    UInt expectedMax = expectedMin;
+    for (size_t i = 1; i < rows.size(); i++) {
+        expectedMin = min(expectedMin, (UInt) rows[i].GetHoleNumber());
+        expectedMax = max(expectedMax, (UInt) rows[i].GetHoleNumber());
+    }
+
+    HDFRegionTableReader reader;
+    ASSERT_EQ(reader.Initialize(fileName), 1);
+    UInt minHole, maxHole;
+    reader.GetMinMaxHoleNumber(minHole, maxHole);
+    reader.Close();
+    EXPECT_EQ(minHole, expectedMin);
+    EXPECT_EQ(maxHole, expectedMax);
+}
@@ -16,9 +16,13 @@
  * =====================================================================================
  */
 
+#include <stdio.h>
+#include <fstream>
 #include "gtest/gtest.h"
 #include "FASTAReader.hpp"
+#include "StringUtils.hpp"
 #include "pbdata/testdata.h"
+#include "TestUtils.hpp"
 
 class FASTAReaderTest:public::testing::Test{
 public:
@@ -63,3 +67,106 @@ TEST_F(FASTAReaderTest, ReadAllSequences) {
     EXPECT_EQ(strcmp((char*)seqs[11].seq, expected_seq.c_str()), 0);
 }
 
+
+//
+// Records with titles at the end of the file and between blank lines,
+// lines of different lengths, and an empty record.
+//
+TEST(FASTAReaderIntoOneTest, ReadAllSequencesIntoOne) {
+    string fileName = "FASTAReader_gtest_into_one.fasta";
+    ofstream out(fileName.c_str());
+    out << ">chr1 first\nACGTa\ncgt\n\n>chr2\r\nGG TT\n>empty\n>chr4\nttttt\ntt";
+    out.close();
+    string expected = "ACGTACGTNGGTTNNTTTTTTTN";
+    string names[] = {"chr1 first", "chr2\r", "empty", "chr4"};
+
+    for (int nThreads = 1; nThreads <= 3; nThreads += 2) {
+        FASTAReader reader;
+        reader.Initialize(fileName);
+        reader.SetToUpper();
+        reader.SetNumThreads(nThreads);
+        reader.computeMD5 = true;
+        FASTASequence seq;
+        SequenceIndexDatabase<FASTASequence> seqdb;
+        EXPECT_EQ(expected.size(), reader.ReadAllSequencesIntoOne(seq, &seqdb));
+        ASSERT_EQ(expected, string((char*) seq.seq, seq.length));
+        EXPECT_EQ(0, strcmp(seq.title, "chr1 first"));
+        ASSERT_EQ(5, seqdb.nSeqPos);
+        for (int i = 0; i < 4; i++) {
+            EXPECT_EQ(names[i], string(seqdb.names[i]));
+        }
+        EXPECT_EQ(8, seqdb.GetLengthOfSeq(0));
+        EXPECT_EQ(4, seqdb.GetLengthOfSeq(1));
+        EXPECT_EQ(0, seqdb.GetLengthOfSeq(2));
+        EXPECT_EQ(7, seqdb.GetLengthOfSeq(3));
+        string md5;
+        string bases = "GGTT";
+        MakeMD5(bases, md5);
+        ASSERT_EQ(4, seqdb.md5.size());
+        EXPECT_EQ(md5, seqdb.md5[1]);
+        reader.Close();
+
+        FASTAReader wideReader;
+        wideReader.Initialize(fileName);
+        wideReader.SetToUpper();
+        wideReader.SetNumThreads(nThreads);
+        Nucleotide *wideSeq;
+        uint64_t wideLength;
+        SequenceIndexDatabase<FASTASequence, uint64_t> wideSeqdb;
+        wideReader.ReadAllSequencesIntoOne(wideSeq, wideLength, &wideSeqdb);
+        EXPECT_EQ(expected, string((char*) wideSeq, wideLength));
+        ASSERT_EQ(5, wideSeqdb.nSeqPos);
+        EXPECT_EQ(15, wideSeqdb.seqStartPos[3]);
+        delete[] wideSeq;
+        wideReader.Close();
+    }
+    remove(fileName.c_str());
+}
+
+//
+// Reads with pieces of a few bytes, so that each record is split
+// across the threads, and pieces end within lines and line breaks.
+//
+class SmallPieceFASTAReader : public FASTAReader {
+public:
+    SmallPieceFASTAReader(long pieceSizeP) {
+        pieceSize = pieceSizeP;
+    }
+};
+
+TEST(FASTAReaderIntoOneTest, RecordSpansPieces) {
+    string fileName = "FASTAReader_gtest_pieces.fasta";
+    string records[] = {RandomSequence(1000), RandomSequence(1), RandomSequence(333)};
+    ofstream out(fileName.c_str());
+    string expected;
+    for (int r = 0; r < 3; r++) {
+        out << ">rec" << r << "\r\n";
+        for (size_t i = 0; i < records[r].size(); i += 60) {
+            out << records[r].substr(i, 60) << "\r\n";
+        }
+        expected += records[r] + "N";
+    }
+    out.close();
+
+    long pieceSizes[] = {1, 7, 64};
+    for (int s = 0; s < 3; s++) {
+        SmallPieceFASTAReader reader(pieceSizes[s]);
+        reader.Initialize(fileName);
+        reader.SetNumThreads(4);
+        reader.computeMD5 = true;
+        FASTASequence seq;
+        SequenceIndexDatabase<FASTASequence> seqdb;
+        EXPECT_EQ(expected.size(), reader.ReadAllSequencesIntoOne(seq, &seqdb));
+        ASSERT_EQ(expected, string((char*) seq.seq, seq.length));
+        ASSERT_EQ(4, seqdb.nSeqPos);
+        ASSERT_EQ(3, seqdb.md5.size());
+        for (int r = 0; r < 3; r++) {
+            EXPECT_EQ(records[r].size(), seqdb.GetLengthOfSeq(r));
+            string md5;
+            MakeMD5(records[r], md5);
+            EXPECT_EQ(md5, seqdb.md5[r]);
+        }
+        reader.Close();
+    }
+    remove(fileName.c_str());
+}
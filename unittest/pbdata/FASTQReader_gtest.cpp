@@ -18,6 +18,9 @@
 
 
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <fstream>
 #include "gtest/gtest.h"
 #include "FASTQReader.hpp"
 #include "pbdata/testdata.h"
@@ -88,3 +91,53 @@ TEST_F(FASTQReaderTest, GetNext) {
     EXPECT_FALSE(reader.GetNext(seq));
 }
 
+
+TEST(FASTQReaderBlockTest, GetNextBlock) {
+    srand(1);
+    string fileName = "FASTQReader_gtest.fastq";
+    ofstream out(fileName.c_str());
+    int nRecords = 300;
+    for (int r = 0; r < nRecords; r++) {
+        out << "@read/" << r << "\n";
+        int length = rand() % 200;
+        string bases, quals;
+        for (int i = 0; i < length; i++) {
+            bases.push_back("ACGTN"[rand() % 5]);
+            quals.push_back('!' + rand() % 60);
+        }
+        out << bases << "\n+\n" << quals << "\n";
+    }
+    out.close();
+
+    int maxRecords[] = {1, 7, 4096};
+    for (int nThreads = 1; nThreads <= 3; nThreads += 2) {
+        for (int m = 0; m < 3; m++) {
+            FASTQReader serialReader, blockReader;
+            serialReader.Initialize(fileName);
+            blockReader.Initialize(fileName);
+            blockReader.SetNumThreads(nThreads);
+            FASTQBlock block;
+            FASTQSequence expected, seq;
+            int nRead = 0;
+            while (blockReader.GetNextBlock(block, maxRecords[m]) > 0) {
+                ASSERT_LE(block.size(), maxRecords[m]);
+                for (int i = 0; i < block.size(); i++) {
+                    ASSERT_TRUE(serialReader.GetNext(expected));
+                    block.GetRecord(i, seq);
+                    ASSERT_STREQ(expected.title, seq.title);
+                    ASSERT_EQ(expected.length, seq.length);
+                    for (DNALength j = 0; j < seq.length; j++) {
+                        ASSERT_EQ(expected.seq[j], seq.seq[j]);
+                        ASSERT_EQ(expected.qual[j], seq.qual[j]);
+                    }
+                    nRead++;
+                }
+            }
+            EXPECT_EQ(nRecords, nRead);
+            EXPECT_FALSE(serialReader.GetNext(expected));
+            serialReader.Close();
+            blockReader.Close();
+        }
+    }
+    remove(fileName.c_str());
+}
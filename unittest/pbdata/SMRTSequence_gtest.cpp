@@ -60,3 +60,27 @@ TEST_F(SMRTSequenceTest, GetDeletionQV) {
 }
 
 
+
+TEST_F(SMRTSequenceTest, CopyConstructor) {
+    SMRTSequence src;
+    src.Allocate(10);
+    for (int i = 0; i < 10; i++) {
+        src.seq[i] = 'A';
+        src.preBaseFrames[i] = i;
+        src.widthInFrames[i] = i;
+        src.pulseIndex[i] = i;
+    }
+    src.holeNumber = 7;
+
+    std::vector<SMRTSequence> reads;
+    for (int i = 0; i < 50; i++) {
+        reads.push_back(src);
+    }
+    for (int i = 0; i < 50; i++) {
+        ASSERT_NE(reads[i].seq, src.seq);
+        ASSERT_NE(reads[i].preBaseFrames, src.preBaseFrames);
+        EXPECT_EQ(reads[i].preBaseFrames[3], 3);
+        EXPECT_EQ(reads[i].HoleNumber(), 7);
+    }
+    src.Free();
+}
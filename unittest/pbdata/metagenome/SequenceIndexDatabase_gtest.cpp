@@ -0,0 +1,132 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SequenceIndexDatabase_gtest.cpp
+ *
+ *    Description:  Test pbdata/metagenome/SequenceIndexDatabase.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "gtest/gtest.h"
+#include "FASTASequence.hpp"
+#include "metagenome/SequenceIndexDatabase.hpp"
+
+using namespace std;
+
+//
+// The index SearchForIndex has always returned: the number of sequence
+// starts after the first that are at or before pos.
+//
+static int BinarySearchForIndex(vector<DNALength> &starts, DNALength pos) {
+    if (starts.size() == 1) {
+        return 0;
+    }
+    return upper_bound(starts.begin() + 1, starts.end(), pos) - starts.begin() - 1;
+}
+
+class SequenceIndexDatabaseTest : public ::testing::Test {
+public:
+    void AddSequences(int nSeq, int maxLength) {
+        for (int i = 0; i < nSeq; i++) {
+            FASTASequence seq;
+            stringstream title;
+            title << "contig" << i;
+            seq.CopyTitle(title.str());
+            //
+            // Only the length is indexed.  Mostly short contigs, with an
+            // occasional long one, so that buckets hold different
+            // numbers of boundaries.
+            //
+            seq.length = (rand() % 10 == 0) ? rand() % (maxLength * 50) : rand() % maxLength;
+            db.AddSequence(seq);
+            seq.length = 0;
+        }
+        db.Finalize();
+        starts.assign(db.seqStartPos, db.seqStartPos + db.nSeqPos);
+    }
+
+    void ExpectSameIndices() {
+        DNALength end = starts.back() + 100;
+        vector<DNALength> positions;
+        for (int i = 0; i < 20000; i++) {
+            positions.push_back(rand() % end);
+        }
+        for (size_t i = 0; i < starts.size(); i++) {
+            positions.push_back(starts[i]);
+            if (starts[i] > 0) {
+                positions.push_back(starts[i] - 1);
+            }
+        }
+        for (size_t i = 0; i < positions.size(); i++) {
+            ASSERT_EQ(BinarySearchForIndex(starts, positions[i]),
+                      db.SearchForIndex(positions[i])) << positions[i];
+            ASSERT_EQ(BinarySearchForIndex(starts, positions[i]),
+                      db.SearchForIndex(positions[i], rand() % db.nSeqPos)) << positions[i];
+        }
+
+        sort(positions.begin(), positions.end());
+        vector<int> indices;
+        db.SearchForIndices(positions, indices);
+        ASSERT_EQ(positions.size(), indices.size());
+        SeqBoundaryFtr<FASTASequence> boundary(&db);
+        for (size_t i = 0; i < positions.size(); i++) {
+            int index = BinarySearchForIndex(starts, positions[i]);
+            ASSERT_EQ(index, indices[i]) << positions[i];
+            ASSERT_EQ(index, boundary.GetIndex(positions[i]));
+            ASSERT_EQ(starts[index], boundary(positions[i]));
+            if (index + 1 < (int) starts.size()) {
+                ASSERT_EQ(starts[index + 1] - starts[index], boundary.Length(positions[i]));
+            }
+        }
+    }
+
+    SequenceIndexDatabase<FASTASequence> db;
+    vector<DNALength> starts;
+};
+
+TEST_F(SequenceIndexDatabaseTest, LookupMatchesBinarySearch) {
+    srand(3);
+    AddSequences(5000, 200);
+    EXPECT_GT(db.seqIndexLookup.size(), 0);
+    EXPECT_LE(db.seqIndexLookup.size(), 2 * db.nSeqPos + 1);
+    ExpectSameIndices();
+}
+
+TEST_F(SequenceIndexDatabaseTest, FewSequences) {
+    srand(4);
+    AddSequences(1, 1000);
+    ExpectSameIndices();
+    EXPECT_EQ(db.SearchForStartBoundary(0), 0);
+}
+
+TEST_F(SequenceIndexDatabaseTest, ReadDatabaseBuildsLookup) {
+    srand(5);
+    AddSequences(300, 50);
+    stringstream path;
+    path << "/tmp/SequenceIndexDatabase_gtest." << getpid();
+    ofstream out(path.str().c_str(), ios::binary);
+    db.WriteDatabase(out);
+    out.close();
+
+    SequenceIndexDatabase<FASTASequence> readDB;
+    ifstream in(path.str().c_str(), ios::binary);
+    readDB.ReadDatabase(in);
+    in.close();
+    remove(path.str().c_str());
+    EXPECT_EQ(db.seqIndexLookup, readDB.seqIndexLookup);
+    EXPECT_EQ(db.seqIndexLookupShift, readDB.seqIndexLookupShift);
+    for (size_t i = 0; i < starts.size(); i++) {
+        EXPECT_EQ(db.SearchForIndex(starts[i]), readDB.SearchForIndex(starts[i]));
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * ==================================================================
+ *
+ *       Filename:  RegionTable_gtest.cpp
+ *
+ *    Description:  Test pbdata/reads/RegionTable.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * ==================================================================
+ */
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "reads/RegionTable.hpp"
+
+using namespace std;
+
+//
+// Add regions for some of the holes in [0, nHoles) * holeSpacing, in
+// the order of a bax file: inserts, adapters, then the HQ region.
+//
+static void MakeTable(RegionTable &table, int nHoles, int holeSpacing) {
+    table.Reset();
+    table.CreateDefaultAttributes();
+    for (int h = 0; h < nHoles; h++) {
+        if (rand() % 4 == 0) {
+            continue;
+        }
+        int holeNumber = h * holeSpacing;
+        int nInserts = rand() % 4;
+        for (int i = 0; i < nInserts; i++) {
+            table.Append(RegionAnnotation(holeNumber, 1, 300 * i, 300 * i + 250, -1));
+        }
+        for (int i = 0; i + 1 < nInserts; i++) {
+            table.Append(RegionAnnotation(holeNumber, 0, 300 * i + 250, 300 * i + 300, 700));
+        }
+        table.Append(RegionAnnotation(holeNumber, 2, 0, 300 * nInserts, 800));
+    }
+}
+
+static void ExpectSameLookups(RegionTable &table, int maxHoleNumber) {
+    const vector<int> &holeNumbers = table.columns[RegionAnnotation::HOLENUMBERCOL];
+    for (int holeNumber = -2; holeNumber < maxHoleNumber + 2; holeNumber++) {
+        int low, high;
+        int n = table.LookupRegionsByHoleNumber(holeNumber, low, high);
+        int expectedLow  = lower_bound(holeNumbers.begin(), holeNumbers.end(), holeNumber) - holeNumbers.begin();
+        int expectedHigh = upper_bound(holeNumbers.begin(), holeNumbers.end(), holeNumber) - holeNumbers.begin();
+        ASSERT_EQ(expectedHigh - expectedLow, n) << holeNumber;
+        if (n > 0) {
+            ASSERT_EQ(expectedLow, low) << holeNumber;
+            ASSERT_EQ(expectedHigh, high) << holeNumber;
+        }
+    }
+}
+
+TEST(RegionTableTest, DenseHoleIndex) {
+    srand(1);
+    RegionTable table;
+    MakeTable(table, 500, 1);
+    table.IndexHoleNumbers();
+    ASSERT_TRUE(table.HoleNumbersAreIndexed());
+    EXPECT_TRUE(table.indexedHoleNumbers.empty());
+    ExpectSameLookups(table, 500);
+}
+
+TEST(RegionTableTest, SparseHoleIndex) {
+    srand(2);
+    RegionTable table;
+    MakeTable(table, 500, 1000);
+    table.IndexHoleNumbers();
+    ASSERT_TRUE(table.HoleNumbersAreIndexed());
+    EXPECT_FALSE(table.indexedHoleNumbers.empty());
+    ExpectSameLookups(table, 500 * 1000);
+}
+
+TEST(RegionTableTest, IndexSortsByHoleNumber) {
+    RegionTable table;
+    table.CreateDefaultAttributes();
+    table.Append(RegionAnnotation(7, 1, 10, 20, -1));
+    table.Append(RegionAnnotation(3, 1, 50, 60, -1));
+    table.Append(RegionAnnotation(7, 0, 5, 10, 900));
+    table.Append(RegionAnnotation(3, 2, 0, 60, 800));
+    table.IndexHoleNumbers();
+
+    //
+    // The regions of a hole keep their order.
+    //
+    int low, high;
+    ASSERT_EQ(2, table.LookupRegionsByHoleNumber(3, low, high));
+    EXPECT_EQ(50, table.GetStart(low));
+    EXPECT_EQ(HQRegion, table.GetType(low + 1));
+    ASSERT_EQ(2, table.LookupRegionsByHoleNumber(7, low, high));
+    EXPECT_EQ(10, table.GetStart(low));
+    EXPECT_EQ(900, table.GetScore(low + 1));
+    EXPECT_EQ(0, table.LookupRegionsByHoleNumber(5, low, high));
+
+    table.SortTableByHoleNumber();
+    ASSERT_EQ(2, table.LookupRegionsByHoleNumber(7, low, high));
+    EXPECT_EQ(5, table.GetStart(low));
+    EXPECT_EQ(7, table.GetAnnotation(low).GetHoleNumber());
+
+    vector<RegionAnnotation> annotations = table.GetAnnotations();
+    ASSERT_EQ(4, annotations.size());
+    EXPECT_EQ(3, annotations[0].GetHoleNumber());
+    EXPECT_EQ(60, annotations[1].GetEnd());
+    EXPECT_EQ(5, annotations[2].GetStart());
+    EXPECT_EQ(-1, annotations[3].GetScore());
+}
+
+TEST(RegionTableTest, StaleIndexFallsBack) {
+    srand(3);
+    RegionTable table;
+    MakeTable(table, 100, 1);
+    table.IndexHoleNumbers();
+    table.Append(RegionAnnotation(200, 2, 0, 100, 800));
+    EXPECT_FALSE(table.HoleNumbersAreIndexed());
+    ExpectSameLookups(table, 201);
+    table.IndexHoleNumbers();
+    ExpectSameLookups(table, 201);
+}
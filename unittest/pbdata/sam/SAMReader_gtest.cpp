@@ -0,0 +1,194 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  SAMReader_gtest.cpp
+ *
+ *    Description:  Test pbdata/sam/SAMReader.hpp and SAMAlignment.hpp
+ *
+ *        Version:  1.0
+ *       Compiler:  gcc
+ *
+ * =====================================================================================
+ */
+
+#include <stdlib.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "sam/SAMReader.hpp"
+#include "TestUtils.hpp"
+
+using namespace std;
+
+typedef SAMReader<SAMReferenceSequence, SAMReadGroup, SAMAlignment> Reader;
+
+static string MakeSAM(int nRecords) {
+    stringstream sam;
+    sam << "@HD\tVN:1.4\tSO:UNKNOWN\n"
+        << "@SQ\tSN:chr1\tLN:100000\n"
+        << "@SQ\tSN:chr2\tLN:5000\n"
+        << "@RG\tID:abcd1234\tPU:movie1\n"
+        << "@PG\tID:BLASR\tVN:1.3.1\n"
+        << "@CO\tcomment\n";
+    for (int i = 0; i < nRecords; i++) {
+        int length = 1 + rand() % 300;
+        if (i % 7 == 3) {
+            sam << "movie1/" << i << "/0_" << length << "\t4\t*\t0\t255\t*\t*\t0\t0\t"
+                << RandomSequence(length) << "\t*\n";
+            continue;
+        }
+        sam << "movie1/" << i << "/0_" << length << "\t" << (i % 2) * 16 << "\tchr"
+            << 1 + i % 2 << "\t" << 1 + rand() % 4000 << "\t" << rand() % 255 << "\t"
+            << length / 2 << "M1I" << length - length / 2 - 1 << "M\t*\t0\t-"
+            << rand() % 10 << "\t" << RandomSequence(length) << "\t*"
+            << "\tRG:Z:abcd1234\tAS:i:-" << rand() % 1000 << "\tXS:i:1\tXE:i:" << length
+            << "\tXL:i:" << length << "\tXT:i:1\tNM:i:" << rand() % 5 << "\tFI:i:1"
+            << "\tXQ:i:" << length;
+        if (i % 3 == 0) {
+            sam << "\tiq:Z:" << string(length, '!') << "\tdq:Z:" << string(length, '"')
+                << "\tsq:Z:" << string(length, '#') << "\tmq:Z:" << string(length, '$')
+                << "\tst:Z:" << RandomSequence(length) << "\tdt:Z:" << RandomSequence(length);
+        }
+        //
+        // The last record has no newline.
+        //
+        if (i + 1 < nRecords) {
+            sam << (i % 5 == 0 ? "\r\n" : "\n");
+        }
+    }
+    return sam.str();
+}
+
+static string SAMAlignmentToString(SAMAlignment &a) {
+    stringstream out;
+    out << a.qName << "|" << a.flag << "|" << a.rName << "|" << a.pos << "|"
+        << a.mapQV << "|" << a.cigar << "|" << a.rNext << "|" << a.pNext << "|"
+        << a.tLen << "|" << a.seq << "|" << a.qual << "|" << a.rg << "|" << a.as << "|"
+        << a.xs << "|" << a.xe << "|" << a.xl << "|" << a.xt << "|" << a.nm << "|"
+        << a.fi << "|" << a.xq << "|" << a.iq << "|" << a.dq << "|" << a.sq << "|"
+        << a.mq << "|" << a.st << "|" << a.dt << "|" << a.optTagStr;
+    return out.str();
+}
+
+TEST(SAMAlignmentTest, StoreValues) {
+    string line = "movie1/7/0_10\t16\tchr1\t101\t-2\t5M1I4M\t*\t0\t-3\tACGTAACGTA\t*"
+                  "\tRG:Z:abcd1234\tAS:i:-50\tXS:i:1\tXE:i:10\tXL:i:10\tXT:i:1"
+                  "\tNM:i:2\tFI:i:1\tXQ:i:10\tiq:Z:!!!!!!!!!!\tdt:Z:NNNNNNNNNN\r";
+    SAMAlignment alignment;
+    EXPECT_TRUE(alignment.StoreValues(line));
+    EXPECT_EQ(alignment.qName, "movie1/7/0_10");
+    EXPECT_EQ(alignment.flag, 16);
+    EXPECT_EQ(alignment.rName, "chr1");
+    EXPECT_EQ(alignment.pos, 101);
+    EXPECT_EQ(alignment.mapQV, 254);
+    EXPECT_EQ(alignment.cigar, "5M1I4M");
+    EXPECT_EQ(alignment.rNext, "*");
+    EXPECT_EQ(alignment.pNext, 0);
+    EXPECT_EQ(alignment.tLen, -3);
+    EXPECT_EQ(alignment.seq, "ACGTAACGTA");
+    EXPECT_EQ(alignment.qual, "*");
+    EXPECT_EQ(alignment.rg, "abcd1234");
+    EXPECT_EQ(alignment.as, -50);
+    EXPECT_EQ(alignment.xe, 10);
+    EXPECT_EQ(alignment.nm, 2);
+    EXPECT_EQ(alignment.xq, 10);
+    EXPECT_EQ(alignment.iq, "!!!!!!!!!!");
+    EXPECT_EQ(alignment.dt, "NNNNNNNNNN");
+    EXPECT_EQ(alignment.optTagStr, line.substr(line.find("RG:Z"), line.size() - line.find("RG:Z") - 1));
+
+    vector<int> lengths;
+    vector<char> ops;
+    alignment.cigar.Vectorize(lengths, ops);
+    ASSERT_EQ(lengths.size(), 3);
+    EXPECT_EQ(lengths[0], 5); EXPECT_EQ(ops[0], 'M');
+    EXPECT_EQ(lengths[1], 1); EXPECT_EQ(ops[1], 'I');
+    EXPECT_EQ(lengths[2], 4); EXPECT_EQ(ops[2], 'M');
+
+    //
+    // Reusing the alignment must not keep the optional fields of the
+    // previous record.
+    //
+    line = "movie1/8/0_4\t4\t*\t0\t255\t*\t*\t0\t0\tACGT\t*";
+    EXPECT_TRUE(alignment.StoreValues(line));
+    EXPECT_EQ(alignment.qName, "movie1/8/0_4");
+    EXPECT_EQ(alignment.rName, "*");
+    EXPECT_EQ(alignment.rg, "");
+    EXPECT_EQ(alignment.as, 0);
+    EXPECT_EQ(alignment.iq, "");
+    EXPECT_EQ(alignment.optTagStr, "");
+}
+
+TEST(SAMReaderTest, ReadAndGetNextAlignmentsAgree) {
+    srand(7);
+    string sam = MakeSAM(500);
+
+    //
+    // A tiny buffer makes every line straddle a refill.
+    //
+    AlignmentSet<> alignmentSet;
+    Reader reader(16);
+    stringstream in(sam);
+    reader.Initialize(&in);
+    reader.Read(alignmentSet);
+    ASSERT_EQ(alignmentSet.alignments.size(), 500);
+    EXPECT_EQ(alignmentSet.references.size(), 2);
+    EXPECT_EQ(alignmentSet.references[1].sequenceName, "chr2");
+    EXPECT_EQ(alignmentSet.readGroups.size(), 1);
+
+    stringstream lines(sam);
+    string line;
+    int i = 0;
+    while (getline(lines, line)) {
+        if (line[0] == '@') {
+            continue;
+        }
+        SAMAlignment expected;
+        expected.StoreValues(line);
+        ASSERT_EQ(SAMAlignmentToString(expected), SAMAlignmentToString(alignmentSet.alignments[i])) << i;
+        i++;
+    }
+
+    int bufferSizes[] = {64, 1000, 1 << 20};
+    for (int b = 0; b < 3; b++) {
+        for (int nThreads = 1; nThreads <= 3; nThreads++) {
+            AlignmentSet<> headerSet;
+            Reader blockReader(bufferSizes[b]);
+            stringstream blockIn(sam);
+            blockReader.Initialize(&blockIn);
+            EXPECT_EQ(blockReader.ReadHeader(headerSet).size(), 6);
+            vector<SAMAlignment> block;
+            int n, nRead = 0;
+            while ((n = blockReader.GetNextAlignments(block, 37, nThreads)) > 0) {
+                EXPECT_LE(n, 37);
+                for (int j = 0; j < n; j++) {
+                    ASSERT_EQ(SAMAlignmentToString(alignmentSet.alignments[nRead + j]),
+                              SAMAlignmentToString(block[j]))
+                        << "buffer " << bufferSizes[b] << " threads " << nThreads;
+                }
+                nRead += n;
+            }
+            EXPECT_EQ(nRead, 500);
+        }
+    }
+}
+
+TEST(SAMReaderTest, GetNextAlignment) {
+    srand(8);
+    string sam = MakeSAM(20);
+    AlignmentSet<> alignmentSet;
+    Reader reader(100);
+    stringstream in(sam);
+    reader.Initialize(&in);
+    reader.ReadHeader(alignmentSet);
+    EXPECT_EQ(alignmentSet.header.formatVersion, "1.4");
+    SAMAlignment alignment;
+    int n = 0;
+    while (reader.GetNextAlignment(alignment)) {
+        stringstream name;
+        name << "movie1/" << n << "/";
+        EXPECT_EQ(alignment.qName.find(name.str()), 0);
+        n++;
+    }
+    EXPECT_EQ(n, 20);
+}